@@ -45,13 +45,17 @@ struct OrtArenaCfg {
   uint64_t cuda_mempool_release_threshold = 0;
   // Bytes to keep on shrink for CudaMemPool, 0 is to attempt to release all, allocated space not affected.
   size_t cuda_mempool_bytes_to_keep_on_shrink = 0;
+  // Free bytes every thread may keep in its cache of small blocks (up to 64KB) of a BFCArena.
+  // Use -1 to allow ORT to choose the default, 0 disables the thread caches.
+  int64_t thread_cache_bytes = -1;
 
   bool IsValid() {
     return arena_extend_strategy >= -1 && arena_extend_strategy <= 1 &&
            initial_chunk_size_bytes >= -1 &&
            max_dead_bytes_per_chunk >= -1 &&
            initial_growth_chunk_size_bytes >= -1 &&
-           max_power_of_two_extend_bytes >= -1;
+           max_power_of_two_extend_bytes >= -1 &&
+           thread_cache_bytes >= -1;
   }
 
   // config key names that we parse in FromKeyValuePairs
@@ -65,6 +69,7 @@ struct OrtArenaCfg {
     static constexpr const char* UseCudaMemPool = "arena.use_cuda_mempool";
     static constexpr const char* CudaMempoolReleaseThreshold = "arena.cuda_mempool_release_threshold";
     static constexpr const char* CudaMempoolBytesToKeepOnShrink = "arena.cuda_mempool_bytes_to_keep_on_shrink";
+    static constexpr const char* ThreadCacheBytes = "arena.thread_cache_bytes";
   };
 
   static onnxruntime::common::Status FromKeyValuePairs(const OrtKeyValuePairs& kvps, OrtArenaCfg& cfg);
@@ -120,7 +120,8 @@ class OpKernel {
   //                            with it and it upto the kernel developer to store it in any order of their choice in PrePack()
   //                            and must use the same order for retrieval in UseSharedPrePackedBuffers(). Though each element
   //                           of this vector is a BufferUniquePtr, the deleter of the BufferUniquePtr is NULL. So actually they
-  //                           are raw pointers.
+  //                           are raw pointers. The buffers are shared with other kernels and sessions and may be
+  //                           read-only file mappings, so the kernel must never write into them.
   // @param input_idx: The input index of the tensor in this kernel
   // @param used_shared_buffers: Boolean flag set by the kernel implementation indicating
   // that the provided weight has been used by the kernel.
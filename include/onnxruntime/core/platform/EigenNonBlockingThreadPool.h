@@ -39,7 +39,9 @@
 #pragma warning(disable : 4127)
 #pragma warning(disable : 4805)
 #endif
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include "unsupported/Eigen/CXX11/ThreadPool"
 
 #if defined(__GNUC__)
@@ -788,6 +790,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
       all_coprimes_.emplace_back(i);
       ComputeCoprimes(i, &all_coprimes_.back());
     }
+    InitNumaPeers(thread_options);
 
     // Eigen::MaxSizeVector has neither essential exception safety features
     // such as swap, nor it is movable. So we have to join threads right here
@@ -1266,6 +1269,11 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
             work_item->fn(par_idx);
           }
           ps.workers_in_loop--;
+          if (GetPerThread()->leave_parallel_section) {
+            // The loop gave this worker up for other work, the main thread runs the
+            // remaining loops of the section.
+            break;
+          }
         }
       }
     };
@@ -1323,6 +1331,13 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     return -1;
   }
 
+  // Called from a task helping a parallel section so that, once the current
+  // loop of the section returns, the worker stops helping the section and
+  // goes back to its queue.
+  static void LeaveParallelSection() {
+    GetPerThread()->leave_parallel_section = true;
+  }
+
   void EnableSpinning() {
     spin_loop_status_ = SpinLoopStatus::kBusy;
   }
@@ -1376,6 +1391,10 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     Tag tag{};                        // Work item tag used to identify this thread.
     bool leading_par_section{false};  // Leading a parallel section (used only for asserts)
 
+    // Set when the running task gives up helping its parallel section, see
+    // LeaveParallelSection.
+    bool leave_parallel_section{false};
+
     // When this thread is entering a parallel section, it will
     // initially push work to this set of workers.  The aim is to
     // retain cache state within the workers, and to reduce the number
@@ -1498,6 +1517,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   const bool set_denormal_as_zero_;
   Eigen::MaxSizeVector<WorkerData> worker_data_;
   Eigen::MaxSizeVector<Eigen::MaxSizeVector<unsigned>> all_coprimes_;
+  // numa_peers_[i] lists the other workers running on the NUMA node of worker i.
+  // Empty unless the affinities of the workers span more than one node.
+  std::vector<std::vector<unsigned>> numa_peers_;
   std::atomic<unsigned> blocked_;  // Count of blocked workers, used as a termination condition
   std::atomic<bool> done_;
 
@@ -1632,6 +1654,7 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
 
       if (t) {
         td.SetActive();
+        pt->leave_parallel_section = false;
         t();
         profiler_.LogRun(thread_id);
         td.SetSpinning();
@@ -1652,9 +1675,32 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
   // "snatching" work from a thread which is just about to notice the
   // work itself.
 
+  //
+  // On NUMA systems a worker first steals from the workers of its own
+  // node: the stolen task then runs next to the caches and memory its
+  // neighbors have been touching.  A single attempt (made while
+  // spinning) never leaves the node, remote workers are only tried
+  // before blocking.
+
   Task Steal(StealAttemptKind steal_kind) {
     PerThread* pt = GetPerThread();
-    unsigned size = num_threads_;
+    if (!numa_peers_.empty() && pt->pool == this) {
+      const std::vector<unsigned>& peers = numa_peers_[pt->thread_id];
+      if (!peers.empty()) {
+        Task t = StealFromWorkers(pt, steal_kind, static_cast<unsigned>(peers.size()),
+                                  [&peers](unsigned i) { return peers[i]; });
+        if (t || steal_kind == StealAttemptKind::TRY_ONE) {
+          return t;
+        }
+      }
+    }
+    return StealFromWorkers(pt, steal_kind, num_threads_, [](unsigned i) { return i; });
+  }
+
+  // Visits the candidates [0, size) in a pseudo-random order, worker_index maps
+  // a candidate to the index of its worker in worker_data_.
+  template <typename WorkerIndex>
+  Task StealFromWorkers(PerThread* pt, StealAttemptKind steal_kind, unsigned size, WorkerIndex worker_index) {
     unsigned num_attempts = (steal_kind == StealAttemptKind::TRY_ALL) ? size : 1;
     unsigned r = Rand(&pt->rand);
     unsigned inc = all_coprimes_[size - 1][r % all_coprimes_[size - 1].size()];
@@ -1662,8 +1708,9 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
 
     for (unsigned i = 0; i < num_attempts; i++) {
       assert(victim < size);
-      if (worker_data_[victim].GetStatus() == WorkerData::ThreadStatus::Active) {
-        Task t = worker_data_[victim].queue.PopBack();
+      WorkerData& td = worker_data_[worker_index(victim)];
+      if (td.GetStatus() == WorkerData::ThreadStatus::Active) {
+        Task t = td.queue.PopBack();
         if (t) {
           return t;
         }
@@ -1677,6 +1724,42 @@ class ThreadPoolTempl : public onnxruntime::concurrency::ExtendedThreadPoolInter
     return Task();
   }
 
+  // Groups the workers by the NUMA node of the first logical processor of their
+  // affinity.  Workers without an affinity, or whose processor is not found in the
+  // topology, are grouped together.
+  void InitNumaPeers(const ThreadOptions& thread_options) {
+    if (thread_options.affinities.size() < num_threads_) {
+      return;
+    }
+    const std::vector<LogicalProcessors> numa_nodes = env_.GetNumaNodeProcessors();
+    if (numa_nodes.size() <= 1) {
+      return;
+    }
+    std::vector<int> worker_node(num_threads_, -1);
+    for (unsigned i = 0; i < num_threads_; ++i) {
+      const LogicalProcessors& affinity = thread_options.affinities[i];
+      if (affinity.empty()) {
+        continue;
+      }
+      for (size_t node = 0; node < numa_nodes.size() && worker_node[i] < 0; ++node) {
+        if (std::find(numa_nodes[node].begin(), numa_nodes[node].end(), affinity.front()) != numa_nodes[node].end()) {
+          worker_node[i] = static_cast<int>(node);
+        }
+      }
+    }
+    if (std::all_of(worker_node.begin(), worker_node.end(), [&](int node) { return node == worker_node[0]; })) {
+      return;
+    }
+    numa_peers_.resize(num_threads_);
+    for (unsigned i = 0; i < num_threads_; ++i) {
+      for (unsigned j = 0; j < num_threads_; ++j) {
+        if (j != i && worker_node[j] == worker_node[i]) {
+          numa_peers_[i].push_back(j);
+        }
+      }
+    }
+  }
+
   int NonEmptyQueueIndex() {
     PerThread* pt = GetPerThread();
     const unsigned size = static_cast<unsigned>(worker_data_.size());
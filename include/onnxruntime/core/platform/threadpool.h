@@ -121,6 +121,10 @@ class ThreadPoolInterface;
 
 namespace onnxruntime {
 
+namespace profiling {
+class LatencyHistogram;
+}  // namespace profiling
+
 struct TensorOpCost {
   double bytes_loaded;
   double bytes_stored;
@@ -221,6 +225,45 @@ class ThreadPool {
 
   void DisableSpinning();
 
+  // Priority classes of parallel loops.  A pool created with
+  // ThreadOptions::priority_class_weights shares its worker threads
+  // between the classes that have loops running, in proportion to
+  // their weights.  A worker helping a loop of a class that holds more
+  // than its share leaves the loop between two blocks of iterations
+  // when another class is below its share, so a latency-critical loop
+  // takes workers from a batch loop at block granularity.  The thread
+  // that entered a loop always runs it to completion: a loop loses
+  // helpers, but never starves.
+  //
+  // Without priority_class_weights, the classes are ignored.
+  enum class PriorityClass : uint8_t {
+    kHigh = 0,
+    kNormal = 1,
+    kLow = 2,
+  };
+  static constexpr size_t kNumPriorityClasses = 3;
+
+  // Sets the priority class of the parallel loops entered by the calling
+  // thread, for the lifetime of the object.  Threads that set no class
+  // run their loops as PriorityClass::kNormal.
+  class PriorityScope {
+   public:
+    explicit PriorityScope(PriorityClass priority_class);
+    ~PriorityScope();
+
+   private:
+    PriorityClass previous_;
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PriorityScope);
+  };
+
+  // Returns the histogram of the queueing delays of the loops of a
+  // priority class: the time between a thread entering a parallel loop
+  // and the first worker joining it.  Loops that no worker joined are
+  // not counted.  Returns nullptr if the pool was created without
+  // priority_class_weights.
+  static const profiling::LatencyHistogram* GetQueueingDelayHistogram(const ThreadPool* tp,
+                                                                      PriorityClass priority_class);
+
   // Schedules fn() for execution in the pool of threads.  The function may run
   // synchronously if it cannot be enqueued.  This will occur if the thread pool's
   // degree-of-parallelism is 1, but it may also occur for implementation-dependent
@@ -428,6 +471,11 @@ class ThreadPool {
 
   // Force the thread pool to run in hybrid mode on a normal cpu.
   bool force_hybrid_ = false;
+
+  // Shares the workers between the priority classes, nullptr unless the
+  // pool was created with priority_class_weights.
+  class PriorityScheduler;
+  std::unique_ptr<PriorityScheduler> priority_scheduler_;
 };
 
 }  // namespace concurrency
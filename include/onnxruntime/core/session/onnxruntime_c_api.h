@@ -3220,6 +3220,8 @@ struct OrtApi {
    *  Use -1 to allow ORT to choose the default 1GB for max_power_of_two_extend_bytes.
    *  Ultimately, the allocation size is determined by the allocation memory request.
    *  Further allocation sizes are governed by the arena extend strategy.
+   * "thread_cache_bytes": Free memory every thread may keep in its cache of small blocks (up to 64KB).
+   *  Allocations served by the cache of the calling thread do not lock the arena. Default is 0 (disabled).
    *
    * \param[in] arena_config_keys Keys to configure the arena
    * \param[in] arena_config_values Values to configure the arena
@@ -4863,6 +4865,12 @@ struct OrtApi {
                   _In_reads_(num_keys) const char* const* provider_options_keys, _In_reads_(num_keys) const char* const* provider_options_values, _In_ size_t num_keys);
 
   /** \brief Run the model asynchronously in a thread owned by intra op thread pool
+   *
+   * If the session config entry "session.run_async_max_concurrency" is set, the request is queued in the session
+   * instead, and run by threads the session creates for it. With "session.run_async_max_batch_size", queued
+   * requests may be merged into one run along the input axis set by "session.run_async_batch_axis" (the first
+   * dimension by default). "session.run_async_max_delay_us" sets how long a request may wait for others to merge
+   * with. With "session.run_micro_batching", concurrent synchronous Run calls go through the same queue.
    *
    * \param[in] session
    * \param[in] run_options If nullptr, will use a default ::OrtRunOptions
@@ -7242,6 +7250,63 @@ struct OrtApi {
    * \since Version 1.25.
    */
   ORT_API2_STATUS(RunOptionsDisableProfiling, _Inout_ OrtRunOptions* options);
+
+  /** \brief Get a percentile of the latency of a node, measured by the sampling profiler
+   *
+   * The sampling profiler is enabled with the "session.sampling_profiler_rate" or
+   * "session.sampling_profiler_interval_ms" session config entries. It records the latency of the nodes of the
+   * main graph in a sample of the runs into histograms whose buckets are within 1/8 of the values they hold.
+   *
+   * \param[in] session
+   * \param[in] node_name Name of a node of the main graph.
+   * \param[in] percentile Percentile in [0, 100], e.g. 50 or 99.
+   * \param[out] latency_ns The latency in nanoseconds, 0 if no run was sampled yet.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.25.
+   */
+  ORT_API2_STATUS(SessionGetSampledNodeLatency, _In_ const OrtSession* session, _In_ const char* node_name,
+                  _In_ double percentile, _Out_ uint64_t* latency_ns);
+
+  /** \brief Set the weights of the priority classes of the parallel loops in the global intra-op thread pool
+   *
+   * The workers of the pool are shared between the priority classes that have loops running, in proportion to
+   * their weights. A worker helping a loop of a class above its share leaves it, between two blocks of iterations,
+   * for a class below its share; the thread that entered a loop always completes it. A class with a weight of 0
+   * only gets the workers the other classes do not need. The sessions choose their class with the
+   * "session.intra_op_priority_class" session config entry, and runs with the "run.intra_op_priority_class" run
+   * config entry.
+   *
+   * \param[in] tp_options
+   * \param[in] weights The weights of the high, normal and low priority classes, in that order.
+   * \param[in] num_weights Must be 3.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.25.
+   */
+  ORT_API2_STATUS(SetGlobalIntraOpPriorityClassWeights, _Inout_ OrtThreadingOptions* tp_options,
+                  _In_reads_(num_weights) const int* weights, _In_ size_t num_weights);
+
+  /** \brief Get a percentile of the queueing delay of the parallel loops of a priority class
+   *
+   * The queueing delay of a loop is the time between a kernel entering it and the first worker of the intra-op
+   * thread pool joining it. It is only measured by thread pools created with priority class weights, see
+   * OrtApi::SetGlobalIntraOpPriorityClassWeights and "session.intra_op_priority_class_weights". With the global
+   * thread pools, the delays include the loops of all the sessions sharing the pool.
+   *
+   * \param[in] session
+   * \param[in] priority_class 0 for high, 1 for normal, 2 for low.
+   * \param[in] percentile Percentile in [0, 100], e.g. 50 or 99.
+   * \param[out] delay_ns The delay in nanoseconds, 0 if no loop of the class was joined yet.
+   *
+   * \snippet{doc} snippets.dox OrtStatus Return Value
+   *
+   * \since Version 1.25.
+   */
+  ORT_API2_STATUS(SessionGetIntraOpQueueingDelay, _In_ const OrtSession* session, _In_ int priority_class,
+                  _In_ double percentile, _Out_ uint64_t* delay_ns);
 };
 
 /*
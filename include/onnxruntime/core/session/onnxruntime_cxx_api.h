@@ -848,6 +848,9 @@ struct ThreadingOptions : detail::Base<OrtThreadingOptions> {
 
   /// \brief Wraps OrtApi::SetGlobalCustomJoinThreadFn
   ThreadingOptions& SetGlobalCustomJoinThreadFn(OrtCustomJoinThreadFn ort_custom_join_thread_fn);
+
+  /// \brief Wraps OrtApi::SetGlobalIntraOpPriorityClassWeights
+  ThreadingOptions& SetGlobalIntraOpPriorityClassWeights(int high, int normal, int low);
 };
 
 /** \brief The TensorRTOptions (V2)
@@ -1747,6 +1750,15 @@ struct ConstSessionImpl : Base<T> {
   uint64_t GetProfilingStartTimeNs() const;  ///< Wraps OrtApi::SessionGetProfilingStartTimeNs
   ModelMetadata GetModelMetadata() const;    ///< Wraps OrtApi::SessionGetModelMetadata
 
+  /// Returns a percentile, in [0, 100], of the latency in nanoseconds of a node measured by the sampling profiler.
+  /// Wraps OrtApi::SessionGetSampledNodeLatency
+  uint64_t GetSampledNodeLatency(const char* node_name, double percentile) const;
+
+  /// Returns a percentile, in [0, 100], of the queueing delay in nanoseconds of the parallel loops of a priority
+  /// class (0 high, 1 normal, 2 low) in the intra-op thread pool.
+  /// Wraps OrtApi::SessionGetIntraOpQueueingDelay
+  uint64_t GetIntraOpQueueingDelay(int priority_class, double percentile) const;
+
   TypeInfo GetInputTypeInfo(size_t index) const;                   ///< Wraps OrtApi::SessionGetInputTypeInfo
   TypeInfo GetOutputTypeInfo(size_t index) const;                  ///< Wraps OrtApi::SessionGetOutputTypeInfo
   TypeInfo GetOverridableInitializerTypeInfo(size_t index) const;  ///< Wraps OrtApi::SessionGetOverridableInitializerTypeInfo
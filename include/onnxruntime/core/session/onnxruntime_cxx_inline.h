@@ -500,6 +500,12 @@ inline ThreadingOptions& ThreadingOptions::SetGlobalCustomJoinThreadFn(OrtCustom
   return *this;
 }
 
+inline ThreadingOptions& ThreadingOptions::SetGlobalIntraOpPriorityClassWeights(int high, int normal, int low) {
+  const int weights[] = {high, normal, low};
+  ThrowOnError(GetApi().SetGlobalIntraOpPriorityClassWeights(p_, weights, 3));
+  return *this;
+}
+
 inline TensorRTProviderOptions::TensorRTProviderOptions() {
   ThrowOnError(GetApi().CreateTensorRTProviderOptions(&this->p_));
 }
@@ -1773,6 +1779,20 @@ inline uint64_t ConstSessionImpl<T>::GetProfilingStartTimeNs() const {
   return out;
 }
 
+template <typename T>
+inline uint64_t ConstSessionImpl<T>::GetSampledNodeLatency(const char* node_name, double percentile) const {
+  uint64_t out;
+  ThrowOnError(GetApi().SessionGetSampledNodeLatency(this->p_, node_name, percentile, &out));
+  return out;
+}
+
+template <typename T>
+inline uint64_t ConstSessionImpl<T>::GetIntraOpQueueingDelay(int priority_class, double percentile) const {
+  uint64_t out;
+  ThrowOnError(GetApi().SessionGetIntraOpQueueingDelay(this->p_, priority_class, percentile, &out));
+  return out;
+}
+
 template <typename T>
 inline ModelMetadata ConstSessionImpl<T>::GetModelMetadata() const {
   OrtModelMetadata* out;
@@ -52,3 +52,8 @@ static const char* const kOrtRunOptionsConfigQnnLoraConfig = "qnn.lora_config";
 // If the value is set to -1, cuda graph capture/replay is disabled in that run.
 // User are not expected to set the value to 0 as it is reserved for internal use.
 static const char* const kOrtRunOptionsConfigCudaGraphAnnotation = "gpu_graph_id";
+
+// Priority class of the parallel loops of this run in the intra-op thread pool: "high", "normal" or "low".
+// Overrides the session config entry "session.intra_op_priority_class". Only has an effect on thread pools created
+// with priority class weights.
+static const char* const kOrtRunOptionsConfigIntraOpPriorityClass = "run.intra_op_priority_class";
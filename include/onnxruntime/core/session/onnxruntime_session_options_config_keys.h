@@ -304,6 +304,140 @@ static const char* const kOrtSessionOptionsModelExternalInitializersFileFolderPa
 static const char* const kOrtSessionOptionsSavePrePackedConstantInitializers =
     "session.save_external_prepacked_constant_initializers";
 
+// Directory used as a content-addressed cache of pre-packed constant initializers.
+// Every pre-packed weight is written once into this directory (one file per op type and hash of the
+// pre-packed buffers) and memory mapped from it, so that processes loading the same model on the same host
+// share the physical pages holding the pre-packed weights instead of keeping one heap copy each.
+// The directory must exist and be writable. Pages modified by a kernel after pre-packing are copied on write.
+//
+// - "": Default, pre-packed weights are kept on the heap.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsPrePackedWeightsCacheDir, "/var/cache/ort")
+static const char* const kOrtSessionOptionsPrePackedWeightsCacheDir =
+    "session.prepacked_weights_cache_dir";
+
+// Map every external data file of the model once, in full and read-only, and let the initializers placed on CPU
+// alias that mapping. The pages are shared with the file system cache and with the other processes loading
+// the same files, and the platform is advised to read them ahead and to back them with huge pages.
+// Initializers stored inside the model file are not affected.
+// Kernels must not write into their initializers when this is enabled: the pages are not copied on write.
+// Pre-packed weights stored with the external data keep their private copy-on-write mapping, as kernels may update
+// the pre-packed buffers they are given.
+//
+// - "0": Default, every external initializer gets its own private copy-on-write mapping.
+// - "1": Map external data files read-only.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsMapExternalInitializersReadOnly, "1")
+static const char* const kOrtSessionOptionsMapExternalInitializersReadOnly =
+    "session.map_external_initializers_read_only";
+
+// Maximum number of memory patterns kept by a session when the memory pattern optimization is enabled.
+// A pattern is recorded for every distinct set of input shapes: the first run with these shapes traces its
+// allocations, the following ones place all the intermediate tensors in one pre-allocated block.
+// Once the cache is full, the least recently used pattern is dropped.
+//
+// - "0": Default, no limit.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsMemoryPatternCacheCapacity, "64")
+static const char* const kOrtSessionOptionsMemoryPatternCacheCapacity = "session.memory_pattern_cache_capacity";
+
+// Plan the memory pattern of a model ahead of the first run instead of tracing it, when the graph inputs and the
+// intermediate tensors have static shapes. The offsets of the tensors in the block are packed from their lifetimes
+// in the execution plan, and the outputs of elementwise CPU kernels reuse the buffer of an input used for the last
+// time. Requires the memory pattern optimization and sequential execution. Tensors with dynamic shapes are still
+// allocated at run time. The planned and the naive peak sizes are logged at INFO level.
+// The pattern is used when the inputs are fed with their declared shapes, in the order of the graph inputs.
+//
+// - "0": Default, the memory pattern is traced during the first run with given input shapes.
+// - "1": Plan the memory pattern when the session is created.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsStaticMemoryPlanning, "1")
+static const char* const kOrtSessionOptionsStaticMemoryPlanning = "session.static_memory_planning";
+
+// Collect hardware performance counters around every kernel when profiling is enabled: cycles, instructions,
+// last level cache misses and branch misses. They are added to the arguments of the node events, and
+// EndProfiling writes one event per op type with their sums, the instructions per cycle and the cache misses per
+// thousand instructions, and logs them as a table at INFO level. Available on Linux through perf_event_open.
+// The counters cover the thread running the kernel, not the intra-op thread pool, so set intra_op_num_threads to 1
+// to count the whole kernel.
+//
+// - "0": Default, no hardware counters.
+// - "1": Collect hardware counters.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsProfileHardwareCounters, "1")
+static const char* const kOrtSessionOptionsProfileHardwareCounters = "session.profile_hardware_counters";
+
+// Measure the latency of every node of the main graph in a sample of the Run calls, without enable_profiling.
+// The latencies go into lock-free histograms, one per node, that OrtApi::SessionGetSampledNodeLatency queries,
+// e.g. for the p50 and p99 of a node. Runs that are not sampled only pay for an atomic increment, so this can stay
+// on in production. A run is sampled if either the rate or the interval below selects it.
+//
+// Sample one in every N runs.
+// - "0": Default, no sampling by rate.
+// - "N": Sample one in every N runs, "1" samples every run.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsSamplingProfilerRate, "100")
+static const char* const kOrtSessionOptionsSamplingProfilerRate = "session.sampling_profiler_rate";
+
+// Sample a run if at least this many milliseconds passed since the last sampled run.
+// - "0": Default, no sampling by time.
+// - "N": Sample one run every N milliseconds.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsSamplingProfilerIntervalMs, "1000")
+static const char* const kOrtSessionOptionsSamplingProfilerIntervalMs = "session.sampling_profiler_interval_ms";
+
+// Maximum number of RunAsync requests running at the same time. When set, RunAsync requests go to a queue in the
+// session that is served by this many threads of its own, instead of being scheduled on the intra-op thread pool.
+// Requests beyond the limit wait in the queue without holding a thread.
+// - "0": Default, RunAsync schedules each request on the intra-op thread pool.
+// - "N": Run at most N requests at the same time.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsRunAsyncMaxConcurrency, "2")
+static const char* const kOrtSessionOptionsRunAsyncMaxConcurrency = "session.run_async_max_concurrency";
+
+// Maximum batch size of merged RunAsync requests, used with kOrtSessionOptionsRunAsyncMaxConcurrency.
+// Queued requests with the same input and output names, CPU inputs of the same types and of the same shapes but
+// for the batch axis, and no pre-allocated outputs, are run together on their inputs concatenated along the
+// batch axis, and the outputs are split back. Only enable for models whose inputs and outputs all have a
+// dynamic batch on the batch axis, and whose batch items are independent of each other.
+// - "1": Default, requests are not merged.
+// - "N": Merge requests up to a total batch size of N.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsRunAsyncMaxBatchSize, "16")
+static const char* const kOrtSessionOptionsRunAsyncMaxBatchSize = "session.run_async_max_batch_size";
+
+// Axis the merged requests are concatenated along, used with kOrtSessionOptionsRunAsyncMaxBatchSize.
+// - "0": Default, the first dimension is the batch.
+// - "N": Dimension N is the batch.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsRunAsyncBatchAxis, "1")
+static const char* const kOrtSessionOptionsRunAsyncBatchAxis = "session.run_async_batch_axis";
+
+// How long, in microseconds, a request may wait for other requests to merge with, used with
+// kOrtSessionOptionsRunAsyncMaxBatchSize. Longer delays make larger batches at the cost of the latency of the
+// requests that arrive when the session is idle.
+// - "0": Default, only the requests already queued are merged.
+// - "N": Wait up to N microseconds after the first request of a batch was queued.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsRunAsyncMaxDelayUs, "2000")
+static const char* const kOrtSessionOptionsRunAsyncMaxDelayUs = "session.run_async_max_delay_us";
+
+// Route the synchronous Run calls through the RunAsync queue, so that concurrent Run calls can be merged into one
+// batch as configured by kOrtSessionOptionsRunAsyncMaxBatchSize. Each call blocks until its part of the batch is
+// ready. Runs with IOBinding are not merged. Without kOrtSessionOptionsRunAsyncMaxConcurrency, the queue has a
+// single dispatcher.
+// - "0": Default, Run executes on the calling thread.
+// - "1": Run goes through the queue.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsRunMicroBatching, "1")
+static const char* const kOrtSessionOptionsRunMicroBatching = "session.run_micro_batching";
+
+// Weights of the priority classes of the parallel loops in the intra-op thread pool of the session, as
+// "<high>;<normal>;<low>". The workers are shared between the classes that have loops running in proportion to
+// their weights: a worker helping a loop of a class above its share leaves it, between two blocks of iterations,
+// for a class below its share. A class with a weight of 0 only gets the workers the other classes do not need.
+// Only applies to the pools of the session, see OrtApi::SetGlobalIntraOpPriorityClassWeights for the global pool.
+// - "": Default, priority classes are ignored.
+// - "H;N;L": Share the workers in proportion to these weights.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsIntraOpPriorityClassWeights, "8;2;0")
+static const char* const kOrtSessionOptionsIntraOpPriorityClassWeights = "session.intra_op_priority_class_weights";
+
+// Priority class of the parallel loops of the runs of this session, see
+// kOrtSessionOptionsIntraOpPriorityClassWeights. A run can override it with the run config entry
+// "run.intra_op_priority_class".
+// - "normal": Default.
+// - "high", "low": For latency-critical or batch scoring models sharing a thread pool.
+// Sample usage: sess_options.add_session_config_entry(kOrtSessionOptionsIntraOpPriorityClass, "high")
+static const char* const kOrtSessionOptionsIntraOpPriorityClass = "session.intra_op_priority_class";
+
 // Use this config when you want to collect memory stats for each node in the graph.
 // The file format is a CSV file with the following columns:
 // The file will be created if it does not exist, and will be overwritten if it does.
@@ -374,6 +508,20 @@ static const char* const kOrtSessionOptionsEpContextModelExternalInitializersFil
 // - "1": Gemm FastMath mode is enabled.
 static const char* const kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16 = "mlas.enable_gemm_fastmath_arm64_bfloat16";
 
+// Allow the fp32 Conv kernel to use the Winograd and FFT algorithms when they are cheaper than expanding the input.
+// These algorithms round differently from the direct computation, so results are not bit-exact.
+// Option values:
+// - "0": Only use the direct algorithms. [DEFAULT]
+// - "1": Allow the Winograd and FFT algorithms.
+static const char* const kOrtSessionOptionsMlasConvFastAlgorithms = "mlas.enable_conv_fast_algorithms";
+
+// Let the TreeEnsemble kernels evaluate ensembles of small trees with the QuickScorer bitvector algorithm.
+// Its scan is scalar, so ensembles of few deep trees may run faster node by node.
+// Option values:
+// - "0": Always walk the trees node by node.
+// - "1": Use QuickScorer for the ensembles it supports. [DEFAULT]
+static const char* const kOrtSessionOptionsTreeEnsembleQuickScorer = "session.tree_ensemble_quick_scorer";
+
 // Use LUT (Lookup Table) based GEMM for quantized models when available.
 // Option values:
 // - "0": Do not use LUT based GEMM. [DEFAULT]
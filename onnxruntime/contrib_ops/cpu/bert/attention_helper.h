@@ -3,7 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <type_traits>
 #include "core/util/math.h"
 #include "core/util/math_cpuonly.h"
 #include "core/common/safeint.h"
@@ -175,5 +178,90 @@ T* ConcatStateChunkGQA(const T* past,
   return start;
 }
 
+// Symmetric quantization of the GroupQueryAttention KV cache. An int8_t cache holds one value per byte. A uint8_t
+// cache holds two int4 values per byte, biased by 8, with the even element in the low nibble.
+template <typename TCache>
+constexpr size_t QuantizedKVHeadSize(size_t head_size) {
+  static_assert(std::is_same_v<TCache, int8_t> || std::is_same_v<TCache, uint8_t>);
+  return std::is_same_v<TCache, uint8_t> ? (head_size + 1) / 2 : head_size;
+}
+
+// Value of a cache byte that decodes to zero.
+template <typename TCache>
+constexpr TCache QuantizedKVZero() {
+  return std::is_same_v<TCache, uint8_t> ? static_cast<TCache>(0x88) : static_cast<TCache>(0);
+}
+
+// Quantizes rows x head_size values as q = clamp(round(x / scale), qmin, qmax), with one scale per channel or a
+// single scale for all channels.
+template <typename T, typename TCache>
+void QuantizeKVChunk(const T* input, TCache* output, size_t rows, size_t head_size, const float* scale,
+                     bool per_channel) {
+  constexpr bool is_int4 = std::is_same_v<TCache, uint8_t>;
+  constexpr float qmin = is_int4 ? -8.0f : -128.0f;
+  constexpr float qmax = is_int4 ? 7.0f : 127.0f;
+  auto quantize = [&](const T* x, size_t h) {
+    // A zero scale (e.g. an all-zero channel) quantizes to zero, as in the CUDA kernel.
+    const float s = per_channel ? scale[h] : scale[0];
+    const float inv_s = s == 0.0f ? 0.0f : 1.0f / s;
+    return static_cast<int>(std::clamp(std::nearbyint(static_cast<float>(x[h]) * inv_s), qmin, qmax));
+  };
+
+  const size_t cache_head_size = QuantizedKVHeadSize<TCache>(head_size);
+  for (size_t r = 0; r < rows; r++) {
+    const T* x = input + r * head_size;
+    TCache* q = output + r * cache_head_size;
+    if constexpr (is_int4) {
+      for (size_t h = 0; h < head_size; h += 2) {
+        const int q0 = quantize(x, h);
+        const int q1 = h + 1 < head_size ? quantize(x, h + 1) : 0;
+        q[h / 2] = static_cast<uint8_t>(((q0 + 8) & 0x0F) | (((q1 + 8) & 0x0F) << 4));
+      }
+    } else {
+      for (size_t h = 0; h < head_size; h++) {
+        q[h] = static_cast<int8_t>(quantize(x, h));
+      }
+    }
+  }
+}
+
+// Returns the dot product of a float vector and the quantized values of one cache row. The caller folds the
+// dequantization scale into x.
+template <typename TCache>
+inline float QuantizedKVDot(const float* x, const TCache* row, size_t head_size) {
+  float sum = 0.0f;
+  if constexpr (std::is_same_v<TCache, uint8_t>) {
+    for (size_t h = 0; h < head_size / 2; h++) {
+      sum += x[2 * h] * static_cast<float>((row[h] & 0x0F) - 8) + x[2 * h + 1] * static_cast<float>((row[h] >> 4) - 8);
+    }
+    if (head_size % 2 != 0) {
+      sum += x[head_size - 1] * static_cast<float>((row[head_size / 2] & 0x0F) - 8);
+    }
+  } else {
+    for (size_t h = 0; h < head_size; h++) {
+      sum += x[h] * static_cast<float>(row[h]);
+    }
+  }
+  return sum;
+}
+
+// Computes y += a * row on the quantized values of one cache row. The caller applies the dequantization scale to y.
+template <typename TCache>
+inline void QuantizedKVAxpy(float a, const TCache* row, size_t head_size, float* y) {
+  if constexpr (std::is_same_v<TCache, uint8_t>) {
+    for (size_t h = 0; h < head_size / 2; h++) {
+      y[2 * h] += a * static_cast<float>((row[h] & 0x0F) - 8);
+      y[2 * h + 1] += a * static_cast<float>((row[h] >> 4) - 8);
+    }
+    if (head_size % 2 != 0) {
+      y[head_size - 1] += a * static_cast<float>((row[head_size / 2] & 0x0F) - 8);
+    }
+  } else {
+    for (size_t h = 0; h < head_size; h++) {
+      y[h] += a * static_cast<float>(row[h]);
+    }
+  }
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
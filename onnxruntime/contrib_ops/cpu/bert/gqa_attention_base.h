@@ -11,6 +11,8 @@
 #include "core/common/common.h"
 #include "core/common/safeint.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/env.h"
+#include "core/platform/env_var_utils.h"
 
 namespace onnxruntime {
 namespace contrib {
@@ -37,6 +39,9 @@ class GQAAttentionBase {
     local_window_size_ = has_local ? static_cast<int>(info.GetAttrOrDefault<int64_t>("local_window_size", -1)) : -1;
 
     qk_output_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("qk_output", static_cast<int64_t>(QKOutputType::NO_OUTPUT)));
+
+    l2_cache_size_ = Env::Default().GetL2CacheSize();
+    disable_flash_ = ParseEnvironmentVariableWithDefault<bool>(attention::kDisableFlashAttention, false);
   }
 
   int num_heads_;     // number of attention heads of Q
@@ -50,6 +55,9 @@ class GQAAttentionBase {
 
   bool use_smooth_softmax_;
 
+  int l2_cache_size_;
+  bool disable_flash_;
+
   template <typename T>
   Status ApplyAttention(const T* Q,                                 // Q data with shape BxNxSxH
                         const T* K,                                 // K data with shape BxN_kvxSxH
@@ -82,6 +90,25 @@ class GQAAttentionBase {
     }
     int seqlen_present_kv_cache = static_cast<int>(present_key->Shape().GetDims()[2]);
 
+    // The flash attention kernel never materializes the BxNxSxT probabilities, which dominate memory traffic for
+    // long prompts. Token generation (S = 1) keeps the GEMM based path since its probabilities are small.
+    if constexpr (std::is_same_v<T, float>) {
+      if (!disable_flash_ && l2_cache_size_ > 0 && sequence_length > 1 &&
+          attention_bias == nullptr && output_qk == nullptr) {
+        const T* past_key_data = past_key != nullptr ? past_key->Data<T>() : nullptr;
+        const T* past_value_data = past_value != nullptr ? past_value->Data<T>() : nullptr;
+        const T* k = packed_qkv ? Q + num_heads_ * sequence_length * head_size : K;
+        const T* v = packed_qkv ? Q + (num_heads_ + kv_num_heads_) * sequence_length * head_size : V;
+        ConcatPresentKV(k, v, seqlens_k->Data<int32_t>(), batch_size, sequence_length, seqlen_past_kv_cache,
+                        seqlen_present_kv_cache, head_size, past_key_data, past_value_data,
+                        present_key->MutableData<T>(), present_value->MutableData<T>(), packed_qkv, is_prompt, tp);
+        ApplyFlashAttention(Q, head_sink, seqlens_k->Data<int32_t>(), batch_size, sequence_length,
+                            seqlen_present_kv_cache, head_size, present_key->Data<T>(), present_value->Data<T>(),
+                            output->MutableData<T>(), packed_qkv, tp, allocator);
+        return Status::OK();
+      }
+    }
+
     // Compute the attention score.
     bool gqa_mlas_supported = MlasGQASupported<T>(CblasNoTrans, CblasTrans) &&
                               MlasGQASupported<T>(CblasNoTrans, CblasNoTrans);
@@ -134,7 +161,487 @@ class GQAAttentionBase {
     return Status::OK();
   }
 
+  // Paged KV-cache variant of ApplyAttention. Q, K and V hold only the new tokens of every sequence, packed back to
+  // back without padding. The KV cache is a pool of fixed-size pages shared by all sequences, and block_table maps
+  // the logical pages of each sequence to physical pages of the pool, so no contiguous past/present buffer is needed.
+  // The sequence lengths and block table are expected to be validated by paged_attention_helper::CheckSequenceData.
+  template <typename T>
+  Status ApplyPagedAttention(const T* Q,                                  // Q data with shape (token_count, q_stride)
+                             const T* K,                                  // K data with shape (token_count, kv_stride)
+                             const T* V,                                  // V data with shape (token_count, kv_stride)
+                             const size_t q_stride,                       // row stride of Q
+                             const size_t kv_stride,                      // row stride of K and V
+                             T* key_cache,                                // (num_blocks, block_size, N_kv, H)
+                             T* value_cache,                              // (num_blocks, block_size, N_kv, H)
+                             const int32_t* cumulative_seqlens_q,         // (batch_size + 1)
+                             const int32_t* past_seqlens,                 // (batch_size)
+                             const int32_t* block_table,                  // (batch_size, max_num_blocks_per_seq)
+                             T* output,                                   // output with shape (token_count, hidden_size)
+                             const PagedAttentionParameters& parameters,  // attention parameters
+                             AllocatorPtr allocator,                      // allocator for temporary buffers
+                             OpKernelContext* context) const {
+    const size_t batch_size = static_cast<size_t>(parameters.batch_size);
+    const size_t head_size = static_cast<size_t>(parameters.head_size);
+    const size_t hidden_size = static_cast<size_t>(parameters.hidden_size);
+    const size_t kv_hidden_size = static_cast<size_t>(parameters.kv_hidden_size);
+    const size_t block_size = static_cast<size_t>(parameters.block_size);
+    const size_t max_num_blocks_per_seq = static_cast<size_t>(parameters.max_num_blocks_per_seq);
+    const size_t kv_num_heads_factor = num_heads_ / kv_num_heads_;
+
+    auto* tp = context->GetOperatorThreadPool();
+
+    // Append the new keys and values to the pages. A (slot, N_kv, H) row of the pool has the same layout as a row
+    // of K and V, so every new token is a single contiguous copy per cache.
+    const size_t kv_row_bytes = kv_hidden_size * sizeof(T);
+    const double copy_cost = static_cast<double>(parameters.token_count) / batch_size * kv_row_bytes * 2;
+    ThreadPool::TryParallelFor(tp, batch_size, TensorOpCost{copy_cost, copy_cost, 0.0},
+                               [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+                                 for (std::ptrdiff_t b = begin; b != end; ++b) {
+                                   const int32_t* blocks = block_table + b * max_num_blocks_per_seq;
+                                   size_t position = static_cast<size_t>(past_seqlens[b]);
+                                   for (int32_t t = cumulative_seqlens_q[b]; t < cumulative_seqlens_q[b + 1]; t++, position++) {
+                                     const size_t slot = static_cast<size_t>(blocks[position / block_size]) * block_size +
+                                                         position % block_size;
+                                     memcpy(key_cache + slot * kv_hidden_size, K + t * kv_stride, kv_row_bytes);
+                                     memcpy(value_cache + slot * kv_hidden_size, V + t * kv_stride, kv_row_bytes);
+                                   }
+                                 }
+                               });
+
+    const size_t loop_len = batch_size * num_heads_;
+    const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+
+    // Cost of the two GEMMs of an average (sequence, head) pair.
+    const double average_new_seqlen = static_cast<double>(parameters.token_count) / batch_size;
+    double average_total_seqlen = 0.0;
+    for (size_t b = 0; b < batch_size; b++) {
+      average_total_seqlen += static_cast<double>(cumulative_seqlens_q[b + 1] - cumulative_seqlens_q[b] + past_seqlens[b]);
+    }
+    average_total_seqlen /= batch_size;
+    TensorOpCost unit_cost;
+    unit_cost.compute_cycles = 4.0 * average_new_seqlen * average_total_seqlen * head_size;
+    unit_cost.bytes_loaded = (average_new_seqlen + 2.0 * average_total_seqlen) * head_size * sizeof(T);
+    unit_cost.bytes_stored = average_new_seqlen * head_size * sizeof(T);
+
+    ThreadPool::TryParallelFor(tp, loop_len, unit_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      for (std::ptrdiff_t i = begin; i != end; ++i) {
+        const size_t batch_index = i / num_heads_;
+        const size_t head_index = i % num_heads_;
+        const size_t kv_head_index = head_index / kv_num_heads_factor;
+        const size_t token_offset = static_cast<size_t>(cumulative_seqlens_q[batch_index]);
+        const size_t sequence_length = static_cast<size_t>(cumulative_seqlens_q[batch_index + 1]) - token_offset;
+        if (sequence_length == 0) {
+          continue;
+        }
+        const size_t past_seqlen = static_cast<size_t>(past_seqlens[batch_index]);
+        const size_t total_seqlen = past_seqlen + sequence_length;
+        const size_t num_pages = (total_seqlen + block_size - 1) / block_size;
+        const int32_t* blocks = block_table + batch_index * max_num_blocks_per_seq;
+
+        // Pages that lie entirely before the local window of the first query token are never read.
+        size_t first_page = 0;
+        if (local_window_size_ >= 0 && past_seqlen + 1 > static_cast<size_t>(local_window_size_)) {
+          first_page = (past_seqlen + 1 - local_window_size_) / block_size;
+        }
+        const size_t first_column = first_page * block_size;
+
+        // Scores are kept in fp32. For fp16 the query, the current page and the output are staged in fp32 as well.
+        size_t scratch_elements = sequence_length * total_seqlen;
+        if constexpr (!std::is_same_v<T, float>) {
+          scratch_elements += (2 * sequence_length + block_size) * head_size;
+        }
+        auto scratch = allocator->Alloc(SafeInt<size_t>(scratch_elements) * sizeof(float));
+        BufferUniquePtr scratch_buffer(scratch, BufferDeleter(allocator));
+        float* scores = static_cast<float*>(scratch);
+
+        const T* q = Q + token_offset * q_stride + head_index * head_size;
+        T* out = output + token_offset * hidden_size + head_index * head_size;
+
+        const float* q_data;
+        size_t q_ld;
+        float* page_fp32 = nullptr;
+        float* out_fp32 = nullptr;
+        if constexpr (std::is_same_v<T, float>) {
+          q_data = q;
+          q_ld = q_stride;
+        } else {
+          float* q_fp32 = scores + sequence_length * total_seqlen;
+          for (size_t s = 0; s < sequence_length; s++) {
+            MlasConvertHalfToFloatBuffer(q + s * q_stride, q_fp32 + s * head_size, head_size);
+          }
+          q_data = q_fp32;
+          q_ld = head_size;
+          page_fp32 = q_fp32 + sequence_length * head_size;
+          out_fp32 = page_fp32 + block_size * head_size;
+        }
+
+        // Returns the rows of one head in a page of the pool together with their leading dimension.
+        auto load_page = [&](const T* cache, size_t page, size_t rows, size_t& ld) -> const float* {
+          const T* page_data = cache + (static_cast<size_t>(blocks[page]) * block_size * kv_num_heads_ + kv_head_index) *
+                                           head_size;
+          if constexpr (std::is_same_v<T, float>) {
+            ORT_UNUSED_PARAMETER(rows);
+            ld = kv_hidden_size;
+            return page_data;
+          } else {
+            for (size_t r = 0; r < rows; r++) {
+              MlasConvertHalfToFloatBuffer(page_data + r * kv_hidden_size, page_fp32 + r * head_size, head_size);
+            }
+            ld = head_size;
+            return page_fp32;
+          }
+        };
+
+        // scores(S, T) = alpha * Q(S, H) x K'(H, T), one page of K at a time
+        for (size_t page = first_page; page < num_pages; page++) {
+          const size_t rows = std::min(block_size, total_seqlen - page * block_size);
+          size_t k_ld = 0;
+          const float* k = load_page(key_cache, page, rows, k_ld);
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasTrans, sequence_length, rows, head_size, alpha, q_data,
+                                          static_cast<int>(q_ld), k, static_cast<int>(k_ld), 0.0f /*beta*/,
+                                          scores + page * block_size, static_cast<int>(total_seqlen), nullptr);
+        }
+
+        for (size_t seq = 0; seq < sequence_length; seq++) {
+          float* row = scores + seq * total_seqlen;
+          const size_t seq_causal_length = past_seqlen + seq + 1;
+          const bool should_apply_local_window = local_window_size_ >= 0 &&
+                                                 seq_causal_length > static_cast<size_t>(local_window_size_);
+          const size_t start_offset = should_apply_local_window ? seq_causal_length - local_window_size_ : 0;
+          const size_t window_size = seq_causal_length - start_offset;
+
+          if (softcap_ > 0.f) {
+            ComputeAttentionSoftcapInplace(row + start_offset, static_cast<int>(window_size), softcap_);
+          }
+          if (use_smooth_softmax_) {
+            ComputeSmoothSoftmaxInplace(row + start_offset, static_cast<int>(window_size), 0.0f, nullptr);
+          } else {
+            ComputeAttentionSoftmaxInplace(row + start_offset, 1, static_cast<int>(window_size), nullptr);
+          }
+
+          // Mask the columns outside of [start_offset, seq_causal_length) that the second GEMM reads.
+          std::fill(row + first_column, row + start_offset, 0.0f);
+          std::fill(row + seq_causal_length, row + total_seqlen, 0.0f);
+        }
+
+        // out(S, H) = probs(S, T) x V(T, H), accumulated one page of V at a time
+        float* out_data;
+        size_t out_ld;
+        if constexpr (std::is_same_v<T, float>) {
+          out_data = out;
+          out_ld = hidden_size;
+        } else {
+          out_data = out_fp32;
+          out_ld = head_size;
+        }
+        for (size_t page = first_page; page < num_pages; page++) {
+          const size_t rows = std::min(block_size, total_seqlen - page * block_size);
+          size_t v_ld = 0;
+          const float* v = load_page(value_cache, page, rows, v_ld);
+          math::GemmEx<float, ThreadPool>(CblasNoTrans, CblasNoTrans, sequence_length, head_size, rows, 1.0f /*alpha*/,
+                                          scores + page * block_size, static_cast<int>(total_seqlen), v,
+                                          static_cast<int>(v_ld), page == first_page ? 0.0f : 1.0f /*beta*/,
+                                          out_data, static_cast<int>(out_ld), nullptr);
+        }
+
+        if constexpr (!std::is_same_v<T, float>) {
+          for (size_t s = 0; s < sequence_length; s++) {
+            MlasConvertFloatToHalfBuffer(out_fp32 + s * head_size, out + s * hidden_size, head_size);
+          }
+        }
+      }
+    });
+
+    return Status::OK();
+  }
+
+  // Variant of ApplyAttention for a KV cache quantized to int8 (TCache = int8_t) or packed int4 (TCache = uint8_t).
+  // The new keys and values are quantized into the present buffers, and the cache is dequantized while it is read:
+  // the key scale is folded into the query and the value scale is applied once to the output, so a decoding step
+  // streams one byte or half a byte per cached element instead of sizeof(T).
+  template <typename T, typename TCache>
+  Status ApplyQuantizedKVAttention(const T* Q,                                       // Q data with shape BxNxSxH
+                                   const T* K,                                       // K data with shape BxN_kvxSxH
+                                   const T* V,                                       // V data with shape BxN_kvxSxH
+                                   const T* head_sink,                               // head sink for smooth softmax
+                                   const Tensor* past_key,                           // past K input tensor
+                                   const Tensor* past_value,                         // past V input tensor
+                                   Tensor* output,                                   // output tensor
+                                   Tensor* present_key,                              // present K output tensor
+                                   Tensor* present_value,                            // present V output tensor
+                                   const float* k_scale,                             // scale of the key cache
+                                   const float* v_scale,                             // scale of the value cache
+                                   const Tensor* seqlens_k,                          // past sequence lengths tensor
+                                   const GroupQueryAttentionParameters& parameters,  // attention parameters
+                                   AllocatorPtr allocator,                           // allocator for temporary buffers
+                                   OpKernelContext* context) const {
+    const bool is_prompt = parameters.is_first_prompt;
+    const size_t batch_size = static_cast<size_t>(parameters.batch_size);
+    const size_t sequence_length = static_cast<size_t>(parameters.sequence_length);
+    const size_t head_size = static_cast<size_t>(parameters.head_size);
+    const bool packed_qkv = parameters.is_packed_qkv;
+    const bool k_per_channel = parameters.k_quant_type == KVQuantizationType::PER_CHANNEL;
+    const bool v_per_channel = parameters.v_quant_type == KVQuantizationType::PER_CHANNEL;
+    const size_t cache_head_size = QuantizedKVHeadSize<TCache>(head_size);
+    const size_t kv_num_heads_factor = num_heads_ / kv_num_heads_;
+    const int32_t* seqlens = seqlens_k->Data<int32_t>();
+
+    auto* tp = context->GetOperatorThreadPool();
+
+    const size_t past_buffer_sequence_length = past_key != nullptr ? static_cast<size_t>(past_key->Shape()[2]) : 0;
+    const size_t present_buffer_sequence_length = static_cast<size_t>(present_key->Shape()[2]);
+    const TCache* past_key_data = past_key != nullptr ? past_key->Data<TCache>() : nullptr;
+    const TCache* past_value_data = past_value != nullptr ? past_value->Data<TCache>() : nullptr;
+    TCache* present_key_data = present_key->MutableData<TCache>();
+    TCache* present_value_data = present_value->MutableData<TCache>();
+    const bool past_present_share_buffer = past_key_data == present_key_data && past_value_data == present_value_data;
+
+    const ptrdiff_t packed_batch_stride =
+        packed_qkv ? SafeInt<ptrdiff_t>(num_heads_ + 2 * kv_num_heads_) * sequence_length * head_size
+                   : SafeInt<ptrdiff_t>(0);
+    const T* k_input = packed_qkv ? Q + num_heads_ * sequence_length * head_size : K;
+    const T* v_input = packed_qkv ? Q + (num_heads_ + kv_num_heads_) * sequence_length * head_size : V;
+    const size_t chunk_length = sequence_length * head_size;                                   // S x H
+    const size_t past_buff_chunk_length = past_buffer_sequence_length * cache_head_size;        // L x H'
+    const size_t present_buff_chunk_length = present_buffer_sequence_length * cache_head_size;  // T x H'
+
+    if (!past_present_share_buffer) {
+      const size_t present_elements = batch_size * kv_num_heads_ * present_buff_chunk_length;
+      std::fill_n(present_key_data, present_elements, QuantizedKVZero<TCache>());
+      std::fill_n(present_value_data, present_elements, QuantizedKVZero<TCache>());
+    }
+
+    // Append the quantized new keys and values to the past state of every (batch, kv head) pair.
+    const double append_bytes = static_cast<double>(2 * present_buff_chunk_length + 2 * chunk_length * sizeof(T));
+    ThreadPool::TryParallelFor(tp, batch_size * kv_num_heads_, TensorOpCost{append_bytes, append_bytes, 0.0},
+                               [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+                                 for (std::ptrdiff_t i = begin; i != end; ++i) {
+                                   const size_t batch_index = i / kv_num_heads_;
+                                   const size_t head_index = i % kv_num_heads_;
+                                   const size_t total_seqlen = static_cast<size_t>(seqlens[batch_index]) + 1;
+                                   const size_t past_seqlen = is_prompt ? 0 : total_seqlen - sequence_length;
+                                   const ptrdiff_t input_offset =
+                                       packed_qkv ? packed_batch_stride * batch_index + chunk_length * head_index
+                                                  : chunk_length * i;
+
+                                   TCache* key_chunk = present_key_data + i * present_buff_chunk_length;
+                                   TCache* value_chunk = present_value_data + i * present_buff_chunk_length;
+                                   if (!past_present_share_buffer && past_seqlen > 0) {
+                                     memcpy(key_chunk, past_key_data + i * past_buff_chunk_length,
+                                            past_seqlen * cache_head_size * sizeof(TCache));
+                                     memcpy(value_chunk, past_value_data + i * past_buff_chunk_length,
+                                            past_seqlen * cache_head_size * sizeof(TCache));
+                                   }
+                                   QuantizeKVChunk(k_input + input_offset, key_chunk + past_seqlen * cache_head_size,
+                                                   sequence_length, head_size,
+                                                   k_scale + (k_per_channel ? head_index * head_size : 0), k_per_channel);
+                                   QuantizeKVChunk(v_input + input_offset, value_chunk + past_seqlen * cache_head_size,
+                                                   sequence_length, head_size,
+                                                   v_scale + (v_per_channel ? head_index * head_size : 0), v_per_channel);
+                                 }
+                               });
+
+    const float alpha = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+    T* output_data = output->MutableData<T>();
+
+    TensorOpCost unit_cost;
+    unit_cost.compute_cycles =
+        static_cast<double>(SafeInt<ptrdiff_t>(4) * sequence_length * head_size * present_buffer_sequence_length);
+    unit_cost.bytes_loaded = static_cast<double>(2 * present_buff_chunk_length * sizeof(TCache) +
+                                                 chunk_length * sizeof(T));
+    unit_cost.bytes_stored = static_cast<double>(chunk_length * sizeof(T));
+
+    ThreadPool::TryParallelFor(tp, batch_size * num_heads_, unit_cost, [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+      // Scores of one query row, followed by the scaled query and the output accumulator.
+      const size_t scratch_elements = present_buffer_sequence_length + 2 * head_size;
+      auto scratch = allocator->Alloc(SafeInt<size_t>(scratch_elements) * sizeof(float));
+      BufferUniquePtr scratch_buffer(scratch, BufferDeleter(allocator));
+      float* scores = static_cast<float*>(scratch);
+      float* q_scaled = scores + present_buffer_sequence_length;
+      float* accumulator = q_scaled + head_size;
+
+      for (std::ptrdiff_t i = begin; i != end; ++i) {
+        const size_t batch_index = i / num_heads_;
+        const size_t head_index = i % num_heads_;
+        const size_t kv_head_index = head_index / kv_num_heads_factor;
+        const size_t total_seqlen = static_cast<size_t>(seqlens[batch_index]) + 1;
+        const size_t past_seqlen = is_prompt ? 0 : total_seqlen - sequence_length;
+
+        const size_t kv_offset = (batch_index * kv_num_heads_ + kv_head_index) * present_buff_chunk_length;
+        const TCache* k_cache = present_key_data + kv_offset;
+        const TCache* v_cache = present_value_data + kv_offset;
+        const float* k_scale_head = k_scale + (k_per_channel ? kv_head_index * head_size : 0);
+        const float* v_scale_head = v_scale + (v_per_channel ? kv_head_index * head_size : 0);
+        const T* q = packed_qkv ? Q + packed_batch_stride * batch_index + chunk_length * head_index
+                                : Q + chunk_length * i;
+
+        for (size_t seq = 0; seq < sequence_length; seq++) {
+          const size_t seq_causal_length = past_seqlen + seq + 1;
+          const bool should_apply_local_window = local_window_size_ >= 0 &&
+                                                 seq_causal_length > static_cast<size_t>(local_window_size_);
+          const size_t start_offset = should_apply_local_window ? seq_causal_length - local_window_size_ : 0;
+          const size_t window_size = seq_causal_length - start_offset;
+
+          // scores = alpha * q x (k_scale * K_q)' = (alpha * k_scale * q) x K_q'
+          for (size_t h = 0; h < head_size; h++) {
+            q_scaled[h] = alpha * static_cast<float>(q[seq * head_size + h]) *
+                          (k_per_channel ? k_scale_head[h] : k_scale_head[0]);
+          }
+          for (size_t t = 0; t < window_size; t++) {
+            scores[t] = QuantizedKVDot(q_scaled, k_cache + (start_offset + t) * cache_head_size, head_size);
+          }
+
+          if (softcap_ > 0.f) {
+            ComputeAttentionSoftcapInplace(scores, static_cast<int>(window_size), softcap_);
+          }
+          if (use_smooth_softmax_ || head_sink != nullptr) {
+            float sink = (head_sink != nullptr) ? static_cast<float>(head_sink[head_index]) : 0.0f;
+            ComputeSmoothSoftmaxInplace(scores, static_cast<int>(window_size), sink, nullptr);
+          } else {
+            ComputeAttentionSoftmaxInplace(scores, 1, static_cast<int>(window_size), nullptr);
+          }
+
+          // output = probs x (v_scale * V_q) = v_scale * (probs x V_q)
+          std::fill_n(accumulator, head_size, 0.0f);
+          for (size_t t = 0; t < window_size; t++) {
+            QuantizedKVAxpy(scores[t], v_cache + (start_offset + t) * cache_head_size, head_size, accumulator);
+          }
+          for (size_t h = 0; h < head_size; h++) {
+            accumulator[h] *= v_per_channel ? v_scale_head[h] : v_scale_head[0];
+          }
+
+          T* out = output_data + ((batch_index * sequence_length + seq) * num_heads_ + head_index) * head_size;
+          if constexpr (std::is_same_v<T, float>) {
+            memcpy(out, accumulator, head_size * sizeof(float));
+          } else {
+            MlasConvertFloatToHalfBuffer(accumulator, out, head_size);
+          }
+        }
+      }
+    });
+
+    return Status::OK();
+  }
+
  private:
+  // Appends the new K and V chunks of every sequence to its past state in the present buffers.
+  template <typename T>
+  void ConcatPresentKV(const T* K,                                    // new keys with shape BxN_kvxSxH
+                       const T* V,                                    // new values with shape BxN_kvxSxH
+                       const int32_t* seqlens_k,                      // total - 1 sequence lengths tensor
+                       const size_t batch_size,                       // batch size
+                       const size_t sequence_length,                  // sequence length of new tokens
+                       const size_t past_buffer_sequence_length,      // sequence length of past state
+                       const size_t present_buffer_sequence_length,   // sequence length of present state
+                       const size_t head_size,                        // head size of K and V
+                       const T* past_key,                             // past key only
+                       const T* past_value,                           // past value only
+                       T* present_key,                                // present key only
+                       T* present_value,                              // present value only
+                       const bool packed_qkv,                         // whether Q, K, V are packed
+                       const bool is_prompt,                          // whether it is prompt
+                       ThreadPool* tp) const {
+    const ptrdiff_t packed_batch_stride =
+        packed_qkv ? SafeInt<ptrdiff_t>(num_heads_ + 2 * kv_num_heads_) * sequence_length * head_size
+                   : SafeInt<ptrdiff_t>(0);
+    const size_t kv_input_chunk_length = sequence_length * head_size;                     // L x H
+    const size_t past_buff_chunk_length = past_buffer_sequence_length * head_size;        // L x H
+    const size_t present_buff_chunk_length = present_buffer_sequence_length * head_size;  // T x H
+    const bool past_present_share_buffer = past_key == present_key && past_value == present_value;
+
+    if (!past_present_share_buffer) {
+      const size_t present_bytes = batch_size * kv_num_heads_ * present_buff_chunk_length * sizeof(T);
+      memset((void*)present_key, 0, present_bytes);
+      memset((void*)present_value, 0, present_bytes);
+    }
+
+    const double bytes_to_copy = static_cast<double>(2 * present_buff_chunk_length * sizeof(T));
+    ThreadPool::TryParallelFor(tp, batch_size * kv_num_heads_, TensorOpCost{bytes_to_copy, bytes_to_copy, 0.0},
+                               [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+                                 for (std::ptrdiff_t i = begin; i != end; ++i) {
+                                   const size_t batch_index = i / kv_num_heads_;
+                                   const size_t head_index = i % kv_num_heads_;
+                                   const size_t total_seqlen = static_cast<size_t>(seqlens_k[batch_index]) + 1;
+                                   const size_t past_seqlen = is_prompt ? 0 : total_seqlen - sequence_length;
+                                   const size_t past_chunk_length = past_seqlen * head_size;
+
+                                   const ptrdiff_t input_offset =
+                                       packed_qkv ? packed_batch_stride * batch_index + kv_input_chunk_length * head_index
+                                                  : kv_input_chunk_length * i;
+                                   ConcatStateChunkGQA(past_key, K + input_offset, present_key, present_buff_chunk_length,
+                                                       past_buff_chunk_length, past_chunk_length, kv_input_chunk_length,
+                                                       past_present_share_buffer, i);
+                                   ConcatStateChunkGQA(past_value, V + input_offset, present_value,
+                                                       present_buff_chunk_length, past_buff_chunk_length,
+                                                       past_chunk_length, kv_input_chunk_length,
+                                                       past_present_share_buffer, i);
+                                 }
+                               });
+  }
+
+  // Computes the output with the tiled, online softmax flash attention kernel of MLAS, reading the grouped K and V
+  // heads directly from the present buffers.
+  void ApplyFlashAttention(const float* Q,                               // Q data with shape BxNxSxH
+                           const float* head_sink,                       // head sink for smooth softmax
+                           const int32_t* seqlens_k,                     // total - 1 sequence lengths tensor
+                           const int batch_size,                         // batch size
+                           const int sequence_length,                    // sequence length of Q
+                           const int present_buffer_sequence_length,     // sequence length of present state
+                           const int head_size,                          // head size of Q, K, V
+                           const float* present_key,                     // present key with shape BxN_kvxTxH
+                           const float* present_value,                   // present value with shape BxN_kvxTxH
+                           float* output,                                // output with shape BxSxNxH
+                           const bool packed_qkv,                        // whether Q, K, V are packed
+                           ThreadPool* tp,                               // thread pool
+                           AllocatorPtr allocator) const {               // allocator for temporary buffer
+    std::vector<int32_t> total_seqlens(batch_size);
+    for (int b = 0; b < batch_size; b++) {
+      total_seqlens[b] = seqlens_k[b] + 1;
+    }
+
+    MlasFlashAttentionThreadedArgs args;
+    args.batch_size = batch_size;
+    args.num_heads = num_heads_;
+    args.kv_num_heads = kv_num_heads_;
+    args.q_sequence_length = sequence_length;
+    args.kv_sequence_length = present_buffer_sequence_length;
+    args.qk_head_size = head_size;
+    args.v_head_size = head_size;
+    args.scale = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+    args.q_batch_stride = packed_qkv ? SafeInt<size_t>(num_heads_ + 2 * kv_num_heads_) * sequence_length * head_size
+                                     : SafeInt<size_t>(0);
+    args.kv_valid_lengths = total_seqlens.data();
+    args.is_causal = true;
+    args.local_window_size = local_window_size_;
+    args.softcap = softcap_;
+    args.use_smooth_softmax = use_smooth_softmax_ || head_sink != nullptr;
+    args.head_sink = head_sink;
+
+    // Same block sizes as MultiHeadAttention: Bc = M / (4 * (qk_head_size + v_head_size)) and
+    // Br = min(Bc, qk_head_size + v_head_size) keep the working set in 3/4 of the L2 cache.
+    args.kv_block_size = l2_cache_size_ / (static_cast<int>(sizeof(float)) * 4 * (2 * head_size));
+    args.kv_block_size = std::max(args.kv_block_size, 1);  // avoid kv_block_size = 0
+    args.q_block_size = std::min(args.kv_block_size, 2 * head_size);
+    args.kv_block_size = std::min(args.kv_block_size, present_buffer_sequence_length);
+    args.q_block_size = std::min(args.q_block_size, sequence_length);
+
+    args.thread_count = concurrency::ThreadPool::DegreeOfParallelism(tp);
+    args.buffer_size_per_thread = (static_cast<size_t>(args.q_block_size) * 2 +
+                                   static_cast<size_t>(args.q_block_size) * static_cast<size_t>(args.kv_block_size) +
+                                   static_cast<size_t>(args.q_block_size) * static_cast<size_t>(args.v_head_size)) *
+                                  sizeof(float);
+    size_t buffer_bytes = args.buffer_size_per_thread * args.thread_count;
+    IAllocatorUniquePtr<void> buffer = IAllocator::MakeUniquePtr<void>(allocator, buffer_bytes);
+    args.buffer = reinterpret_cast<float*>(buffer.get());
+
+    args.query = Q;
+    args.key = present_key;
+    args.value = present_value;
+    args.output = output;
+
+    MlasFlashAttention(&args, tp);
+  }
+
   // Helper function to compute the attention probs. It does 2 things:
   //  attention_probs(B, N, S, T) = 1/sqrt(H) x Q(B, N, S, H) x K'(B, N, T, H -> B, N, H, T)
   //  attention_probs(B, N, S, T) = Softmax(attention_probs)
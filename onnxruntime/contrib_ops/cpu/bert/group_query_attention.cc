@@ -22,24 +22,53 @@ namespace onnxruntime {
 namespace contrib {
 
 // These ops are internal-only, so register outside of onnx
-#define REGISTER_KERNEL_TYPED(T)                                        \
-  ONNX_OPERATOR_TYPED_KERNEL_EX(                                        \
-      GroupQueryAttention,                                              \
-      kMSDomain,                                                        \
-      1,                                                                \
-      T,                                                                \
-      kCpuExecutionProvider,                                            \
-      KernelDefBuilder()                                                \
-          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())        \
-          .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()), \
+#define REGISTER_KERNEL_TYPED(T)                                               \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                               \
+      GroupQueryAttention,                                                     \
+      kMSDomain,                                                               \
+      1,                                                                       \
+      T,                                                                       \
+      kCpuExecutionProvider,                                                   \
+      KernelDefBuilder()                                                       \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())               \
+          .TypeConstraint("T_CACHE", {DataTypeImpl::GetTensorType<T>(),        \
+                                      DataTypeImpl::GetTensorType<int8_t>(),   \
+                                      DataTypeImpl::GetTensorType<uint8_t>()}) \
+          .TypeConstraint("T_KV_SCALE", DataTypeImpl::GetTensorType<float>())  \
+          .TypeConstraint("M", DataTypeImpl::GetTensorType<int32_t>()),        \
       GroupQueryAttention<T>);
 
 REGISTER_KERNEL_TYPED(float)
 REGISTER_KERNEL_TYPED(MLFloat16)
 
+namespace {
+// Checks the scale of a quantized key or value cache: a single element for PER_TENSOR and one element per channel,
+// i.e. (kv_num_heads * head_size) elements, for PER_CHANNEL.
+Status CheckKVCacheScale(const Tensor* scale, const char* name, KVQuantizationType quant_type, int kv_num_heads,
+                         int head_size) {
+  if (scale == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, name, " must be provided when the KV cache is quantized");
+  }
+  const int64_t expected_size = quant_type == KVQuantizationType::PER_TENSOR
+                                    ? int64_t{1}
+                                    : static_cast<int64_t>(kv_num_heads) * head_size;
+  if (scale->Shape().Size() != expected_size) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, name, " is expected to have ", expected_size,
+                           " elements, got ", scale->Shape().Size());
+  }
+  return Status::OK();
+}
+}  // namespace
+
 template <typename T>
 GroupQueryAttention<T>::GroupQueryAttention(const OpKernelInfo& info)
-    : OpKernel(info), GQAAttentionBase(info, true) {}
+    : OpKernel(info), GQAAttentionBase(info, true) {
+  k_quant_type_ = group_query_attention_helper::StringToKVQuantizationType(
+      info.GetAttrOrDefault<std::string>("k_quant_type", "NONE"));
+  v_quant_type_ = group_query_attention_helper::StringToKVQuantizationType(
+      info.GetAttrOrDefault<std::string>("v_quant_type", "NONE"));
+  kv_cache_bit_width_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("kv_cache_bit_width", 0));
+}
 
 template <typename T>
 Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
@@ -55,6 +84,19 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
   const Tensor* position_ids = context->Input<Tensor>(9);
   const Tensor* attention_bias = context->Input<Tensor>(10);
   const Tensor* head_sink = context->Input<Tensor>(11);
+  const Tensor* k_scale = context->Input<Tensor>(12);
+  const Tensor* v_scale = context->Input<Tensor>(13);
+
+  // Key and value caches share the T_CACHE type, so they are either both quantized or both unquantized.
+  const bool is_kv_quantized = k_quant_type_ != KVQuantizationType::NONE;
+  if (is_kv_quantized != (v_quant_type_ != KVQuantizationType::NONE)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "k_quant_type and v_quant_type shall be both NONE or both quantized.");
+  }
+  if (is_kv_quantized && kv_cache_bit_width_ != 4 && kv_cache_bit_width_ != 8) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "kv_cache_bit_width must be 4 or 8 for a quantized KV cache. Got ", kv_cache_bit_width_);
+  }
 
   GroupQueryAttentionParameters parameters = {};
   ORT_RETURN_IF_ERROR(group_query_attention_helper::CheckInputs(query,
@@ -71,13 +113,25 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
                                                                 total_seqlen_tensor,
                                                                 scale_,
                                                                 softcap_,
-                                                                0));
+                                                                is_kv_quantized ? kv_cache_bit_width_ : 0));
 
   ORT_RETURN_IF_ERROR(group_query_attention_helper::CheckCustomAttentionInputs(position_ids,
                                                                                attention_bias,
                                                                                head_sink,
                                                                                parameters));
 
+  if (is_kv_quantized) {
+    ORT_RETURN_IF_ERROR(CheckKVCacheScale(k_scale, "k_scale", k_quant_type_, kv_num_heads_, parameters.head_size));
+    ORT_RETURN_IF_ERROR(CheckKVCacheScale(v_scale, "v_scale", v_quant_type_, kv_num_heads_, parameters.head_size));
+    if (attention_bias != nullptr || qk_output_ != static_cast<int>(QKOutputType::NO_OUTPUT)) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, NOT_IMPLEMENTED,
+                             "attention_bias and qk_output are not supported with a quantized KV cache.");
+    }
+    parameters.k_quant_type = k_quant_type_;
+    parameters.v_quant_type = v_quant_type_;
+    parameters.kv_cache_bit_width = kv_cache_bit_width_;
+  }
+
   const int batch_size = parameters.batch_size;
   const int sequence_length = parameters.sequence_length;
   const int present_kv_seqlen = parameters.seqlen_present_kv_cache;
@@ -91,11 +145,23 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
   output_shape[2] = static_cast<int64_t>(q_hidden_size);
   Tensor* output = context->Output(0, output_shape);
 
-  std::vector<int64_t> present_k_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(head_size)});
-  std::vector<int64_t> present_v_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(head_size)});
+  // A 4-bit cache packs two values into one byte.
+  const int cache_head_size = (is_kv_quantized && kv_cache_bit_width_ == 4) ? (head_size + 1) / 2 : head_size;
+  std::vector<int64_t> present_k_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(cache_head_size)});
+  std::vector<int64_t> present_v_shape({static_cast<int64_t>(batch_size), static_cast<int64_t>(kv_num_heads_), static_cast<int64_t>(present_kv_seqlen), static_cast<int64_t>(cache_head_size)});
   Tensor* present_k = context->Output(1, present_k_shape);
   Tensor* present_v = context->Output(2, present_v_shape);
 
+  bool is_cache_type_valid = present_k->IsDataType<T>();
+  if (is_kv_quantized) {
+    is_cache_type_valid = kv_cache_bit_width_ == 8 ? present_k->IsDataType<int8_t>() : present_k->IsDataType<uint8_t>();
+  }
+  if (!is_cache_type_valid) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "The KV cache shall have type T when it is not quantized, int8 for 8-bit quantization "
+                           "and uint8 for 4-bit quantization.");
+  }
+
   std::vector<int64_t> output_qk_shape{static_cast<int64_t>(batch_size), static_cast<int64_t>(num_heads_), static_cast<int64_t>(parameters.sequence_length), static_cast<int64_t>(parameters.total_sequence_length)};
   Tensor* output_qk = context->Output(3, output_qk_shape);
 
@@ -214,6 +280,19 @@ Status GroupQueryAttention<T>::Compute(OpKernelContext* context) const {
 
   const T* head_sink_data = (head_sink != nullptr) ? head_sink->Data<T>() : nullptr;
 
+  if (is_kv_quantized) {
+    const T* k_data = packed_qkv ? nullptr : k_rotary;
+    const T* v_data = packed_qkv ? nullptr : V.Get<Tensor>().Data<T>();
+    if (kv_cache_bit_width_ == 8) {
+      return ApplyQuantizedKVAttention<T, int8_t>(q_rotary, k_data, v_data, head_sink_data, past_key, past_value,
+                                                  output, present_k, present_v, k_scale->Data<float>(),
+                                                  v_scale->Data<float>(), seqlens_k, parameters, allocator, context);
+    }
+    return ApplyQuantizedKVAttention<T, uint8_t>(q_rotary, k_data, v_data, head_sink_data, past_key, past_value,
+                                                 output, present_k, present_v, k_scale->Data<float>(),
+                                                 v_scale->Data<float>(), seqlens_k, parameters, allocator, context);
+  }
+
   // Compute the attention score and apply the score to V
   return ApplyAttention(q_rotary, packed_qkv ? nullptr : k_rotary, packed_qkv ? nullptr : V.Get<Tensor>().Data<T>(),
                         head_sink_data, attention_bias, past_key, past_value, output, present_k, present_v,
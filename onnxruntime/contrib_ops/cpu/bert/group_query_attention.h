@@ -15,6 +15,11 @@ class GroupQueryAttention final : public OpKernel, public GQAAttentionBase {
  public:
   GroupQueryAttention(const OpKernelInfo& info);
   Status Compute(OpKernelContext* context) const override;
+
+ private:
+  KVQuantizationType k_quant_type_;
+  KVQuantizationType v_quant_type_;
+  int kv_cache_bit_width_;
 };
 
 }  // namespace contrib
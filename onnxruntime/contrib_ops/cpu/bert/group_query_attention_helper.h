@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <string>
+
 #include "core/common/common.h"
 #include "core/providers/common.h"
 #include "contrib_ops/cpu/bert/attention_common.h"
@@ -12,6 +16,22 @@ namespace onnxruntime {
 namespace contrib {
 namespace group_query_attention_helper {
 
+// Map string attribute to quantization type enum
+inline KVQuantizationType StringToKVQuantizationType(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+  if (s == "NONE") {
+    return KVQuantizationType::NONE;
+  }
+  if (s == "PER_TENSOR") {
+    return KVQuantizationType::PER_TENSOR;
+  }
+
+  if (s == "PER_CHANNEL") {
+    return KVQuantizationType::PER_CHANNEL;
+  }
+  return KVQuantizationType::NONE;
+}
+
 template <typename T>
 Status Check_Q_K_V(const T* query, const T* key, const T* value, const int num_heads, const int kv_num_heads,
                    int& batch_size, int& sequence_length, int& q_hidden_size, int& kv_hidden_size, int& head_size) {
@@ -225,17 +245,11 @@ Status CheckInputs(const T* query,
                            num_heads % kv_num_heads);
   }
 
-#ifdef USE_INT4_KV_CACHE
+  // Execution providers that do not support every bit width shall reject the others before calling this function.
   if (kv_cache_bit_width != 0 && kv_cache_bit_width != 4 && kv_cache_bit_width != 8) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "kv_cache_bit_width must be 0, 4 or 8. Got kv_cache_bit_width == ", kv_cache_bit_width);
   }
-#else
-  if (kv_cache_bit_width != 0 && kv_cache_bit_width != 8) {
-    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
-                           "kv_cache_bit_width must be 0 or 8. Got kv_cache_bit_width == ", kv_cache_bit_width);
-  }
-#endif
 
   int batch_size = 0;
   int sequence_length = 0;
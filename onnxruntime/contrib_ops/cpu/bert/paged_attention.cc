@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "contrib_ops/cpu/bert/paged_attention.h"
+#include "contrib_ops/cpu/bert/paged_attention_helper.h"
+#include "contrib_ops/cpu/bert/rotary_embedding.h"
+#include "contrib_ops/cpu/bert/rotary_embedding_helper.h"
+
+#include "core/common/safeint.h"
+#include "core/platform/threadpool.h"
+
+#include <vector>
+
+using onnxruntime::concurrency::ThreadPool;
+
+namespace onnxruntime {
+namespace contrib {
+
+// These ops are internal-only, so register outside of onnx
+#define REGISTER_KERNEL_TYPED(T)                                        \
+  ONNX_OPERATOR_TYPED_KERNEL_EX(                                        \
+      PagedAttention,                                                   \
+      kMSDomain,                                                        \
+      1,                                                                \
+      T,                                                                \
+      kCpuExecutionProvider,                                            \
+      KernelDefBuilder()                                                \
+          .TypeConstraint("T", DataTypeImpl::GetTensorType<T>())        \
+          .TypeConstraint("S", DataTypeImpl::GetTensorType<int32_t>())  \
+          .MayInplace(3, 1)                                             \
+          .MayInplace(4, 2),                                            \
+      PagedAttention<T>);
+
+REGISTER_KERNEL_TYPED(float)
+REGISTER_KERNEL_TYPED(MLFloat16)
+
+template <typename T>
+PagedAttention<T>::PagedAttention(const OpKernelInfo& info)
+    : OpKernel(info), GQAAttentionBase(info, true) {
+  ORT_ENFORCE(num_heads_ % kv_num_heads_ == 0, "num_heads must be a multiple of kv_num_heads");
+}
+
+template <typename T>
+Status PagedAttention<T>::Compute(OpKernelContext* context) const {
+  const Tensor* query = context->Input<Tensor>(0);
+  const Tensor* key = context->Input<Tensor>(1);
+  const Tensor* value = context->Input<Tensor>(2);
+  const Tensor* key_cache = context->Input<Tensor>(3);
+  const Tensor* value_cache = context->Input<Tensor>(4);
+  const Tensor* cumulative_seqlens_q = context->Input<Tensor>(5);
+  const Tensor* past_seqlens = context->Input<Tensor>(6);
+  const Tensor* block_table = context->Input<Tensor>(7);
+  const Tensor* cos_cache = context->Input<Tensor>(8);
+  const Tensor* sin_cache = context->Input<Tensor>(9);
+
+  PagedAttentionParameters parameters = {};
+  ORT_RETURN_IF_ERROR(paged_attention_helper::CheckInputs(query,
+                                                          key,
+                                                          value,
+                                                          key_cache,
+                                                          value_cache,
+                                                          cumulative_seqlens_q,
+                                                          past_seqlens,
+                                                          block_table,
+                                                          cos_cache,
+                                                          sin_cache,
+                                                          &parameters,
+                                                          num_heads_,
+                                                          kv_num_heads_,
+                                                          scale_,
+                                                          softcap_,
+                                                          0));
+  parameters.local_window_size = local_window_size_;
+  parameters.do_rotary = do_rotary_;
+  parameters.rotary_interleaved = rotary_interleaved_;
+
+  if (do_rotary_ && (cos_cache == nullptr || sin_cache == nullptr)) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "cos_cache and sin_cache must be passed to PagedAttention when do_rotary = 1");
+  }
+
+  const int token_count = parameters.token_count;
+  const int hidden_size = parameters.hidden_size;
+  const int kv_hidden_size = parameters.kv_hidden_size;
+  const int head_size = parameters.head_size;
+  const bool packed_qkv = parameters.is_packed_qkv;
+
+  std::vector<int64_t> output_shape({static_cast<int64_t>(token_count), static_cast<int64_t>(hidden_size)});
+  Tensor* output = context->Output(0, output_shape);
+  Tensor* key_cache_out = context->Output(1, key_cache->Shape());
+  Tensor* value_cache_out = context->Output(2, value_cache->Shape());
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  // The pool is updated through the cache outputs, which share the input buffers when they can be reused in place.
+  // The inputs are never written: an output bound to another buffer is filled with a copy of the pool first,
+  // and a missing output is replaced by a scratch copy that only lives for this run.
+  auto get_writable_cache = [&allocator](const Tensor* cache, Tensor* cache_out, IAllocatorUniquePtr<T>& scratch) {
+    T* cache_data = nullptr;
+    if (cache_out != nullptr) {
+      cache_data = cache_out->MutableData<T>();
+    } else {
+      scratch = IAllocator::MakeUniquePtr<T>(allocator, static_cast<size_t>(cache->Shape().Size()));
+      cache_data = scratch.get();
+    }
+    if (cache_data != cache->Data<T>()) {
+      memcpy(cache_data, cache->DataRaw(), cache->SizeInBytes());
+    }
+    return cache_data;
+  };
+  IAllocatorUniquePtr<T> key_cache_scratch;
+  IAllocatorUniquePtr<T> value_cache_scratch;
+  T* key_cache_data = get_writable_cache(key_cache, key_cache_out, key_cache_scratch);
+  T* value_cache_data = get_writable_cache(value_cache, value_cache_out, value_cache_scratch);
+
+  const size_t q_stride = static_cast<size_t>(packed_qkv ? hidden_size + 2 * kv_hidden_size : hidden_size);
+  const size_t kv_stride = packed_qkv ? q_stride : static_cast<size_t>(kv_hidden_size);
+  const T* q = query->Data<T>();
+  const T* k = packed_qkv ? q + hidden_size : key->Data<T>();
+  const T* v = packed_qkv ? q + hidden_size + kv_hidden_size : value->Data<T>();
+
+  const int32_t* cumulative_seqlens_q_data = cumulative_seqlens_q->Data<int32_t>();
+  const int32_t* past_seqlens_data = past_seqlens->Data<int32_t>();
+  const int32_t* block_table_data = block_table->Data<int32_t>();
+  ORT_RETURN_IF_ERROR(paged_attention_helper::CheckSequenceData(cumulative_seqlens_q_data, past_seqlens_data,
+                                                                block_table_data, parameters));
+
+  OrtValue RotaryQ;
+  OrtValue RotaryK;
+  if (do_rotary_) {
+    // Position ids of the packed tokens continue from the past length of their sequence.
+    std::vector<int64_t> pos_ids(token_count);
+    const int64_t max_position = cos_cache->Shape().GetDims()[0];
+    for (int b = 0; b < parameters.batch_size; b++) {
+      for (int t = cumulative_seqlens_q_data[b]; t < cumulative_seqlens_q_data[b + 1]; t++) {
+        pos_ids[t] = static_cast<int64_t>(past_seqlens_data[b]) + t - cumulative_seqlens_q_data[b];
+        if (pos_ids[t] >= max_position) {
+          return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Position ", pos_ids[t],
+                                 " exceeds the size of cos_cache and sin_cache (", max_position, ")");
+        }
+      }
+    }
+
+    rotary_embedding_helper::RotaryParameters rotary_params = {};
+    rotary_params.batch_size = 1;
+    rotary_params.sequence_length = token_count;
+    rotary_params.hidden_size = hidden_size;
+    rotary_params.head_size = head_size;
+    rotary_params.rotary_embedding_dim = parameters.rotary_dim;
+    rotary_params.num_heads = num_heads_;
+    rotary_params.max_sequence_length = static_cast<int>(max_position);  // unused
+    rotary_params.head_stride = head_size;
+    rotary_params.seq_stride = static_cast<int>(q_stride);
+    rotary_params.batch_stride = token_count * rotary_params.seq_stride;
+    rotary_params.position_ids_format = 1;
+    rotary_params.transposed = false;
+    auto* tp = context->GetOperatorThreadPool();
+
+    auto element_type = DataTypeImpl::GetType<T>();
+    T* q_rotary;
+    T* k_rotary;
+    if (packed_qkv) {
+      // Keep V next to the rotated Q and K so that the packed strides stay valid.
+      Tensor::InitOrtValue(element_type, query->Shape(), allocator, RotaryQ);
+      q_rotary = RotaryQ.GetMutable<Tensor>()->MutableData<T>();
+      k_rotary = q_rotary + hidden_size;
+      memcpy(q_rotary, q, query->SizeInBytes());
+    } else {
+      Tensor::InitOrtValue(element_type, query->Shape(), allocator, RotaryQ);
+      Tensor::InitOrtValue(element_type, key->Shape(), allocator, RotaryK);
+      q_rotary = RotaryQ.GetMutable<Tensor>()->MutableData<T>();
+      k_rotary = RotaryK.GetMutable<Tensor>()->MutableData<T>();
+    }
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, q, pos_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), q_rotary, rotary_interleaved_));
+
+    rotary_params.num_heads = kv_num_heads_;
+    rotary_params.hidden_size = kv_hidden_size;
+    rotary_params.seq_stride = static_cast<int>(kv_stride);
+    rotary_params.batch_stride = token_count * rotary_params.seq_stride;
+    ORT_RETURN_IF_ERROR(RunRotaryEmbedding<T>(tp, rotary_params, k, pos_ids.data(), cos_cache->Data<T>(),
+                                              sin_cache->Data<T>(), k_rotary, rotary_interleaved_));
+    q = q_rotary;
+    k = k_rotary;
+    if (packed_qkv) {
+      v = q_rotary + hidden_size + kv_hidden_size;
+    }
+  }
+
+  return ApplyPagedAttention(q, k, v, q_stride, kv_stride, key_cache_data, value_cache_data,
+                             cumulative_seqlens_q_data, past_seqlens_data, block_table_data,
+                             output->MutableData<T>(), parameters, allocator, context);
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
@@ -106,11 +106,9 @@ Status CheckKVCache(const T* key_cache, const T* value_cache, const int kv_num_h
 
   num_blocks = static_cast<int>(key_cache_dims[0]);
   block_size = static_cast<int>(key_cache_dims[1]);
-  // TODO(aciddelgado): block size multiple of 8
-  if (block_size % 256 != 0) {
+  if (block_size <= 0) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
-                           "block_size must be a multiple of 256. Got block_size % 256 == ",
-                           block_size % 256);
+                           "block_size must be positive. Got ", block_size);
   }
   if (value_cache_dims[0] != num_blocks) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
@@ -166,7 +164,7 @@ Status CheckSequenceLengthTensors(const T* cumulative_sequence_length, const T*
   batch_size = static_cast<int>(cumulative_seqlen_dim[0]) - 1;
 
   const auto& seqlens_dim = seqlens->Shape().GetDims();
-  if (seqlens_dim.size() != 1 && seqlens_dim[0] != batch_size) {
+  if (seqlens_dim.size() != 1 || seqlens_dim[0] != batch_size) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
                            "seqlens must be shape (batch_size).");
   }
@@ -273,6 +271,43 @@ Status CheckInputs(const T* query,
   return Status::OK();
 }
 
+// Validates the contents of the sequence length tensors and the block table. This reads the data of the tensors, so
+// it can only be used when they reside in CPU memory.
+inline Status CheckSequenceData(const int32_t* cumulative_sequence_length,
+                                const int32_t* seqlens,
+                                const int32_t* block_table,
+                                const PagedAttentionParameters& parameters) {
+  if (cumulative_sequence_length[0] != 0 ||
+      cumulative_sequence_length[parameters.batch_size] != parameters.token_count) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "cumulative_sequence_length must start at 0 and end at the token count ",
+                           parameters.token_count);
+  }
+  const int64_t max_num_blocks_per_seq = parameters.max_num_blocks_per_seq;
+  for (int b = 0; b < parameters.batch_size; b++) {
+    const int32_t new_seqlen = cumulative_sequence_length[b + 1] - cumulative_sequence_length[b];
+    if (new_seqlen < 0 || seqlens[b] < 0) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                             "Sequence lengths must be non-negative. Got new length ", new_seqlen,
+                             " and past length ", seqlens[b], " for batch entry ", b);
+    }
+    const int64_t total_seqlen = static_cast<int64_t>(seqlens[b]) + new_seqlen;
+    const int64_t num_blocks = (total_seqlen + parameters.block_size - 1) / parameters.block_size;
+    if (num_blocks > max_num_blocks_per_seq) {
+      return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Batch entry ", b, " needs ", num_blocks,
+                             " blocks but block_table only has ", max_num_blocks_per_seq);
+    }
+    for (int64_t i = 0; i < num_blocks; i++) {
+      const int32_t block = block_table[b * max_num_blocks_per_seq + i];
+      if (block < 0 || block >= parameters.num_blocks) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "block_table entry ", block,
+                               " is out of range [0, ", parameters.num_blocks, ")");
+      }
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace paged_attention_helper
 }  // namespace contrib
 }  // namespace onnxruntime
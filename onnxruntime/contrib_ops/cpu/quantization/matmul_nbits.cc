@@ -145,6 +145,9 @@ class MatMulNBits final : public OpKernel {
   const bool has_bias_;
   bool scales_are_packed_{false};
   const bool prefer_lut_gemm_{false};
+  // True once the LUT packed buffer holds the scales (and zero points). A buffer received through
+  // UseSharedPrePackedBuffers() always does and is read-only, so it must never be repacked.
+  bool lut_scales_packed_{false};
   const MLAS_QNBIT_GEMM_COMPUTE_TYPE compute_type_;
   bool has_unquantized_zero_point_{false};
   const bool column_wise_quant_{true};
@@ -188,7 +191,6 @@ template <typename T1>
 Status MatMulNBits<T1>::PrePack(const Tensor& tensor, int input_idx, /*out*/ AllocatorPtr alloc,
                                 /*out*/ bool& is_packed,
                                 /*out*/ PrePackedWeights* prepacked_weights) {
-  ORT_UNUSED_PARAMETER(prepacked_weights);
   is_packed = false;
   if (has_g_idx_ || has_unquantized_zero_point_) {
     return Status::OK();
@@ -248,6 +250,7 @@ Status MatMulNBits<T1>::PrePack(const Tensor& tensor, int input_idx, /*out*/ All
           zp_ptr,
           static_cast<std::byte*>(packed_b_.get()),
           threadpool_ptr);
+      lut_scales_packed_ = scales_ptr != nullptr;
 
       if (prepacked_weights != nullptr) {
         prepacked_weights->buffers_.push_back(std::move(packed_b_));
@@ -263,35 +266,37 @@ Status MatMulNBits<T1>::PrePack(const Tensor& tensor, int input_idx, /*out*/ All
       packed_b_ = IAllocator::MakeUniquePtr<void>(alloc, packed_b_size_, true);
       MlasQNBitGemmPackQuantBData(N_, K_, nbits_, block_size_, compute_type_, qptr, packed_b_.get(), scale_ptr,
                                   has_zp_input_, nullptr, threadpool_ptr);
-    }
-    is_packed = true;
-  } else if (compute_type_ == SQNBIT_CompInt8) {
-    // Packing scales and zero points
-    bool should_pack_scale_and_zp_inputs = [&]() {
+
+      // Packing scales and zero points. They are packed here rather than when PrePack is called for them, so that
+      // the packed buffer is complete before it is shared, and is not written once it is shared.
+      const bool should_pack_scale_and_zp_inputs = [&]() {
 #if defined(MLAS_TARGET_AMD64_IX86)
-      return true;
+        return true;
 #else
-      return (nbits_ == 8);
+        return (nbits_ == 8);
 #endif
-    }();
-
-    if (should_pack_scale_and_zp_inputs) {
-      if (input_idx == InputIndex::scales && packed_b_ != nullptr) {
-        auto sptr = tensor.Data<float>();
-        MlasQNBitGemmPackQuantBData(N_, K_, nbits_, block_size_, compute_type_, nullptr, packed_b_.get(), sptr,
-                                    has_zp_input_, nullptr, nullptr);
-        is_packed = false;
+      }();
+
+      if (compute_type_ == SQNBIT_CompInt8 && should_pack_scale_and_zp_inputs) {
+        if (scales != nullptr) {
+          MlasQNBitGemmPackQuantBData(N_, K_, nbits_, block_size_, compute_type_, nullptr, packed_b_.get(),
+                                      scales->Data<float>(), has_zp_input_, nullptr, nullptr);
+        }
+
+        const Tensor* zero_points = nullptr;
+        if (has_zp_input_ && OpKernel::Info().TryGetConstantInput(InputIndex::zero_points, &zero_points)) {
+          MlasQNBitGemmPackQuantBData(N_, K_, nbits_, block_size_, compute_type_, nullptr, packed_b_.get(), nullptr,
+                                      has_zp_input_, zero_points->Data<uint8_t>(), nullptr);
+        }
       }
 
-      // Packing zero_point
-      if (input_idx == InputIndex::zero_points && packed_b_ != nullptr) {
-        auto zptr = tensor.Data<uint8_t>();
-        MlasQNBitGemmPackQuantBData(N_, K_, nbits_, block_size_, compute_type_, nullptr, packed_b_.get(), nullptr,
-                                    has_zp_input_, zptr, nullptr);
-        is_packed = false;
+      if (prepacked_weights != nullptr) {
+        prepacked_weights->buffers_.push_back(std::move(packed_b_));
+        prepacked_weights->buffer_sizes_.push_back(packed_b_size_);
       }
     }
-
+    is_packed = true;
+  } else if (compute_type_ == SQNBIT_CompInt8) {
 #if defined(MLAS_TARGET_ARM64)
     if (input_idx == InputIndex::scales && packed_b_ != nullptr &&
         MlasQNBitGemmScalesPacked(K_, nbits_, block_size_, compute_type_, has_zp_input_)) {
@@ -300,8 +305,9 @@ Status MatMulNBits<T1>::PrePack(const Tensor& tensor, int input_idx, /*out*/ All
     }
 #endif  // MLAS_TARGET_ARM64
   } else if (prefer_lut_gemm_) {
-    // Pack scales/zero_points for LUT GEMM if B was already packed but scales weren't available then
-    if (input_idx == InputIndex::scales && packed_b_ != nullptr) {
+    // Pack scales/zero_points for LUT GEMM if B was already packed but scales weren't available then.
+    // Constant scales are normally packed together with B, and a shared buffer must not be written to.
+    if (input_idx == InputIndex::scales && packed_b_ != nullptr && !lut_scales_packed_) {
       auto scales_ptr = tensor.Data<float>();
       const uint8_t* zp_ptr = nullptr;
       if (has_zp_input_) {
@@ -316,7 +322,8 @@ Status MatMulNBits<T1>::PrePack(const Tensor& tensor, int input_idx, /*out*/ All
           scales_ptr,
           zp_ptr,
           static_cast<std::byte*>(packed_b_.get()),
-          nullptr);       // No threadpool needed for scales only
+          nullptr);  // No threadpool needed for scales only
+      lut_scales_packed_ = true;
       is_packed = false;  // scales tensor can be released but not "packed" in the ORT sense
     }
   }
@@ -405,6 +412,9 @@ Status MatMulNBits<T1>::UseSharedPrePackedBuffers(std::vector<BufferUniquePtr>&
     if (prefer_lut_gemm_) {
       MlasInitLutGemmKernelConfig(N_, K_, nbits_, block_size_, has_zp_input_);
       packed_b_size_ = MlasLutGemmPackedSize(N_, K_, nbits_, block_size_, has_zp_input_);
+      lut_scales_packed_ = true;
+    } else {
+      packed_b_size_ = MlasQNBitGemmPackQuantBDataSize(N_, K_, nbits_, block_size_, has_zp_input_, compute_type_);
     }
   }
 
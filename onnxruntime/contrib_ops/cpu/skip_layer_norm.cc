@@ -39,7 +39,7 @@ REGISTER_KERNEL_TYPED(MLFloat16)
 
 namespace {
 
-template <typename T, typename = std::enable_if_t<std::is_same_v<T, float> || std::is_same_v<T, double>, void>>
+template <typename T, typename = std::enable_if_t<std::is_same_v<T, double>, void>>
 void ComputeJob(
     const T* input_data,
     const T* skip_data,
@@ -96,6 +96,31 @@ void ComputeJob(
   }
 }
 
+// float and MLFloat16 rows are normalized by MLAS. skip, gamma, beta and bias are float in both cases, the
+// MLFloat16 row is converted to float chunk by chunk inside the kernel.
+template <typename T, typename = std::enable_if_t<std::is_same_v<T, float> || std::is_same_v<T, MLFloat16>, void>>
+void ComputeJob(
+    const T* input_data,
+    const float* skip_data,
+    const float* gamma_data,
+    const float* beta_data,
+    const float* bias_data,
+    ptrdiff_t task_idx,
+    int hidden_size,
+    int64_t skip_size,
+    float epsilon,
+    bool simplified,
+    T* output_data,
+    T* skip_input_bias_add_output_data) {
+  auto offset = task_idx * hidden_size;
+  T* p_skip_input_bias_add_output = skip_input_bias_add_output_data == nullptr ? nullptr : skip_input_bias_add_output_data + offset;
+
+  MlasLayerNormalization<T>(input_data + offset, skip_data + (offset % skip_size), bias_data, gamma_data, beta_data,
+                            static_cast<size_t>(hidden_size), epsilon, simplified,
+                            output_data + offset, p_skip_input_bias_add_output, nullptr, nullptr, 0,
+                            nullptr, nullptr);
+}
+
 void ConvertMLFloat16ToFloatIfNeeded(const Tensor& tensor, AllocatorPtr alloc, IAllocatorUniquePtr<float>& dest, bool& is_packed) {
   if (tensor.GetElementType() == utils::ToTensorProtoElementType<MLFloat16>()) {
     auto tensor_data_ptr = tensor.Data<MLFloat16>();
@@ -162,39 +187,22 @@ Status SkipLayerNorm<T, simplified>::Compute(OpKernelContext* p_ctx) const {
   const int64_t skip_size = skip ? skip->Shape().Size() : prepacked_skip_fp32_size_;
 
   if constexpr (std::is_same_v<T, MLFloat16>) {
-    const size_t total_data_size = static_cast<size_t>(input->Shape().Size());
-
     AllocatorPtr alloc;
     ORT_RETURN_IF_ERROR(p_ctx->GetTempSpaceAllocator(&alloc));
 
-    IAllocatorUniquePtr<float> input_fp32;
-    IAllocatorUniquePtr<float> output_fp32;
-    IAllocatorUniquePtr<float> skip_input_bias_add_output_fp32;
     IAllocatorUniquePtr<float> skip_fp32;
     IAllocatorUniquePtr<float> gamma_fp32;
     IAllocatorUniquePtr<float> beta_fp32;
     IAllocatorUniquePtr<float> bias_fp32;
 
-    const float* input_data_f = nullptr;
     const float* skip_data_f = nullptr;
     const float* gamma_data_f = nullptr;
     const float* beta_data_f = nullptr;
     const float* bias_data_f = nullptr;
-    float* output_data_f = nullptr;
-    float* skip_input_bias_add_output_data_f = nullptr;
 
     const size_t num_elems = static_cast<size_t>(hidden_size);
 
-    input_fp32 = IAllocator::MakeUniquePtr<float>(alloc, total_data_size);
-    MlasConvertHalfToFloatBuffer(input_data, input_fp32.get(), total_data_size);
-    input_data_f = input_fp32.get();
-
-    output_fp32 = IAllocator::MakeUniquePtr<float>(alloc, total_data_size);
-    output_data_f = output_fp32.get();
-
-    skip_input_bias_add_output_fp32 = IAllocator::MakeUniquePtr<float>(alloc, total_data_size);
-    skip_input_bias_add_output_data_f = skip_input_bias_add_output_fp32.get();
-
+    // The input and outputs stay in MLFloat16, only the parameters are converted to float up front.
     if (skip_data) {
       skip_fp32 = IAllocator::MakeUniquePtr<float>(alloc, static_cast<size_t>(skip_size));
       MlasConvertHalfToFloatBuffer(skip_data, skip_fp32.get(), static_cast<size_t>(skip_size));
@@ -230,13 +238,10 @@ Status SkipLayerNorm<T, simplified>::Compute(OpKernelContext* p_ctx) const {
     concurrency::ThreadPool::TryBatchParallelFor(
         p_ctx->GetOperatorThreadPool(), static_cast<int32_t>(task_count),
         [&](ptrdiff_t task_idx) {
-          ComputeJob(input_data_f, skip_data_f, gamma_data_f, beta_data_f, bias_data_f, task_idx, hidden_size, skip_size,
-                     epsilon_, simplified, output_data_f, skip_input_bias_add_output_data_f);
+          ComputeJob(input_data, skip_data_f, gamma_data_f, beta_data_f, bias_data_f, task_idx, hidden_size, skip_size,
+                     epsilon_, simplified, output_data, skip_input_bias_add_output_data);
         },
         0);
-    MlasConvertFloatToHalfBuffer(output_data_f, output_data, total_data_size);
-    if (skip_input_bias_add_output_data != nullptr)
-      MlasConvertFloatToHalfBuffer(skip_input_bias_add_output_data_f, skip_input_bias_add_output_data, total_data_size);
   } else {
     concurrency::ThreadPool::TryBatchParallelFor(
         p_ctx->GetOperatorThreadPool(), static_cast<int32_t>(task_count),
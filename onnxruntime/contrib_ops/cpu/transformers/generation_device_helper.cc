@@ -63,6 +63,78 @@ void ExpandInputs(const OrtValue& input, int num_beams, AllocatorPtr allocator,
   }
 }
 
+template <typename T>
+void GatherRows(const OrtValue& input, int batch_axis, gsl::span<const int32_t> rows, AllocatorPtr allocator,
+                OrtValue& output) {
+  const Tensor& input_tensor = input.Get<Tensor>();
+  ORT_ENFORCE(input_tensor.DataType() == DataTypeImpl::GetType<T>());
+
+  const TensorShape& input_shape = input_tensor.Shape();
+  const size_t outer_size = onnxruntime::narrow<size_t>(input_shape.SizeToDimension(batch_axis));
+  const size_t row_size = onnxruntime::narrow<size_t>(input_shape.SizeFromDimension(batch_axis + 1));
+  const size_t input_rows = onnxruntime::narrow<size_t>(input_shape[batch_axis]);
+
+  TensorShape output_shape = input_shape;
+  output_shape[batch_axis] = static_cast<int64_t>(rows.size());
+  Tensor::InitOrtValue(input_tensor.DataType(), output_shape, allocator, output);
+
+  const T* input_data = input_tensor.Data<T>();
+  T* target = output.GetMutable<Tensor>()->MutableData<T>();
+  for (size_t i = 0; i < outer_size; i++) {
+    for (int32_t row : rows) {
+      memcpy(target, input_data + (i * input_rows + row) * row_size, sizeof(T) * row_size);
+      target += row_size;
+    }
+  }
+}
+
+template <typename T>
+void ScatterRows(const OrtValue& input, gsl::span<const int32_t> rows, int64_t batch_size, AllocatorPtr allocator,
+                 OrtValue& output) {
+  const Tensor& input_tensor = input.Get<Tensor>();
+  ORT_ENFORCE(input_tensor.DataType() == DataTypeImpl::GetType<T>());
+  ORT_ENFORCE(input_tensor.Shape()[0] == static_cast<int64_t>(rows.size()));
+
+  TensorShape output_shape = input_tensor.Shape();
+  output_shape[0] = batch_size;
+  Tensor::InitOrtValue(input_tensor.DataType(), output_shape, allocator, output);
+
+  const size_t row_size = onnxruntime::narrow<size_t>(output_shape.SizeFromDimension(1));
+  T* output_data = output.GetMutable<Tensor>()->MutableData<T>();
+  memset(output_data, 0, output.Get<Tensor>().SizeInBytes());
+
+  const T* source = input_tensor.Data<T>();
+  for (int32_t row : rows) {
+    memcpy(output_data + row * row_size, source, sizeof(T) * row_size);
+    source += row_size;
+  }
+}
+
+template <typename T>
+void TruncatePastState(const OrtValue& present, int past_sequence_length, AllocatorPtr allocator, OrtValue& past) {
+  const Tensor& present_tensor = present.Get<Tensor>();
+  const TensorShape& present_shape = present_tensor.Shape();
+  ORT_ENFORCE(present_shape.NumDimensions() == 5 && past_sequence_length <= present_shape[3]);
+  if (present_shape[3] == past_sequence_length) {
+    past = present;
+    return;
+  }
+
+  TensorShape past_shape = present_shape;
+  past_shape[3] = past_sequence_length;
+  Tensor::InitOrtValue(present_tensor.DataType(), past_shape, allocator, past);
+
+  const size_t num_blocks = onnxruntime::narrow<size_t>(present_shape.SizeToDimension(3));
+  const size_t head_size = onnxruntime::narrow<size_t>(present_shape[4]);
+  const size_t present_block_size = onnxruntime::narrow<size_t>(present_shape[3]) * head_size;
+  const size_t past_block_size = static_cast<size_t>(past_sequence_length) * head_size;
+  const T* source = present_tensor.Data<T>();
+  T* target = past.GetMutable<Tensor>()->MutableData<T>();
+  for (size_t i = 0; i < num_blocks; i++) {
+    memcpy(target + i * past_block_size, source + i * present_block_size, sizeof(T) * past_block_size);
+  }
+}
+
 // TODO(wy): Dispatch it to avoid passing multiple functions to interface.
 template <typename T>
 Status ExpandBuffer(Stream* stream,
@@ -1041,6 +1113,23 @@ template Status UpdateDecoderFeeds<MLFloat16>(
 
 template void ExpandInputs<int32_t>(const OrtValue& input, int num_beams, AllocatorPtr allocator, OrtValue& expanded);
 
+template void GatherRows<int32_t>(const OrtValue& input, int batch_axis, gsl::span<const int32_t> rows,
+                                  AllocatorPtr allocator, OrtValue& output);
+template void GatherRows<float>(const OrtValue& input, int batch_axis, gsl::span<const int32_t> rows,
+                                AllocatorPtr allocator, OrtValue& output);
+template void GatherRows<MLFloat16>(const OrtValue& input, int batch_axis, gsl::span<const int32_t> rows,
+                                    AllocatorPtr allocator, OrtValue& output);
+
+template void ScatterRows<float>(const OrtValue& input, gsl::span<const int32_t> rows, int64_t batch_size,
+                                 AllocatorPtr allocator, OrtValue& output);
+template void ScatterRows<MLFloat16>(const OrtValue& input, gsl::span<const int32_t> rows, int64_t batch_size,
+                                     AllocatorPtr allocator, OrtValue& output);
+
+template void TruncatePastState<float>(const OrtValue& present, int past_sequence_length, AllocatorPtr allocator,
+                                       OrtValue& past);
+template void TruncatePastState<MLFloat16>(const OrtValue& present, int past_sequence_length,
+                                           AllocatorPtr allocator, OrtValue& past);
+
 template Status ExpandBuffer<int32_t>(
     Stream* stream,
     const OrtValue& input,
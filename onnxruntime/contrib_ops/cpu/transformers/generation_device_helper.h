@@ -397,6 +397,21 @@ Status ExpandBuffer(
     bool only_copy_shape,
     int max_sequence_length);
 
+// Gathers the given rows along batch_axis of a CPU tensor into a new tensor.
+template <typename T>
+void GatherRows(const OrtValue& input, int batch_axis, gsl::span<const int32_t> rows, AllocatorPtr allocator,
+                OrtValue& output);
+
+// Scatters the rows along axis 0 of a CPU tensor to the given rows of a zero initialized tensor with batch_size rows.
+template <typename T>
+void ScatterRows(const OrtValue& input, gsl::span<const int32_t> rows, int64_t batch_size, AllocatorPtr allocator,
+                 OrtValue& output);
+
+// Keeps the first past_sequence_length entries of a GPT present state with shape
+// (2, batch_size, num_heads, present_sequence_length, head_size).
+template <typename T>
+void TruncatePastState(const OrtValue& present, int past_sequence_length, AllocatorPtr allocator, OrtValue& past);
+
 Status UpdateDecoderCrossQK(
     int iteration_number,
     Stream* stream,
@@ -3,6 +3,7 @@
 
 #pragma once
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
 #include "core/common/span_utils.h"
@@ -84,6 +85,19 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
   Status Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                  const FeedsFetchesManager& feeds_fetches_manager);
 
+  // Set the draft subgraph of speculative decoding.
+  void InitializeSpeculative(const SessionState& draft_decoder_session_state, GptSubgraph& draft_gpt_subgraph) {
+    draft_decoder_session_state_ = &draft_decoder_session_state;
+    draft_gpt_subgraph_ = &draft_gpt_subgraph;
+  }
+
+  // Execute speculative decoding. In each iteration, the draft subgraph proposes up to num_speculative_tokens tokens
+  // one at a time, then the GPT subgraph scores all of them in one run. The longest prefix of the proposals that
+  // matches the greedy choice of the GPT subgraph is accepted, followed by the token chosen by the GPT subgraph at
+  // the first mismatch. The generated sequence is the same as the one of Execute.
+  Status ExecuteSpeculative(const FeedsFetchesManager& feeds_fetches_manager,
+                            const FeedsFetchesManager& draft_feeds_fetches_manager);
+
  private:
   // Prepare the inputs for first inference of subgraph
   Status CreateInitialFeeds(gsl::span<int32_t>& sequence_lengths,
@@ -101,10 +115,31 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
       gsl::span<const int32_t> next_tokens,
       int past_sequence_length);
 
+  // Remove the sequences that have met EOS from the subgraph feeds, so that the remaining iterations only run the
+  // unfinished ones. active_rows maps each row of the feeds to its index in the batch.
+  Status CompactFinishedSequences(gsl::span<const bool> eos_meet,
+                                  std::vector<int32_t>& active_rows,
+                                  std::vector<OrtValue>& fetches,
+                                  std::vector<OrtValue>& feeds,
+                                  gsl::span<int32_t> next_positions,
+                                  OrtValue& position_ids);
+
+  // Update the input of the GPT or draft subgraph to run the given tokens after the first cache_length entries of
+  // the present state in last_outputs.
+  Status UpdateSpeculativeFeeds(const GptSubgraph& subgraph,
+                                const std::vector<OrtValue>& last_outputs,
+                                std::vector<OrtValue>& next_inputs,
+                                gsl::span<const int32_t> tokens,
+                                int first_position,
+                                int cache_length);
+
   const SessionState* init_run_decoder_session_state_ = nullptr;
   GptSubgraph* init_run_gpt_subgraph_ = nullptr;
   GptSubgraph& gpt_subgraph_;
 
+  const SessionState* draft_decoder_session_state_ = nullptr;
+  GptSubgraph* draft_gpt_subgraph_ = nullptr;
+
   // Device specific functions
   GenerationDeviceHelper::CreateGptInputsFunc create_inputs_func_;
   GenerationDeviceHelper::AddToFeedsFunc add_to_feeds_func_;
@@ -187,6 +222,266 @@ Status GreedySearchGpt<T, ParametersT>::UpdateFeeds(
                             false);
 }
 
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::CompactFinishedSequences(gsl::span<const bool> eos_meet,
+                                                                 std::vector<int32_t>& active_rows,
+                                                                 std::vector<OrtValue>& fetches,
+                                                                 std::vector<OrtValue>& feeds,
+                                                                 gsl::span<int32_t> next_positions,
+                                                                 OrtValue& position_ids) {
+  std::vector<int32_t> kept_rows;
+  kept_rows.reserve(active_rows.size());
+  for (size_t row = 0; row < active_rows.size(); row++) {
+    if (!eos_meet[active_rows[row]]) {
+      kept_rows.push_back(static_cast<int32_t>(row));
+    }
+  }
+  if (kept_rows.size() == active_rows.size()) {
+    return Status::OK();
+  }
+
+  // Present state has shape (2, batch_size, num_heads, past_sequence_length, head_size).
+  for (size_t i = static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex()); i < fetches.size(); i++) {
+    OrtValue present;
+    GenerationCpuDeviceHelper::GatherRows<T>(fetches[i], 1, kept_rows, this->temp_space_allocator_, present);
+    fetches[i] = present;
+  }
+
+  // Attention mask has shape (batch_size, current_length - 1). Input IDs and past state are replaced by UpdateFeeds.
+  OrtValue attention_mask;
+  GenerationCpuDeviceHelper::GatherRows<int32_t>(feeds[2], 0, kept_rows, this->temp_space_allocator_,
+                                                 attention_mask);
+  feeds[2] = attention_mask;
+
+  // Rows only move towards the front, so position IDs and the batch mapping can be compacted in place.
+  for (size_t i = 0; i < kept_rows.size(); i++) {
+    next_positions[i] = next_positions[kept_rows[i]];
+    active_rows[i] = active_rows[kept_rows[i]];
+  }
+  active_rows.resize(kept_rows.size());
+
+  int64_t dims[] = {static_cast<int64_t>(kept_rows.size()), 1};
+  TensorShape shape(&dims[0], 2);
+  Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(),
+                       shape,
+                       next_positions.data(),
+                       this->temp_space_allocator_->Info(),
+                       position_ids);
+  return Status::OK();
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::UpdateSpeculativeFeeds(const GptSubgraph& subgraph,
+                                                               const std::vector<OrtValue>& last_outputs,
+                                                               std::vector<OrtValue>& next_inputs,
+                                                               gsl::span<const int32_t> tokens,
+                                                               int first_position,
+                                                               int cache_length) {
+  // next_inputs: input_ids, position_ids, attention_mask, past_0, past_1, ...
+  const int64_t num_tokens = static_cast<int64_t>(tokens.size());
+  auto int32_type = DataTypeImpl::GetType<int32_t>();
+
+  OrtValue input_ids;
+  Tensor::InitOrtValue(int32_type, TensorShape{1, num_tokens}, this->temp_space_allocator_, input_ids);
+  OrtValue position_ids;
+  Tensor::InitOrtValue(int32_type, TensorShape{1, num_tokens}, this->temp_space_allocator_, position_ids);
+  int32_t* input_ids_data = input_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  int32_t* position_data = position_ids.GetMutable<Tensor>()->MutableData<int32_t>();
+  for (int64_t i = 0; i < num_tokens; i++) {
+    input_ids_data[i] = tokens[i];
+    position_data[i] = first_position + static_cast<int32_t>(i);
+  }
+  next_inputs[0] = input_ids;
+  next_inputs[1] = position_ids;
+
+  // Keep the mask of the entries that stay in the past state, and attend to all the new tokens.
+  const int32_t* old_mask_data = next_inputs[2].Get<Tensor>().Data<int32_t>();
+  OrtValue attention_mask;
+  Tensor::InitOrtValue(int32_type, TensorShape{1, cache_length + num_tokens}, this->temp_space_allocator_,
+                       attention_mask);
+  int32_t* mask_data = attention_mask.GetMutable<Tensor>()->MutableData<int32_t>();
+  std::copy_n(old_mask_data, cache_length, mask_data);
+  std::fill_n(mask_data + cache_length, num_tokens, 1);
+  next_inputs[2] = attention_mask;
+
+  const int k = subgraph.GetFirstPastInputIndex() - subgraph.GetFirstPresentOutputIndex();
+  for (size_t i = static_cast<size_t>(subgraph.GetFirstPresentOutputIndex()); i < last_outputs.size(); ++i) {
+    GenerationCpuDeviceHelper::TruncatePastState<T>(last_outputs[i], cache_length, this->temp_space_allocator_,
+                                                    next_inputs[i + k]);
+  }
+  return Status::OK();
+}
+
+template <typename T, typename ParametersT>
+Status GreedySearchGpt<T, ParametersT>::ExecuteSpeculative(const FeedsFetchesManager& feeds_fetches_manager,
+                                                           const FeedsFetchesManager& draft_feeds_fetches_manager) {
+  const ParametersT* parameters = this->parameters_;
+  ORT_RETURN_IF(draft_gpt_subgraph_ == nullptr, "InitializeSpeculative must be called before ExecuteSpeculative");
+  ORT_RETURN_IF(this->IsCuda(), "Speculative decoding is only supported by the CPU execution provider");
+  ORT_RETURN_IF(parameters->batch_size != 1, "Speculative decoding requires batch_size 1, got ", parameters->batch_size);
+  ORT_RETURN_IF(gpt_subgraph_.past_present_share_buffer_ || draft_gpt_subgraph_->past_present_share_buffer_,
+                "Speculative decoding does not support subgraphs that share the past and present buffers");
+  ORT_RETURN_IF(parameters->num_speculative_tokens <= 0,
+                "num_speculative_tokens shall be positive, got ", parameters->num_speculative_tokens);
+
+  // Allocate output tensors.
+  int64_t sequences_dims[] = {parameters->batch_size, parameters->max_length};
+  TensorShape sequences_shape(&sequences_dims[0], sizeof(sequences_dims) / sizeof(sequences_dims[0]));
+  Tensor* output_sequences = this->context_.Output(0, sequences_shape);
+
+  GreedySearchState<T> greedy_state;
+  greedy_state.Init(this->cpu_allocator_,
+                    this->temp_space_allocator_,
+                    static_cast<int>(parameters->BatchBeamSize()),
+                    static_cast<int>(parameters->vocab_size),
+                    static_cast<int>(parameters->sequence_length),
+                    static_cast<int>(parameters->max_length),
+                    static_cast<int>(parameters->num_heads),
+                    static_cast<int>(parameters->head_size),
+                    false,
+                    false,
+                    this->ort_stream_);
+  SamplingState<T> sampling_state;  // not used by greedy search
+
+  const OrtValue* input_ids_value = this->context_.GetInputOrtValue(0);
+  const Tensor& input_ids = input_ids_value->Get<Tensor>();
+  const OrtValue* attn_mask_value = this->context_.GetInputOrtValue(6);
+
+  std::vector<OrtValue> feeds;
+  std::vector<OrtValue> fetches;
+  IAllocatorUniquePtr<char> buffer;
+  OrtValue expanded_input_ids_in_cpu;
+  ORT_RETURN_IF_ERROR(gpt_subgraph_.CreateInitialFeeds(input_ids, this->implicit_inputs_, parameters->num_beams,
+                                                       parameters->pad_token_id, greedy_state.sequence_lengths,
+                                                       expanded_input_ids_in_cpu, attn_mask_value, feeds,
+                                                       this->create_inputs_func_, this->add_to_feeds_func_, buffer,
+                                                       this->ort_stream_, parameters->max_length));
+
+  std::vector<OrtValue> draft_feeds;
+  std::vector<OrtValue> draft_fetches;
+  IAllocatorUniquePtr<char> draft_buffer;
+  OrtValue draft_input_ids_in_cpu;
+  ORT_RETURN_IF_ERROR(draft_gpt_subgraph_->CreateInitialFeeds(input_ids, this->implicit_inputs_, parameters->num_beams,
+                                                              parameters->pad_token_id, greedy_state.sequence_lengths,
+                                                              draft_input_ids_in_cpu, attn_mask_value, draft_feeds,
+                                                              this->create_inputs_func_, this->add_to_feeds_func_,
+                                                              draft_buffer, this->ort_stream_,
+                                                              parameters->max_length));
+
+  init_greedy_state_func_(&greedy_state, greedy_state.sequence_lengths, this->ort_stream_);
+  greedy_state.SetSequence(expanded_input_ids_in_cpu.Get<Tensor>().DataAsSpan<int32_t>(),
+                           static_cast<size_t>(parameters->BatchBeamSize()),
+                           parameters->max_length,
+                           parameters->sequence_length);
+
+  auto run_subgraph = [this](const SessionState& session_state, const FeedsFetchesManager& ffm,
+                             const std::vector<OrtValue>& subgraph_feeds, std::vector<OrtValue>& subgraph_fetches) {
+    subgraph_fetches.clear();
+    return utils::ExecuteSubgraph(session_state, ffm, subgraph_feeds, subgraph_fetches, {},
+                                  ExecutionMode::ORT_SEQUENTIAL, this->context_.GetTerminateFlag(),
+                                  this->context_.Logger(), this->ort_stream_);
+  };
+
+  // Run both subgraphs on the prompt. The GPT subgraph chooses the first token.
+  ORT_RETURN_IF_ERROR(run_subgraph(this->decoder_session_state_, feeds_fetches_manager, feeds, fetches));
+  ORT_RETURN_IF_ERROR(run_subgraph(*draft_decoder_session_state_, draft_feeds_fetches_manager, draft_feeds,
+                                   draft_fetches));
+
+  int iteration_counter = 1;
+  gsl::span<int32_t> next_tokens;
+  ORT_RETURN_IF_ERROR(this->GenerateNextToken(fetches[0], next_tokens, greedy_state, sampling_state,
+                                              iteration_counter, parameters->eos_token_id));
+  int current_length = parameters->sequence_length + 1;
+
+  // Position of the first generated token. Token i after the prompt has position first_position + i.
+  const int first_position = greedy_state.next_positions[0];
+  int generated_count = 1;
+
+  // Number of entries in the past state of each subgraph, and the generated tokens that are not in it yet.
+  int cache_length = parameters->sequence_length;
+  int draft_cache_length = parameters->sequence_length;
+  std::vector<int32_t> pending_tokens{next_tokens[0]};
+  std::vector<int32_t> draft_pending_tokens{next_tokens[0]};
+  std::vector<int32_t> draft_tokens;
+  std::vector<int32_t> verify_tokens;
+
+  const int vocab_size = parameters->vocab_size;
+  while (current_length < parameters->max_length && !greedy_state.eos_meet[0]) {
+    // The GPT subgraph emits at most one token more than the number of proposals.
+    const int num_draft_tokens = std::min(parameters->num_speculative_tokens,
+                                          parameters->max_length - current_length - 1);
+
+    // Propose tokens with the draft subgraph.
+    draft_tokens.clear();
+    const int draft_cache_length_before = draft_cache_length;
+    for (int i = 0; i < num_draft_tokens; i++) {
+      gsl::span<const int32_t> tokens = i == 0 ? gsl::span<const int32_t>(draft_pending_tokens)
+                                               : gsl::span<const int32_t>(&draft_tokens.back(), 1);
+      ORT_RETURN_IF_ERROR(UpdateSpeculativeFeeds(*draft_gpt_subgraph_, draft_fetches, draft_feeds, tokens,
+                                                 first_position + generated_count - static_cast<int>(tokens.size()) +
+                                                     i,
+                                                 draft_cache_length));
+      ORT_RETURN_IF_ERROR(run_subgraph(*draft_decoder_session_state_, draft_feeds_fetches_manager, draft_feeds,
+                                       draft_fetches));
+      draft_cache_length += static_cast<int>(tokens.size());
+
+      const Tensor& draft_logits = draft_fetches[0].Get<Tensor>();
+      const int64_t padded_vocab_size = draft_logits.Shape()[2];
+      const T* row = draft_logits.Data<T>() + (draft_logits.Shape()[1] - 1) * padded_vocab_size;
+      int32_t best = 0;
+      for (int v = 1; v < vocab_size; v++) {
+        if (static_cast<float>(row[v]) > static_cast<float>(row[best])) {
+          best = v;
+        }
+      }
+      draft_tokens.push_back(best);
+    }
+
+    // Score the pending token and all proposals with the GPT subgraph.
+    verify_tokens = pending_tokens;
+    verify_tokens.insert(verify_tokens.end(), draft_tokens.begin(), draft_tokens.end());
+    ORT_RETURN_IF_ERROR(UpdateSpeculativeFeeds(gpt_subgraph_, fetches, feeds, verify_tokens,
+                                               first_position + generated_count - 1, cache_length));
+    ORT_RETURN_IF_ERROR(run_subgraph(this->decoder_session_state_, feeds_fetches_manager, feeds, fetches));
+
+    // Logits processing only reads the last position, so a view of the first j + 1 positions yields the token
+    // that the GPT subgraph chooses after verify_tokens[j].
+    const Tensor& logits = fetches[0].Get<Tensor>();
+    int num_accepted = 0;
+    for (int j = 0; j <= num_draft_tokens; j++) {
+      OrtValue logits_view;
+      Tensor::InitOrtValue(logits.DataType(), TensorShape{1, j + 1, logits.Shape()[2]},
+                           const_cast<T*>(logits.Data<T>()), logits.Location(), logits_view);
+      ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits_view, next_tokens, greedy_state, sampling_state,
+                                                  ++iteration_counter, parameters->eos_token_id));
+      ++current_length;
+      ++generated_count;
+      if (j == num_draft_tokens || greedy_state.eos_meet[0] || next_tokens[0] != draft_tokens[j]) {
+        break;
+      }
+      ++num_accepted;
+    }
+
+    // Drop the past state of the rejected proposals. The draft subgraph has not run the last proposal.
+    cache_length += 1 + num_accepted;
+    if (num_draft_tokens > 0) {
+      draft_cache_length = draft_cache_length_before + static_cast<int>(draft_pending_tokens.size()) +
+                           std::min(num_accepted, num_draft_tokens - 1);
+      draft_pending_tokens.clear();
+      if (num_accepted == num_draft_tokens) {
+        draft_pending_tokens.push_back(draft_tokens.back());
+      }
+    }
+    draft_pending_tokens.push_back(next_tokens[0]);
+    pending_tokens.assign(1, next_tokens[0]);
+  }
+
+  // Copy the sequences to output
+  gsl::span<int32_t> output = output_sequences->MutableDataAsSpan<int32_t>();
+  gsl::copy(greedy_state.sequences.GetSequence(0), output.subspan(0, parameters->max_length));
+  return Status::OK();
+}
+
 template <typename T, typename ParametersT>
 Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                                                 const FeedsFetchesManager& feeds_fetches_manager) {
@@ -268,6 +563,13 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                        this->temp_space_allocator_->Info(),
                        position_ids);
 
+  // On CPU, sequences that have met EOS are dropped from the batch of the subgraph. Their logits are filled with
+  // zeros before logits processing, which only emits pad tokens for them.
+  const bool compact_finished_sequences = !this->IsCuda() && !gpt_subgraph_.past_present_share_buffer_;
+  std::vector<int32_t> active_rows(static_cast<size_t>(parameters->BatchBeamSize()));
+  std::iota(active_rows.begin(), active_rows.end(), 0);
+  std::vector<int32_t> active_next_tokens;
+
   int current_length = parameters->sequence_length;
   int iteration_counter = 0;
   while (current_length < parameters->max_length) {
@@ -312,7 +614,11 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     ORT_RETURN_IF_ERROR(status);
 
-    const OrtValue& logits = fetches[0];
+    OrtValue logits = fetches[0];
+    if (active_rows.size() < static_cast<size_t>(parameters->BatchBeamSize())) {
+      GenerationCpuDeviceHelper::ScatterRows<T>(fetches[0], active_rows, parameters->BatchBeamSize(),
+                                                this->temp_space_allocator_, logits);
+    }
     gsl::span<int32_t> next_tokens;
 
     ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
@@ -361,9 +667,22 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
     if (current_length < parameters->max_length) {
       bool increase_position = (iteration_counter > 1);
 
+      gsl::span<const int32_t> feed_tokens = ReinterpretAsSpan<const int32_t>(next_tokens);
+      if (compact_finished_sequences) {
+        ORT_RETURN_IF_ERROR(CompactFinishedSequences(eos_meet, active_rows, fetches, feeds,
+                                                     greedy_state.next_positions, position_ids));
+        if (active_rows.size() < next_tokens.size()) {
+          active_next_tokens.resize(active_rows.size());
+          for (size_t row = 0; row < active_rows.size(); row++) {
+            active_next_tokens[row] = next_tokens[active_rows[row]];
+          }
+          feed_tokens = active_next_tokens;
+        }
+      }
+
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
                                       position_ids, increase_position,
-                                      ReinterpretAsSpan<const int32_t>(next_tokens),
+                                      feed_tokens,
                                       current_length - 1));
     }
     if (gpt_subgraph_.past_present_share_buffer_) {
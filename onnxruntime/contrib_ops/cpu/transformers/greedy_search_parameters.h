@@ -16,6 +16,10 @@ struct GreedySearchParameters : public BeamSearchParameters {
   void ParseFromAttributes(const OpKernelInfo& info) override;
 
   void ParseFromInputs(OpKernelContext* context);
+
+  // Number of tokens proposed by the draft decoder in each step of speculative decoding. 0 to decode without
+  // the draft decoder.
+  int num_speculative_tokens = 4;
 };
 
 }  // namespace transformers
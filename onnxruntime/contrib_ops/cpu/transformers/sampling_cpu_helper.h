@@ -2,53 +2,93 @@
 // Licensed under the MIT License.
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include "core/mlas/inc/mlas.h"
+#include "core/platform/threadpool.h"
+
 namespace onnxruntime {
 namespace contrib {
 namespace SamplingCpuHelper {
 
+// Applies top-p filtering to the scores of one batch row, using probs as scratch space for the softmax and
+// candidates as scratch space for the token indices. Both spans hold vocab_size elements.
+//
+// Sorting the whole vocabulary is not needed: a token whose probability is below (1 - top_p) / vocab_size is always
+// filtered, since the tokens with probability no more than its own sum up to less than 1 - top_p. Only the remaining
+// candidates are sorted, which are a small fraction of the vocabulary for the distributions seen in practice.
 template <typename T>
-void filter_scores(std::vector<size_t>& sorted_indice,
-                   gsl::span<T>& next_token_score,
-                   const transformers::IGenerationParameters* parameters,
-                   size_t chunk_offset,
-                   size_t offset) {
-  size_t real_index = sorted_indice[chunk_offset + offset];
-  next_token_score[chunk_offset + real_index] = (T)parameters->filter_value;
-}
-
-template <typename T>
-void cumulate_and_filter_custom(gsl::span<T>& next_token_scores,
-                                gsl::span<T>& cumulative_probs,
-                                const transformers::IGenerationParameters* parameters,
-                                std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] > parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 1);
+void FilterTopP(gsl::span<T> scores,
+                gsl::span<T> probs,
+                gsl::span<int32_t> candidates,
+                const transformers::IGenerationParameters* parameters) {
+  const int vocab_size = parameters->vocab_size;
+  const T filter_value = static_cast<T>(parameters->filter_value);
+  MlasComputeSoftmax(scores.data(), probs.data(), 1, static_cast<size_t>(vocab_size), false, false, 0.0f, nullptr);
+
+  // Mass of the filtered tokens, in the order of the probabilities when ascending.
+  const float threshold = (1.0f - parameters->top_p) / static_cast<float>(vocab_size);
+  float filtered_mass = 0.0f;
+  size_t num_candidates = 0;
+  for (int i = 0; i < vocab_size; i++) {
+    if (static_cast<float>(probs[i]) >= threshold) {
+      candidates[num_candidates++] = i;
+    } else {
+      filtered_mass += static_cast<float>(probs[i]);
     }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - 1; j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] > parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j + 1);
+  }
+
+  // The top min_tokens_to_keep tokens are never filtered. Fall back to all tokens in the rare case that there are
+  // fewer candidates.
+  if (num_candidates < static_cast<size_t>(parameters->min_tokens_to_keep)) {
+    num_candidates = static_cast<size_t>(vocab_size);
+    std::iota(candidates.begin(), candidates.end(), 0);
+    filtered_mass = 0.0f;
+  } else if (num_candidates < static_cast<size_t>(vocab_size)) {
+    for (int i = 0; i < vocab_size; i++) {
+      if (static_cast<float>(probs[i]) < threshold) {
+        scores[i] = filter_value;
       }
     }
   }
-}
 
-template <typename T>
-void cumulate_and_filter(gsl::span<T>& next_token_scores,
-                         gsl::span<T>& cumulative_probs,
-                         const transformers::IGenerationParameters* parameters,
-                         std::vector<size_t>& sorted_indices) {
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    size_t offset = i * parameters->vocab_size;
-    if (cumulative_probs[offset] <= 1 - parameters->top_p) {
-      filter_scores(sorted_indices, next_token_scores, parameters, offset, 0);
+  // Sort in descending order of the probabilities. Tokens with the same probability are visited by the cumulative
+  // filter in ascending order of their index, like a stable sort of the vocabulary in the order of the filter does.
+  const bool custom_sampling = parameters->custom_sampling;
+  std::sort(candidates.begin(), candidates.begin() + num_candidates,
+            [&probs, custom_sampling](int32_t i1, int32_t i2) {
+              const float p1 = static_cast<float>(probs[i1]);
+              const float p2 = static_cast<float>(probs[i2]);
+              if (p1 != p2) {
+                return p1 > p2;
+              }
+              return custom_sampling ? i1 < i2 : i1 > i2;
+            });
+
+  if (custom_sampling) {
+    // Keep the tokens before the cumulative probability in descending order exceeds top_p, and the token after it.
+    float cumulative_prob = 0.0f;
+    for (size_t rank = 0; rank + 1 < num_candidates; rank++) {
+      cumulative_prob += static_cast<float>(probs[candidates[rank]]);
+      if (cumulative_prob > parameters->top_p) {
+        for (size_t r = rank + 1; r < num_candidates; r++) {
+          scores[candidates[r]] = filter_value;
+        }
+        break;
+      }
     }
-    for (size_t j = 1; j < static_cast<size_t>(parameters->vocab_size) - static_cast<size_t>(parameters->min_tokens_to_keep); j++) {
-      cumulative_probs[j + offset] += cumulative_probs[j + offset - 1];
-      if (cumulative_probs[j + offset] <= 1 - parameters->top_p) {
-        filter_scores(sorted_indices, next_token_scores, parameters, offset, j);
+  } else {
+    // Filter the tokens while the cumulative probability in ascending order is no more than 1 - top_p.
+    const size_t min_tokens_to_keep = static_cast<size_t>(parameters->min_tokens_to_keep);
+    float cumulative_prob = filtered_mass;
+    for (size_t rank = num_candidates; rank-- > 0;) {
+      cumulative_prob += static_cast<float>(probs[candidates[rank]]);
+      if (cumulative_prob > 1.0f - parameters->top_p) {
+        break;
+      }
+      const bool is_last = rank == static_cast<size_t>(vocab_size) - 1;
+      if (rank >= min_tokens_to_keep || is_last) {
+        scores[candidates[rank]] = filter_value;
       }
     }
   }
@@ -64,56 +104,21 @@ Status Sample(AllocatorPtr& allocator,
               const IConsoleDumper* dumper) {
   ORT_UNUSED_PARAMETER(dumper);
 
-  gsl::span<T>& sorted_scores = sampling_state->sorted_scores;
-  memcpy(sorted_scores.data(), next_token_scores.data(), next_token_scores.size_bytes());
-  std::vector<size_t> sorted_indices(static_cast<size_t>(parameters->batch_size) * static_cast<size_t>(parameters->vocab_size));
-
-  std::function<bool(T, T)> predicator;
-  if (parameters->custom_sampling) {
-    predicator = std::greater<T>();
-  } else {
-    predicator = std::less<T>();
-  }
-
-  // TODO: This could be optimized with allocated buffer and handwritten sort algorithm
-  for (size_t i = 0; i < static_cast<size_t>(parameters->batch_size); i++) {
-    auto indices_begin = sorted_indices.begin() + i * parameters->vocab_size;
-    auto indices_end = sorted_indices.begin() + (i + 1) * parameters->vocab_size;
-    gsl::span<T> next_token_score = next_token_scores.subspan(i * parameters->vocab_size, parameters->vocab_size);
-    std::iota(indices_begin, indices_end, 0);
-    std::sort(indices_begin, indices_end,
-              [&next_token_score, &predicator](size_t i1, size_t i2) {
-                return predicator(next_token_score[i1], next_token_score[i2]);
-              });
-
-    std::sort(sorted_scores.begin() + i * parameters->vocab_size,
-              sorted_scores.begin() + (i + 1) * parameters->vocab_size,
-              predicator);
-  }
-
-#ifdef DEBUG_GENERATION
-  dumper->Print("sorted_scores", sorted_scores.data(), parameters->batch_size, parameters->vocab_size);
-  std::vector<int64_t> sorted_indices_copy(sorted_indices.begin(), sorted_indices.end());
-  dumper->Print("sorted_indices", sorted_indices_copy.data(), parameters->batch_size, parameters->vocab_size);
-#endif
-
-  gsl::span<T>& cumulative_probs = sampling_state->cumulative_probs;
-
-  ORT_RETURN_IF_ERROR(SoftmaxCPU<T>(parameters->batch_size,
-                                    parameters->vocab_size,
-                                    sorted_scores.data(),
-                                    cumulative_probs.data(),
-                                    false,
-                                    thread_pool));
-
-  if (parameters->custom_sampling) {
-    cumulate_and_filter_custom(next_token_scores, cumulative_probs, parameters, sorted_indices);
-  } else {
-    cumulate_and_filter(next_token_scores, cumulative_probs, parameters, sorted_indices);
-  }
+  // Filter each batch row in parallel. The rows of cumulative_probs hold the probabilities of the rows, and the
+  // rows of candidates the token indices that they sort.
+  gsl::span<T>& probs = sampling_state->cumulative_probs;
+  const size_t vocab_size = static_cast<size_t>(parameters->vocab_size);
+  auto candidates_buffer = IAllocator::MakeUniquePtr<int32_t>(allocator, next_token_scores.size());
+  gsl::span<int32_t> candidates(candidates_buffer.get(), next_token_scores.size());
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, parameters->batch_size,
+      [&next_token_scores, &probs, &candidates, parameters, vocab_size](std::ptrdiff_t batch_id) {
+        const size_t offset = static_cast<size_t>(batch_id) * vocab_size;
+        FilterTopP(next_token_scores.subspan(offset, vocab_size), probs.subspan(offset, vocab_size),
+                   candidates.subspan(offset, vocab_size), parameters);
+      });
 
 #ifdef DEBUG_GENERATION
-  dumper->Print("cumulative_probs after filtering", cumulative_probs.data(), parameters->batch_size, parameters->vocab_size);
   dumper->Print("next_token_scores after filtering", next_token_scores.data(), parameters->batch_size, parameters->vocab_size);
 #endif
 
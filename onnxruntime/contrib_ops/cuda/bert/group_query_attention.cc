@@ -24,24 +24,6 @@ namespace onnxruntime {
 namespace contrib {
 namespace cuda {
 
-namespace {
-// Map string attribute to quantization type enum
-KVQuantizationType StringToKVQuantizationType(std::string s) {
-  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
-  if (s == "NONE") {
-    return KVQuantizationType::NONE;
-  }
-  if (s == "PER_TENSOR") {
-    return KVQuantizationType::PER_TENSOR;
-  }
-
-  if (s == "PER_CHANNEL") {
-    return KVQuantizationType::PER_CHANNEL;
-  }
-  return KVQuantizationType::NONE;
-}
-}  // namespace
-
 #define REGISTER_KERNEL_TYPED(T, U)                                                   \
   ONNX_OPERATOR_TYPED_KERNEL_EX(                                                      \
       GroupQueryAttention,                                                            \
@@ -102,8 +84,8 @@ GroupQueryAttention<T, U>::GroupQueryAttention(const OpKernelInfo& info)
   softcap_ = info.GetAttrOrDefault<float>("softcap", 0.0f);
   use_smooth_softmax_ = info.GetAttrOrDefault<int64_t>("smooth_softmax", 0) == 1;
 
-  k_quant_type_ = StringToKVQuantizationType(info.GetAttrOrDefault<std::string>("k_quant_type", "NONE"));
-  v_quant_type_ = StringToKVQuantizationType(info.GetAttrOrDefault<std::string>("v_quant_type", "NONE"));
+  k_quant_type_ = group_query_attention_helper::StringToKVQuantizationType(info.GetAttrOrDefault<std::string>("k_quant_type", "NONE"));
+  v_quant_type_ = group_query_attention_helper::StringToKVQuantizationType(info.GetAttrOrDefault<std::string>("v_quant_type", "NONE"));
   kv_cache_bit_width_ = static_cast<int>(info.GetAttrOrDefault<int64_t>("kv_cache_bit_width", 0));
 
   bool is_quantized = (k_quant_type_ != KVQuantizationType::NONE || v_quant_type_ != KVQuantizationType::NONE);
@@ -195,6 +177,13 @@ Status GroupQueryAttention<T, U>::ComputeInternal(OpKernelContext* context) cons
                            "attention_bias is not supported in GroupQueryAttention cuda kernel.");
   }
 
+#ifndef USE_INT4_KV_CACHE
+  if (kv_cache_bit_width_ == 4) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "kv_cache_bit_width must be 0 or 8. Got kv_cache_bit_width == ", kv_cache_bit_width_);
+  }
+#endif
+
   auto& device_prop = GetDeviceProp();
   GroupQueryAttentionParameters parameters;
 
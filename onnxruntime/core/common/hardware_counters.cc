@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/hardware_counters.h"
+
+#if defined(__linux__)
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace onnxruntime {
+namespace profiling {
+
+#if defined(__linux__)
+namespace {
+
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    const std::array<std::pair<uint32_t, uint64_t>, kNumCounters> events{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    }};
+
+    for (size_t i = 0; i < kNumCounters; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = events[i].first;
+      attr.config = events[i].second;
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // The leader starts disabled so that the whole group is enabled at once.
+      attr.disabled = group_fd_ == -1 ? 1 : 0;
+
+      const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /*calling thread*/, -1 /*any cpu*/,
+                                              group_fd_, 0));
+      if (fd == -1) {
+        // Without cycles there is no group, the other counters are optional.
+        if (group_fd_ == -1) {
+          return;
+        }
+        continue;
+      }
+
+      if (group_fd_ == -1) {
+        group_fd_ = fd;
+      }
+      fds_[i] = fd;
+      // The group read returns the values of the members in the order they were opened.
+      slots_[i] = num_opened_++;
+    }
+
+    ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~ThreadCounters() {
+    for (int fd : fds_) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+  }
+
+  bool Read(HardwareCounterValues& values) const {
+    if (group_fd_ == -1) {
+      return false;
+    }
+
+    // PERF_FORMAT_GROUP: the number of counters followed by their values.
+    std::array<uint64_t, kNumCounters + 1> buffer{};
+    const auto bytes = read(group_fd_, buffer.data(), sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(sizeof(uint64_t) * (num_opened_ + 1))) {
+      return false;
+    }
+
+    auto value = [&](size_t i) -> uint64_t { return fds_[i] == -1 ? 0 : buffer[1 + slots_[i]]; };
+    values.cycles = value(0);
+    values.instructions = value(1);
+    values.llc_misses = value(2);
+    values.branch_misses = value(3);
+    return true;
+  }
+
+ private:
+  static constexpr size_t kNumCounters = 4;
+  int group_fd_{-1};
+  std::array<int, kNumCounters> fds_{-1, -1, -1, -1};
+  std::array<size_t, kNumCounters> slots_{};
+  size_t num_opened_{0};
+};
+
+}  // namespace
+
+bool HardwareCounters::Read(HardwareCounterValues& values) {
+  thread_local ThreadCounters counters;
+  return counters.Read(values);
+}
+
+#else
+
+bool HardwareCounters::Read(HardwareCounterValues& /*values*/) {
+  return false;
+}
+
+#endif
+
+}  // namespace profiling
+}  // namespace onnxruntime
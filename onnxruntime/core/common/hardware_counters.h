@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+
+namespace onnxruntime {
+namespace profiling {
+
+// Hardware performance counters of a thread.
+struct HardwareCounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t llc_misses = 0;
+  uint64_t branch_misses = 0;
+
+  HardwareCounterValues& operator+=(const HardwareCounterValues& other) {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    llc_misses += other.llc_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+  }
+
+  friend HardwareCounterValues operator-(const HardwareCounterValues& end, const HardwareCounterValues& begin) {
+    return {end.cycles - begin.cycles, end.instructions - begin.instructions,
+            end.llc_misses - begin.llc_misses, end.branch_misses - begin.branch_misses};
+  }
+};
+
+// Size of the cache line a last level cache miss is assumed to move from memory.
+constexpr uint64_t kHardwareCounterCacheLineSize = 64;
+
+/**
+ * Reads the cycles, instructions, last level cache misses and branch misses of the calling thread.
+ *
+ * On Linux the counters are opened with perf_event_open, as one group, the first time a thread reads them,
+ * and are closed when the thread exits. Only user space is counted, so this works with the default
+ * perf_event_paranoid setting. Counters the CPU or the hypervisor do not expose read as 0.
+ */
+class HardwareCounters {
+ public:
+  // Returns false if the counters are not available on the calling thread, e.g. on other platforms
+  // or in containers where perf events are not allowed.
+  static bool Read(HardwareCounterValues& values);
+};
+
+}  // namespace profiling
+}  // namespace onnxruntime
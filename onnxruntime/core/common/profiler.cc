@@ -3,6 +3,9 @@
 
 #include "profiler.h"
 
+#include <iomanip>
+#include <sstream>
+
 namespace onnxruntime {
 namespace profiling {
 using namespace std::chrono;
@@ -103,10 +106,98 @@ void Profiler::EndTimeAndRecordEvent(
   }
 }
 
+void Profiler::RecordHardwareCounters(const std::string& op_type,
+                                      const HardwareCounterValues& values,
+                                      size_t tensor_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& summary = hardware_counter_summary_[op_type];
+  ++summary.calls;
+  summary.tensor_bytes += tensor_bytes;
+  summary.values += values;
+}
+
+namespace {
+std::string FormatRatio(double numerator, double denominator) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(2) << (denominator > 0 ? numerator / denominator : 0.0);
+  return ss.str();
+}
+}  // namespace
+
+void Profiler::AddHardwareCounterSummary() {
+  Events summary_events;
+  std::ostringstream table;
+  // The counters of a kernel are read on the thread that runs it, the intra-op thread pool workers are not counted.
+  table << "Hardware counters per op type (calling thread only, intra-op thread pool workers excluded):\n"
+        << std::left << std::setw(32) << "op_type" << std::right
+        << std::setw(10) << "calls" << std::setw(16) << "cycles" << std::setw(16) << "instructions"
+        << std::setw(8) << "ipc" << std::setw(14) << "llc_misses" << std::setw(8) << "mpki"
+        << std::setw(14) << "branch_misses" << std::setw(16) << "llc_miss_bytes" << std::setw(16) << "tensor_bytes";
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (hardware_counter_summary_.empty()) {
+      return;
+    }
+
+    long long ts = TimeDiffMicroSeconds(profiling_start_time_);
+    for (const auto& [op_type, summary] : hardware_counter_summary_) {
+      const auto& values = summary.values;
+      const auto ipc = FormatRatio(static_cast<double>(values.instructions), static_cast<double>(values.cycles));
+      // Last level cache misses per thousand instructions, high with a low ipc means memory bound.
+      const auto mpki = FormatRatio(1000.0 * static_cast<double>(values.llc_misses),
+                                    static_cast<double>(values.instructions));
+      const uint64_t llc_miss_bytes = values.llc_misses * kHardwareCounterCacheLineSize;
+
+      table << "\n"
+            << std::left << std::setw(32) << op_type << std::right
+            << std::setw(10) << summary.calls << std::setw(16) << values.cycles
+            << std::setw(16) << values.instructions << std::setw(8) << ipc
+            << std::setw(14) << values.llc_misses << std::setw(8) << mpki
+            << std::setw(14) << values.branch_misses << std::setw(16) << llc_miss_bytes
+            << std::setw(16) << summary.tensor_bytes;
+
+      InlinedHashMap<std::string, std::string> event_args = {
+          {"op_name", op_type},
+          {"calls", std::to_string(summary.calls)},
+          {"cycles", std::to_string(values.cycles)},
+          {"instructions", std::to_string(values.instructions)},
+          {"ipc", ipc},
+          {"llc_misses", std::to_string(values.llc_misses)},
+          {"mpki", mpki},
+          {"branch_misses", std::to_string(values.branch_misses)},
+          {"llc_miss_bytes", std::to_string(llc_miss_bytes)},
+          {"tensor_bytes", std::to_string(summary.tensor_bytes)},
+          {"counted_threads", "calling thread only"},
+      };
+      summary_events.emplace_back(SESSION_EVENT, logging::GetProcessId(), logging::GetThreadId(),
+                                  op_type + "_hardware_counters", ts, 0, std::move(event_args));
+    }
+    hardware_counter_summary_.clear();
+
+    if (!profile_with_logger_) {
+      for (auto& event : summary_events) {
+        events_.emplace_back(std::move(event));
+      }
+    }
+  }
+
+  if (profile_with_logger_) {
+    for (auto& event : summary_events) {
+      custom_logger_->SendProfileEvent(event);
+    }
+  }
+
+  if (session_logger_) {
+    LOGS(*session_logger_, INFO) << table.str();
+  }
+}
+
 std::string Profiler::EndProfiling() {
   if (!enabled_) {
     return std::string();
   }
+  AddHardwareCounterSummary();
   if (profile_with_logger_) {
     profile_with_logger_ = false;
     return std::string();
@@ -9,8 +9,12 @@
 #include <iostream>
 #include <tuple>
 
+#include "core/common/hardware_counters.h"
 #include "core/common/profiler_common.h"
 #include "core/common/logging/logging.h"
+#include "core/common/sampling_profiler.h"
+#include <map>
+#include <memory>
 #include <mutex>
 
 namespace onnxruntime {
@@ -80,6 +84,41 @@ class Profiler {
                              InlinedHashMap<std::string, std::string> event_args = {},
                              bool sync_gpu = false);
 
+  /*
+  Collect hardware performance counters around every kernel, see HardwareCounters.
+  Set before profiling starts. Has no effect where the counters are not available.
+  */
+  void EnableHardwareCounters(bool enable) {
+    hardware_counters_enabled_ = enable;
+  }
+
+  bool HardwareCountersEnabled() const {
+    return hardware_counters_enabled_;
+  }
+
+  /*
+  Accumulate the counters of a kernel into the per op type summary written by EndProfiling.
+  tensor_bytes is the size of the inputs and outputs of the kernel.
+  */
+  void RecordHardwareCounters(const std::string& op_type,
+                              const HardwareCounterValues& values,
+                              size_t tensor_bytes);
+
+  /*
+  Measure the latency of every node in a sample of the runs, independently of whether profiling is enabled.
+  See SamplingProfiler. Set after the graph is finalized and before the first run.
+  */
+  void EnableSampling(size_t num_nodes, uint32_t sampling_rate, uint32_t sampling_interval_ms) {
+    sampling_profiler_ = std::make_unique<SamplingProfiler>(num_nodes, sampling_rate, sampling_interval_ms);
+  }
+
+  /*
+  nullptr if sampling is not enabled.
+  */
+  SamplingProfiler* GetSamplingProfiler() const {
+    return sampling_profiler_.get();
+  }
+
   /*
   Write profile data to the given stream in chrome format defined below.
   https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview#
@@ -122,6 +161,15 @@ class Profiler {
  private:
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Profiler);
 
+  struct HardwareCounterSummary {
+    uint64_t calls = 0;
+    uint64_t tensor_bytes = 0;
+    HardwareCounterValues values;
+  };
+
+  // Adds one event per op type with the summed counters, and logs them as a table.
+  void AddHardwareCounterSummary();
+
   /**
    * The maximum number of profiler records to collect.
    * This value is used to initialize the per-profiler maximum.
@@ -156,6 +204,12 @@ class Profiler {
 #endif
 
   std::vector<std::unique_ptr<EpProfiler>> ep_profilers_;
+
+  bool hardware_counters_enabled_{false};
+  // Ordered so that the summary is stable.
+  std::map<std::string, HardwareCounterSummary> hardware_counter_summary_;
+
+  std::unique_ptr<SamplingProfiler> sampling_profiler_;
 };
 
 }  // namespace profiling
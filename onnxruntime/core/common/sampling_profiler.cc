@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/sampling_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace onnxruntime {
+namespace profiling {
+
+size_t LatencyHistogram::BucketIndex(uint64_t value_ns) {
+  if (value_ns < kSubBuckets) {
+    return static_cast<size_t>(value_ns);
+  }
+  if (value_ns >> kMaxValueBits) {
+    return kNumBuckets - 1;
+  }
+
+  uint32_t msb = 0;
+  for (uint64_t v = value_ns; v > 1; v >>= 1) {
+    ++msb;
+  }
+  // The kSubBucketBits bits below the most significant one select the bucket within its power of two.
+  const uint32_t shift = msb - kSubBucketBits;
+  return static_cast<size_t>(shift) * kSubBuckets + static_cast<size_t>(value_ns >> shift);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const size_t shift = index / kSubBuckets - 1;
+  const uint64_t mantissa = index % kSubBuckets + kSubBuckets;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (const auto& bucket : counts_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+  // Take a snapshot so that concurrent recording does not move the target rank.
+  std::array<uint64_t, kNumBuckets> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = counts_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * total)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(kNumBuckets - 1);
+}
+
+SamplingProfiler::SamplingProfiler(size_t num_nodes, uint32_t sampling_rate, uint32_t sampling_interval_ms)
+    : sampling_rate_(sampling_rate),
+      sampling_interval_(std::chrono::milliseconds(sampling_interval_ms)),
+      // Seeded one interval back so the first run is sampled whatever the epoch of the steady clock is.
+      last_sample_time_((std::chrono::steady_clock::now() - sampling_interval_).time_since_epoch().count()),
+      histograms_(num_nodes) {
+}
+
+bool SamplingProfiler::ShouldSample() {
+  bool sample = sampling_rate_ > 0 && num_runs_.fetch_add(1, std::memory_order_relaxed) % sampling_rate_ == 0;
+
+  if (sampling_interval_.count() > 0) {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto last = last_sample_time_.load(std::memory_order_relaxed);
+    if (sample) {
+      last_sample_time_.store(now, std::memory_order_relaxed);
+    } else if (now - last >= sampling_interval_.count()) {
+      // Only one of the runs starting at the same time wins the interval.
+      sample = last_sample_time_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+    }
+  }
+
+  if (sample) {
+    num_sampled_runs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return sample;
+}
+
+}  // namespace profiling
+}  // namespace onnxruntime
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace onnxruntime {
+namespace profiling {
+
+/**
+ * Histogram of latencies in nanoseconds with log-linear buckets, in the style of HdrHistogram.
+ *
+ * Every power of two is split into kSubBuckets buckets, so a recorded value is known within 1/kSubBuckets
+ * of its magnitude. Recording is a relaxed atomic increment, so any number of threads can record into the
+ * same histogram without a lock. Values above 2^kMaxValueBits ns (about 18 minutes) go to the last bucket.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr uint32_t kSubBucketBits = 3;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+  static constexpr uint32_t kMaxValueBits = 40;
+  static constexpr size_t kNumBuckets = (kMaxValueBits - kSubBucketBits) * kSubBuckets + kSubBuckets;
+
+  void Record(uint64_t value_ns) {
+    counts_[BucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t Count() const;
+
+  // Returns the highest value of the bucket holding the given percentile, in [0, 100], of the recorded values.
+  // Returns 0 if nothing was recorded.
+  uint64_t Percentile(double percentile) const;
+
+  static size_t BucketIndex(uint64_t value_ns);
+  static uint64_t BucketUpperBound(size_t index);
+
+ private:
+  std::array<std::atomic<uint64_t>, kNumBuckets> counts_{};
+};
+
+/**
+ * Always-on, low-overhead profiler that measures the latency of every node in a sample of the Run calls.
+ *
+ * A run is sampled when it is the Nth run since the last one sampled by rate, or when at least the given
+ * interval passed since the last sampled run. Sampled runs record the wall time of each kernel into the
+ * histogram of its node, unsampled runs only pay for ShouldSample.
+ */
+class SamplingProfiler {
+ public:
+  // num_nodes is the number of node indices of the graph, see Graph::MaxNodeIndex.
+  // A sampling_rate or sampling_interval_ms of 0 disables that condition.
+  SamplingProfiler(size_t num_nodes, uint32_t sampling_rate, uint32_t sampling_interval_ms);
+
+  // Decides whether the run starting now is sampled. Thread safe.
+  bool ShouldSample();
+
+  void RecordNodeLatency(size_t node_index, uint64_t latency_ns) {
+    if (node_index < histograms_.size()) {
+      histograms_[node_index].Record(latency_ns);
+    }
+  }
+
+  // nullptr if node_index is out of range.
+  const LatencyHistogram* GetNodeHistogram(size_t node_index) const {
+    return node_index < histograms_.size() ? &histograms_[node_index] : nullptr;
+  }
+
+  uint64_t NumSampledRuns() const {
+    return num_sampled_runs_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const uint32_t sampling_rate_;
+  const std::chrono::steady_clock::duration sampling_interval_;
+
+  std::atomic<uint64_t> num_runs_{0};
+  std::atomic<uint64_t> num_sampled_runs_{0};
+  std::atomic<std::chrono::steady_clock::rep> last_sample_time_;
+
+  std::vector<LatencyHistogram> histograms_;
+};
+
+}  // namespace profiling
+}  // namespace onnxruntime
@@ -13,11 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <chrono>
 #include <memory>
 #include <optional>
 
 #include "core/platform/threadpool.h"
 #include "core/common/common.h"
+#include "core/common/sampling_profiler.h"
 #include "core/common/cpuid_info.h"
 #include "core/common/eigen_common_wrapper.h"
 #include "core/platform/EigenNonBlockingThreadPool.h"
@@ -366,6 +368,149 @@ class alignas(CACHE_LINE_BYTES) LoopCounter {
   const unsigned _num_shards;
 };
 
+// Priority scheduling
+// -------------------
+//
+// The scheduler counts, for each priority class, the workers a class's
+// running loops asked for and the workers currently helping them.  The
+// share of a class is its weight's fraction of the workers, among the
+// classes that asked for workers.  A helper checks before claiming each
+// block of iterations whether its class holds more than its share while
+// another class holds less than it needs; if so it leaves the loop, and
+// the worker goes back to its queue where the other class's tasks wait.
+// The thread that entered the loop never leaves, so all the iterations
+// run.  The counters are only read by helpers between blocks, the loop
+// entry and exit cost two atomic updates and reading the clock.
+
+namespace {
+thread_local ThreadPool::PriorityClass current_priority_class = ThreadPool::PriorityClass::kNormal;
+}  // namespace
+
+class ThreadPool::PriorityScheduler {
+ public:
+  PriorityScheduler(const std::vector<int>& weights, int num_workers) : num_workers_(num_workers) {
+    ORT_ENFORCE(weights.size() == kNumPriorityClasses, "Expected ", kNumPriorityClasses,
+                " priority class weights, got ", weights.size());
+    int total_weight = 0;
+    for (size_t i = 0; i < kNumPriorityClasses; ++i) {
+      ORT_ENFORCE(weights[i] >= 0, "Priority class weights must not be negative");
+      weights_[i] = weights[i];
+      total_weight += weights[i];
+    }
+    ORT_ENFORCE(total_weight > 0, "At least one priority class weight must be positive");
+  }
+
+  class Helper;
+
+  // A parallel loop entered by the calling thread, asking for num_work_items - 1 workers.
+  class Loop {
+   public:
+    Loop(PriorityScheduler& scheduler, unsigned num_work_items)
+        : scheduler_(scheduler),
+          class_index_(static_cast<size_t>(current_priority_class)),
+          num_helpers_(static_cast<int>(num_work_items) - 1),
+          start_(std::chrono::steady_clock::now()) {
+      scheduler_.classes_[class_index_].wanted_helpers.fetch_add(num_helpers_, std::memory_order_relaxed);
+    }
+
+    ~Loop() {
+      scheduler_.classes_[class_index_].wanted_helpers.fetch_sub(num_helpers_, std::memory_order_relaxed);
+    }
+
+   private:
+    friend class Helper;
+    PriorityScheduler& scheduler_;
+    const size_t class_index_;
+    const int num_helpers_;
+    const std::chrono::steady_clock::time_point start_;
+    std::atomic<bool> joined_{false};
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Loop);
+  };
+
+  // A work item of a loop.  Only the work items run by workers, idx != 0, are helpers.
+  class Helper {
+   public:
+    Helper(Loop* loop, unsigned idx) : loop_(idx != 0 ? loop : nullptr) {
+      if (loop_) {
+        auto& scheduler = loop_->scheduler_;
+        scheduler.classes_[loop_->class_index_].helpers.fetch_add(1, std::memory_order_relaxed);
+        if (!loop_->joined_.exchange(true, std::memory_order_relaxed)) {
+          const auto delay = std::chrono::steady_clock::now() - loop_->start_;
+          scheduler.queueing_delays_[loop_->class_index_].Record(
+              static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count()));
+        }
+      }
+    }
+
+    ~Helper() {
+      if (loop_) {
+        loop_->scheduler_.classes_[loop_->class_index_].helpers.fetch_sub(1, std::memory_order_relaxed);
+        if (left_) {
+          ThreadPoolTempl<Env>::LeaveParallelSection();
+        }
+      }
+    }
+
+    // Whether to claim another block of iterations.
+    bool ShouldContinue() {
+      if (loop_ && !left_ && loop_->scheduler_.ShouldYield(loop_->class_index_)) {
+        left_ = true;
+      }
+      return !left_;
+    }
+
+   private:
+    Loop* const loop_;
+    bool left_{false};
+    ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(Helper);
+  };
+
+  const profiling::LatencyHistogram& GetQueueingDelayHistogram(PriorityClass priority_class) const {
+    return queueing_delays_[static_cast<size_t>(priority_class)];
+  }
+
+ private:
+  // Whether a helper of a loop of class self should leave it for the loops of another class.
+  bool ShouldYield(size_t self) const {
+    int wanted[kNumPriorityClasses];
+    int helpers[kNumPriorityClasses];
+    int total_weight = 0;
+    for (size_t i = 0; i < kNumPriorityClasses; ++i) {
+      wanted[i] = classes_[i].wanted_helpers.load(std::memory_order_relaxed);
+      helpers[i] = classes_[i].helpers.load(std::memory_order_relaxed);
+      if (wanted[i] > 0) {
+        total_weight += weights_[i];
+      }
+    }
+
+    auto share = [&](size_t i) {
+      // Rounded up, so that the shares never leave a worker idle.  When only
+      // classes of weight 0 run, they share the workers evenly.
+      return total_weight == 0 ? num_workers_
+                               : (num_workers_ * weights_[i] + total_weight - 1) / total_weight;
+    };
+    if (helpers[self] <= share(self)) {
+      return false;
+    }
+    for (size_t i = 0; i < kNumPriorityClasses; ++i) {
+      if (i != self && wanted[i] > 0 && helpers[i] < std::min(wanted[i], share(i))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  struct alignas(CACHE_LINE_BYTES) ClassState {
+    std::atomic<int> wanted_helpers{0};
+    std::atomic<int> helpers{0};
+  };
+
+  const int num_workers_;
+  int weights_[kNumPriorityClasses];
+  ClassState classes_[kNumPriorityClasses];
+  profiling::LatencyHistogram queueing_delays_[kNumPriorityClasses];
+};
+
 #ifdef _MSC_VER
 #pragma warning(pop) /* Padding added in LoopCounterShard, LoopCounter */
 #endif
@@ -397,11 +542,31 @@ ThreadPool::ThreadPool(Env* env,
                                                 *env,
                                                 thread_options_);
     underlying_threadpool_ = extended_eigen_threadpool_.get();
+    if (!thread_options_.priority_class_weights.empty()) {
+      priority_scheduler_ = std::make_unique<PriorityScheduler>(thread_options_.priority_class_weights,
+                                                                threads_to_create);
+    }
   }
 }
 
 ThreadPool::~ThreadPool() = default;
 
+ThreadPool::PriorityScope::PriorityScope(PriorityClass priority_class) : previous_(current_priority_class) {
+  current_priority_class = priority_class;
+}
+
+ThreadPool::PriorityScope::~PriorityScope() {
+  current_priority_class = previous_;
+}
+
+const profiling::LatencyHistogram* ThreadPool::GetQueueingDelayHistogram(const ThreadPool* tp,
+                                                                         PriorityClass priority_class) {
+  if (tp == nullptr || tp->priority_scheduler_ == nullptr) {
+    return nullptr;
+  }
+  return &tp->priority_scheduler_->GetQueueingDelayHistogram(priority_class);
+}
+
 // Base case for parallel loops, running iterations 0..total, divided into blocks
 // of block_size iterations, and calling into a function that takes a start..end
 // range of indices to run.
@@ -426,11 +591,17 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     assert(num_work_items > 0);
 
     LoopCounter lc(total, d_of_p, block_size);
+    std::optional<PriorityScheduler::Loop> priority_loop;
+    if (priority_scheduler_) {
+      priority_loop.emplace(*priority_scheduler_, num_work_items);
+    }
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
+      PriorityScheduler::Helper helper(priority_loop ? &*priority_loop : nullptr, idx);
       unsigned my_home_shard = lc.GetHomeShard(idx);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
-      while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
+      while (helper.ShouldContinue() &&
+             lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, block_size)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
       }
@@ -444,12 +615,18 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     std::ptrdiff_t base_block_size = static_cast<std::ptrdiff_t>(std::max(1LL, std::llroundl(static_cast<long double>(total) / num_of_blocks)));
     alignas(CACHE_LINE_BYTES) std::atomic<std::ptrdiff_t> left{total};
     LoopCounter lc(total, d_of_p, base_block_size);
+    const int num_work_items = std::min(NumThreads() + 1, num_of_blocks);
+    std::optional<PriorityScheduler::Loop> priority_loop;
+    if (priority_scheduler_) {
+      priority_loop.emplace(*priority_scheduler_, num_work_items);
+    }
     std::function<void(unsigned)> run_work = [&](unsigned idx) {
+      PriorityScheduler::Helper helper(priority_loop ? &*priority_loop : nullptr, idx);
       std::ptrdiff_t b = base_block_size;
       unsigned my_home_shard = lc.GetHomeShard(idx);
       unsigned my_shard = my_home_shard;
       uint64_t my_iter_start, my_iter_end;
-      while (lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, b)) {
+      while (helper.ShouldContinue() && lc.ClaimIterations(my_home_shard, my_shard, my_iter_start, my_iter_end, b)) {
         fn(static_cast<std::ptrdiff_t>(my_iter_start),
            static_cast<std::ptrdiff_t>(my_iter_end));
         auto todo = left.fetch_sub(static_cast<std::ptrdiff_t>(my_iter_end - my_iter_start), std::memory_order_relaxed);
@@ -460,7 +637,7 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(const std::ptrdiff_t total,
     };
     // Distribute task among all threads in the pool, reduce number of work items if
     // num_of_blocks is smaller than number of threads.
-    RunInParallel(run_work, std::min(NumThreads() + 1, num_of_blocks), base_block_size);
+    RunInParallel(run_work, num_work_items, base_block_size);
   }
 }
 
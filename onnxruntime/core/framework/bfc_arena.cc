@@ -3,16 +3,155 @@
 
 #include "core/framework/allocator.h"
 #include "core/framework/bfc_arena.h"
+#include <algorithm>
+#include <atomic>
 #include <type_traits>
 
 namespace onnxruntime {
+
+struct BFCArena::Span {
+  void* begin;
+  void* end;
+  int cls;
+};
+
+// Maps the 1MB granules of the address space to the spans overlapping them.
+// Insert requires lock_, Find does not take any lock: entries are never removed and are published
+// with release stores. A span is at least as large as a granule so at most two spans overlap a granule.
+class BFCArena::SpanMap {
+ public:
+  SpanMap() : entries_(std::make_unique<Entry[]>(kCapacity)) {}
+
+  // Keeps the load factor under one half so that probing stays short.
+  // A span is smaller than two granules (the arena splits larger chunks) so it overlaps at most three.
+  bool HasRoom() const { return num_entries_ + 3 <= kCapacity / 2; }
+
+  void Insert(const Span* span) {
+    const uint64_t first = reinterpret_cast<uintptr_t>(span->begin) >> kGranuleBits;
+    const uint64_t last = (reinterpret_cast<uintptr_t>(span->end) - 1) >> kGranuleBits;
+    for (uint64_t granule = first; granule <= last; ++granule) {
+      Entry& entry = FindEntry(granule);
+      if (entry.key.load(std::memory_order_relaxed) == 0) {
+        entry.spans[0].store(span, std::memory_order_relaxed);
+        entry.key.store(granule + 1, std::memory_order_release);
+        ++num_entries_;
+      } else {
+        ORT_ENFORCE(entry.spans[1].load(std::memory_order_relaxed) == nullptr,
+                    "More than two spans overlap a granule.");
+        entry.spans[1].store(span, std::memory_order_release);
+      }
+    }
+  }
+
+  const Span* Find(const void* p) const {
+    const Entry& entry = FindEntry(reinterpret_cast<uintptr_t>(p) >> kGranuleBits);
+    if (entry.key.load(std::memory_order_acquire) == 0) {
+      return nullptr;
+    }
+    for (const auto& slot : entry.spans) {
+      const Span* span = slot.load(std::memory_order_acquire);
+      if (span != nullptr && span->begin <= p && p < span->end) {
+        return span;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  static constexpr size_t kGranuleBits = 20;
+  static constexpr size_t kCapacityBits = 15;
+  static constexpr size_t kCapacity = size_t{1} << kCapacityBits;
+  static_assert((size_t{1} << kGranuleBits) <= kThreadCacheSpanSize);
+
+  struct Entry {
+    std::atomic<uint64_t> key{0};  // granule + 1, 0 when empty
+    std::atomic<const Span*> spans[2] = {nullptr, nullptr};
+  };
+
+  // Returns the entry of the granule or the empty entry where it would be inserted.
+  Entry& FindEntry(uint64_t granule) const {
+    size_t index = static_cast<size_t>((granule * 0x9E3779B97F4A7C15ull) >> (64 - kCapacityBits));
+    for (;;) {
+      Entry& entry = entries_[index];
+      const uint64_t key = entry.key.load(std::memory_order_acquire);
+      if (key == 0 || key == granule + 1) {
+        return entry;
+      }
+      index = (index + 1) & (kCapacity - 1);
+    }
+  }
+
+  std::unique_ptr<Entry[]> entries_;
+  size_t num_entries_ = 0;
+};
+
+// Shared by an arena and the thread caches it created, it outlives the arena.
+struct BFCArena::ThreadCacheRegistry {
+  std::mutex mutex;
+  BFCArena* arena = nullptr;  // null once the arena is destroyed
+  std::atomic<bool> alive{true};
+  std::vector<ThreadCache*> caches;
+  // Counters of the caches of the threads which exited.
+  int64_t retired_hits = 0;
+  int64_t retired_misses = 0;
+};
+
+// Per thread, per arena stacks of free blocks, one per class.
+// Only the owning thread touches the stacks, the counters are read by GetStats.
+struct BFCArena::ThreadCache {
+  static constexpr size_t kMaxBlocks = 64;
+
+  struct Magazine {
+    void* blocks[kMaxBlocks];
+    size_t count = 0;
+    size_t capacity = 0;
+    // Number of blocks moved at once from or to the central list.
+    size_t batch = 0;
+  };
+
+  ThreadCache(std::shared_ptr<ThreadCacheRegistry> registry_in, int64_t thread_cache_bytes)
+      : registry(std::move(registry_in)) {
+    for (int cls = 0; cls < kNumThreadCacheClasses; ++cls) {
+      const int64_t blocks = thread_cache_bytes / kNumThreadCacheClasses /
+                             static_cast<int64_t>(ThreadCacheBlockSize(cls));
+      magazines[cls].capacity = static_cast<size_t>(std::clamp<int64_t>(blocks, 0, kMaxBlocks));
+      magazines[cls].batch = std::max<size_t>(magazines[cls].capacity / 2, 1);
+    }
+  }
+
+  // Gives the blocks back when the thread exits.
+  ~ThreadCache() {
+    std::lock_guard<std::mutex> guard(registry->mutex);
+    if (registry->arena != nullptr) {
+      for (int cls = 0; cls < kNumThreadCacheClasses; ++cls) {
+        registry->arena->ReturnToCentral(cls, magazines[cls].blocks, magazines[cls].count);
+      }
+      auto& caches = registry->caches;
+      caches.erase(std::remove(caches.begin(), caches.end(), this), caches.end());
+      registry->retired_hits += hits.load(std::memory_order_relaxed);
+      registry->retired_misses += misses.load(std::memory_order_relaxed);
+    }
+  }
+
+  static void Increment(std::atomic<int64_t>& counter, int64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  std::shared_ptr<ThreadCacheRegistry> registry;
+  std::array<Magazine, kNumThreadCacheClasses> magazines;
+  std::atomic<int64_t> hits{0};
+  std::atomic<int64_t> misses{0};
+  std::atomic<int64_t> cached_bytes{0};
+};
+
 BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
                    size_t total_memory,
                    ArenaExtendStrategy arena_extend_strategy,
                    int initial_chunk_size_bytes,
                    int max_dead_bytes_per_chunk,
                    int initial_growth_chunk_size_bytes,
-                   int64_t max_power_of_two_extend_bytes)
+                   int64_t max_power_of_two_extend_bytes,
+                   int64_t thread_cache_bytes)
     : IArena(OrtMemoryInfo(resource_allocator->Info().name.c_str(),
                            OrtAllocatorType::OrtArenaAllocator,
                            resource_allocator->Info().device,
@@ -23,14 +162,16 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       initial_chunk_size_bytes_(initial_chunk_size_bytes),
       max_dead_bytes_per_chunk_(max_dead_bytes_per_chunk),
       initial_growth_chunk_size_bytes_(initial_growth_chunk_size_bytes),
-      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes) {
+      max_power_of_two_extend_bytes_(max_power_of_two_extend_bytes),
+      thread_cache_bytes_(thread_cache_bytes) {
   LOGS_DEFAULT(INFO) << "Creating BFCArena for " << device_allocator_->Info().name
                      << " with following configs: initial_chunk_size_bytes: " << initial_chunk_size_bytes_
                      << " max_dead_bytes_per_chunk: " << max_dead_bytes_per_chunk_
                      << " initial_growth_chunk_size_bytes: " << initial_growth_chunk_size_bytes_
                      << " max_power_of_two_extend_bytes: " << max_power_of_two_extend_bytes_
                      << " memory limit: " << total_memory
-                     << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy);
+                     << " arena_extend_strategy: " << static_cast<int32_t>(arena_extend_strategy)
+                     << " thread_cache_bytes: " << thread_cache_bytes_;
 
   // static_cast<std::underlying_type_t<ArenaExtendStrategy>>(arena_extend_strategy); doesn't work on this compiler
 
@@ -73,9 +214,23 @@ BFCArena::BFCArena(std::unique_ptr<IAllocator> resource_allocator,
       ORT_ENFORCE(BinForSize(bin_size * 2) != BinFromIndex(b));
     }
   }
+
+  if (thread_cache_bytes_ > 0) {
+    thread_cache_registry_ = std::make_shared<ThreadCacheRegistry>();
+    thread_cache_registry_->arena = this;
+    span_map_ = std::make_unique<SpanMap>();
+  }
 }
 
 BFCArena::~BFCArena() {
+  if (thread_cache_registry_ != nullptr) {
+    // The blocks still held by other threads die with the regions.
+    std::lock_guard<std::mutex> guard(thread_cache_registry_->mutex);
+    thread_cache_registry_->arena = nullptr;
+    thread_cache_registry_->alive.store(false, std::memory_order_relaxed);
+    thread_cache_registry_->caches.clear();
+  }
+
   for (const auto& region : region_manager_.regions()) {
     device_allocator_->Free(region.ptr());
   }
@@ -268,6 +423,11 @@ size_t BFCArena::RoundedBytes(size_t bytes) {
 }
 
 void* BFCArena::Alloc(size_t size) {
+  if (thread_cache_registry_ != nullptr && size != 0 && size <= kThreadCacheMaxBlockSize) {
+    if (void* p = ThreadCacheAlloc(size)) {
+      return p;
+    }
+  }
   return AllocateRawInternal(size, false, nullptr);
 }
 
@@ -292,6 +452,12 @@ void* BFCArena::Reserve(size_t size) {
 }
 
 size_t BFCArena::RequestedSize(const void* ptr) {
+  if (span_map_ != nullptr) {
+    // Blocks do not record the requested size.
+    if (const Span* span = span_map_->Find(ptr)) {
+      return ThreadCacheBlockSize(span->cls);
+    }
+  }
   std::lock_guard<std::mutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
@@ -300,6 +466,11 @@ size_t BFCArena::RequestedSize(const void* ptr) {
 }
 
 size_t BFCArena::AllocatedSize(const void* ptr) {
+  if (span_map_ != nullptr) {
+    if (const Span* span = span_map_->Find(ptr)) {
+      return ThreadCacheBlockSize(span->cls);
+    }
+  }
   std::lock_guard<std::mutex> lock(lock_);
   BFCArena::ChunkHandle h = region_manager_.get_handle(ptr);
   ORT_ENFORCE(h != kInvalidChunkHandle);
@@ -359,8 +530,166 @@ void* BFCArena::AllocateRawInternal(size_t num_bytes,
 }
 
 void BFCArena::GetStats(AllocatorStats* stats) {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t cached_bytes = 0;
+  if (thread_cache_registry_ != nullptr) {
+    std::lock_guard<std::mutex> guard(thread_cache_registry_->mutex);
+    hits = thread_cache_registry_->retired_hits;
+    misses = thread_cache_registry_->retired_misses;
+    for (const ThreadCache* cache : thread_cache_registry_->caches) {
+      hits += cache->hits.load(std::memory_order_relaxed);
+      misses += cache->misses.load(std::memory_order_relaxed);
+      cached_bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+    }
+  }
+
   std::lock_guard<std::mutex> lock(lock_);
   *stats = stats_;
+  if (thread_cache_registry_ != nullptr) {
+    // The spans are in use from the point of view of the bins, their free blocks are not.
+    cached_bytes += central_block_bytes_;
+    stats->num_allocs += hits + misses;
+    stats->bytes_in_use -= cached_bytes + span_tail_bytes_;
+    stats->num_thread_cache_hits = hits;
+    stats->num_thread_cache_misses = misses;
+    stats->thread_cache_bytes = cached_bytes;
+  }
+}
+
+int BFCArena::ThreadCacheClassForSize(size_t bytes) {
+  return bytes <= kMinAllocationSize ? 0 : Log2FloorNonZero((bytes - 1) >> kMinAllocationBits) + 1;
+}
+
+BFCArena::ThreadCache* BFCArena::GetThreadCache() {
+  thread_local std::vector<std::unique_ptr<ThreadCache>> thread_caches;
+  for (const auto& cache : thread_caches) {
+    if (cache->registry == thread_cache_registry_) {
+      return cache.get();
+    }
+  }
+
+  // Drop the caches of the arenas destroyed since the last lookup.
+  thread_caches.erase(std::remove_if(thread_caches.begin(), thread_caches.end(),
+                                     [](const std::unique_ptr<ThreadCache>& cache) {
+                                       return !cache->registry->alive.load(std::memory_order_relaxed);
+                                     }),
+                      thread_caches.end());
+
+  auto cache = std::make_unique<ThreadCache>(thread_cache_registry_, thread_cache_bytes_);
+  {
+    std::lock_guard<std::mutex> guard(thread_cache_registry_->mutex);
+    thread_cache_registry_->caches.push_back(cache.get());
+  }
+  thread_caches.push_back(std::move(cache));
+  return thread_caches.back().get();
+}
+
+void* BFCArena::ThreadCacheAlloc(size_t num_bytes) {
+  const int cls = ThreadCacheClassForSize(num_bytes);
+  ThreadCache* cache = GetThreadCache();
+  auto& magazine = cache->magazines[cls];
+  if (magazine.count == 0) {
+    if (magazine.capacity == 0) {
+      return nullptr;
+    }
+    magazine.count = TakeFromCentral(cls, magazine.blocks, magazine.batch);
+    if (magazine.count == 0) {
+      return nullptr;
+    }
+    ThreadCache::Increment(cache->misses, 1);
+    ThreadCache::Increment(cache->cached_bytes,
+                           static_cast<int64_t>(magazine.count * ThreadCacheBlockSize(cls)));
+  } else {
+    ThreadCache::Increment(cache->hits, 1);
+  }
+  ThreadCache::Increment(cache->cached_bytes, -static_cast<int64_t>(ThreadCacheBlockSize(cls)));
+  return magazine.blocks[--magazine.count];
+}
+
+bool BFCArena::ThreadCacheFree(void* p) {
+  const Span* span = span_map_->Find(p);
+  if (span == nullptr) {
+    return false;
+  }
+
+  const int cls = span->cls;
+  ThreadCache* cache = GetThreadCache();
+  auto& magazine = cache->magazines[cls];
+  if (magazine.capacity == 0) {
+    ReturnToCentral(cls, &p, 1);
+    return true;
+  }
+  if (magazine.count == magazine.capacity) {
+    // Return the oldest blocks, the most recent ones are more likely to be in the cache.
+    ReturnToCentral(cls, magazine.blocks, magazine.batch);
+    std::copy(magazine.blocks + magazine.batch, magazine.blocks + magazine.count, magazine.blocks);
+    magazine.count -= magazine.batch;
+    ThreadCache::Increment(cache->cached_bytes,
+                           -static_cast<int64_t>(magazine.batch * ThreadCacheBlockSize(cls)));
+  }
+  magazine.blocks[magazine.count++] = p;
+  ThreadCache::Increment(cache->cached_bytes, static_cast<int64_t>(ThreadCacheBlockSize(cls)));
+  return true;
+}
+
+size_t BFCArena::TakeFromCentral(int cls, void** blocks, size_t count) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto& central = central_blocks_[cls];
+  if (central.empty() && !AddSpan(cls)) {
+    return 0;
+  }
+  const size_t n = std::min(count, central.size());
+  std::copy(central.end() - n, central.end(), blocks);
+  central.resize(central.size() - n);
+  central_block_bytes_ -= static_cast<int64_t>(n * ThreadCacheBlockSize(cls));
+  return n;
+}
+
+void BFCArena::ReturnToCentral(int cls, void* const* blocks, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  central_blocks_[cls].insert(central_blocks_[cls].end(), blocks, blocks + count);
+  central_block_bytes_ += static_cast<int64_t>(count * ThreadCacheBlockSize(cls));
+}
+
+bool BFCArena::AddSpan(int cls) {
+  if (!span_map_->HasRoom()) {
+    return false;
+  }
+
+  const BinNum bin_num = BinNumForSize(kThreadCacheSpanSize);
+  Chunk* chunk = FindChunkPtr(bin_num, kThreadCacheSpanSize, kThreadCacheSpanSize, nullptr);
+  if (chunk == nullptr) {
+    if (!Extend(kThreadCacheSpanSize).IsOK()) {
+      return false;
+    }
+    chunk = FindChunkPtr(bin_num, kThreadCacheSpanSize, kThreadCacheSpanSize, nullptr);
+    if (chunk == nullptr) {
+      return false;
+    }
+  }
+
+  // The chunk may be larger than requested, the span covers all of it.
+  auto span = std::make_unique<Span>();
+  span->begin = chunk->ptr;
+  span->end = static_cast<char*>(chunk->ptr) + chunk->size;
+  span->cls = cls;
+  span_map_->Insert(span.get());
+
+  // Lowest addresses at the back, they are handed out first.
+  const size_t block_size = ThreadCacheBlockSize(cls);
+  const size_t num_blocks = chunk->size / block_size;
+  auto& central = central_blocks_[cls];
+  for (size_t i = num_blocks; i > 0; --i) {
+    central.push_back(static_cast<char*>(span->begin) + (i - 1) * block_size);
+  }
+  central_block_bytes_ += static_cast<int64_t>(num_blocks * block_size);
+  span_tail_bytes_ += static_cast<int64_t>(chunk->size - num_blocks * block_size);
+  spans_.push_back(std::move(span));
+  return true;
 }
 
 BFCArena::Chunk* BFCArena::SplitFreeChunkFromBin(BFCArena::Bin::FreeChunkSet* free_chunks,
@@ -473,6 +802,9 @@ void BFCArena::Free(void* p) {
   if (p == nullptr) {
     return;
   }
+  if (span_map_ != nullptr && ThreadCacheFree(p)) {
+    return;
+  }
   std::lock_guard<std::mutex> lock(lock_);
   auto it = reserved_chunks_.find(p);
   if (it != reserved_chunks_.end()) {
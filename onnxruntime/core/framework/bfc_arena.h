@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <vector>
 
 #include "onnxruntime_config.h"
 
@@ -60,14 +61,18 @@ class BFCArena : public IArena {
   static const int DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES = 2 * 1024 * 1024;
   static const int64_t DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES = 1024 * 1024 * 1024;  // 1GB
   static const size_t DEFAULT_MAX_MEM = std::numeric_limits<size_t>::max();
+  static const int64_t DEFAULT_THREAD_CACHE_BYTES = 0;  // thread caches disabled
 
+  // thread_cache_bytes: upper bound of the free memory every thread may keep in its
+  // cache of small blocks, 0 disables the thread caches. See ThreadCache in bfc_arena.cc.
   BFCArena(std::unique_ptr<IAllocator> resource_allocator,
            size_t total_memory,
            ArenaExtendStrategy arena_extend_strategy = DEFAULT_ARENA_EXTEND_STRATEGY,
            int initial_chunk_size_bytes = DEFAULT_INITIAL_CHUNK_SIZE_BYTES,
            int max_dead_bytes_per_chunk = DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
            int initial_growth_chunk_size_bytes = DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES,
-           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES);
+           int64_t max_power_of_two_extend_bytes = DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+           int64_t thread_cache_bytes = DEFAULT_THREAD_CACHE_BYTES);
 
   ~BFCArena() override;
 
@@ -88,7 +93,7 @@ class BFCArena : public IArena {
   size_t AllocatedSize(const void* ptr);
 
   // Frees all allocation regions in which no chunk is in use.
-  // Does not free any reserved chunks.
+  // Does not free any reserved chunks, nor the spans carved into blocks for the thread caches.
   // Resets the size that the arena will grow by in the next allocation to
   // `initial_growth_chunk_size_bytes_` but ultimately all
   // future allocation sizes are determined by the arena growth strategy
@@ -109,6 +114,33 @@ class BFCArena : public IArena {
  private:
   void DeallocateRawInternal(void* ptr);
 
+  // Thread caches of small blocks, defined in bfc_arena.cc.
+  //
+  // Allocations of up to kThreadCacheMaxBlockSize bytes are rounded up to a power of two
+  // (a class) and served from a per-thread stack of free blocks without taking lock_.
+  // The blocks are carved from spans of at least kThreadCacheSpanSize bytes allocated from the arena
+  // and never go back to the bins. SpanMap finds the span, hence the class, of a freed block
+  // without taking lock_. Threads exchange blocks with the central per-class lists by batches.
+  struct Span;
+  class SpanMap;
+  struct ThreadCache;
+  struct ThreadCacheRegistry;
+  static const int kNumThreadCacheClasses = 9;  // 256 bytes to 64KB
+  static const size_t kThreadCacheMaxBlockSize = static_cast<size_t>(256) << (kNumThreadCacheClasses - 1);
+  static const size_t kThreadCacheSpanSize = 1 << 20;
+
+  int ThreadCacheClassForSize(size_t bytes);
+  static size_t ThreadCacheBlockSize(int cls) { return static_cast<size_t>(256) << cls; }
+  ThreadCache* GetThreadCache();
+  void* ThreadCacheAlloc(size_t num_bytes);
+  bool ThreadCacheFree(void* p);
+  // Moves up to `count` free blocks of class `cls` to `blocks`, carving a new span when the
+  // central list is empty. Returns the number of blocks moved.
+  size_t TakeFromCentral(int cls, void** blocks, size_t count);
+  void ReturnToCentral(int cls, void* const* blocks, size_t count);
+  // Requires lock_.
+  bool AddSpan(int cls);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   using ChunkHandle = size_t;
@@ -498,6 +530,17 @@ class BFCArena : public IArena {
   // is to be considered for shrinkage or not.
   bool consider_first_allocation_region_for_shrinkage_;
 
+  // Thread caches, all null when disabled.
+  const int64_t thread_cache_bytes_;
+  std::shared_ptr<ThreadCacheRegistry> thread_cache_registry_;
+  std::unique_ptr<SpanMap> span_map_;
+  // Guarded by lock_.
+  std::vector<std::unique_ptr<Span>> spans_;
+  std::array<std::vector<void*>, kNumThreadCacheClasses> central_blocks_;
+  int64_t central_block_bytes_ = 0;
+  // Bytes at the end of the spans which do not fit a block.
+  int64_t span_tail_bytes_ = 0;
+
   ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(BFCArena);
 };
 
@@ -17,6 +17,28 @@ TensorShapeVector StridesForTensor(const Tensor& tensor) {
   return strides;
 }
 
+TensorShapeVector BroadcastStridesForShape(const TensorShape& shape, const TensorShape& broadcast_shape) {
+  const size_t rank = shape.NumDimensions();
+  const size_t broadcast_rank = broadcast_shape.NumDimensions();
+  ORT_ENFORCE(rank <= broadcast_rank, "Cannot broadcast shape ", shape, " to ", broadcast_shape);
+
+  // leading dimensions missing from 'shape' are broadcast
+  TensorShapeVector strides(broadcast_rank, 0);
+  int64_t running_size = 1;
+  for (size_t i = rank; i > 0; i--) {
+    const int64_t dim = shape[i - 1];
+    const size_t broadcast_axis = broadcast_rank - rank + i - 1;
+    if (dim == broadcast_shape[broadcast_axis]) {
+      strides[broadcast_axis] = running_size;
+    } else {
+      ORT_ENFORCE(dim == 1, "Cannot broadcast shape ", shape, " to ", broadcast_shape);
+    }
+    running_size *= dim;
+  }
+
+  return strides;
+}
+
 namespace {
 /*
     Check if we can coalesce dim with dim + 1.
@@ -8,6 +8,9 @@
 #include "core/framework/tensor.h"
 #include "core/framework/op_kernel_type_control_utils.h"
 
+#include <algorithm>
+#include <array>
+#include <tuple>
 #include <vector>
 
 namespace onnxruntime {
@@ -17,6 +20,12 @@ void CoalesceDimensions(
 
 TensorShapeVector StridesForTensor(const Tensor& tensor);
 
+/*
+    Strides for reading a contiguous tensor of shape 'shape' as if it were broadcast to 'broadcast_shape'
+    (numpy rules). Broadcast dimensions get a stride of 0. The result has the rank of 'broadcast_shape'.
+*/
+TensorShapeVector BroadcastStridesForShape(const TensorShape& shape, const TensorShape& broadcast_shape);
+
 namespace strided_copy_detail {
 
 template <typename T>
@@ -45,6 +54,9 @@ void Copy1D(T* dst, int64_t dst_stride, const T* src, int64_t src_stride, std::p
   } else {
     if (dst_stride == 1 && src_stride == 1) {
       Copy1DContiguous(dst, src, count);
+    } else if (dst_stride == 1 && src_stride == 0) {
+      // broadcast of a single value along the innermost dimension
+      std::fill_n(dst, count, src[0]);
     } else {
       Copy1DNonContiguous(dst, dst_stride, src, src_stride, count);
     }
@@ -104,6 +116,72 @@ struct NdCounter {
 };
 }  // namespace strided_copy_detail
 
+/*
+    Visit the elements of 'shape' in N tensors addressed by 'strides' (in elements), split across the thread pool.
+
+    Dimensions that are contiguous in all the tensors are coalesced first. 'fn' is then called as
+    fn(offsets, inner_strides, count) for each run of 'count' elements along the innermost coalesced dimension,
+    where offsets[i] is the offset of the first element of the run in tensor i and inner_strides[i] the stride of
+    tensor i along the run. Runs of different calls never overlap, so 'fn' may write to any of the tensors.
+*/
+template <size_t N, typename TFunc>
+void StridedForEach(concurrency::ThreadPool* thread_pool,
+                    const TensorShape& shape_in,
+                    std::array<TensorShapeVector, N> strides,
+                    const TensorOpCost& cost_per_element,
+                    const TFunc& fn) {
+  const int64_t total_num_elements = shape_in.Size();
+  ORT_ENFORCE(total_num_elements >= 0, "shape must have non-negative size");
+  if (total_num_elements == 0) {
+    return;
+  }
+
+  TensorShapeVector shape = shape_in.AsShapeVector();
+  for (const auto& tensor_strides : strides) {
+    ORT_ENFORCE(tensor_strides.size() == shape.size(), "strides must have the rank of the shape");
+  }
+
+  if (shape.empty()) {
+    // treat a scalar as a single element 1D tensor
+    shape.push_back(1);
+    for (auto& tensor_strides : strides) {
+      tensor_strides.push_back(1);
+    }
+  }
+
+  std::apply([&shape](auto&... tensor_strides) { CoalesceDimensions({tensor_strides...}, shape); }, strides);
+
+  const std::size_t dims = shape.size();
+  std::array<std::ptrdiff_t, N> inner_strides;
+  for (size_t i = 0; i < N; i++) {
+    inner_strides[i] = static_cast<std::ptrdiff_t>(strides[i][dims - 1]);
+  }
+
+  const auto& const_shape = shape;
+  const auto& const_strides = strides;
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(total_num_elements), cost_per_element,
+      [&const_shape, &const_strides, &inner_strides, &fn, dims](std::ptrdiff_t first, std::ptrdiff_t last) {
+        strided_copy_detail::NdCounter counter(const_shape, first, last);
+
+        auto iter_size = counter.NextStepSize();
+        while (iter_size > 0) {
+          std::array<std::ptrdiff_t, N> offsets{};
+          for (std::size_t dim = 0; dim < dims; dim++) {
+            for (size_t i = 0; i < N; i++) {
+              offsets[i] += static_cast<std::ptrdiff_t>(counter.current_index[dim] * const_strides[i][dim]);
+            }
+          }
+
+          fn(offsets, inner_strides, iter_size);
+
+          counter.Step(iter_size);
+          iter_size = counter.NextStepSize();
+        }
+      });
+}
+
 template <typename T>
 void StridedCopy(concurrency::ThreadPool* thread_pool,
                  T* dst,
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/external_data_mapper.h"
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+
+namespace onnxruntime {
+
+Status ExternalDataMapper::GetData(const Env& env, const std::filesystem::path& file_path, FileOffsetType offset,
+                                   size_t length, IAllocatorUniquePtr<void>& data) {
+  std::shared_ptr<const MappedFile> file;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = files_[file_path.native()];
+    if (entry == nullptr) {
+      auto mapped_file = std::make_shared<MappedFile>();
+      mapped_file->length = narrow<size_t>(std::filesystem::file_size(file_path));
+      ORT_RETURN_IF_ERROR(env.MapFileIntoMemoryReadOnly(file_path.native().c_str(), 0, mapped_file->length,
+                                                        mapped_file->memory));
+      entry = std::move(mapped_file);
+    }
+    file = entry;
+  }
+
+  SafeInt<FileOffsetType> end(offset);
+  end += length;
+  ORT_RETURN_IF(offset < 0 || static_cast<size_t>(static_cast<FileOffsetType>(end)) > file->length,
+                "Range [", offset, ", ", static_cast<FileOffsetType>(end), ") is outside of ", file_path,
+                " of length ", file->length);
+
+  char* slice = file->memory.get() + offset;
+  data = IAllocatorUniquePtr<void>(slice, [file = std::move(file)](void*) {});
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
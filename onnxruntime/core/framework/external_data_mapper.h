@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "core/common/common.h"
+#include "core/framework/allocator.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+/// <summary>
+/// Maps every external data file once, in full, with Env::MapFileIntoMemoryReadOnly and hands out
+/// slices of the mapping for the initializers stored in it.
+///
+/// A slice keeps the whole file mapped until it is released, so the mapper itself can be dropped once
+/// the initializers are loaded. The slices are read-only: the caller must not write into them.
+/// </summary>
+class ExternalDataMapper {
+ public:
+  ExternalDataMapper() = default;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(ExternalDataMapper);
+
+  // Sets data to the length bytes found at offset in file_path.
+  // The range must lie within the file.
+  Status GetData(const Env& env, const std::filesystem::path& file_path, FileOffsetType offset, size_t length,
+                 IAllocatorUniquePtr<void>& data);
+
+ private:
+  struct MappedFile {
+    Env::MappedMemoryPtr memory;
+    size_t length = 0;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::filesystem::path::string_type, std::shared_ptr<const MappedFile>> files_;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+
+#include "core/common/hash_combine.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+
+namespace {
+void AppendShape(const TensorShape& shape, MemoryPatternCache::Key& key) {
+  const auto dims = shape.GetDims();
+  // The rank separates the feeds, {2, 3}, {4} and {2}, {3, 4} give different keys.
+  key.push_back(static_cast<int64_t>(dims.size()));
+  key.insert(key.end(), dims.begin(), dims.end());
+}
+}  // namespace
+
+MemoryPatternCache::Key MemoryPatternCache::MakeKey(gsl::span<const OrtValue> tensor_inputs) {
+  Key key;
+  for (const auto& input : tensor_inputs) {
+    AppendShape(input.Get<Tensor>().Shape(), key);
+  }
+  return key;
+}
+
+MemoryPatternCache::Key MemoryPatternCache::MakeKey(gsl::span<const TensorShape> input_shapes) {
+  Key key;
+  for (const auto& shape : input_shapes) {
+    AppendShape(shape, key);
+  }
+  return key;
+}
+
+size_t MemoryPatternCache::KeyHash::operator()(const Key& key) const {
+  size_t seed = key.size();
+  for (int64_t dim : key) {
+    HashCombine(dim, seed);
+  }
+  return seed;
+}
+
+std::shared_ptr<const MemoryPatternCache::Entry> MemoryPatternCache::Find(const Key& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return it->second->second;
+}
+
+std::shared_ptr<const MemoryPatternCache::Entry> MemoryPatternCache::Insert(const Key& key, Entry entry) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Do not replace an existing entry, a concurrent run with the same shapes may have added it.
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+  }
+
+  if (capacity_ != 0 && lru_.size() >= capacity_) {
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
+    ++stats_.evictions;
+  }
+  lru_.emplace_front(key, std::make_shared<const Entry>(std::move(entry)));
+  index_.emplace(key, lru_.begin());
+  return lru_.front().second;
+}
+
+MemoryPatternCache::Stats MemoryPatternCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.size = lru_.size();
+  return stats;
+}
+
+}  // namespace onnxruntime
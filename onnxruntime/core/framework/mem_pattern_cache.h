@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <gsl/gsl>
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/framework/mem_pattern.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/tensor_shape.h"
+
+namespace onnxruntime {
+
+/// <summary>
+/// Least recently used cache of the memory patterns of a session, keyed by the shapes of the feeds.
+///
+/// The key holds the rank and every dimension of every feed, so two different sets of shapes never share
+/// an entry. Entries are reference counted: an execution frame keeps using the pattern it looked up
+/// while the entry is evicted by a concurrent run with other shapes.
+/// </summary>
+class MemoryPatternCache {
+ public:
+  using Key = std::vector<int64_t>;
+
+  struct Entry {
+    MemoryPatternGroup patterns;
+    // Shapes of the intermediate values, only generated ahead of the run in training builds.
+    InlinedHashMap<int, TensorShape> inferred_shapes;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+  };
+
+  // A capacity of 0 never evicts.
+  explicit MemoryPatternCache(size_t capacity = 0) : capacity_(capacity) {}
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(MemoryPatternCache);
+
+  // All values must contain tensors.
+  static Key MakeKey(gsl::span<const OrtValue> tensor_inputs);
+  static Key MakeKey(gsl::span<const TensorShape> input_shapes);
+
+  // Returns the entry of key and marks it as the most recently used, or nullptr.
+  std::shared_ptr<const Entry> Find(const Key& key);
+
+  // Adds an entry for key unless one already exists, evicting the least recently used entry
+  // when the cache is full. Returns the entry held by the cache.
+  std::shared_ptr<const Entry> Insert(const Key& key, Entry entry);
+
+  Stats GetStats() const;
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  using LruList = std::list<std::pair<Key, std::shared_ptr<const Entry>>>;
+
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  LruList lru_;
+  std::unordered_map<Key, LruList::iterator, KeyHash> index_;
+  Stats stats_;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepacked_weights_disk_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "core/common/narrow.h"
+#include "core/common/safeint.h"
+
+namespace onnxruntime {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'R', 'T', 'P', 'P', 'W', '\0', '\1'};
+
+uint64_t AlignUp(uint64_t value) {
+  return (value + PrepackedWeightsDiskCache::kBufferAlignment - 1) / PrepackedWeightsDiskCache::kBufferAlignment *
+         PrepackedWeightsDiskCache::kBufferAlignment;
+}
+
+// Header: magic, number of buffers, then (offset, size) for every buffer.
+std::vector<uint64_t> ComputeOffsets(const PrePackedWeights& packed_weights) {
+  const size_t num_buffers = packed_weights.buffer_sizes_.size();
+  std::vector<uint64_t> offsets(num_buffers);
+  SafeInt<uint64_t> offset = sizeof(kMagic) + sizeof(uint64_t) * (1 + 2 * num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    offsets[i] = AlignUp(offset);
+    offset = SafeInt<uint64_t>(offsets[i]) + packed_weights.buffer_sizes_[i];
+  }
+  return offsets;
+}
+
+Status ReadHeader(const std::filesystem::path& file_path, std::vector<uint64_t>& offsets,
+                  std::vector<uint64_t>& sizes) {
+  std::ifstream in(file_path, std::ios::binary);
+  ORT_RETURN_IF_NOT(in.good(), "Unable to open pre-packed weights cache file ", file_path);
+  char magic[sizeof(kMagic)];
+  uint64_t num_buffers = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&num_buffers), sizeof(num_buffers));
+  ORT_RETURN_IF_NOT(in.good() && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 && num_buffers < 1024,
+                    "Invalid pre-packed weights cache file ", file_path);
+  offsets.resize(narrow<size_t>(num_buffers));
+  sizes.resize(narrow<size_t>(num_buffers));
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    in.read(reinterpret_cast<char*>(&offsets[i]), sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(&sizes[i]), sizeof(uint64_t));
+  }
+  ORT_RETURN_IF_NOT(in.good(), "Truncated pre-packed weights cache file ", file_path);
+
+  const std::uintmax_t file_length = std::filesystem::file_size(file_path);
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    ORT_RETURN_IF(SafeInt<std::uintmax_t>(offsets[i]) + sizes[i] > file_length,
+                  "Truncated pre-packed weights cache file ", file_path);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+std::filesystem::path PrepackedWeightsDiskCache::GetFilePath(const std::string& key) const {
+  std::string file_name;
+  file_name.reserve(key.size() + 4);
+  for (char c : key) {
+    const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                      c == '+' || c == '-' || c == '_';
+    file_name.push_back(keep ? c : '_');
+  }
+  file_name += ".bin";
+  return cache_dir_ / file_name;
+}
+
+Status PrepackedWeightsDiskCache::Store(const Env& env, const std::filesystem::path& file_path,
+                                        const PrePackedWeights& packed_weights) const {
+  static std::atomic<uint64_t> counter{0};
+  std::filesystem::path tmp_path = file_path;
+  tmp_path += ".tmp." + std::to_string(env.GetSelfPid()) + "." + std::to_string(counter++);
+
+  const auto offsets = ComputeOffsets(packed_weights);
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    ORT_RETURN_IF_NOT(out.good(), "Unable to create pre-packed weights cache file ", tmp_path);
+
+    const uint64_t num_buffers = offsets.size();
+    out.write(kMagic, sizeof(kMagic));
+    out.write(reinterpret_cast<const char*>(&num_buffers), sizeof(num_buffers));
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      const uint64_t size = packed_weights.buffer_sizes_[i];
+      out.write(reinterpret_cast<const char*>(&offsets[i]), sizeof(uint64_t));
+      out.write(reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+    }
+
+    const char zeros[64] = {};
+    uint64_t position = sizeof(kMagic) + sizeof(uint64_t) * (1 + 2 * offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      while (position < offsets[i]) {
+        const uint64_t padding = std::min<uint64_t>(sizeof(zeros), offsets[i] - position);
+        out.write(zeros, narrow<std::streamsize>(padding));
+        position += padding;
+      }
+      out.write(static_cast<const char*>(packed_weights.buffers_[i].get()),
+                narrow<std::streamsize>(packed_weights.buffer_sizes_[i]));
+      position += packed_weights.buffer_sizes_[i];
+    }
+    out.close();
+    if (!out.good()) {
+      std::error_code ec;
+      std::filesystem::remove(tmp_path, ec);
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Unable to write pre-packed weights cache file ", tmp_path);
+    }
+  }
+
+  // Another process may have stored the same key in the meantime, both files hold the same content.
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, file_path, ec);
+  if (ec) {
+    std::error_code ignored;
+    std::filesystem::remove(tmp_path, ignored);
+    ORT_RETURN_IF_NOT(std::filesystem::exists(file_path, ignored),
+                      "Unable to rename pre-packed weights cache file ", tmp_path, ": ", ec.message());
+  }
+  return Status::OK();
+}
+
+Status PrepackedWeightsDiskCache::MapOrStore(const Env& env, const std::string& key,
+                                             PrePackedWeights& packed_weights) const {
+  const size_t num_buffers = packed_weights.buffers_.size();
+  ORT_RETURN_IF_NOT(num_buffers == packed_weights.buffer_sizes_.size(), "Inconsistent pre-packed weights for ", key);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    // Place-holders cannot be mapped.
+    ORT_RETURN_IF(packed_weights.buffers_[i] == nullptr || packed_weights.buffer_sizes_[i] == 0,
+                  "Pre-packed weights ", key, " contain an empty buffer and cannot be cached on disk.");
+  }
+
+  const auto file_path = GetFilePath(key);
+  std::error_code ec;
+  if (!std::filesystem::exists(file_path, ec)) {
+    ORT_RETURN_IF_ERROR(Store(env, file_path, packed_weights));
+  }
+
+  std::vector<uint64_t> offsets, sizes;
+  ORT_RETURN_IF_ERROR(ReadHeader(file_path, offsets, sizes));
+  ORT_RETURN_IF_NOT(offsets.size() == num_buffers, "Pre-packed weights cache file ", file_path,
+                    " holds ", offsets.size(), " buffers, expected ", num_buffers);
+
+  InlinedVector<IAllocatorUniquePtr<void>> mapped_buffers;
+  mapped_buffers.reserve(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    ORT_RETURN_IF_NOT(sizes[i] == packed_weights.buffer_sizes_[i], "Pre-packed weights cache file ", file_path,
+                      " has a buffer of ", sizes[i], " bytes, expected ", packed_weights.buffer_sizes_[i]);
+    Env::MappedMemoryPtr mapped_memory;
+    ORT_RETURN_IF_ERROR(env.MapFileIntoMemoryReadOnly(file_path.native().c_str(),
+                                                      narrow<FileOffsetType>(offsets[i]),
+                                                      packed_weights.buffer_sizes_[i], mapped_memory));
+    // The key is a hash of the content, the comparison guards against collisions and corrupted files.
+    ORT_RETURN_IF_NOT(std::memcmp(mapped_memory.get(), packed_weights.buffers_[i].get(),
+                                  packed_weights.buffer_sizes_[i]) == 0,
+                      "Pre-packed weights cache file ", file_path, " does not match the pre-packed weights ", key);
+    mapped_buffers.emplace_back(mapped_memory.release(), mapped_memory.get_deleter());
+  }
+
+  packed_weights.buffers_ = std::move(mapped_buffers);
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
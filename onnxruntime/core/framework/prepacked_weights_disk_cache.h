@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "core/common/common.h"
+#include "core/framework/prepacked_weights.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+/// <summary>
+/// Content-addressed store of pre-packed weights shared by all the processes of a host.
+///
+/// Every PrePackedWeights instance is saved in one file named after its key
+/// (op_type + "+" + hash of the pre-packed buffers, see SessionState). The file holds a small header
+/// followed by the buffers, each one aligned on kBufferAlignment bytes so that it can be mapped on its own.
+/// Files are written to a temporary name and renamed, so concurrent writers never expose a partial file.
+///
+/// The buffers are mapped read-only with Env::MapFileIntoMemoryReadOnly, so processes mapping the same file share
+/// its physical pages. Kernels must never write into a buffer received through OpKernel::UseSharedPrePackedBuffers;
+/// doing so faults.
+/// </summary>
+class PrepackedWeightsDiskCache {
+ public:
+  static constexpr size_t kBufferAlignment = 4096;
+
+  explicit PrepackedWeightsDiskCache(std::filesystem::path cache_dir) : cache_dir_(std::move(cache_dir)) {}
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PrepackedWeightsDiskCache);
+
+  // Replaces the buffers of packed_weights with memory mapped copies stored in the cache directory.
+  // The file is created first if the cache does not contain the key yet.
+  // packed_weights is left unchanged if an error is returned, including when the cached file
+  // does not hold the same content.
+  Status MapOrStore(const Env& env, const std::string& key, PrePackedWeights& packed_weights) const;
+
+  // Returns the path of the file holding the pre-packed weights associated with key.
+  std::filesystem::path GetFilePath(const std::string& key) const;
+
+ private:
+  Status Store(const Env& env, const std::filesystem::path& file_path, const PrePackedWeights& packed_weights) const;
+
+  std::filesystem::path cache_dir_;
+};
+
+}  // namespace onnxruntime
@@ -179,6 +179,12 @@ class SessionScope {
   {
     session_start_ = StartProfilingIfEnabled();
 
+    // Node indices are only unique within a graph, so only the runs of the main graph are sampled.
+    auto* sampling_profiler = session_state_.Profiler().GetSamplingProfiler();
+    if (sampling_profiler && !session_state_.GetGraphViewer().IsSubgraph() && sampling_profiler->ShouldSample()) {
+      sampling_profiler_ = sampling_profiler;
+    }
+
     auto& logger = session_state_.Logger();
     VLOGS(logger, 0) << "Begin execution";
     const SequentialExecutionPlan& seq_exec_plan = *session_state_.GetExecutionPlan();
@@ -273,6 +279,19 @@ class SessionScope {
     }
   }
 
+  // The profiler events are recorded to, the session profiler takes precedence. nullptr if profiling is disabled.
+  profiling::Profiler* GetEnabledProfiler() const {
+    if (session_state_.Profiler().IsEnabled()) {
+      return &session_state_.Profiler();
+    }
+    return IsRunProfilingEnabled() ? run_profiler_ : nullptr;
+  }
+
+  // The sampling profiler if this run is sampled, nullptr otherwise.
+  profiling::SamplingProfiler* GetSamplingProfiler() const {
+    return sampling_profiler_;
+  }
+
   TimePoint StartProfilingIfEnabled() {
     const bool session_profiling_enabled = session_state_.Profiler().IsEnabled();
     const bool run_profiling_enabled = IsRunProfilingEnabled();
@@ -288,6 +307,7 @@ class SessionScope {
  private:
   const SessionState& session_state_;
   profiling::Profiler* run_profiler_;
+  profiling::SamplingProfiler* sampling_profiler_{nullptr};
   TimePoint session_start_;
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
   const ExecutionFrame& frame_;
@@ -388,6 +408,15 @@ class KernelScope {
       CalculateTotalInputSizes(&kernel_context, &kernel_,
                                input_activation_sizes_, input_parameter_sizes_,
                                node_name_, input_type_shape_);
+
+      // Read last so that the bookkeeping above is not counted.
+      if (session_scope_.GetEnabledProfiler()->HardwareCountersEnabled()) {
+        hardware_counters_read_ = profiling::HardwareCounters::Read(hardware_counters_begin_);
+      }
+    }
+
+    if (session_scope_.GetSamplingProfiler()) {
+      sampled_begin_time_ = std::chrono::steady_clock::now();
     }
   }
 
@@ -398,10 +427,21 @@ class KernelScope {
     node_compute_range_.End();
 #endif
 
+    if (auto* sampling_profiler = session_scope_.GetSamplingProfiler()) {
+      const auto latency = std::chrono::steady_clock::now() - sampled_begin_time_;
+      sampling_profiler->RecordNodeLatency(
+          kernel_.Node().Index(),
+          static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+    }
+
     const bool session_profiling_enabled = session_state_.Profiler().IsEnabled();
     const bool run_profiling_enabled = session_scope_.IsRunProfilingEnabled();
 
     if (session_profiling_enabled || run_profiling_enabled) {
+      profiling::HardwareCounterValues hardware_counters_end;
+      const bool hardware_counters_read = hardware_counters_read_ &&
+                                          profiling::HardwareCounters::Read(hardware_counters_end);
+
       std::string output_type_shape_;
       CalculateTotalOutputSizes(&kernel_context_, total_output_sizes_, node_name_, output_type_shape_);
 
@@ -418,6 +458,18 @@ class KernelScope {
            concurrency::ThreadPool::StopProfiling(session_state_.GetThreadPool())},
       };
 
+      if (hardware_counters_read) {
+        // Counted on the thread running the kernel, the work done by the intra-op thread pool is not included.
+        const auto counters = hardware_counters_end - hardware_counters_begin_;
+        event_args["cycles"] = std::to_string(counters.cycles);
+        event_args["instructions"] = std::to_string(counters.instructions);
+        event_args["llc_misses"] = std::to_string(counters.llc_misses);
+        event_args["branch_misses"] = std::to_string(counters.branch_misses);
+        session_scope_.GetEnabledProfiler()->RecordHardwareCounters(
+            kernel_.Node().OpType(), counters,
+            input_activation_sizes_ + input_parameter_sizes_ + total_output_sizes_);
+      }
+
       session_scope_.StopProfilingIfEnabled(profiling::NODE_EVENT,
                                             node_name_ + "_kernel_time",
                                             kernel_begin_time_,
@@ -456,6 +508,11 @@ class KernelScope {
   size_t total_output_sizes_{};
   std::string input_type_shape_;
 
+  profiling::HardwareCounterValues hardware_counters_begin_;
+  bool hardware_counters_read_{false};
+
+  std::chrono::steady_clock::time_point sampled_begin_time_;
+
 #ifdef CONCURRENCY_VISUALIZER
   diagnostic::span span_;
 #endif
@@ -3,10 +3,14 @@
 
 #include "core/framework/session_state.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include <mutex>
+#include <optional>
 #include "core/common/logging/logging.h"
+#include "core/common/parse_string.h"
+#include "core/common/path_string.h"
 #include "core/common/safeint.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
@@ -14,7 +18,10 @@
 #include "core/framework/op_kernel.h"
 #include "core/framework/ort_value_pattern_planner.h"
 #include "core/framework/prepacked_weights_container.h"
+#include "core/framework/prepacked_weights_disk_cache.h"
 #include "core/framework/session_state_utils.h"
+#include "core/framework/static_mem_pattern_planner.h"
+#include "core/framework/tensorprotoutils.h"
 #include "core/framework/utils.h"
 #include "core/providers/cpu/controlflow/utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
@@ -79,6 +86,16 @@ class StreamCommandHandleRegistryImpl : public IStreamCommandHandleRegistry {
 };
 #endif
 
+namespace {
+size_t GetMemoryPatternCacheCapacity(const SessionOptions& sess_options) {
+  const std::string value =
+      sess_options.config_options.GetConfigOrDefault(kOrtSessionOptionsMemoryPatternCacheCapacity, "0");
+  size_t capacity = 0;
+  ORT_THROW_IF_ERROR(ParseStringWithClassicLocale(value, capacity));
+  return capacity;
+}
+}  // namespace
+
 SessionState::SessionState(Graph& graph,
                            const ExecutionProviders& execution_providers,
                            concurrency::ThreadPool* thread_pool,
@@ -95,6 +112,7 @@ SessionState::SessionState(Graph& graph,
       execution_providers_(execution_providers),
       logger_(logger),
       profiler_(profiler),
+      mem_patterns_(GetMemoryPatternCacheCapacity(sess_options)),
       thread_pool_(thread_pool),
       inter_op_thread_pool_(inter_op_thread_pool),
       data_transfer_mgr_(data_transfer_mgr),
@@ -462,7 +480,27 @@ static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
 Status SessionState::PrepackConstantInitializedTensors(
     InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
     const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map) {
-  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map](
+  // Newly pre-packed weights are replaced by a memory mapped copy shared with the other processes of the host
+  // if a cache directory is configured. Weights keep their heap buffers if the cache cannot be used.
+  std::optional<PrepackedWeightsDiskCache> prepacked_weights_disk_cache;
+  const std::string prepacked_weights_cache_dir =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsPrePackedWeightsCacheDir, "");
+  if (!prepacked_weights_cache_dir.empty()) {
+    prepacked_weights_disk_cache.emplace(ToPathString(prepacked_weights_cache_dir));
+  }
+  auto map_from_disk_cache = [this, &prepacked_weights_disk_cache](const std::string& key,
+                                                                   PrePackedWeights& packed_weights) {
+    if (prepacked_weights_disk_cache.has_value()) {
+      auto status = prepacked_weights_disk_cache->MapOrStore(Env::Default(), key, packed_weights);
+      if (!status.IsOK()) {
+        LOGS(logger_, WARNING) << "Pre-packed weight " << key << " is not shared through the disk cache: "
+                               << status.ErrorMessage();
+      }
+    }
+  };
+
+  auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map,
+                                     &map_from_disk_cache](
                                         bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
     for (auto& node : GetGraphViewer().Nodes()) {
       if (sess_options_.IsLoadCancellationFlagSet()) {
@@ -560,6 +598,11 @@ Status SessionState::PrepackConstantInitializedTensors(
                       // everybody can share the same memory mapped entry
                       // the shared container takes ownership of the memory mapped entries
 
+                      // Map the buffers before anything refers to them, unless they were loaded with the model
+                      if (prepacked_for_graph->GetPrepackedWeights(prepacked_weights_container_key) == nullptr) {
+                        map_from_disk_cache(prepacked_weights_container_key, weights_to_be_filled_in);
+                      }
+
                       // The next line replaces the existing entry with references to it
                       // and returns the container that holds the memory mapped entries
                       // so we can transfer it to shared container.
@@ -607,11 +650,9 @@ Status SessionState::PrepackConstantInitializedTensors(
                                                       is_packed,
                                                       &weights_to_be_filled_in));
 
-                  // Some kernels (matmul_nbits and non-CPU related kernels) do not share their pre-packed results
+                  // Some kernels (fp16 matmul_nbits and non-CPU related kernels) do not share their pre-packed results
                   // even though they set is_packed = true so we leave it up to them.
                   // We can change their behavior if we wish do so in a separate PR
-                  // XXX: Interestingly enough, matmul_nbits does accept shared pre-packs, but does not
-                  // produce them.
                   if (is_packed && !weights_to_be_filled_in.buffers_.empty()) {
                     const auto& op_type = node.OpType();
                     const std::string prepacked_weights_container_key = GenerateKeyForPrepackedWeightsMap(
@@ -623,6 +664,7 @@ Status SessionState::PrepackConstantInitializedTensors(
                         prepacked_weights_container_key);
 
                     if (weights_to_use == nullptr) {
+                      map_from_disk_cache(prepacked_weights_container_key, weights_to_be_filled_in);
                       // In this case pre-packed container owns the data
                       prepacked_for_graph->WritePackedMaybeForSave(input_name, prepacked_weights_container_key,
                                                                    std::move(weights_to_be_filled_in));
@@ -676,15 +718,6 @@ Status SessionState::PrepackConstantInitializedTensors(
   }
 }
 
-static int64_t
-CalculateMemoryPatternsKey(const gsl::span<const OrtValue>& tensor_inputs) {
-  int64_t key = 0;
-  for (const auto& input : tensor_inputs) {
-    for (auto dim : input.Get<Tensor>().Shape().GetDims()) key ^= dim;
-  }
-  return key;
-}
-
 #ifdef ENABLE_TRAINING
 namespace {
 Status ResolveDimParams(const GraphViewer& graph,
@@ -919,38 +952,35 @@ Status SessionState::GeneratePatternGroupCache(gsl::span<const OrtValue> tensor_
 
 #endif
 
-// MemoryPatternGroup pointer is cached. It only inserted upon creation
-// and is not updated if already present.
-const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
+// Entries are only inserted upon creation and never updated, they are shared with the execution frames.
+std::shared_ptr<const MemoryPatternGroup> SessionState::GetMemoryPatternGroup(
     gsl::span<const OrtValue> tensor_inputs,
     gsl::span<const int> feed_mlvalue_idxs,
     const InlinedHashMap<int, TensorShape>*& out_inferred_shapes) const {
   out_inferred_shapes = nullptr;
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
-  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
-  auto it = mem_patterns_.find(key);
-  if (it == mem_patterns_.end()) {
+  auto key = MemoryPatternCache::MakeKey(tensor_inputs);
+  auto entry = mem_patterns_.Find(key);
+  if (!entry) {
 #ifdef ENABLE_TRAINING
-    MemoryPatternGroup mem_patterns;
-    InlinedHashMap<int, TensorShape> inferred_shapes;
-    if (GeneratePatternGroupCache(tensor_inputs, feed_mlvalue_idxs, mem_patterns, inferred_shapes).IsOK()) {
-      auto patt_insert = mem_patterns_.insert_or_assign(key, std::move(mem_patterns));
-      auto ptr = &patt_insert.first->second;
-      auto shape_insert = shape_patterns_.insert_or_assign(key, std::move(inferred_shapes));
-      out_inferred_shapes = &shape_insert.first->second;
-      return ptr;
+    MemoryPatternCache::Entry new_entry;
+    if (GeneratePatternGroupCache(tensor_inputs, feed_mlvalue_idxs, new_entry.patterns,
+                                  new_entry.inferred_shapes)
+            .IsOK()) {
+      entry = mem_patterns_.Insert(key, std::move(new_entry));
     }
 #else
     ORT_UNUSED_PARAMETER(feed_mlvalue_idxs);
 #endif
-    return nullptr;
+    if (!entry) {
+      return nullptr;
+    }
   }
 
-  auto patt_hit = shape_patterns_.find(key);
-  if (patt_hit != shape_patterns_.cend()) {
-    out_inferred_shapes = &patt_hit->second;
+  if (!entry->inferred_shapes.empty()) {
+    out_inferred_shapes = &entry->inferred_shapes;
   }
-  return &it->second;
+  // Share the ownership of the entry so that the inferred shapes outlive an eviction as well.
+  return std::shared_ptr<const MemoryPatternGroup>(entry, &entry->patterns);
 }
 
 void SessionState::ResolveMemoryPatternFlag() {
@@ -997,15 +1027,186 @@ void SessionState::ResolveMemoryPatternFlag() {
       }
     }
   }
+
+  // The feeds of a subgraph are ordered by its control flow node, only plan the main graph.
+  if (enable_mem_pattern_ && !graph_viewer_->IsSubgraph() &&
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsStaticMemoryPlanning, "0") == "1") {
+    auto status = GenerateStaticMemoryPatterns();
+    if (!status.IsOK()) {
+      LOGS(logger_, WARNING) << "Static memory planning failed, the memory patterns will be traced at run time: "
+                             << status.ErrorMessage();
+    }
+  }
+}
+
+namespace {
+// Returns false if a dimension of arg is unknown.
+bool TryGetStaticShape(const NodeArg& arg, TensorShape& shape) {
+  const auto* shape_proto = arg.Shape();
+  if (shape_proto == nullptr) {
+    return false;
+  }
+  shape = utils::GetTensorShapeFromTensorShapeProto(*shape_proto);
+  const auto dims = shape.GetDims();
+  return std::all_of(dims.begin(), dims.end(), [](int64_t dim) { return dim >= 0; });
+}
+
+// Elementwise kernels of the CPU EP that read each input element at the index they write the output element.
+// Their output can take the buffer of an input of the same shape that is not used afterwards, even though
+// the kernels do not declare MayInplace.
+bool CanComputeInPlace(const Node& node) {
+  static const InlinedHashSet<std::string_view> elementwise_ops{
+      "Add", "Sub", "Mul", "Div", "Abs", "Neg", "Sqrt", "Exp", "Log", "Reciprocal", "Floor", "Ceil"};
+  return node.GetExecutionProviderType() == kCpuExecutionProvider &&
+         node.Domain() == kOnnxDomain &&
+         elementwise_ops.find(node.OpType()) != elementwise_ops.end();
+}
+}  // namespace
+
+Status SessionState::GenerateStaticMemoryPatterns() {
+  const auto* exe_plan = GetExecutionPlan();
+  ORT_RETURN_IF_NOT(exe_plan, "The execution plan is not created.");
+  // Lifetimes are only static when all the nodes run one after the other.
+  ORT_RETURN_IF_NOT(exe_plan->NumberOfValidStreams() == 1, "The execution plan has more than one stream.");
+
+  InlinedVector<TensorShape> input_shapes;
+  for (const auto* input : graph_viewer_->GetInputs()) {
+    TensorShape shape;
+    ORT_RETURN_IF_NOT(TryGetStaticShape(*input, shape), "The shape of graph input ", input->Name(),
+                      " is not static.");
+    input_shapes.push_back(std::move(shape));
+  }
+
+  // Step of each node in the execution order.
+  InlinedVector<NodeIndex> execution_order;
+  InlinedHashMap<NodeIndex, size_t> node_steps;
+  for (const auto& logic_stream : exe_plan->execution_plan) {
+    for (const auto& step : logic_stream->steps_) {
+      const auto node_index = step->GetNodeIndex();
+      if (node_steps.emplace(node_index, execution_order.size()).second) {
+        execution_order.push_back(node_index);
+      }
+    }
+  }
+  if (execution_order.empty()) {
+    return Status::OK();
+  }
+  const size_t last_step = execution_order.size() - 1;
+
+  // A buffer freed by a node is alive until that node completes. Buffers released by several nodes,
+  // or not at all, are kept alive until the end.
+  InlinedHashMap<size_t, size_t> release_steps;
+  for (size_t step = 0; step < execution_order.size(); ++step) {
+    for (size_t action_idx : exe_plan->node_release_list[execution_order[step]]) {
+      const auto& action = exe_plan->release_actions[action_idx];
+      if (action.ref_count == 1) {
+        release_steps[action.value_index] = step;
+      }
+    }
+  }
+  auto get_last_step = [&release_steps, last_step](int ort_value_idx) {
+    auto it = release_steps.find(static_cast<size_t>(ort_value_idx));
+    return it != release_steps.end() ? it->second : last_step;
+  };
+
+  // StaticMemPatternPlanner is not movable.
+  NodeHashMap<OrtDevice, StaticMemPatternPlanner> planners;
+  // Shape and element type of the planned tensors that an in-place output may still take over.
+  InlinedHashMap<int, std::pair<TensorShape, MLDataType>> planned_tensors;
+  size_t num_in_place = 0;
+
+  for (size_t step = 0; step < execution_order.size(); ++step) {
+    const auto* node = graph_viewer_->GetNode(execution_order[step]);
+    if (node == nullptr) {
+      continue;
+    }
+
+    const auto& output_defs = node->OutputDefs();
+    for (size_t i = 0, end = output_defs.size(); i < end; ++i) {
+      const auto* output = output_defs[i];
+      int ort_value_idx = 0;
+      if (!output->Exists() || !ort_value_name_idx_map_.GetIdx(output->Name(), ort_value_idx).IsOK()) {
+        continue;
+      }
+
+      const auto& alloc_plan = exe_plan->allocation_plan[ort_value_idx];
+      if (alloc_plan.alloc_kind != AllocKind::kAllocate || alloc_plan.value_type == nullptr ||
+          !alloc_plan.value_type->IsTensorType() ||
+          alloc_plan.location.MemType() != OrtDevice::MemType::DEFAULT) {
+        continue;
+      }
+
+      const auto* element_type = static_cast<const TensorTypeBase*>(alloc_plan.value_type)->GetElementType();
+      TensorShape shape;
+      if (element_type == DataTypeImpl::GetType<std::string>() || !TryGetStaticShape(*output, shape)) {
+        // Allocated at run time.
+        continue;
+      }
+
+      // Must match the size ExecutionFrame computes, or the block is ignored.
+      const auto alignment = std::max(alloc_plan.location.GetAlignment(), kAllocAlignment);
+      size_t size = 0;
+      ORT_RETURN_IF_ERROR(Tensor::CalculateTensorStorageSize(element_type, shape, alignment, size));
+
+      auto& planner = planners[alloc_plan.location];
+      const size_t output_last_step = std::max(step, get_last_step(ort_value_idx));
+
+      bool in_place = false;
+      if (i == 0 && CanComputeInPlace(*node)) {
+        for (const auto* input : node->InputDefs()) {
+          int input_idx = 0;
+          if (!input->Exists() || !ort_value_name_idx_map_.GetIdx(input->Name(), input_idx).IsOK()) {
+            continue;
+          }
+
+          // Equal storage sizes are not enough: a broadcast input rounded up to the same size would be
+          // overwritten while it is still read. Only an input with the output's exact shape is safe.
+          auto planned = planned_tensors.find(input_idx);
+          if (planned != planned_tensors.end() && planned->second.first == shape &&
+              planned->second.second == element_type &&
+              exe_plan->allocation_plan[input_idx].location == alloc_plan.location &&
+              get_last_step(input_idx) == step) {
+            planner.ShareBuffer(ort_value_idx, input_idx, output_last_step);
+            // The input is dead, it can't be shared twice.
+            planned_tensors.erase(planned);
+            in_place = true;
+            ++num_in_place;
+            break;
+          }
+        }
+      }
+
+      if (!in_place) {
+        planner.AddBuffer(ort_value_idx, size, step, output_last_step);
+      }
+      planned_tensors[ort_value_idx] = {shape, element_type};
+    }
+  }
+
+  if (planners.empty()) {
+    return Status::OK();
+  }
+
+  MemoryPatternCache::Entry entry;
+  for (const auto& [location, planner] : planners) {
+    entry.patterns.locations.push_back(location);
+    entry.patterns.patterns.push_back(planner.GeneratePattern());
+    LOGS(logger_, INFO) << "Static memory plan for " << location.ToString() << ": "
+                        << entry.patterns.patterns.back().PeakSize() << " bytes for " << planner.NumBuffers()
+                        << " buffers, " << planner.NaivePeakSize() << " bytes without reuse.";
+  }
+  LOGS(logger_, INFO) << "Static memory plan: " << num_in_place << " elementwise outputs computed in place.";
+
+  mem_patterns_.Insert(MemoryPatternCache::MakeKey(input_shapes), std::move(entry));
+  return Status::OK();
 }
 
 Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                                    MemoryPatternGroup mem_patterns) const {
-  int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
-
-  std::lock_guard<std::mutex> lock(mem_patterns_lock_);
-  // Do not update if present, as the pointer to the existing one is cached
-  mem_patterns_.emplace(key, std::move(mem_patterns));
+  MemoryPatternCache::Entry entry;
+  entry.patterns = std::move(mem_patterns);
+  // Does not update if present, as the existing one may be in use
+  mem_patterns_.Insert(MemoryPatternCache::MakeKey(tensor_inputs), std::move(entry));
   return Status::OK();
 }
 
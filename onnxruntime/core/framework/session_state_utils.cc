@@ -4,6 +4,7 @@
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <utility>
 
@@ -84,7 +85,8 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
                                              OrtValue& ort_value, const DataTransferManager& data_transfer_mgr,
                                              const ExternalDataLoaderManager& external_data_loader_mgr,
                                              PrepackedWeightsForGraph& prepacked_for_graph,
-                                             bool use_device_allocator_for_initializers = false) {
+                                             bool use_device_allocator_for_initializers = false,
+                                             ExternalDataMapper* external_data_mapper = nullptr) {
   if (alloc != nullptr && memory_buffer != nullptr) {
     return Status(common::ONNXRUNTIME, common::INVALID_ARGUMENT,
                   "DeserializeTensorProto() takes either pre-allocated buffer or an allocator!");
@@ -116,7 +118,8 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
       // utilize the mmap'd buffer directly.
       ORT_RETURN_IF_ERROR(utils::GetExtDataFromTensorProto(env, proto_path, tensor_proto,
                                                            ort_value,
-                                                           &prepacked_for_graph));
+                                                           &prepacked_for_graph,
+                                                           external_data_mapper));
       return common::Status::OK();
     } else {  // non-cpu tensor or tensor in a cpu accessible memory
       if (utils::HasString(tensor_proto)) {
@@ -134,7 +137,8 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
       OrtValue deserialized_value;
       ORT_RETURN_IF_ERROR(utils::GetExtDataFromTensorProto(env, proto_path, tensor_proto,
                                                            deserialized_value,
-                                                           &prepacked_for_graph));
+                                                           &prepacked_for_graph,
+                                                           external_data_mapper));
 
       return CopyTensorFromCPUToDevice(data_transfer_mgr, deserialized_value.Get<Tensor>(),
                                        std::move(tensor), ort_value);
@@ -359,6 +363,13 @@ common::Status SaveInitializedTensors(
       session_options.config_options.GetConfigOrDefault(
           kOrtSessionOptionsUseDeviceAllocatorForInitializers, "0") == "1";
 
+  // Every external data file is mapped once and read-only, the CPU initializers alias the mapping.
+  std::optional<ExternalDataMapper> external_data_mapper;
+  if (session_options.config_options.GetConfigOrDefault(
+          kOrtSessionOptionsMapExternalInitializersReadOnly, "0") == "1") {
+    external_data_mapper.emplace();
+  }
+
   // 3. create weight tensors based on weights buffer
   for (const auto& entry : id_to_initialized_tensor) {
     // We check for cancellation for every initializer since mapping from disk can be costly
@@ -418,7 +429,8 @@ common::Status SaveInitializedTensors(
                                            (memory_buffer.has_value()) ? &*memory_buffer : nullptr,
                                            alloc, default_cpu_alloc, ort_value, data_transfer_mgr,
                                            external_data_loader_mgr, prepacked_for_graph,
-                                           use_device_allocator_for_initializers);
+                                           use_device_allocator_for_initializers,
+                                           external_data_mapper ? &*external_data_mapper : nullptr);
         if (!st.IsOK()) {
           std::ostringstream oss;
           oss << "Deserialize tensor " << name << " failed." << st.ErrorMessage();
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/static_mem_pattern_planner.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "core/common/safeint.h"
+
+namespace onnxruntime {
+
+void StaticMemPatternPlanner::AddBuffer(int ort_value_idx, size_t size, size_t first_step, size_t last_step) {
+  ORT_ENFORCE(first_step <= last_step, "Invalid lifetime for OrtValue ", ort_value_idx);
+  buffers_.push_back(Buffer{size, first_step, last_step, {ort_value_idx}});
+}
+
+void StaticMemPatternPlanner::ShareBuffer(int ort_value_idx, int shared_ort_value_idx, size_t last_step) {
+  auto it = std::find_if(buffers_.begin(), buffers_.end(), [shared_ort_value_idx](const Buffer& buffer) {
+    return std::find(buffer.ort_value_idxs.begin(), buffer.ort_value_idxs.end(), shared_ort_value_idx) !=
+           buffer.ort_value_idxs.end();
+  });
+  ORT_ENFORCE(it != buffers_.end(), "No buffer was added for OrtValue ", shared_ort_value_idx);
+  it->ort_value_idxs.push_back(ort_value_idx);
+  it->last_step = std::max(it->last_step, last_step);
+}
+
+size_t StaticMemPatternPlanner::Place(Strategy strategy, std::vector<size_t>& offsets) const {
+  std::vector<size_t> order(buffers_.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  if (strategy == Strategy::kGreedyBySize) {
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      const auto& lhs = buffers_[a];
+      const auto& rhs = buffers_[b];
+      if (lhs.size != rhs.size) return lhs.size > rhs.size;
+      // Among equal sizes, the longer lived buffers constrain the others the most.
+      return lhs.last_step - lhs.first_step > rhs.last_step - rhs.first_step;
+    });
+  } else {
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return buffers_[a].first_step < buffers_[b].first_step;
+    });
+  }
+
+  offsets.assign(buffers_.size(), 0);
+  std::vector<size_t> placed;
+  placed.reserve(buffers_.size());
+  std::vector<size_t> live;
+  size_t peak_size = 0;
+
+  for (size_t i : order) {
+    const auto& buffer = buffers_[i];
+    if (buffer.size == 0) {
+      continue;
+    }
+
+    // The placed buffers alive at the same time, sorted by offset.
+    live.clear();
+    for (size_t j : placed) {
+      if (buffers_[j].first_step <= buffer.last_step && buffer.first_step <= buffers_[j].last_step) {
+        live.push_back(j);
+      }
+    }
+    std::sort(live.begin(), live.end(), [&offsets](size_t a, size_t b) { return offsets[a] < offsets[b]; });
+
+    size_t current = 0;
+    size_t best_offset = 0;
+    size_t best_waste = std::numeric_limits<size_t>::max();
+    bool found = false;
+    for (size_t j : live) {
+      if (offsets[j] > current) {
+        const size_t gap = offsets[j] - current;
+        if (gap >= buffer.size && gap - buffer.size < best_waste) {
+          best_waste = gap - buffer.size;
+          best_offset = current;
+          found = true;
+        }
+      }
+      current = std::max(current, offsets[j] + buffers_[j].size);
+    }
+
+    offsets[i] = found ? best_offset : current;
+    const size_t buffer_end = SafeInt<size_t>(offsets[i]) + buffer.size;
+    peak_size = std::max(peak_size, buffer_end);
+    placed.push_back(i);
+  }
+
+  return peak_size;
+}
+
+MemoryPattern StaticMemPatternPlanner::GeneratePattern(Strategy strategy) const {
+  std::vector<size_t> offsets;
+  size_t peak_size = 0;
+  if (strategy == Strategy::kBest) {
+    std::vector<size_t> best_fit_offsets;
+    peak_size = Place(Strategy::kGreedyBySize, offsets);
+    const size_t best_fit_peak_size = Place(Strategy::kBestFit, best_fit_offsets);
+    if (best_fit_peak_size < peak_size) {
+      peak_size = best_fit_peak_size;
+      offsets = std::move(best_fit_offsets);
+    }
+  } else {
+    peak_size = Place(strategy, offsets);
+  }
+
+  MemoryPattern pattern;
+  pattern.peak_size_ = peak_size;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    for (int ort_value_idx : buffers_[i].ort_value_idxs) {
+      pattern.patterns_.insert_or_assign(ort_value_idx, MemoryBlock(offsets[i], buffers_[i].size));
+    }
+  }
+  return pattern;
+}
+
+size_t StaticMemPatternPlanner::NaivePeakSize() const {
+  SafeInt<size_t> size = 0;
+  for (const auto& buffer : buffers_) {
+    // Without reuse, the outputs computed in place would have had a buffer of their own.
+    size += SafeInt<size_t>(buffer.size) * buffer.ort_value_idxs.size();
+  }
+  return size;
+}
+
+}  // namespace onnxruntime
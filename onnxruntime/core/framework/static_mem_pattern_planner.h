@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/framework/mem_pattern.h"
+
+namespace onnxruntime {
+
+// StaticMemPatternPlanner places buffers whose size and lifetime are known before the first run
+// in a single block. Unlike MemPatternPlanner, which sees the allocations one at a time while tracing
+// a run, it knows all of them up front and solves the offset assignment as a packing problem:
+// two buffers may share memory as long as their lifetimes, [first_step, last_step] in the
+// execution order, do not intersect.
+class StaticMemPatternPlanner {
+ public:
+  enum class Strategy {
+    // Place the largest buffers first, each in the tightest gap left by the already placed buffers
+    // that are alive at the same time.
+    kGreedyBySize,
+    // Place the buffers in allocation order, each in the tightest gap. This is what tracing a run
+    // gives, the baseline greedy-by-size is compared against.
+    kBestFit,
+    // Run both and keep the smaller block.
+    kBest,
+  };
+
+  StaticMemPatternPlanner() = default;
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(StaticMemPatternPlanner);
+
+  // size must already be aligned, the offsets are sums of sizes.
+  void AddBuffer(int ort_value_idx, size_t size, size_t first_step, size_t last_step);
+
+  // Makes ort_value_idx use the buffer of shared_ort_value_idx, which must have been added before,
+  // and extends the lifetime of that buffer to last_step. Used for outputs computed in place.
+  void ShareBuffer(int ort_value_idx, int shared_ort_value_idx, size_t last_step);
+
+  MemoryPattern GeneratePattern(Strategy strategy = Strategy::kBest) const;
+
+  // Size of the block when every buffer gets memory of its own.
+  size_t NaivePeakSize() const;
+
+  size_t NumBuffers() const { return buffers_.size(); }
+
+ private:
+  struct Buffer {
+    size_t size;
+    size_t first_step;
+    size_t last_step;
+    // OrtValues using the buffer, the first one is the one it was added for.
+    std::vector<int> ort_value_idxs;
+  };
+
+  // Returns the peak size, offsets[i] is the offset of buffers_[i].
+  size_t Place(Strategy strategy, std::vector<size_t>& offsets) const;
+
+  std::vector<Buffer> buffers_;
+};
+
+}  // namespace onnxruntime
@@ -1246,13 +1246,24 @@ ORT_API(void, OrtUninitializeBuffer, _In_opt_ void* input, size_t input_len, enu
 
 #if !defined(__wasm__)
 static Status GetFileContent(const Env& env, const std::filesystem::path& file_path, FileOffsetType offset,
-                             size_t length, IAllocatorUniquePtr<void>& external_data) {
+                             size_t length, IAllocatorUniquePtr<void>& external_data,
+                             ExternalDataMapper* external_data_mapper = nullptr) {
   // query length if it is 0
   if (length == 0) {
     // The return type of std::filesystem::file_size is uintmax_t which could be bigger than size_t
     length = narrow<size_t>(std::filesystem::file_size(file_path));
   }
 
+  // alias the read-only mapping of the whole file if requested
+  if (external_data_mapper != nullptr) {
+    auto status = external_data_mapper->GetData(env, file_path, offset, length, external_data);
+    if (status.IsOK()) {
+      return Status::OK();
+    }
+    LOGS_DEFAULT(WARNING) << "Falling back to a private mapping of " << PathToUTF8String(file_path.native())
+                          << ": " << status.ErrorMessage();
+  }
+
   // first, try to map into memory
   {
     Env::MappedMemoryPtr mapped_memory{};
@@ -1279,7 +1290,8 @@ static Status GetFileContent(const Env& env, const std::filesystem::path& file_p
 Status GetExtDataFromTensorProto(const Env& env,
                                  const std::filesystem::path& model_path,
                                  const ONNX_NAMESPACE::TensorProto& tensor_proto,
-                                 OrtValue& ort_value, PrepackedWeightsForGraph* prepacked_info) {
+                                 OrtValue& ort_value, PrepackedWeightsForGraph* prepacked_info,
+                                 ExternalDataMapper* external_data_mapper) {
   ORT_ENFORCE(HasExternalData(tensor_proto), "TensorProto for: ",
               tensor_proto.name(), "Expected to have external data");
 
@@ -1315,6 +1327,7 @@ Status GetExtDataFromTensorProto(const Env& env,
     Tensor::InitOrtValue(std::move(tensor), ort_value);
   } else {
 #if defined(__wasm__)
+    ORT_UNUSED_PARAMETER(external_data_mapper);
     ORT_RETURN_IF(file_offset < 0 || file_offset + raw_data_safe_len >= 4294967296,
                   "External initializer: ", tensor_proto.name(), " offset: ", file_offset,
                   " size to read: ", static_cast<size_t>(raw_data_safe_len),
@@ -1351,9 +1364,14 @@ Status GetExtDataFromTensorProto(const Env& env,
                   " size to read: ", static_cast<size_t>(raw_data_safe_len), " given file_length: ", file_length,
                   " are out of bounds or can not be read in full.");
 
+    // The byte order is swapped in place below, which a read-only mapping does not allow.
+    if constexpr (endian::native != endian::little) {
+      external_data_mapper = nullptr;
+    }
+
     IAllocatorUniquePtr<void> ext_data_buf;
     ORT_RETURN_IF_ERROR(GetFileContent(env, external_data_file_path, file_offset, raw_data_safe_len,
-                                       ext_data_buf));
+                                       ext_data_buf, external_data_mapper));
 
     // Data on disk is little endian
     if constexpr (endian::native != endian::little) {
@@ -1394,9 +1412,10 @@ Status GetExtDataFromTensorProto(const Env& env,
                         "Pre-packed blob: ", key, " offset: ", blob_offset, " file_length: ", file_length,
                         " is out of bounds and can not read in full");
 
+          // Kernels may write into the pre-packed buffers they are handed through UseSharedPrePackedBuffers,
+          // so the blobs always get a private copy-on-write mapping rather than a slice of the read-only one.
           IAllocatorUniquePtr<void> data_ptr;
-          ORT_RETURN_IF_ERROR(GetFileContent(env, external_data_file_path, blob_offset, blob_length,
-                                             data_ptr));
+          ORT_RETURN_IF_ERROR(GetFileContent(env, external_data_file_path, blob_offset, blob_length, data_ptr));
           prepacked_weights.buffers_.push_back(std::move(data_ptr));
           prepacked_weights.buffer_sizes_.push_back(blob_length);
         }
@@ -15,6 +15,7 @@
 #include "core/framework/allocator.h"
 #include "core/framework/endian_utils.h"
 #include "core/framework/external_data_loader.h"
+#include "core/framework/external_data_mapper.h"
 #include "core/framework/mem_buffer.h"
 #include "core/framework/ort_value.h"
 #include "core/framework/prepacked_weights_container.h"
@@ -215,10 +216,13 @@ constexpr const ORTCHAR_T* kTensorProtoMemoryAddressTag = ORT_TSTR("*/_ORT_MEM_A
 /// <param name="tensor_proto">tensor proto containing external data</param>
 /// <param name="ort_value">output ort value</param>
 /// <param name="prepacked_info">optional pre-packed weight data output container</param>
+/// <param name="external_data_mapper">optional mapper. If provided, the tensor and the pre-packed weights alias
+/// a read-only mapping of the whole external data file shared by all the initializers stored in it.</param>
 /// <returns>Status</returns>
 common::Status GetExtDataFromTensorProto(const Env& env, const std::filesystem::path& model_path,
                                          const ONNX_NAMESPACE::TensorProto& tensor_proto,
-                                         OrtValue& ort_value, PrepackedWeightsForGraph* prepacked_info = nullptr);
+                                         OrtValue& ort_value, PrepackedWeightsForGraph* prepacked_info = nullptr,
+                                         ExternalDataMapper* external_data_mapper = nullptr);
 
 // Given a tensor proto with external data obtain a tensor using the specified custom external data loader.
 common::Status LoadExtDataToTensorFromTensorProto(const Env& env, const std::filesystem::path& model_path,
@@ -1350,8 +1350,8 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
 constexpr const char* PagedAttention_ver1_doc = R"DOC(
 Paged Attention.
 
-This op leverages a block-based KV cache to enable continuous batching for LLMs. Currently, it is designed to work with
-the CUDA Execution Provider only.
+This op leverages a block-based KV cache to enable continuous batching for LLMs. It is supported by the CUDA and CPU
+Execution Providers.
 
 In other attention ops, batch entries typically aren't of the same length, so they are padded.
 Below is a batch with 3 sequences where * denotes a padding token.
@@ -1537,7 +1537,7 @@ ONNX_MS_OPERATOR_SET_SCHEMA(
                 "the same tensor as value_cache.",
                 "T",
                 OpSchema::Optional)
-        .TypeConstraint("T", {"tensor(float16)", "tensor(bfloat16)"}, "Constrain input and output to float tensors.")
+        .TypeConstraint("T", {"tensor(float)", "tensor(float16)", "tensor(bfloat16)"}, "Constrain input and output to float tensors.")
         .TypeConstraint("S", {"tensor(int32)"}, "Constrain Positional inputs to int tensor.")
         .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
           PagedAttentionTypeAndShapeInference(ctx);
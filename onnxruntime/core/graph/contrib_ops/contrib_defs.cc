@@ -1323,6 +1323,15 @@ ONNX_MS_OPERATOR_SET_SCHEMA(GreedySearch, 1,
                                       "This is relevant only for the GPT2 model. If this attribute is missing, the `decoder` subgraph will be used for all decoding runs",
                                       AttributeProto::GRAPH, OPTIONAL_VALUE)
                                 .Attr("decoder", "Decoder subgraph to execute in a loop.", AttributeProto::GRAPH)
+                                .Attr("draft_decoder",
+                                      "Smaller decoder subgraph for speculative decoding. It proposes `num_speculative_tokens` tokens, "
+                                      "which the `decoder` subgraph verifies in one run. It shall have the same inputs, outputs and "
+                                      "vocabulary as the `decoder` subgraph. This is relevant only for the GPT2 model with batch_size 1",
+                                      AttributeProto::GRAPH, OPTIONAL_VALUE)
+                                .Attr("num_speculative_tokens",
+                                      "Number of tokens proposed by the `draft_decoder` subgraph in each step of speculative decoding. "
+                                      "If it is 0, the `draft_decoder` subgraph is not used",
+                                      AttributeProto::INT, static_cast<int64_t>(4))
                                 .Attr("vocab_size",
                                       "Size of the vocabulary. "
                                       "If not provided, it will be inferred from the decoder subgraph's output shape",
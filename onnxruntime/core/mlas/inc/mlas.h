@@ -843,6 +843,8 @@ enum MLAS_CONV_ALGORITHM {
 #if defined(MLAS_TARGET_WASM_SCALAR) || defined(MLAS_TARGET_ARM64)
     MlasConvAlgorithmDepthwise,
 #endif
+    MlasConvAlgorithmWinograd,
+    MlasConvAlgorithmFft,
 };
 
 struct MLAS_CONV_PARAMETERS {
@@ -872,6 +874,14 @@ struct MLAS_CONV_PARAMETERS {
         struct {
             size_t ThreadStrideN;
         } ExpandThenGemmSegmented;
+        struct {
+            size_t TransformSize;
+            size_t TileHeight;
+            size_t TileWidth;
+            size_t TileCountHeight;
+            size_t TileCountWidth;
+            size_t TileBlockSize;
+        } Transform;
     } u;
 };
 
@@ -891,7 +901,45 @@ MlasConvPrepare(MLAS_CONV_PARAMETERS* Parameters,
                 const MLAS_ACTIVATION* Activation,
                 size_t* WorkingBufferSize,
                 float Beta,
-                MLAS_THREADPOOL* ThreadPool);
+                MLAS_THREADPOOL* ThreadPool,
+                bool AllowFastAlgorithms);
+
+//
+// Replaces the algorithm selected by MlasConvPrepare, for benchmarks and
+// tests. TransformSize is the size of the transformed tiles of the Winograd
+// (6 for F(4x4,3x3), 8 for F(6x6,3x3)) and FFT (16 or 32) algorithms. Returns
+// false if the algorithm does not support the convolution.
+//
+
+bool
+MLASCALL
+MlasConvSetAlgorithm(
+    MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
+//
+// The Winograd and FFT algorithms run on a transformed filter: MlasConv then
+// takes the filter packed by MlasConvPackFilter, for which
+// MlasConvPackFilterSize returns a nonzero size.
+//
+
+size_t
+MLASCALL
+MlasConvPackFilterSize(
+    const MLAS_CONV_PARAMETERS* Parameters
+    );
+
+void
+MLASCALL
+MlasConvPackFilter(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Filter,
+    void* PackedFilter
+    );
 
 void
 MLASCALL
@@ -1145,6 +1193,30 @@ MlasComputeTanh(
     size_t N
     );
 
+//
+// Reduction routines.
+//
+
+enum MLAS_REDUCE_KIND {
+    MlasReduceSum,
+    MlasReduceSumSquare,
+    MlasReduceMaximum,
+    MlasReduceMinimum,
+    MlasReduceLogSumExp,
+};
+
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND ReduceKind,
+    const float* Input,
+    float* Output,
+    size_t OuterCount,
+    size_t ReduceCount,
+    size_t InnerCount,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 //
 // Transpose routines.
 //
@@ -1579,6 +1651,56 @@ MlasRotaryEmbedOneRow(
     T* output
 );
 
+/**
+ * @brief Layer normalization or root mean square normalization of one row,
+ *        with an optional skip connection and an optional int8 quantized output.
+ *
+ *        x = Input + Skip + Bias
+ *        Output = (x - mean(x)) / sqrt(var(x) + Epsilon) * Scale + Shift
+ *
+ *        The simplified (root mean square) form drops the mean and divides x by
+ *        sqrt(mean(x * x) + Epsilon) instead. The statistics are always accumulated
+ *        in single precision.
+ *
+ * @tparam T: data type of the input and outputs, float or MLAS_FP16.
+ * @param Input:               input row, of shape [N]
+ * @param Skip:                optional skip row added to the input, of shape [N]
+ * @param Bias:                optional bias added to the input, of shape [N]
+ * @param Scale:               scale (gamma), of shape [N]
+ * @param Shift:               optional shift (beta), of shape [N]
+ * @param N:                   number of elements in the row
+ * @param Epsilon:             value added to the variance for numerical stability
+ * @param Simplified:          whether to compute the root mean square normalization
+ * @param Output:              optional normalized row, of shape [N]
+ * @param SumOutput:           optional row receiving x, of shape [N]
+ * @param QuantizedOutput:     optional normalized row quantized to symmetric int8, of shape [N]
+ * @param QuantizedScale:      receives the scale of each quantization block when QuantizedOutput
+ *                             is supplied, of shape [ceil(N / QuantizedBlockSize)]
+ * @param QuantizedBlockSize:  number of elements sharing a quantization scale, 0 for the whole row
+ * @param Mean:                optionally receives the mean of x, zero for the simplified form
+ * @param InvStdDev:           optionally receives the reciprocal of the standard deviation
+ */
+template <typename T>
+void
+MLASCALL
+MlasLayerNormalization(
+    const T* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    T* Output,
+    T* SumOutput,
+    int8_t* QuantizedOutput,
+    float* QuantizedScale,
+    size_t QuantizedBlockSize,
+    float* Mean,
+    float* InvStdDev
+);
+
 /**
  * @brief Supply matrices data information to half precision gemm functions
  */
@@ -2113,6 +2235,19 @@ struct MlasFlashAttentionThreadedArgs {
     const float* key;
     const float* value;
     float* output;
+
+    //
+    // Optional features. The defaults give plain non-causal multi-head attention over [B, N, S, H] inputs.
+    //
+
+    int kv_num_heads = 0;                       // number of K/V heads for grouped query attention, 0 means num_heads
+    size_t q_batch_stride = 0;                  // elements between batches of query, 0 means num_heads * S * H
+    const int32_t* kv_valid_lengths = nullptr;  // per batch count of valid K/V rows, nullptr means kv_sequence_length
+    bool is_causal = false;                     // queries are aligned to the end of the valid K/V rows
+    int local_window_size = -1;                 // K/V rows a query attends to (including itself), -1 means all
+    float softcap = 0.0f;                       // scores are capped by softcap * tanh(score / softcap) when positive
+    bool use_smooth_softmax = false;            // add exp(sink) to the softmax denominator
+    const float* head_sink = nullptr;           // per head sink of smooth softmax, nullptr means 0
 };
 
 /**
@@ -1006,7 +1006,8 @@ Arguments:
 
     Input - Supplies the input tensor.
 
-    Filter - Supplies the filter tensor.
+    Filter - Supplies the filter tensor, or the filter packed by
+        MlasConvPackFilter if MlasConvPackFilterSize returns a nonzero size.
 
     Bias - Optionally supplies the bias vector.
 
@@ -1024,6 +1025,11 @@ Return Value:
 
 --*/
 {
+    if (Parameters->Algorithm == MlasConvAlgorithmWinograd || Parameters->Algorithm == MlasConvAlgorithmFft) {
+        MlasConvTransform(Parameters, Input, Filter, Bias, WorkingBuffer, Output, ThreadPool);
+        return;
+    }
+
     // Override
     if(GetMlasPlatform().MlasConvOverride != nullptr &&
         GetMlasPlatform().MlasConvOverride(Parameters,Input,Filter,Bias,WorkingBuffer,Output,ThreadPool)){
@@ -1224,6 +1230,9 @@ Return Value:
 
                     break;
                 }
+
+                default:
+                    break;
             }
 
             //
@@ -1245,6 +1254,120 @@ Return Value:
 // Chance of arithmetic overflow could be reduced
 #pragma warning(disable : 26451)
 #endif
+static
+void
+MlasConvPrepareExpandThenGemm(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine prepares for a convolution operation that expands the input
+    tensor for a GEMM.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the provided and computed
+        parameters for the convolution operation.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t K = Parameters->K;
+
+    if (FilterCount > OutputSize) {
+
+        //
+        // The filter count is larger than the output dimensions, so perform the
+        // full matrix expansion and then invoke the threaded GEMM.
+        //
+
+        Parameters->Algorithm = MlasConvAlgorithmExpandThenGemm;
+
+        *WorkingBufferSize = OutputSize * K;
+
+    } else {
+
+        //
+        // Segment the operation across multiple threads by slicing the N
+        // dimension (see MlasSgemmTryMultithread).
+        //
+        // Compute the number of target threads given the complexity of the
+        // convolution operation. Small requests should run using the single
+        // threaded path.
+        //
+
+        ptrdiff_t TargetThreadCount;
+        double Complexity = double(FilterCount) * double(OutputSize) * double(K);
+
+        if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
+            TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
+        } else {
+            TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
+        }
+
+        ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+
+        if (TargetThreadCount >= MaximumThreadCount) {
+            TargetThreadCount = MaximumThreadCount;
+        }
+
+        //
+        // Compute the thread stride for slicing the N dimension.
+        //
+
+        size_t StrideN = OutputSize / TargetThreadCount;
+
+        if ((StrideN * TargetThreadCount) != OutputSize) {
+            StrideN++;
+        }
+
+        if (TargetThreadCount > 1) {
+
+            StrideN = (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+
+            if (StrideN >= OutputSize) {
+                TargetThreadCount = 1;
+            } else if (StrideN * (TargetThreadCount - 1) >= OutputSize) {
+                TargetThreadCount--;
+            }
+        }
+
+        Parameters->ThreadCount = TargetThreadCount;
+
+        Parameters->Algorithm = MlasConvAlgorithmExpandThenGemmSegmented;
+        Parameters->u.ExpandThenGemmSegmented.ThreadStrideN = StrideN;
+
+        *WorkingBufferSize = TargetThreadCount * MLAS_CONV_WORKING_BUFFER_SIZE_PER_THREAD;
+
+        if (Parameters->BatchCount > 1 || Parameters->GroupCount > 1) {
+
+            size_t WorkingBufferSizePerThread = std::max({Parameters->OutputSize * Parameters->K,
+                                                          Parameters->FilterCount * Parameters->OutputSize,
+                                                          static_cast<size_t>(MLAS_CONV_WORKING_BUFFER_SIZE_PER_THREAD)});
+            TargetThreadCount = MaximumThreadCount;
+            if (static_cast<size_t>(TargetThreadCount) >= Parameters->BatchCount * Parameters->GroupCount) {
+                TargetThreadCount = static_cast<ptrdiff_t>(Parameters->BatchCount * Parameters->GroupCount);
+            }
+            *WorkingBufferSize = TargetThreadCount * WorkingBufferSizePerThread;
+        }
+    }
+}
+
 void
 MLASCALL
 MlasConvPrepare(
@@ -1263,7 +1386,8 @@ MlasConvPrepare(
     const MLAS_ACTIVATION* Activation,
     size_t* WorkingBufferSize,
     float Beta,
-    MLAS_THREADPOOL* ThreadPool
+    MLAS_THREADPOOL* ThreadPool,
+    bool AllowFastAlgorithms
     )
 /*++
 
@@ -1307,15 +1431,28 @@ Arguments:
     WorkingBufferSize - Receives the number of elements to allocate for the
         working buffer for intermediate results.
 
+    Beta - Supplies the scale of the existing output added to the result.
+
     ThreadPool - Supplies the thread pool object to use, else nullptr if the
         base library threading support should be used.
 
+    AllowFastAlgorithms - Supplies true to allow the Winograd and FFT
+        algorithms, which round differently from the direct computation and
+        require a filter packed by MlasConvPackFilter.
+
 Return Value:
 
     None.
 
 --*/
 {
+    //
+    // An override does not set the algorithm, so start from one that does not
+    // use a transformed filter.
+    //
+
+    Parameters->Algorithm = MlasConvAlgorithmGemmDirect;
+
     // Override
     if (GetMlasPlatform().MlasConvPrepareOverride != nullptr &&
         GetMlasPlatform().MlasConvPrepareOverride(Parameters, Dimensions, BatchCount, GroupCount, InputChannels,
@@ -1440,111 +1577,105 @@ Return Value:
         }
     }
 
-    if (FilterCount > OutputSize) {
-
-        //
-        // The filter count is larger than the output dimensions, so perform the
-        // full matrix expansion and then invoke the threaded GEMM.
-        //
-
-        Parameters->Algorithm = MlasConvAlgorithmExpandThenGemm;
-
-        *WorkingBufferSize = OutputSize * K;
+    //
+    // Select the Winograd or FFT algorithm if allowed and cheaper than
+    // expanding the input.
+    //
 
-    } else {
+    if (AllowFastAlgorithms && MlasConvTransformSelect(Parameters, WorkingBufferSize)) {
+        return;
+    }
 
 #if defined(MLAS_TARGET_WASM_SCALAR) || defined(MLAS_TARGET_ARM64)
 
-        // Scalar (WASM_SCALAR) / vectorized (ARM64) direct conv for depthwise convolution.
-        // Currently only support 3x3 kernel with padding <=1 and dilations = 1
-        // and on ARM64, it is further restricted to strides = 1.
-        // TODO: support more general depthwise convolution.
-
-        // On ARM64, only support stride = 1 for depthwise conv.
-    #if defined(MLAS_TARGET_ARM64)
-        bool depthwise_conv_stride_support_check = Parameters->StrideShape[0] == 1 && Parameters->StrideShape[1] == 1;
-    #else
-        bool depthwise_conv_stride_support_check = true;
-    #endif
-
-        if (Dimensions == 2
-                && Parameters->FilterCount == 1 && Parameters->InputChannels == 1
-                && Parameters->KernelShape[0] == 3 && Parameters->KernelShape[1] == 3
-                && Parameters->Padding[0] <= 1 && Parameters->Padding[1] <= 1
-                && Parameters->Padding[2] <= 1 && Parameters->Padding[3] <= 1
-                && depthwise_conv_stride_support_check
-                && Parameters->DilationShape[0] == 1 && Parameters->DilationShape[1] == 1) {
-
-            *WorkingBufferSize = Parameters->InputShape[1] + 2;
-            Parameters->Algorithm = MlasConvAlgorithmDepthwise;
-            return;
-        }
+    // Scalar (WASM_SCALAR) / vectorized (ARM64) direct conv for depthwise convolution.
+    // Currently only support 3x3 kernel with padding <=1 and dilations = 1
+    // and on ARM64, it is further restricted to strides = 1.
+    // TODO: support more general depthwise convolution.
 
+    // On ARM64, only support stride = 1 for depthwise conv.
+#if defined(MLAS_TARGET_ARM64)
+    bool depthwise_conv_stride_support_check = Parameters->StrideShape[0] == 1 && Parameters->StrideShape[1] == 1;
+#else
+    bool depthwise_conv_stride_support_check = true;
 #endif
 
-        //
-        // Segment the operation across multiple threads by slicing the N
-        // dimension (see MlasSgemmTryMultithread).
-        //
-        // Compute the number of target threads given the complexity of the
-        // convolution operation. Small requests should run using the single
-        // threaded path.
-        //
+    if (FilterCount <= OutputSize
+            && Dimensions == 2
+            && Parameters->FilterCount == 1 && Parameters->InputChannels == 1
+            && Parameters->KernelShape[0] == 3 && Parameters->KernelShape[1] == 3
+            && Parameters->Padding[0] <= 1 && Parameters->Padding[1] <= 1
+            && Parameters->Padding[2] <= 1 && Parameters->Padding[3] <= 1
+            && depthwise_conv_stride_support_check
+            && Parameters->DilationShape[0] == 1 && Parameters->DilationShape[1] == 1) {
+
+        *WorkingBufferSize = Parameters->InputShape[1] + 2;
+        Parameters->Algorithm = MlasConvAlgorithmDepthwise;
+        return;
+    }
 
-        ptrdiff_t TargetThreadCount;
-        double Complexity = double(FilterCount) * double(OutputSize) * double(K);
+#endif
 
-        if (Complexity < double(MLAS_SGEMM_THREAD_COMPLEXITY * MLAS_MAXIMUM_THREAD_COUNT)) {
-            TargetThreadCount = ptrdiff_t(Complexity / double(MLAS_SGEMM_THREAD_COMPLEXITY)) + 1;
-        } else {
-            TargetThreadCount = MLAS_MAXIMUM_THREAD_COUNT;
-        }
+    MlasConvPrepareExpandThenGemm(Parameters, WorkingBufferSize, ThreadPool);
+}
 
-        ptrdiff_t MaximumThreadCount = MlasGetMaximumThreadCount(ThreadPool);
+bool
+MLASCALL
+MlasConvSetAlgorithm(
+    MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize,
+    size_t* WorkingBufferSize,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
 
-        if (TargetThreadCount >= MaximumThreadCount) {
-            TargetThreadCount = MaximumThreadCount;
-        }
+Routine Description:
 
-        //
-        // Compute the thread stride for slicing the N dimension.
-        //
+    This routine replaces the algorithm selected by MlasConvPrepare, so that
+    benchmarks and tests can compare the algorithms.
 
-        size_t StrideN = OutputSize / TargetThreadCount;
+Arguments:
 
-        if ((StrideN * TargetThreadCount) != OutputSize) {
-            StrideN++;
-        }
+    Parameters - Supplies the structure that stores the parameters computed by
+        MlasConvPrepare.
 
-        if (TargetThreadCount > 1) {
+    Algorithm - Supplies the algorithm to use. Both expand then GEMM
+        algorithms select the variant that fits the convolution. The GEMM
+        direct and depthwise algorithms can only be kept if MlasConvPrepare
+        selected them.
 
-            StrideN = (StrideN + MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1) & ~(MLAS_SGEMM_STRIDEN_THREAD_ALIGN - 1);
+    TransformSize - Supplies the size of the transformed tiles of the Winograd
+        and FFT algorithms.
 
-            if (StrideN >= OutputSize) {
-                TargetThreadCount = 1;
-            } else if (StrideN * (TargetThreadCount - 1) >= OutputSize) {
-                TargetThreadCount--;
-            }
-        }
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer for intermediate results.
 
-        Parameters->ThreadCount = TargetThreadCount;
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
 
-        Parameters->Algorithm = MlasConvAlgorithmExpandThenGemmSegmented;
-        Parameters->u.ExpandThenGemmSegmented.ThreadStrideN = StrideN;
+Return Value:
 
-        *WorkingBufferSize = TargetThreadCount * MLAS_CONV_WORKING_BUFFER_SIZE_PER_THREAD;
+    Returns false if the algorithm does not support the convolution, in which
+    case the parameters are unchanged.
 
-        if (Parameters->BatchCount > 1 || Parameters->GroupCount > 1) {
+--*/
+{
+    switch (Algorithm) {
 
-            size_t WorkingBufferSizePerThread = std::max({Parameters->OutputSize * Parameters->K,
-                                                          Parameters->FilterCount * Parameters->OutputSize,
-                                                          static_cast<size_t>(MLAS_CONV_WORKING_BUFFER_SIZE_PER_THREAD)});
-            TargetThreadCount = MaximumThreadCount;
-            if (static_cast<size_t>(TargetThreadCount) >= Parameters->BatchCount * Parameters->GroupCount) {
-                TargetThreadCount = static_cast<ptrdiff_t>(Parameters->BatchCount * Parameters->GroupCount);
-            }
-            *WorkingBufferSize = TargetThreadCount * WorkingBufferSizePerThread;
+        case MlasConvAlgorithmExpandThenGemm:
+        case MlasConvAlgorithmExpandThenGemmSegmented:
+        {
+            MlasConvPrepareExpandThenGemm(Parameters, WorkingBufferSize, ThreadPool);
+            return true;
         }
+
+        case MlasConvAlgorithmWinograd:
+        case MlasConvAlgorithmFft:
+            return MlasConvTransformPrepare(Parameters, Algorithm, TransformSize, WorkingBufferSize);
+
+        default:
+            return Parameters->Algorithm == Algorithm;
     }
 }
 #if defined(_MSC_VER) && !defined(__clang__)
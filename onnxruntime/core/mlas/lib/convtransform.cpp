@@ -0,0 +1,1304 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    convtransform.cpp
+
+Abstract:
+
+    This module implements the convolution algorithms that transform tiles of
+    the input and of the filter so that the convolution becomes a sum of
+    element wise products: Winograd minimal filtering F(4x4,3x3) and
+    F(6x6,3x3), and the fast Fourier transform for larger kernels.
+
+    Both algorithms split the output into tiles and transform the input under
+    each output tile into TransformPoints values per input channel. The sum
+    over the input channels is then one GEMM per transform point:
+
+        Output'[p] (FilterCount x Tiles) =
+            Filter'[p] (FilterCount x InputChannels) * Input'[p] (InputChannels x Tiles)
+
+    The FFT values are complex. Their real and imaginary parts are stored as
+    separate rows, so the FFT GEMMs are twice as large in each dimension.
+
+    The transformed filter only depends on the filter and on the transform,
+    so callers transform it once with MlasConvPackFilter.
+
+--*/
+
+#include "mlasi.h"
+
+#include <cmath>
+
+//
+// Define the Winograd transform matrices, following Lavin & Gray, "Fast
+// Algorithms for Convolutional Neural Networks". The interpolation points
+// are 0, +-1, +-2 and infinity for F(4x4,3x3), with +-1/2 added for
+// F(6x6,3x3).
+//
+
+static const float MlasWinogradF4InputTransform[6 * 6] = {
+    4.0f,  0.0f, -5.0f,  0.0f, 1.0f, 0.0f,
+    0.0f, -4.0f, -4.0f,  1.0f, 1.0f, 0.0f,
+    0.0f,  4.0f, -4.0f, -1.0f, 1.0f, 0.0f,
+    0.0f, -2.0f, -1.0f,  2.0f, 1.0f, 0.0f,
+    0.0f,  2.0f, -1.0f, -2.0f, 1.0f, 0.0f,
+    0.0f,  4.0f,  0.0f, -5.0f, 0.0f, 1.0f,
+};
+
+static const float MlasWinogradF4FilterTransform[6 * 3] = {
+    1.0f / 4.0f,   0.0f,          0.0f,
+    -1.0f / 6.0f,  -1.0f / 6.0f,  -1.0f / 6.0f,
+    -1.0f / 6.0f,  1.0f / 6.0f,   -1.0f / 6.0f,
+    1.0f / 24.0f,  1.0f / 12.0f,  1.0f / 6.0f,
+    1.0f / 24.0f,  -1.0f / 12.0f, 1.0f / 6.0f,
+    0.0f,          0.0f,          1.0f,
+};
+
+static const float MlasWinogradF4OutputTransform[4 * 6] = {
+    1.0f, 1.0f,  1.0f, 1.0f,  1.0f, 0.0f,
+    0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f,
+    0.0f, 1.0f,  1.0f, 4.0f,  4.0f, 0.0f,
+    0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f,
+};
+
+static const float MlasWinogradF6InputTransform[8 * 8] = {
+    1.0f,  0.0f, -5.25f,  0.0f,   5.25f,  0.0f, -1.0f, 0.0f,
+    0.0f,  1.0f,  1.0f,  -4.25f, -4.25f,  1.0f,  1.0f, 0.0f,
+    0.0f, -1.0f,  1.0f,   4.25f, -4.25f, -1.0f,  1.0f, 0.0f,
+    0.0f,  0.5f,  0.25f, -2.5f,  -1.25f,  2.0f,  1.0f, 0.0f,
+    0.0f, -0.5f,  0.25f,  2.5f,  -1.25f, -2.0f,  1.0f, 0.0f,
+    0.0f,  2.0f,  4.0f,  -2.5f,  -5.0f,   0.5f,  1.0f, 0.0f,
+    0.0f, -2.0f,  4.0f,   2.5f,  -5.0f,  -0.5f,  1.0f, 0.0f,
+    0.0f, -1.0f,  0.0f,   5.25f,  0.0f,  -5.25f, 0.0f, 1.0f,
+};
+
+static const float MlasWinogradF6FilterTransform[8 * 3] = {
+    1.0f,           0.0f,           0.0f,
+    -2.0f / 9.0f,   -2.0f / 9.0f,   -2.0f / 9.0f,
+    -2.0f / 9.0f,   2.0f / 9.0f,    -2.0f / 9.0f,
+    1.0f / 90.0f,   1.0f / 45.0f,   2.0f / 45.0f,
+    1.0f / 90.0f,   -1.0f / 45.0f,  2.0f / 45.0f,
+    32.0f / 45.0f,  16.0f / 45.0f,  8.0f / 45.0f,
+    32.0f / 45.0f,  -16.0f / 45.0f, 8.0f / 45.0f,
+    0.0f,           0.0f,           1.0f,
+};
+
+static const float MlasWinogradF6OutputTransform[6 * 8] = {
+    1.0f, 1.0f,  1.0f,  1.0f,  1.0f, 1.0f,       1.0f,        0.0f,
+    0.0f, 1.0f, -1.0f,  2.0f, -2.0f, 0.5f,      -0.5f,        0.0f,
+    0.0f, 1.0f,  1.0f,  4.0f,  4.0f, 0.25f,      0.25f,       0.0f,
+    0.0f, 1.0f, -1.0f,  8.0f, -8.0f, 0.125f,    -0.125f,      0.0f,
+    0.0f, 1.0f,  1.0f, 16.0f, 16.0f, 0.0625f,    0.0625f,     0.0f,
+    0.0f, 1.0f, -1.0f, 32.0f, -32.0f, 0.03125f, -0.03125f,    1.0f,
+};
+
+//
+// Define the largest transform size of the FFT algorithm and the sizes of
+// the scratch buffers that depend on it.
+//
+
+#define MLAS_CONV_FFT_MAXIMUM_SIZE 32
+#define MLAS_CONV_FFT_MAXIMUM_POINTS (MLAS_CONV_FFT_MAXIMUM_SIZE * (MLAS_CONV_FFT_MAXIMUM_SIZE / 2 + 1))
+
+//
+// Define the number of working buffer elements used for the transformed
+// input and output tiles. The tiles are processed in blocks that fit in it.
+//
+
+#define MLAS_CONV_TRANSFORM_WORKING_BUFFER_SIZE (1024 * 1024)
+
+//
+// Define the minimum number of input channels and filters for which the
+// transforms pay off.
+//
+
+#define MLAS_CONV_TRANSFORM_MINIMUM_CHANNELS 8
+
+//
+// Define the cost of one floating point operation of the transforms
+// relative to one of the GEMM kernels, which are vectorized and blocked for
+// the caches, and the cost of writing one element of the im2col expansion.
+//
+
+constexpr double MlasConvTransformFlopCost = 4.0;
+constexpr double MlasConvExpandElementCost = 2.0;
+
+struct MLAS_CONV_WINOGRAD_TRANSFORM {
+    size_t TileSize;
+    size_t TransformSize;
+    const float* InputTransform;
+    const float* FilterTransform;
+    const float* OutputTransform;
+};
+
+static const MLAS_CONV_WINOGRAD_TRANSFORM MlasConvWinogradTransforms[] = {
+    {4, 6, MlasWinogradF4InputTransform, MlasWinogradF4FilterTransform, MlasWinogradF4OutputTransform},
+    {6, 8, MlasWinogradF6InputTransform, MlasWinogradF6FilterTransform, MlasWinogradF6OutputTransform},
+};
+
+static const MLAS_CONV_WINOGRAD_TRANSFORM*
+MlasConvGetWinogradTransform(
+    size_t TransformSize
+    )
+{
+    for (const auto& Transform : MlasConvWinogradTransforms) {
+        if (Transform.TransformSize == TransformSize) {
+            return &Transform;
+        }
+    }
+
+    return nullptr;
+}
+
+struct MLAS_CONV_FFT_TWIDDLES {
+    float Cos[MLAS_CONV_FFT_MAXIMUM_SIZE / 2];
+    float Sin[MLAS_CONV_FFT_MAXIMUM_SIZE / 2];
+
+    MLAS_CONV_FFT_TWIDDLES()
+    {
+        for (size_t k = 0; k < MLAS_CONV_FFT_MAXIMUM_SIZE / 2; k++) {
+            const double Angle = 2.0 * 3.14159265358979323846 * double(k) / double(MLAS_CONV_FFT_MAXIMUM_SIZE);
+            Cos[k] = float(std::cos(Angle));
+            Sin[k] = float(std::sin(Angle));
+        }
+    }
+};
+
+static void
+MlasConvFft(
+    float* Real,
+    float* Imaginary,
+    size_t N,
+    bool Inverse
+    )
+/*++
+
+Routine Description:
+
+    This routine computes an unnormalized in place radix-2 discrete Fourier
+    transform of N complex values.
+
+Arguments:
+
+    Real - Supplies the real parts, which are replaced by the transform.
+
+    Imaginary - Supplies the imaginary parts, which are replaced by the
+        transform.
+
+    N - Supplies the power of two number of values, at most
+        MLAS_CONV_FFT_MAXIMUM_SIZE.
+
+    Inverse - Supplies true to compute the inverse transform.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    static const MLAS_CONV_FFT_TWIDDLES Twiddles;
+
+    for (size_t i = 1, j = 0; i < N; i++) {
+
+        size_t Bit = N >> 1;
+
+        for (; (j & Bit) != 0; Bit >>= 1) {
+            j ^= Bit;
+        }
+
+        j ^= Bit;
+
+        if (i < j) {
+            std::swap(Real[i], Real[j]);
+            std::swap(Imaginary[i], Imaginary[j]);
+        }
+    }
+
+    const float Sign = Inverse ? 1.0f : -1.0f;
+
+    for (size_t Length = 2; Length <= N; Length <<= 1) {
+
+        const size_t TwiddleStride = MLAS_CONV_FFT_MAXIMUM_SIZE / Length;
+        const size_t HalfLength = Length / 2;
+
+        for (size_t i = 0; i < N; i += Length) {
+            for (size_t k = 0; k < HalfLength; k++) {
+
+                const float WReal = Twiddles.Cos[k * TwiddleStride];
+                const float WImaginary = Sign * Twiddles.Sin[k * TwiddleStride];
+
+                const size_t a = i + k;
+                const size_t b = a + HalfLength;
+
+                const float TReal = Real[b] * WReal - Imaginary[b] * WImaginary;
+                const float TImaginary = Real[b] * WImaginary + Imaginary[b] * WReal;
+
+                Real[b] = Real[a] - TReal;
+                Imaginary[b] = Imaginary[a] - TImaginary;
+                Real[a] += TReal;
+                Imaginary[a] += TImaginary;
+            }
+        }
+    }
+}
+
+static void
+MlasConvFftForward2D(
+    const float* Tile,
+    size_t N,
+    float* Real,
+    float* Imaginary
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the two dimensional discrete Fourier transform of a
+    real N x N tile. Only the columns 0 to N/2 of the transform are computed,
+    the others are their complex conjugates.
+
+Arguments:
+
+    Tile - Supplies the N x N real values.
+
+    N - Supplies the transform size.
+
+    Real - Receives the N x (N/2 + 1) real parts of the transform.
+
+    Imaginary - Receives the N x (N/2 + 1) imaginary parts of the transform.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t Columns = N / 2 + 1;
+
+    float RowReal[MLAS_CONV_FFT_MAXIMUM_SIZE];
+    float RowImaginary[MLAS_CONV_FFT_MAXIMUM_SIZE];
+
+    for (size_t u = 0; u < N; u++) {
+
+        std::copy_n(Tile + u * N, N, RowReal);
+        std::fill_n(RowImaginary, N, 0.0f);
+
+        MlasConvFft(RowReal, RowImaginary, N, false);
+
+        std::copy_n(RowReal, Columns, Real + u * Columns);
+        std::copy_n(RowImaginary, Columns, Imaginary + u * Columns);
+    }
+
+    for (size_t v = 0; v < Columns; v++) {
+
+        for (size_t u = 0; u < N; u++) {
+            RowReal[u] = Real[u * Columns + v];
+            RowImaginary[u] = Imaginary[u * Columns + v];
+        }
+
+        MlasConvFft(RowReal, RowImaginary, N, false);
+
+        for (size_t u = 0; u < N; u++) {
+            Real[u * Columns + v] = RowReal[u];
+            Imaginary[u * Columns + v] = RowImaginary[u];
+        }
+    }
+}
+
+static void
+MlasConvFftInverse2D(
+    float* Real,
+    float* Imaginary,
+    size_t N,
+    size_t Rows,
+    float* Tile
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the first rows of the unnormalized two dimensional
+    inverse discrete Fourier transform of a spectrum whose columns N/2 + 1 to
+    N - 1 are the complex conjugates of the columns N/2 - 1 to 1, so that the
+    result is real.
+
+Arguments:
+
+    Real - Supplies the N x (N/2 + 1) real parts of the spectrum. The buffer is
+        used as scratch.
+
+    Imaginary - Supplies the N x (N/2 + 1) imaginary parts of the spectrum. The
+        buffer is used as scratch.
+
+    N - Supplies the transform size.
+
+    Rows - Supplies the number of rows of the result to compute.
+
+    Tile - Receives the Rows x N real values.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t Columns = N / 2 + 1;
+
+    float RowReal[MLAS_CONV_FFT_MAXIMUM_SIZE];
+    float RowImaginary[MLAS_CONV_FFT_MAXIMUM_SIZE];
+
+    for (size_t v = 0; v < Columns; v++) {
+
+        for (size_t u = 0; u < N; u++) {
+            RowReal[u] = Real[u * Columns + v];
+            RowImaginary[u] = Imaginary[u * Columns + v];
+        }
+
+        MlasConvFft(RowReal, RowImaginary, N, true);
+
+        for (size_t u = 0; u < Rows; u++) {
+            Real[u * Columns + v] = RowReal[u];
+            Imaginary[u * Columns + v] = RowImaginary[u];
+        }
+    }
+
+    for (size_t u = 0; u < Rows; u++) {
+
+        for (size_t v = 0; v < Columns; v++) {
+            RowReal[v] = Real[u * Columns + v];
+            RowImaginary[v] = Imaginary[u * Columns + v];
+        }
+
+        for (size_t v = Columns; v < N; v++) {
+            RowReal[v] = Real[u * Columns + N - v];
+            RowImaginary[v] = -Imaginary[u * Columns + N - v];
+        }
+
+        MlasConvFft(RowReal, RowImaginary, N, true);
+
+        std::copy_n(RowReal, N, Tile + u * N);
+    }
+}
+
+static void
+MlasConvTransformGetShape(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    size_t* TransformPoints,
+    size_t* ComplexFactor
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the number of transform points of a tile and whether
+    the values at these points are complex.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    TransformPoints - Receives the number of transform points.
+
+    ComplexFactor - Receives 2 if the transformed values are complex, else 1.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t TransformSize = Parameters->u.Transform.TransformSize;
+
+    if (Parameters->Algorithm == MlasConvAlgorithmWinograd) {
+        *TransformPoints = TransformSize * TransformSize;
+        *ComplexFactor = 1;
+    } else {
+        *TransformPoints = TransformSize * (TransformSize / 2 + 1);
+        *ComplexFactor = 2;
+    }
+}
+
+static bool
+MlasConvTransformIsSupported(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize
+    )
+/*++
+
+Routine Description:
+
+    This routine returns whether the transform algorithm supports the
+    convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Algorithm - Supplies MlasConvAlgorithmWinograd or MlasConvAlgorithmFft.
+
+    TransformSize - Supplies the size of the transformed tiles.
+
+Return Value:
+
+    Returns true if the algorithm supports the convolution.
+
+--*/
+{
+    if (Parameters->Dimensions != 2) {
+        return false;
+    }
+
+    for (size_t dim = 0; dim < 2; dim++) {
+        if (Parameters->StrideShape[dim] != 1 || Parameters->DilationShape[dim] != 1) {
+            return false;
+        }
+    }
+
+    const size_t KernelHeight = Parameters->KernelShape[0];
+    const size_t KernelWidth = Parameters->KernelShape[1];
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        return KernelHeight == 3 && KernelWidth == 3 && MlasConvGetWinogradTransform(TransformSize) != nullptr;
+    }
+
+    if (Algorithm == MlasConvAlgorithmFft) {
+        return (TransformSize == 16 || TransformSize == 32) &&
+               KernelHeight <= TransformSize / 2 + 1 && KernelWidth <= TransformSize / 2 + 1;
+    }
+
+    return false;
+}
+
+static void
+MlasConvTransformSetAlgorithm(
+    MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize,
+    size_t* WorkingBufferSize
+    )
+/*++
+
+Routine Description:
+
+    This routine stores the parameters of a supported transform algorithm and
+    computes the working buffer size it needs.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the convolution
+        parameters.
+
+    Algorithm - Supplies MlasConvAlgorithmWinograd or MlasConvAlgorithmFft.
+
+    TransformSize - Supplies the size of the transformed tiles.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t TileHeight;
+    size_t TileWidth;
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+        TileHeight = MlasConvGetWinogradTransform(TransformSize)->TileSize;
+        TileWidth = TileHeight;
+    } else {
+        TileHeight = TransformSize - Parameters->KernelShape[0] + 1;
+        TileWidth = TransformSize - Parameters->KernelShape[1] + 1;
+    }
+
+    Parameters->Algorithm = Algorithm;
+    Parameters->u.Transform.TransformSize = TransformSize;
+    Parameters->u.Transform.TileHeight = TileHeight;
+    Parameters->u.Transform.TileWidth = TileWidth;
+    Parameters->u.Transform.TileCountHeight = MlasDivRoundup(Parameters->OutputShape[0], TileHeight);
+    Parameters->u.Transform.TileCountWidth = MlasDivRoundup(Parameters->OutputShape[1], TileWidth);
+
+    //
+    // Size the blocks of tiles so that their transformed input and output fit
+    // in the working buffer.
+    //
+
+    size_t TransformPoints;
+    size_t ComplexFactor;
+
+    MlasConvTransformGetShape(Parameters, &TransformPoints, &ComplexFactor);
+
+    const size_t TileCount = Parameters->u.Transform.TileCountHeight * Parameters->u.Transform.TileCountWidth;
+    const size_t ElementsPerTile = TransformPoints * ComplexFactor * (Parameters->InputChannels + Parameters->FilterCount);
+
+    size_t TileBlockSize = MLAS_CONV_TRANSFORM_WORKING_BUFFER_SIZE / ElementsPerTile;
+
+    if (TileBlockSize < 8) {
+        TileBlockSize = 8;
+    }
+
+    if (TileBlockSize > TileCount) {
+        TileBlockSize = TileCount;
+    }
+
+    Parameters->u.Transform.TileBlockSize = TileBlockSize;
+
+    *WorkingBufferSize = TileBlockSize * ElementsPerTile;
+}
+
+static double
+MlasConvTransformCost(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize
+    )
+/*++
+
+Routine Description:
+
+    This routine estimates the cost of running a convolution with a supported
+    transform algorithm, in units of GEMM floating point operations.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Algorithm - Supplies MlasConvAlgorithmWinograd or MlasConvAlgorithmFft.
+
+    TransformSize - Supplies the size of the transformed tiles.
+
+Return Value:
+
+    Returns the estimated cost.
+
+--*/
+{
+    const double InputChannels = double(Parameters->InputChannels);
+    const double FilterCount = double(Parameters->FilterCount);
+    const double Alpha = double(TransformSize);
+
+    double TileHeight;
+    double TileWidth;
+    double GemmFlops;
+    double InputTransformFlops;
+    double OutputTransformFlops;
+
+    if (Algorithm == MlasConvAlgorithmWinograd) {
+
+        TileHeight = double(MlasConvGetWinogradTransform(TransformSize)->TileSize);
+        TileWidth = TileHeight;
+
+        GemmFlops = 2.0 * Alpha * Alpha * FilterCount * InputChannels;
+
+        //
+        // The input transform is two Alpha x Alpha matrix products, the output
+        // transform reduces Alpha x Alpha values to TileSize x TileSize.
+        //
+
+        InputTransformFlops = 4.0 * Alpha * Alpha * Alpha;
+        OutputTransformFlops = 2.0 * TileHeight * Alpha * (Alpha + TileHeight);
+
+    } else {
+
+        TileHeight = double(TransformSize - Parameters->KernelShape[0] + 1);
+        TileWidth = double(TransformSize - Parameters->KernelShape[1] + 1);
+
+        const double Points = Alpha * (Alpha / 2.0 + 1.0);
+
+        GemmFlops = 2.0 * Points * (2.0 * FilterCount) * (2.0 * InputChannels);
+
+        //
+        // A complex FFT of size N takes about 5 N log2(N) operations. The
+        // forward transform runs over all the rows and half the columns, the
+        // inverse one over half the columns and the rows of the output tile.
+        //
+
+        const double FftFlops = 5.0 * Alpha * std::log2(Alpha);
+
+        InputTransformFlops = (Alpha + Alpha / 2.0 + 1.0) * FftFlops;
+        OutputTransformFlops = (Alpha / 2.0 + 1.0 + TileHeight) * FftFlops;
+    }
+
+    const size_t TileCount = size_t(std::ceil(double(Parameters->OutputShape[0]) / TileHeight) *
+                                    std::ceil(double(Parameters->OutputShape[1]) / TileWidth));
+
+    //
+    // The tiles are the columns of the GEMMs, which lose efficiency below the
+    // column stride of the kernels.
+    //
+
+    const size_t GemmColumns = MlasDivRoundup(TileCount, MLAS_SGEMM_STRIDEN_THREAD_ALIGN) * MLAS_SGEMM_STRIDEN_THREAD_ALIGN;
+
+    return double(GemmColumns) * GemmFlops +
+           double(TileCount) * MlasConvTransformFlopCost *
+               (InputChannels * InputTransformFlops + FilterCount * OutputTransformFlops);
+}
+
+bool
+MlasConvTransformSelect(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    )
+/*++
+
+Routine Description:
+
+    This routine selects the cheapest transform algorithm for a convolution if
+    it is estimated to be cheaper than expanding the input for a GEMM.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the convolution
+        parameters.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer if an algorithm is selected.
+
+Return Value:
+
+    Returns true if a transform algorithm was selected.
+
+--*/
+{
+    if (Parameters->InputChannels < MLAS_CONV_TRANSFORM_MINIMUM_CHANNELS ||
+        Parameters->FilterCount < MLAS_CONV_TRANSFORM_MINIMUM_CHANNELS) {
+        return false;
+    }
+
+    const double ExpandedElements = double(Parameters->OutputSize) * double(Parameters->K);
+
+    double BestCost = 2.0 * double(Parameters->FilterCount) * ExpandedElements +
+                      MlasConvExpandElementCost * ExpandedElements;
+
+    MLAS_CONV_ALGORITHM BestAlgorithm = MlasConvAlgorithmWinograd;
+    size_t BestTransformSize = 0;
+
+    static const struct {
+        MLAS_CONV_ALGORITHM Algorithm;
+        size_t TransformSize;
+    } Candidates[] = {
+        {MlasConvAlgorithmWinograd, 6},
+        {MlasConvAlgorithmWinograd, 8},
+        {MlasConvAlgorithmFft, 16},
+        {MlasConvAlgorithmFft, 32},
+    };
+
+    for (const auto& Candidate : Candidates) {
+
+        if (!MlasConvTransformIsSupported(Parameters, Candidate.Algorithm, Candidate.TransformSize)) {
+            continue;
+        }
+
+        const double Cost = MlasConvTransformCost(Parameters, Candidate.Algorithm, Candidate.TransformSize);
+
+        if (Cost < BestCost) {
+            BestCost = Cost;
+            BestAlgorithm = Candidate.Algorithm;
+            BestTransformSize = Candidate.TransformSize;
+        }
+    }
+
+    if (BestTransformSize == 0) {
+        return false;
+    }
+
+    MlasConvTransformSetAlgorithm(Parameters, BestAlgorithm, BestTransformSize, WorkingBufferSize);
+
+    return true;
+}
+
+bool
+MlasConvTransformPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize,
+    size_t* WorkingBufferSize
+    )
+/*++
+
+Routine Description:
+
+    This routine selects a given transform algorithm for a convolution.
+
+Arguments:
+
+    Parameters - Supplies the structure that stores the convolution
+        parameters.
+
+    Algorithm - Supplies MlasConvAlgorithmWinograd or MlasConvAlgorithmFft.
+
+    TransformSize - Supplies the size of the transformed tiles.
+
+    WorkingBufferSize - Receives the number of elements to allocate for the
+        working buffer if the algorithm is selected.
+
+Return Value:
+
+    Returns true if the algorithm supports the convolution.
+
+--*/
+{
+    if (!MlasConvTransformIsSupported(Parameters, Algorithm, TransformSize)) {
+        return false;
+    }
+
+    MlasConvTransformSetAlgorithm(Parameters, Algorithm, TransformSize, WorkingBufferSize);
+
+    return true;
+}
+
+size_t
+MLASCALL
+MlasConvPackFilterSize(
+    const MLAS_CONV_PARAMETERS* Parameters
+    )
+/*++
+
+Routine Description:
+
+    This routine returns the size of the buffer to allocate for the filter
+    packed by MlasConvPackFilter.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters computed by MlasConvPrepare.
+
+Return Value:
+
+    Returns the size in bytes of the packed filter, or zero if the algorithm
+    selected for the convolution uses the filter as is.
+
+--*/
+{
+    if (Parameters->Algorithm != MlasConvAlgorithmWinograd &&
+        Parameters->Algorithm != MlasConvAlgorithmFft) {
+        return 0;
+    }
+
+    size_t TransformPoints;
+    size_t ComplexFactor;
+
+    MlasConvTransformGetShape(Parameters, &TransformPoints, &ComplexFactor);
+
+    return Parameters->GroupCount * TransformPoints * ComplexFactor * Parameters->FilterCount *
+           ComplexFactor * Parameters->InputChannels * sizeof(float);
+}
+
+void
+MLASCALL
+MlasConvPackFilter(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Filter,
+    void* PackedFilter
+    )
+/*++
+
+Routine Description:
+
+    This routine packs the filter for the algorithm selected for the
+    convolution. The packed filter can be used by any convolution with the
+    same filter shape, algorithm and transform size.
+
+    For each group, the packed filter holds one matrix per transform point.
+    For Winograd, the matrix is FilterCount x InputChannels. For FFT, the
+    rows 0 to FilterCount - 1 produce the real parts of the output and the
+    next FilterCount rows its imaginary parts, and the columns take the real
+    parts of the input channels and then their imaginary parts.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters computed by MlasConvPrepare.
+
+    Filter - Supplies the filter tensor.
+
+    PackedFilter - Supplies the buffer of MlasConvPackFilterSize bytes that
+        receives the packed filter.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t KernelHeight = Parameters->KernelShape[0];
+    const size_t KernelWidth = Parameters->KernelShape[1];
+    const size_t KernelSize = KernelHeight * KernelWidth;
+    const size_t TransformSize = Parameters->u.Transform.TransformSize;
+
+    size_t TransformPoints;
+    size_t ComplexFactor;
+
+    MlasConvTransformGetShape(Parameters, &TransformPoints, &ComplexFactor);
+
+    const size_t Rows = ComplexFactor * FilterCount;
+    const size_t Columns = ComplexFactor * InputChannels;
+
+    float* Packed = reinterpret_cast<float*>(PackedFilter);
+
+    for (size_t group = 0; group < Parameters->GroupCount; group++) {
+
+        for (size_t f = 0; f < FilterCount; f++) {
+            for (size_t c = 0; c < InputChannels; c++) {
+
+                const float* Kernel = Filter + (f * InputChannels + c) * KernelSize;
+
+                if (Parameters->Algorithm == MlasConvAlgorithmWinograd) {
+
+                    //
+                    // Compute G * g * G^T.
+                    //
+
+                    const float* G = MlasConvGetWinogradTransform(TransformSize)->FilterTransform;
+
+                    float Temp[8 * 3];
+
+                    for (size_t i = 0; i < TransformSize; i++) {
+                        for (size_t j = 0; j < 3; j++) {
+                            Temp[i * 3 + j] = G[i * 3 + 0] * Kernel[0 * 3 + j] +
+                                              G[i * 3 + 1] * Kernel[1 * 3 + j] +
+                                              G[i * 3 + 2] * Kernel[2 * 3 + j];
+                        }
+                    }
+
+                    for (size_t i = 0; i < TransformSize; i++) {
+                        for (size_t j = 0; j < TransformSize; j++) {
+                            const float Value = Temp[i * 3 + 0] * G[j * 3 + 0] +
+                                                Temp[i * 3 + 1] * G[j * 3 + 1] +
+                                                Temp[i * 3 + 2] * G[j * 3 + 2];
+                            Packed[(i * TransformSize + j) * Rows * Columns + f * Columns + c] = Value;
+                        }
+                    }
+
+                } else {
+
+                    //
+                    // Transform the zero padded kernel. The output is the inverse
+                    // transform of the product of the input transform and of the
+                    // conjugate of the kernel transform, which is a correlation.
+                    // The normalization of the inverse transform is folded in.
+                    //
+
+                    float Tile[MLAS_CONV_FFT_MAXIMUM_SIZE * MLAS_CONV_FFT_MAXIMUM_SIZE];
+                    float Real[MLAS_CONV_FFT_MAXIMUM_POINTS];
+                    float Imaginary[MLAS_CONV_FFT_MAXIMUM_POINTS];
+
+                    std::fill_n(Tile, TransformSize * TransformSize, 0.0f);
+
+                    for (size_t kh = 0; kh < KernelHeight; kh++) {
+                        std::copy_n(Kernel + kh * KernelWidth, KernelWidth, Tile + kh * TransformSize);
+                    }
+
+                    MlasConvFftForward2D(Tile, TransformSize, Real, Imaginary);
+
+                    const float Scale = 1.0f / float(TransformSize * TransformSize);
+
+                    for (size_t p = 0; p < TransformPoints; p++) {
+
+                        const float WReal = Real[p] * Scale;
+                        const float WImaginary = Imaginary[p] * Scale;
+
+                        float* Point = Packed + p * Rows * Columns;
+
+                        Point[f * Columns + c] = WReal;
+                        Point[f * Columns + InputChannels + c] = WImaginary;
+                        Point[(FilterCount + f) * Columns + c] = -WImaginary;
+                        Point[(FilterCount + f) * Columns + InputChannels + c] = WReal;
+                    }
+                }
+            }
+        }
+
+        Filter += FilterCount * InputChannels * KernelSize;
+        Packed += TransformPoints * Rows * Columns;
+    }
+}
+
+static void
+MlasConvTransformInputTile(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    size_t TileIndex,
+    float* Tile
+    )
+/*++
+
+Routine Description:
+
+    This routine copies the input values under an output tile, which are zero
+    outside of the input.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input channel.
+
+    TileIndex - Supplies the index of the output tile.
+
+    Tile - Receives the TransformSize x TransformSize input values.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t TransformSize = Parameters->u.Transform.TransformSize;
+    const size_t InputHeight = Parameters->InputShape[0];
+    const size_t InputWidth = Parameters->InputShape[1];
+
+    const size_t TileRow = TileIndex / Parameters->u.Transform.TileCountWidth;
+    const size_t TileColumn = TileIndex % Parameters->u.Transform.TileCountWidth;
+
+    //
+    // The origin may be negative because of the padding, which wraps around
+    // and is then rejected by the unsigned bounds checks.
+    //
+
+    const size_t OriginHeight = TileRow * Parameters->u.Transform.TileHeight - Parameters->Padding[0];
+    const size_t OriginWidth = TileColumn * Parameters->u.Transform.TileWidth - Parameters->Padding[1];
+
+    for (size_t i = 0; i < TransformSize; i++) {
+
+        const size_t ih = OriginHeight + i;
+
+        if (ih >= InputHeight) {
+            std::fill_n(Tile + i * TransformSize, TransformSize, 0.0f);
+            continue;
+        }
+
+        const float* Row = Input + ih * InputWidth;
+
+        for (size_t j = 0; j < TransformSize; j++) {
+            const size_t iw = OriginWidth + j;
+            Tile[i * TransformSize + j] = (iw < InputWidth) ? Row[iw] : 0.0f;
+        }
+    }
+}
+
+static void
+MlasConvTransformOutputTile(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Tile,
+    size_t TileStride,
+    size_t TileIndex,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine stores the part of an output tile that lies in the output,
+    adding the existing output scaled by Beta.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Tile - Supplies the output tile.
+
+    TileStride - Supplies the number of elements between two rows of the tile.
+
+    TileIndex - Supplies the index of the output tile.
+
+    Output - Supplies the output channel.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t OutputHeight = Parameters->OutputShape[0];
+    const size_t OutputWidth = Parameters->OutputShape[1];
+    const size_t TileHeight = Parameters->u.Transform.TileHeight;
+    const size_t TileWidth = Parameters->u.Transform.TileWidth;
+    const float Beta = Parameters->Beta;
+
+    const size_t OriginHeight = (TileIndex / Parameters->u.Transform.TileCountWidth) * TileHeight;
+    const size_t OriginWidth = (TileIndex % Parameters->u.Transform.TileCountWidth) * TileWidth;
+
+    const size_t Rows = std::min(TileHeight, OutputHeight - OriginHeight);
+    const size_t Columns = std::min(TileWidth, OutputWidth - OriginWidth);
+
+    for (size_t i = 0; i < Rows; i++) {
+
+        float* Row = Output + (OriginHeight + i) * OutputWidth + OriginWidth;
+
+        if (Beta == 0.0f) {
+            std::copy_n(Tile + i * TileStride, Columns, Row);
+        } else {
+            for (size_t j = 0; j < Columns; j++) {
+                Row[j] = Tile[i * TileStride + j] + Beta * Row[j];
+            }
+        }
+    }
+}
+
+void
+MlasConvTransform(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine implements the convolution operation with the Winograd or
+    FFT algorithm.
+
+Arguments:
+
+    Parameters - Supplies the structure that contains the convolution
+        parameters.
+
+    Input - Supplies the input tensor.
+
+    PackedFilter - Supplies the filter packed by MlasConvPackFilter.
+
+    Bias - Optionally supplies the bias vector.
+
+    WorkingBuffer - Supplies a working buffer sized to the number of elements
+        returned by MlasConvPrepare.
+
+    Output - Supplies the output tensor.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    const size_t FilterCount = Parameters->FilterCount;
+    const size_t InputChannels = Parameters->InputChannels;
+    const size_t InputSize = Parameters->InputSize;
+    const size_t OutputSize = Parameters->OutputSize;
+    const size_t TransformSize = Parameters->u.Transform.TransformSize;
+    const size_t TileCount = Parameters->u.Transform.TileCountHeight * Parameters->u.Transform.TileCountWidth;
+    const size_t TileBlockSize = Parameters->u.Transform.TileBlockSize;
+    const bool IsWinograd = (Parameters->Algorithm == MlasConvAlgorithmWinograd);
+
+    const MLAS_CONV_WINOGRAD_TRANSFORM* Winograd =
+        IsWinograd ? MlasConvGetWinogradTransform(TransformSize) : nullptr;
+
+    size_t TransformPoints;
+    size_t ComplexFactor;
+
+    MlasConvTransformGetShape(Parameters, &TransformPoints, &ComplexFactor);
+
+    const size_t Rows = ComplexFactor * FilterCount;
+    const size_t Columns = ComplexFactor * InputChannels;
+    const size_t PackedFilterGroupSize = TransformPoints * Rows * Columns;
+
+    float* TransformedInput = WorkingBuffer;
+    float* TransformedOutput = WorkingBuffer + TransformPoints * Columns * TileBlockSize;
+
+    std::vector<MLAS_SGEMM_DATA_PARAMS> GemmData(TransformPoints);
+
+    for (size_t batch = 0; batch < Parameters->BatchCount; batch++) {
+
+        const float* filter = PackedFilter;
+        const float* bias = Bias;
+
+        for (size_t group = 0; group < Parameters->GroupCount; group++) {
+
+            for (size_t TileStart = 0; TileStart < TileCount; TileStart += TileBlockSize) {
+
+                const size_t TileBlockCount = std::min(TileBlockSize, TileCount - TileStart);
+
+                //
+                // Transform the input tiles. The value of the transform point p
+                // for channel c and tile t is stored at row c of the matrix p,
+                // which is InputChannels (x 2 for complex values) x TileBlockCount.
+                //
+
+                MlasTrySimpleParallel(
+                    ThreadPool, ptrdiff_t(InputChannels * TileBlockCount),
+                    [&](ptrdiff_t Index) {
+                        const size_t c = size_t(Index) / TileBlockCount;
+                        const size_t t = size_t(Index) % TileBlockCount;
+
+                        float Tile[MLAS_CONV_FFT_MAXIMUM_SIZE * MLAS_CONV_FFT_MAXIMUM_SIZE];
+
+                        MlasConvTransformInputTile(Parameters, Input + c * InputSize, TileStart + t, Tile);
+
+                        if (IsWinograd) {
+
+                            //
+                            // Compute B^T * d * B.
+                            //
+
+                            const float* BT = Winograd->InputTransform;
+
+                            float Temp[8 * 8];
+
+                            for (size_t i = 0; i < TransformSize; i++) {
+                                for (size_t j = 0; j < TransformSize; j++) {
+                                    float Sum = 0.0f;
+                                    for (size_t k = 0; k < TransformSize; k++) {
+                                        Sum += BT[i * TransformSize + k] * Tile[k * TransformSize + j];
+                                    }
+                                    Temp[i * TransformSize + j] = Sum;
+                                }
+                            }
+
+                            for (size_t i = 0; i < TransformSize; i++) {
+                                for (size_t j = 0; j < TransformSize; j++) {
+                                    float Sum = 0.0f;
+                                    for (size_t k = 0; k < TransformSize; k++) {
+                                        Sum += Temp[i * TransformSize + k] * BT[j * TransformSize + k];
+                                    }
+                                    TransformedInput[((i * TransformSize + j) * Columns + c) * TileBlockCount + t] = Sum;
+                                }
+                            }
+
+                        } else {
+
+                            float Real[MLAS_CONV_FFT_MAXIMUM_POINTS];
+                            float Imaginary[MLAS_CONV_FFT_MAXIMUM_POINTS];
+
+                            MlasConvFftForward2D(Tile, TransformSize, Real, Imaginary);
+
+                            for (size_t p = 0; p < TransformPoints; p++) {
+                                float* Point = TransformedInput + p * Columns * TileBlockCount;
+                                Point[c * TileBlockCount + t] = Real[p];
+                                Point[(InputChannels + c) * TileBlockCount + t] = Imaginary[p];
+                            }
+                        }
+                    });
+
+                //
+                // Reduce over the input channels with one GEMM per transform point.
+                //
+
+                for (size_t p = 0; p < TransformPoints; p++) {
+                    GemmData[p].A = filter + p * Rows * Columns;
+                    GemmData[p].lda = Columns;
+                    GemmData[p].B = TransformedInput + p * Columns * TileBlockCount;
+                    GemmData[p].ldb = TileBlockCount;
+                    GemmData[p].C = TransformedOutput + p * Rows * TileBlockCount;
+                    GemmData[p].ldc = TileBlockCount;
+                    GemmData[p].alpha = 1.0f;
+                    GemmData[p].beta = 0.0f;
+                }
+
+                MlasGemmBatch(CblasNoTrans, CblasNoTrans, Rows, TileBlockCount, Columns,
+                              GemmData.data(), TransformPoints, ThreadPool);
+
+                //
+                // Transform the output tiles back.
+                //
+
+                MlasTrySimpleParallel(
+                    ThreadPool, ptrdiff_t(FilterCount * TileBlockCount),
+                    [&](ptrdiff_t Index) {
+                        const size_t f = size_t(Index) / TileBlockCount;
+                        const size_t t = size_t(Index) % TileBlockCount;
+
+                        float Tile[MLAS_CONV_FFT_MAXIMUM_SIZE * MLAS_CONV_FFT_MAXIMUM_SIZE];
+                        size_t TileStride;
+
+                        if (IsWinograd) {
+
+                            //
+                            // Compute A^T * m * A.
+                            //
+
+                            const float* AT = Winograd->OutputTransform;
+                            const size_t TileSize = Winograd->TileSize;
+
+                            float Transformed[8 * 8];
+                            float Temp[6 * 8];
+
+                            for (size_t p = 0; p < TransformPoints; p++) {
+                                Transformed[p] = TransformedOutput[(p * Rows + f) * TileBlockCount + t];
+                            }
+
+                            for (size_t i = 0; i < TileSize; i++) {
+                                for (size_t j = 0; j < TransformSize; j++) {
+                                    float Sum = 0.0f;
+                                    for (size_t k = 0; k < TransformSize; k++) {
+                                        Sum += AT[i * TransformSize + k] * Transformed[k * TransformSize + j];
+                                    }
+                                    Temp[i * TransformSize + j] = Sum;
+                                }
+                            }
+
+                            for (size_t i = 0; i < TileSize; i++) {
+                                for (size_t j = 0; j < TileSize; j++) {
+                                    float Sum = 0.0f;
+                                    for (size_t k = 0; k < TransformSize; k++) {
+                                        Sum += Temp[i * TransformSize + k] * AT[j * TransformSize + k];
+                                    }
+                                    Tile[i * TileSize + j] = Sum;
+                                }
+                            }
+
+                            TileStride = TileSize;
+
+                        } else {
+
+                            float Real[MLAS_CONV_FFT_MAXIMUM_POINTS];
+                            float Imaginary[MLAS_CONV_FFT_MAXIMUM_POINTS];
+
+                            for (size_t p = 0; p < TransformPoints; p++) {
+                                const float* Point = TransformedOutput + p * Rows * TileBlockCount;
+                                Real[p] = Point[f * TileBlockCount + t];
+                                Imaginary[p] = Point[(FilterCount + f) * TileBlockCount + t];
+                            }
+
+                            MlasConvFftInverse2D(Real, Imaginary, TransformSize,
+                                                 Parameters->u.Transform.TileHeight, Tile);
+
+                            TileStride = TransformSize;
+                        }
+
+                        MlasConvTransformOutputTile(Parameters, Tile, TileStride, TileStart + t,
+                                                    Output + f * OutputSize);
+                    });
+            }
+
+            //
+            // Apply the activation with optional bias.
+            //
+
+            MlasActivation(Parameters->Activation, Output, bias, FilterCount, OutputSize, OutputSize);
+
+            //
+            // Advance the buffer pointers.
+            //
+
+            if (bias != nullptr) {
+                bias += FilterCount;
+            }
+
+            filter += PackedFilterGroupSize;
+            Input += InputChannels * InputSize;
+            Output += FilterCount * OutputSize;
+        }
+    }
+}
@@ -24,6 +24,12 @@ MlasFlashAttentionThreaded(
     const float* key = args->key;
     const float* value = args->value;
     float* output = args->output;
+    ptrdiff_t kv_num_heads = args->kv_num_heads > 0 ? static_cast<ptrdiff_t>(args->kv_num_heads) : num_heads;
+    ptrdiff_t kv_num_heads_factor = num_heads / kv_num_heads;
+    ptrdiff_t q_batch_stride = args->q_batch_stride > 0 ? static_cast<ptrdiff_t>(args->q_batch_stride)
+                                                        : num_heads * q_sequence_length * qk_head_size;
+    const bool is_causal = args->is_causal;
+    const ptrdiff_t local_window_size = static_cast<ptrdiff_t>(args->local_window_size);
 
 #if defined(MLAS_TARGET_AMD64) || defined(MLAS_TARGET_LARCH64)
     auto&& mlas_platform = GetMlasPlatform();
@@ -51,17 +57,51 @@ MlasFlashAttentionThreaded(
         ptrdiff_t head_idx = batch_idx % num_heads;
         batch_idx /= num_heads;
 
+        //
+        // The valid K/V rows of this batch entry. With causal masking, the query rows are aligned to the end of
+        // the valid K/V rows, so query row i attends to K/V rows [0, past_sequence_length + i].
+        //
+        ptrdiff_t kv_valid_length = args->kv_valid_lengths != nullptr
+                                        ? std::min(static_cast<ptrdiff_t>(args->kv_valid_lengths[batch_idx]), kv_sequence_length)
+                                        : kv_sequence_length;
+        ptrdiff_t past_sequence_length = is_causal ? std::max(kv_valid_length - q_sequence_length, ptrdiff_t{0}) : 0;
+
+        size_t row_size_q_capped = static_cast<size_t>(std::min(q_block_size, q_sequence_length - q_idx));
+
+        //
+        // Only the K/V blocks that are visible to at least one query row of this chunk are visited.
+        //
+        ptrdiff_t kv_start = 0;
+        ptrdiff_t kv_end = kv_valid_length;
+        if (is_causal) {
+            kv_end = std::min(kv_end, past_sequence_length + q_idx + static_cast<ptrdiff_t>(row_size_q_capped));
+        }
+        if (local_window_size >= 0) {
+            kv_start = std::max(past_sequence_length + q_idx + 1 - local_window_size, ptrdiff_t{0});
+            kv_start -= kv_start % kv_block_size;
+        }
+
         char* buffer_current_thread = reinterpret_cast<char*>(buffer) + thread_id * buffer_size_per_thread;
         float* l = reinterpret_cast<float*>(buffer_current_thread);
         float* m = l + q_block_size;
+        //
+        // Smooth softmax adds exp(sink) to the denominator, which is the same as starting the running sum with
+        // one element of value sink.
+        //
+        const float sink = args->head_sink != nullptr ? args->head_sink[head_idx] : 0.0f;
         for (ptrdiff_t t = 0; t < q_block_size; ++t) {
-            m[t] = std::numeric_limits<float>::lowest();
+            m[t] = args->use_smooth_softmax ? sink : std::numeric_limits<float>::lowest();
+            l[t] = args->use_smooth_softmax ? 1.0f : 0.0f;
         }
         float* intermediate = m + q_block_size;
         float* temp_output = intermediate + q_block_size * kv_block_size;
         float negmax = 0;
 
-        for (ptrdiff_t ir = 0; ir < kv_sequence_length; ir += kv_block_size) {
+        if (kv_start >= kv_end) {
+            std::fill_n(temp_output, row_size_q_capped * v_head_size, 0.0f);
+        }
+
+        for (ptrdiff_t ir = kv_start; ir < kv_end; ir += kv_block_size) {
             /*
                 S = Q[batch_idx, head_idx, q_idx:q_idx+q_block_size, :] * (K[batch_idx, head_idx, ir:ir+kv_block_size, :]).T
                 old_m = m
@@ -71,13 +111,12 @@ MlasFlashAttentionThreaded(
                 l = exp(diff) * l + rowsum(S)
                 O = diag(exp(diff)) * O + S * V[batch_idx, head_idx, ir:ir+kv_block_size, :]
             */
-            ptrdiff_t h = batch_idx * num_heads + head_idx;
-            const float* inputQ = query + (h * q_sequence_length + q_idx) * qk_head_size;
-            const float* inputK = key + (h * kv_sequence_length + ir) * qk_head_size;
-            const float* inputV = value + (h * kv_sequence_length + ir) * v_head_size;
+            ptrdiff_t h_kv = batch_idx * kv_num_heads + head_idx / kv_num_heads_factor;
+            const float* inputQ = query + batch_idx * q_batch_stride + (head_idx * q_sequence_length + q_idx) * qk_head_size;
+            const float* inputK = key + (h_kv * kv_sequence_length + ir) * qk_head_size;
+            const float* inputV = value + (h_kv * kv_sequence_length + ir) * v_head_size;
 
-            size_t row_size_q_capped = static_cast<size_t>(std::min(q_block_size, q_sequence_length - q_idx));
-            size_t row_size_kv_capped = static_cast<size_t>(std::min(kv_block_size, kv_sequence_length - ir));
+            size_t row_size_kv_capped = static_cast<size_t>(std::min(kv_block_size, kv_end - ir));
 
             MlasSgemmOperation(CBLAS_TRANSPOSE::CblasNoTrans,
                      CBLAS_TRANSPOSE::CblasTrans,
@@ -96,6 +135,27 @@ MlasFlashAttentionThreaded(
             for (ptrdiff_t irow = 0; irow < static_cast<ptrdiff_t>(row_size_q_capped); ++irow) {
                 float* p = intermediate + irow * row_size_kv_capped;
 
+                if (args->softcap > 0.0f) {
+                    MlasComputeSoftcap(p, p, row_size_kv_capped, args->softcap);
+                }
+
+                //
+                // Mask the columns of this block that lie outside of [row_start, row_end) for this query row.
+                //
+                ptrdiff_t row_start = 0;
+                ptrdiff_t row_end = kv_end;
+                if (is_causal) {
+                    row_end = std::min(row_end, past_sequence_length + q_idx + irow + 1);
+                }
+                if (local_window_size >= 0) {
+                    row_start = past_sequence_length + q_idx + irow + 1 - local_window_size;
+                }
+                for (ptrdiff_t icol = 0; icol < static_cast<ptrdiff_t>(row_size_kv_capped); ++icol) {
+                    if (ir + icol < row_start || ir + icol >= row_end) {
+                        p[icol] = -std::numeric_limits<float>::infinity();
+                    }
+                }
+
 #if defined(MLAS_TARGET_AMD64) || defined(MLAS_TARGET_LARCH64)
                 float rowmax = mlas_platform.ReduceMaximumF32Kernel(p, row_size_kv_capped);
 #else
@@ -112,17 +172,13 @@ MlasFlashAttentionThreaded(
                 float rowsum = MlasComputeSumExpF32Kernel(p, p, row_size_kv_capped, &negmax);
 #endif
 
-                // Note: for ir == 0, there is actually no need to calculate exp_diff
-                if (ir != 0) {
-                    float exp_diff = std::exp(m_diff);
-                    l[irow] = exp_diff * l[irow] + rowsum;
-
+                // Note: for the first block, the old result is zero and does not need to be scaled.
+                float exp_diff = std::exp(m_diff);
+                l[irow] = exp_diff * l[irow] + rowsum;
+                if (ir != kv_start) {
                     for (ptrdiff_t icol = 0; icol < v_head_size; ++icol) {
                         temp_output[irow * v_head_size + icol] = exp_diff * temp_output[irow * v_head_size + icol];
                     }
-                } else {
-                    l[irow] = rowsum;
-                    // When ir == 0, there is no need to scale the old result because it is zero.
                 }
             }
             MlasSgemmOperation(CBLAS_TRANSPOSE::CblasNoTrans,
@@ -135,17 +191,18 @@ MlasFlashAttentionThreaded(
                      row_size_kv_capped,
                      inputV,
                      static_cast<size_t>(v_head_size),
-                     ir == 0 ? 0.0f : 1.0f,
+                     ir == kv_start ? 0.0f : 1.0f,
                      temp_output,
                      static_cast<size_t>(v_head_size));
         }
 
         float* output_row = output + ((batch_idx * q_sequence_length + q_idx) * num_heads + head_idx) * v_head_size;
-        ptrdiff_t row_size_q_valid = std::min(q_block_size, q_sequence_length - q_idx);
+        ptrdiff_t row_size_q_valid = static_cast<ptrdiff_t>(row_size_q_capped);
         // TODO: leverage advanced instruction sets
         for (ptrdiff_t irow = 0; irow < row_size_q_valid; ++irow) {
+            // Rows without any visible K/V row (e.g. padding of a shorter prompt) produce zeros.
             for (ptrdiff_t icol = 0; icol < v_head_size; ++icol) {
-                output_row[icol] = temp_output[irow * v_head_size + icol] / l[irow];
+                output_row[icol] = l[irow] > 0.0f ? temp_output[irow * v_head_size + icol] / l[irow] : 0.0f;
             }
             output_row += num_heads * v_head_size;
         }
@@ -0,0 +1,400 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    layernorm.cpp
+
+Abstract:
+
+    This module implements the layer normalization and root mean square
+    normalization of a row, with an optional residual (skip) connection and an
+    optional fused quantization of the normalized output to int8.
+
+    The row is streamed through the kernel in chunks that are converted to
+    single precision on the fly, so half precision rows never need a full
+    single precision copy.
+
+--*/
+
+#include "mlasi.h"
+
+//
+// Number of elements of a row converted to single precision at a time.
+//
+
+constexpr size_t MLAS_LAYER_NORM_CHUNK_SIZE = 256;
+
+//
+// Largest magnitude of the symmetric int8 quantized output.
+//
+
+constexpr float MLAS_LAYER_NORM_QUANTIZED_MAXIMUM = 127.0f;
+
+template <typename T>
+MLAS_FORCEINLINE
+const float*
+MlasLayerNormLoadChunk(
+    const T* Input,
+    const float* Skip,
+    const float* Bias,
+    size_t Count,
+    float* Buffer
+    )
+/*++
+
+Routine Description:
+
+    This routine loads a chunk of the row to be normalized as single precision
+    values, adding the skip and bias vectors when supplied.
+
+Arguments:
+
+    Input - Supplies the input chunk.
+
+    Skip - Optionally supplies the skip chunk added to the input.
+
+    Bias - Optionally supplies the bias chunk added to the input.
+
+    Count - Supplies the number of elements in the chunk.
+
+    Buffer - Supplies a scratch buffer of at least Count elements.
+
+Return Value:
+
+    Returns the address of the single precision chunk, which is either Input or
+    Buffer.
+
+--*/
+{
+    const float* x;
+
+    if constexpr (std::is_same_v<T, float>) {
+        if (Skip == nullptr && Bias == nullptr) {
+            return Input;
+        }
+        x = Input;
+    } else {
+        MlasConvertHalfToFloatBuffer(Input, Buffer, Count);
+        x = Buffer;
+    }
+
+    if (Skip == nullptr && Bias == nullptr) {
+        return x;
+    }
+
+    size_t i = 0;
+
+    for (; i + 4 <= Count; i += 4) {
+        MLAS_FLOAT32X4 Vector = MlasLoadFloat32x4(x + i);
+        if (Skip != nullptr) {
+            Vector = MlasAddFloat32x4(Vector, MlasLoadFloat32x4(Skip + i));
+        }
+        if (Bias != nullptr) {
+            Vector = MlasAddFloat32x4(Vector, MlasLoadFloat32x4(Bias + i));
+        }
+        MlasStoreFloat32x4(Buffer + i, Vector);
+    }
+
+    for (; i < Count; i++) {
+        float Value = x[i];
+        if (Skip != nullptr) {
+            Value += Skip[i];
+        }
+        if (Bias != nullptr) {
+            Value += Bias[i];
+        }
+        Buffer[i] = Value;
+    }
+
+    return Buffer;
+}
+
+template <typename T>
+MLAS_FORCEINLINE
+void
+MlasLayerNormStoreChunk(
+    const float* Source,
+    T* Destination,
+    size_t Count
+    )
+{
+    if constexpr (std::is_same_v<T, float>) {
+        if (Source != Destination) {
+            std::copy_n(Source, Count, Destination);
+        }
+    } else {
+        MlasConvertFloatToHalfBuffer(Source, Destination, Count);
+    }
+}
+
+MLAS_FORCEINLINE
+float
+MlasLayerNormNormalizeChunk(
+    const float* Input,
+    const float* Scale,
+    const float* Shift,
+    float Multiplier,
+    float Offset,
+    size_t Count,
+    float* Output
+    )
+/*++
+
+Routine Description:
+
+    This routine computes Output = (Input * Multiplier + Offset) * Scale + Shift
+    for a chunk of the row.
+
+Arguments:
+
+    Input - Supplies the single precision chunk to normalize.
+
+    Scale - Supplies the scale (gamma) chunk.
+
+    Shift - Optionally supplies the shift (beta) chunk.
+
+    Multiplier - Supplies the reciprocal of the standard deviation of the row.
+
+    Offset - Supplies the negated mean of the row times Multiplier.
+
+    Count - Supplies the number of elements in the chunk.
+
+    Output - Supplies the single precision output chunk.
+
+Return Value:
+
+    Returns the largest magnitude of the output chunk.
+
+--*/
+{
+    const MLAS_FLOAT32X4 MultiplierVector = MlasBroadcastFloat32x4(Multiplier);
+    const MLAS_FLOAT32X4 OffsetVector = MlasBroadcastFloat32x4(Offset);
+    const MLAS_FLOAT32X4 SignMask = MlasBroadcastFloat32x4(-0.0f);
+    MLAS_FLOAT32X4 MaximumVector = MlasZeroFloat32x4();
+
+    size_t i = 0;
+
+    for (; i + 4 <= Count; i += 4) {
+        MLAS_FLOAT32X4 Vector = MlasLoadFloat32x4(Input + i);
+        Vector = MlasMultiplyAddFloat32x4(Vector, MultiplierVector, OffsetVector);
+        if (Shift != nullptr) {
+            Vector = MlasMultiplyAddFloat32x4(Vector, MlasLoadFloat32x4(Scale + i), MlasLoadFloat32x4(Shift + i));
+        } else {
+            Vector = MlasMultiplyFloat32x4(Vector, MlasLoadFloat32x4(Scale + i));
+        }
+        MlasStoreFloat32x4(Output + i, Vector);
+        MaximumVector = MlasMaximumFloat32x4(MaximumVector, MlasAndNotFloat32x4(SignMask, Vector));
+    }
+
+    float Maximum = MlasReduceMaximumFloat32x4(MaximumVector);
+
+    for (; i < Count; i++) {
+        float Value = (Input[i] * Multiplier + Offset) * Scale[i];
+        if (Shift != nullptr) {
+            Value += Shift[i];
+        }
+        Output[i] = Value;
+        Maximum = std::max(Maximum, std::fabs(Value));
+    }
+
+    return Maximum;
+}
+
+template <typename T>
+void
+MLASCALL
+MlasLayerNormalization(
+    const T* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    T* Output,
+    T* SumOutput,
+    int8_t* QuantizedOutput,
+    float* QuantizedScale,
+    size_t QuantizedBlockSize,
+    float* Mean,
+    float* InvStdDev
+    )
+/*++
+
+Routine Description:
+
+    This routine normalizes a row. See the declaration in mlas.h for the
+    description of the arguments.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(float LoadBuffer[MLAS_LAYER_NORM_CHUNK_SIZE], 16);
+    MLAS_DECLSPEC_ALIGN(float NormalizeBuffer[MLAS_LAYER_NORM_CHUNK_SIZE], 16);
+
+    //
+    // Accumulate the sum and the sum of squares of the row, storing the sum of
+    // the input, skip and bias when requested.
+    //
+
+    MLAS_FLOAT32X4 SumVector = MlasZeroFloat32x4();
+    MLAS_FLOAT32X4 SumSquareVector = MlasZeroFloat32x4();
+    float Sum = 0.0f;
+    float SumSquare = 0.0f;
+
+    for (size_t c = 0; c < N; c += MLAS_LAYER_NORM_CHUNK_SIZE) {
+        const size_t Count = std::min(MLAS_LAYER_NORM_CHUNK_SIZE, N - c);
+        const float* x = MlasLayerNormLoadChunk(Input + c, Skip != nullptr ? Skip + c : nullptr,
+                                                Bias != nullptr ? Bias + c : nullptr, Count, LoadBuffer);
+
+        size_t i = 0;
+
+        for (; i + 4 <= Count; i += 4) {
+            MLAS_FLOAT32X4 Vector = MlasLoadFloat32x4(x + i);
+            SumVector = MlasAddFloat32x4(SumVector, Vector);
+            SumSquareVector = MlasMultiplyAddFloat32x4(Vector, Vector, SumSquareVector);
+        }
+
+        for (; i < Count; i++) {
+            Sum += x[i];
+            SumSquare += x[i] * x[i];
+        }
+
+        if (SumOutput != nullptr) {
+            MlasLayerNormStoreChunk(x, SumOutput + c, Count);
+        }
+    }
+
+    Sum += MlasReduceAddFloat32x4(SumVector);
+    SumSquare += MlasReduceAddFloat32x4(SumSquareVector);
+
+    const float RowMean = Simplified ? 0.0f : Sum / float(N);
+    const float Variance = std::max(SumSquare / float(N) - RowMean * RowMean, 0.0f);
+    const float Multiplier = 1.0f / std::sqrt(Variance + Epsilon);
+    const float Offset = -RowMean * Multiplier;
+
+    if (Mean != nullptr) {
+        *Mean = RowMean;
+    }
+
+    if (InvStdDev != nullptr) {
+        *InvStdDev = Multiplier;
+    }
+
+    //
+    // Normalize the row one quantization block at a time. The normalized
+    // values of a block are recomputed for quantization once the largest
+    // magnitude of the block is known, unless they can be read back from a
+    // single precision output.
+    //
+
+    if (QuantizedOutput == nullptr || QuantizedBlockSize == 0) {
+        QuantizedBlockSize = N;
+    }
+
+    for (size_t b = 0; b < N; b += QuantizedBlockSize) {
+        const size_t BlockEnd = std::min(b + QuantizedBlockSize, N);
+        float Maximum = 0.0f;
+
+        for (size_t c = b; c < BlockEnd; c += MLAS_LAYER_NORM_CHUNK_SIZE) {
+            const size_t Count = std::min(MLAS_LAYER_NORM_CHUNK_SIZE, BlockEnd - c);
+            const float* x = MlasLayerNormLoadChunk(Input + c, Skip != nullptr ? Skip + c : nullptr,
+                                                    Bias != nullptr ? Bias + c : nullptr, Count, LoadBuffer);
+
+            float* y = NormalizeBuffer;
+            if constexpr (std::is_same_v<T, float>) {
+                if (Output != nullptr) {
+                    y = Output + c;
+                }
+            }
+
+            const float ChunkMaximum = MlasLayerNormNormalizeChunk(x, Scale + c, Shift != nullptr ? Shift + c : nullptr,
+                                                                   Multiplier, Offset, Count, y);
+            Maximum = std::max(Maximum, ChunkMaximum);
+
+            if (Output != nullptr) {
+                MlasLayerNormStoreChunk(y, Output + c, Count);
+            }
+        }
+
+        if (QuantizedOutput == nullptr) {
+            continue;
+        }
+
+        const float BlockScale = Maximum / MLAS_LAYER_NORM_QUANTIZED_MAXIMUM;
+        const float QuantizeScale = BlockScale > 0.0f ? BlockScale : 1.0f;
+        QuantizedScale[b / QuantizedBlockSize] = BlockScale;
+
+        for (size_t c = b; c < BlockEnd; c += MLAS_LAYER_NORM_CHUNK_SIZE) {
+            const size_t Count = std::min(MLAS_LAYER_NORM_CHUNK_SIZE, BlockEnd - c);
+            const float* y = NormalizeBuffer;
+
+            bool Normalized = false;
+            if constexpr (std::is_same_v<T, float>) {
+                if (Output != nullptr) {
+                    y = Output + c;
+                    Normalized = true;
+                }
+            }
+
+            if (!Normalized) {
+                const float* x = MlasLayerNormLoadChunk(Input + c, Skip != nullptr ? Skip + c : nullptr,
+                                                        Bias != nullptr ? Bias + c : nullptr, Count, LoadBuffer);
+                MlasLayerNormNormalizeChunk(x, Scale + c, Shift != nullptr ? Shift + c : nullptr,
+                                            Multiplier, Offset, Count, NormalizeBuffer);
+            }
+
+            MlasQuantizeLinear<int8_t>(y, QuantizedOutput + c, Count, QuantizeScale, 0);
+        }
+    }
+}
+
+template
+void
+MLASCALL
+MlasLayerNormalization<float>(
+    const float* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    float* Output,
+    float* SumOutput,
+    int8_t* QuantizedOutput,
+    float* QuantizedScale,
+    size_t QuantizedBlockSize,
+    float* Mean,
+    float* InvStdDev
+    );
+
+template
+void
+MLASCALL
+MlasLayerNormalization<MLAS_FP16>(
+    const MLAS_FP16* Input,
+    const float* Skip,
+    const float* Bias,
+    const float* Scale,
+    const float* Shift,
+    size_t N,
+    float Epsilon,
+    bool Simplified,
+    MLAS_FP16* Output,
+    MLAS_FP16* SumOutput,
+    int8_t* QuantizedOutput,
+    float* QuantizedScale,
+    size_t QuantizedBlockSize,
+    float* Mean,
+    float* InvStdDev
+    );
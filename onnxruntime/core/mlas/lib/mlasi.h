@@ -1627,6 +1627,35 @@ MlasFp32FromBits(
 #pragma warning(pop)
 #endif
 
+//
+// Convolution algorithms that transform tiles of the input.
+//
+
+bool
+MlasConvTransformSelect(
+    MLAS_CONV_PARAMETERS* Parameters,
+    size_t* WorkingBufferSize
+    );
+
+bool
+MlasConvTransformPrepare(
+    MLAS_CONV_PARAMETERS* Parameters,
+    MLAS_CONV_ALGORITHM Algorithm,
+    size_t TransformSize,
+    size_t* WorkingBufferSize
+    );
+
+void
+MlasConvTransform(
+    const MLAS_CONV_PARAMETERS* Parameters,
+    const float* Input,
+    const float* PackedFilter,
+    const float* Bias,
+    float* WorkingBuffer,
+    float* Output,
+    MLAS_THREADPOOL* ThreadPool
+    );
+
 #if defined(MLAS_TARGET_WASM_SCALAR) || defined(MLAS_TARGET_ARM64)
 
 
@@ -0,0 +1,611 @@
+/*++
+
+Copyright (c) Microsoft Corporation. All rights reserved.
+
+Licensed under the MIT License.
+
+Module Name:
+
+    reduce.cpp
+
+Abstract:
+
+    This module implements the reduction of the middle axis of a tensor
+    viewed as [OuterCount, ReduceCount, InnerCount].
+
+    When InnerCount is one, each output is the reduction of a contiguous row.
+    Otherwise, the output columns are split into blocks that stay in the first
+    level cache and the rows of the reduced axis are accumulated into them one
+    after the other, so that the input is read sequentially.
+
+--*/
+
+#include "mlasi.h"
+
+#include <vector>
+
+//
+// Number of adjacent output columns accumulated by one unit of work.
+//
+
+constexpr size_t MLAS_REDUCE_COLUMN_BLOCK_SIZE = 2048;
+
+//
+// Minimum number of input elements reduced by one thread.
+//
+
+constexpr size_t MLAS_REDUCE_THREAD_ELEMENTS = 16384;
+
+//
+// Define the operators used to accumulate the reduced values. Each operator
+// provides the scalar and vector forms of:
+//
+//  Initialize  - converts the first value into an accumulator.
+//  Accumulate  - adds a value to an accumulator.
+//  Combine     - merges two accumulators.
+//  Reduce      - merges the lanes of a vector accumulator.
+//
+
+struct MLAS_REDUCE_SUM_OPERATOR {
+    static float Initialize(float Value) { return Value; }
+    static MLAS_FLOAT32X4 Initialize(MLAS_FLOAT32X4 Value) { return Value; }
+    static float Accumulate(float Accumulator, float Value) { return Accumulator + Value; }
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Value)
+    {
+        return MlasAddFloat32x4(Accumulator, Value);
+    }
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasAddFloat32x4(Vector1, Vector2);
+    }
+    static float Reduce(MLAS_FLOAT32X4 Vector) { return MlasReduceAddFloat32x4(Vector); }
+};
+
+struct MLAS_REDUCE_SUM_SQUARE_OPERATOR {
+    static float Initialize(float Value) { return Value * Value; }
+    static MLAS_FLOAT32X4 Initialize(MLAS_FLOAT32X4 Value) { return MlasMultiplyFloat32x4(Value, Value); }
+    static float Accumulate(float Accumulator, float Value) { return Accumulator + Value * Value; }
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Value)
+    {
+        return MlasMultiplyAddFloat32x4(Value, Value, Accumulator);
+    }
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasAddFloat32x4(Vector1, Vector2);
+    }
+    static float Reduce(MLAS_FLOAT32X4 Vector) { return MlasReduceAddFloat32x4(Vector); }
+};
+
+struct MLAS_REDUCE_MAXIMUM_OPERATOR {
+    static float Initialize(float Value) { return Value; }
+    static MLAS_FLOAT32X4 Initialize(MLAS_FLOAT32X4 Value) { return Value; }
+    static float Accumulate(float Accumulator, float Value) { return std::max(Accumulator, Value); }
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Value)
+    {
+        return MlasMaximumFloat32x4(Accumulator, Value);
+    }
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasMaximumFloat32x4(Vector1, Vector2);
+    }
+    static float Reduce(MLAS_FLOAT32X4 Vector) { return MlasReduceMaximumFloat32x4(Vector); }
+};
+
+struct MLAS_REDUCE_MINIMUM_OPERATOR {
+    static float Initialize(float Value) { return Value; }
+    static MLAS_FLOAT32X4 Initialize(MLAS_FLOAT32X4 Value) { return Value; }
+    static float Accumulate(float Accumulator, float Value) { return std::min(Accumulator, Value); }
+    static MLAS_FLOAT32X4 Accumulate(MLAS_FLOAT32X4 Accumulator, MLAS_FLOAT32X4 Value)
+    {
+        return MlasMinimumFloat32x4(Accumulator, Value);
+    }
+    static MLAS_FLOAT32X4 Combine(MLAS_FLOAT32X4 Vector1, MLAS_FLOAT32X4 Vector2)
+    {
+        return MlasMinimumFloat32x4(Vector1, Vector2);
+    }
+    static float Reduce(MLAS_FLOAT32X4 Vector) { return MlasReduceMinimumFloat32x4(Vector); }
+};
+
+template<typename Operator>
+float
+MlasReduceRow(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a contiguous row.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process, which must be non-zero.
+
+Return Value:
+
+    Returns the reduced value.
+
+--*/
+{
+    float Accumulator;
+
+    if (N >= 4) {
+        MLAS_FLOAT32X4 Accumulator0 = Operator::Initialize(MlasLoadFloat32x4(Input));
+
+        Input += 4;
+        N -= 4;
+
+        if (N >= 12) {
+            MLAS_FLOAT32X4 Accumulator1 = Operator::Initialize(MlasLoadFloat32x4(Input));
+            MLAS_FLOAT32X4 Accumulator2 = Operator::Initialize(MlasLoadFloat32x4(Input + 4));
+            MLAS_FLOAT32X4 Accumulator3 = Operator::Initialize(MlasLoadFloat32x4(Input + 8));
+
+            Input += 12;
+            N -= 12;
+
+            while (N >= 16) {
+                Accumulator0 = Operator::Accumulate(Accumulator0, MlasLoadFloat32x4(Input));
+                Accumulator1 = Operator::Accumulate(Accumulator1, MlasLoadFloat32x4(Input + 4));
+                Accumulator2 = Operator::Accumulate(Accumulator2, MlasLoadFloat32x4(Input + 8));
+                Accumulator3 = Operator::Accumulate(Accumulator3, MlasLoadFloat32x4(Input + 12));
+
+                Input += 16;
+                N -= 16;
+            }
+
+            Accumulator0 = Operator::Combine(Accumulator0, Accumulator1);
+            Accumulator2 = Operator::Combine(Accumulator2, Accumulator3);
+            Accumulator0 = Operator::Combine(Accumulator0, Accumulator2);
+        }
+
+        while (N >= 4) {
+            Accumulator0 = Operator::Accumulate(Accumulator0, MlasLoadFloat32x4(Input));
+
+            Input += 4;
+            N -= 4;
+        }
+
+        Accumulator = Operator::Reduce(Accumulator0);
+
+    } else {
+
+        Accumulator = Operator::Initialize(*Input);
+
+        Input += 1;
+        N -= 1;
+    }
+
+    while (N > 0) {
+        Accumulator = Operator::Accumulate(Accumulator, *Input);
+
+        Input += 1;
+        N -= 1;
+    }
+
+    return Accumulator;
+}
+
+template<typename Operator>
+void
+MlasReduceColumns(
+    const float* Input,
+    float* Output,
+    size_t ReduceCount,
+    size_t InputStride,
+    size_t CountN
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a block of adjacent columns.
+
+Arguments:
+
+    Input - Supplies the first element of the block in the first row.
+
+    Output - Supplies the output buffer.
+
+    ReduceCount - Supplies the number of rows to reduce, which must be
+        non-zero.
+
+    InputStride - Supplies the number of elements between two rows.
+
+    CountN - Supplies the number of columns of the block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    size_t n = 0;
+
+    for (; n + 4 <= CountN; n += 4) {
+        MlasStoreFloat32x4(Output + n, Operator::Initialize(MlasLoadFloat32x4(Input + n)));
+    }
+
+    for (; n < CountN; n++) {
+        Output[n] = Operator::Initialize(Input[n]);
+    }
+
+    for (size_t r = 1; r < ReduceCount; r++) {
+
+        Input += InputStride;
+
+        n = 0;
+
+        for (; n + 16 <= CountN; n += 16) {
+            MLAS_FLOAT32X4 Accumulator0 = MlasLoadFloat32x4(Output + n);
+            MLAS_FLOAT32X4 Accumulator1 = MlasLoadFloat32x4(Output + n + 4);
+            MLAS_FLOAT32X4 Accumulator2 = MlasLoadFloat32x4(Output + n + 8);
+            MLAS_FLOAT32X4 Accumulator3 = MlasLoadFloat32x4(Output + n + 12);
+
+            Accumulator0 = Operator::Accumulate(Accumulator0, MlasLoadFloat32x4(Input + n));
+            Accumulator1 = Operator::Accumulate(Accumulator1, MlasLoadFloat32x4(Input + n + 4));
+            Accumulator2 = Operator::Accumulate(Accumulator2, MlasLoadFloat32x4(Input + n + 8));
+            Accumulator3 = Operator::Accumulate(Accumulator3, MlasLoadFloat32x4(Input + n + 12));
+
+            MlasStoreFloat32x4(Output + n, Accumulator0);
+            MlasStoreFloat32x4(Output + n + 4, Accumulator1);
+            MlasStoreFloat32x4(Output + n + 8, Accumulator2);
+            MlasStoreFloat32x4(Output + n + 12, Accumulator3);
+        }
+
+        for (; n + 4 <= CountN; n += 4) {
+            MlasStoreFloat32x4(Output + n,
+                Operator::Accumulate(MlasLoadFloat32x4(Output + n), MlasLoadFloat32x4(Input + n)));
+        }
+
+        for (; n < CountN; n++) {
+            Output[n] = Operator::Accumulate(Output[n], Input[n]);
+        }
+    }
+}
+
+float
+MlasReduceLogSumExpRow(
+    const float* Input,
+    size_t N
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the logarithm of the sum of the exponentials of a
+    contiguous row.
+
+Arguments:
+
+    Input - Supplies the input buffer.
+
+    N - Supplies the number of elements to process, which must be non-zero.
+
+Return Value:
+
+    Returns the reduced value.
+
+--*/
+{
+#if defined(MLAS_TARGET_AMD64) || defined(MLAS_TARGET_LARCH64) || defined(MLAS_USE_SVE)
+    float Maximum = GetMlasPlatform().ReduceMaximumF32Kernel(Input, N);
+#else
+    float Maximum = MlasReduceMaximumF32Kernel(Input, N);
+#endif
+
+    //
+    // An infinite maximum is the result: shifting by it would turn the
+    // exponentials into NaNs.
+    //
+
+    if (std::isinf(Maximum)) {
+        return Maximum;
+    }
+
+    float NegativeMaximum = -Maximum;
+
+#if defined(MLAS_TARGET_AMD64) || defined(MLAS_USE_SVE)
+    float Accumulation = GetMlasPlatform().ComputeSumExpF32Kernel(Input, nullptr, N, &NegativeMaximum);
+#else
+    float Accumulation = MlasComputeSumExpF32Kernel(Input, nullptr, N, &NegativeMaximum);
+#endif
+
+    return Maximum + std::log(Accumulation);
+}
+
+void
+MlasReduceLogSumExpColumns(
+    const float* Input,
+    float* Output,
+    size_t ReduceCount,
+    size_t InputStride,
+    size_t CountN
+    )
+/*++
+
+Routine Description:
+
+    This routine computes the logarithm of the sum of the exponentials of a
+    block of adjacent columns.
+
+Arguments:
+
+    Input - Supplies the first element of the block in the first row.
+
+    Output - Supplies the output buffer.
+
+    ReduceCount - Supplies the number of rows to reduce, which must be
+        non-zero.
+
+    InputStride - Supplies the number of elements between two rows.
+
+    CountN - Supplies the number of columns of the block, which must not
+        exceed MLAS_REDUCE_COLUMN_BLOCK_SIZE.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    MLAS_DECLSPEC_ALIGN(float Accumulation[MLAS_REDUCE_COLUMN_BLOCK_SIZE], 64);
+    MLAS_DECLSPEC_ALIGN(float Exponential[MLAS_REDUCE_COLUMN_BLOCK_SIZE], 64);
+
+    //
+    // Find the maximum of each column into the output buffer, then add the
+    // exponentials of the shifted rows.
+    //
+
+    MlasReduceColumns<MLAS_REDUCE_MAXIMUM_OPERATOR>(Input, Output, ReduceCount, InputStride, CountN);
+
+    std::fill_n(Accumulation, CountN, 0.0f);
+
+    for (size_t r = 0; r < ReduceCount; r++) {
+
+        size_t n = 0;
+
+        for (; n + 4 <= CountN; n += 4) {
+            MlasStoreFloat32x4(Exponential + n,
+                MlasSubtractFloat32x4(MlasLoadFloat32x4(Input + n), MlasLoadFloat32x4(Output + n)));
+        }
+
+        for (; n < CountN; n++) {
+            Exponential[n] = Input[n] - Output[n];
+        }
+
+        MlasComputeExp(Exponential, Exponential, CountN);
+
+        n = 0;
+
+        for (; n + 4 <= CountN; n += 4) {
+            MlasStoreFloat32x4(Accumulation + n,
+                MlasAddFloat32x4(MlasLoadFloat32x4(Accumulation + n), MlasLoadFloat32x4(Exponential + n)));
+        }
+
+        for (; n < CountN; n++) {
+            Accumulation[n] += Exponential[n];
+        }
+
+        Input += InputStride;
+    }
+
+    for (size_t n = 0; n < CountN; n++) {
+        if (!std::isinf(Output[n])) {
+            Output[n] += std::log(Accumulation[n]);
+        }
+    }
+}
+
+void
+MlasReduceBlock(
+    MLAS_REDUCE_KIND ReduceKind,
+    const float* Input,
+    float* Output,
+    size_t ReduceCount,
+    size_t InnerCount,
+    size_t CountN
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces a block of adjacent columns, or a contiguous row
+    when InnerCount is one.
+
+Arguments:
+
+    ReduceKind - Supplies the kind of reduction.
+
+    Input - Supplies the first element of the block in the first row.
+
+    Output - Supplies the output buffer.
+
+    ReduceCount - Supplies the number of rows to reduce.
+
+    InnerCount - Supplies the number of elements between two rows.
+
+    CountN - Supplies the number of columns of the block.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (InnerCount == 1) {
+
+        switch (ReduceKind) {
+            case MlasReduceSum:
+                *Output = MlasReduceRow<MLAS_REDUCE_SUM_OPERATOR>(Input, ReduceCount);
+                break;
+            case MlasReduceSumSquare:
+                *Output = MlasReduceRow<MLAS_REDUCE_SUM_SQUARE_OPERATOR>(Input, ReduceCount);
+                break;
+            case MlasReduceMaximum:
+                *Output = MlasReduceRow<MLAS_REDUCE_MAXIMUM_OPERATOR>(Input, ReduceCount);
+                break;
+            case MlasReduceMinimum:
+                *Output = MlasReduceRow<MLAS_REDUCE_MINIMUM_OPERATOR>(Input, ReduceCount);
+                break;
+            case MlasReduceLogSumExp:
+                *Output = MlasReduceLogSumExpRow(Input, ReduceCount);
+                break;
+        }
+
+    } else {
+
+        switch (ReduceKind) {
+            case MlasReduceSum:
+                MlasReduceColumns<MLAS_REDUCE_SUM_OPERATOR>(Input, Output, ReduceCount, InnerCount, CountN);
+                break;
+            case MlasReduceSumSquare:
+                MlasReduceColumns<MLAS_REDUCE_SUM_SQUARE_OPERATOR>(Input, Output, ReduceCount, InnerCount, CountN);
+                break;
+            case MlasReduceMaximum:
+                MlasReduceColumns<MLAS_REDUCE_MAXIMUM_OPERATOR>(Input, Output, ReduceCount, InnerCount, CountN);
+                break;
+            case MlasReduceMinimum:
+                MlasReduceColumns<MLAS_REDUCE_MINIMUM_OPERATOR>(Input, Output, ReduceCount, InnerCount, CountN);
+                break;
+            case MlasReduceLogSumExp:
+                MlasReduceLogSumExpColumns(Input, Output, ReduceCount, InnerCount, CountN);
+                break;
+        }
+    }
+}
+
+void
+MLASCALL
+MlasReduce(
+    MLAS_REDUCE_KIND ReduceKind,
+    const float* Input,
+    float* Output,
+    size_t OuterCount,
+    size_t ReduceCount,
+    size_t InnerCount,
+    MLAS_THREADPOOL* ThreadPool
+    )
+/*++
+
+Routine Description:
+
+    This routine reduces the middle axis of a tensor viewed as
+    [OuterCount, ReduceCount, InnerCount] into [OuterCount, InnerCount].
+
+    The work is split over the outputs. When there are fewer outputs than
+    threads, the reduced axis is also split into segments whose partial
+    results are reduced in a second step.
+
+Arguments:
+
+    ReduceKind - Supplies the kind of reduction.
+
+    Input - Supplies the input buffer.
+
+    Output - Supplies the output buffer.
+
+    OuterCount - Supplies the number of independent slices.
+
+    ReduceCount - Supplies the number of elements of the reduced axis, which
+        must be non-zero.
+
+    InnerCount - Supplies the number of elements following the reduced axis.
+
+    ThreadPool - Supplies the thread pool object to use, else nullptr if the
+        base library threading support should be used.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (OuterCount == 0 || InnerCount == 0) {
+        return;
+    }
+
+    const size_t BlockSize = std::min(InnerCount, MLAS_REDUCE_COLUMN_BLOCK_SIZE);
+    const size_t ColumnBlocks = MlasDivRoundup(InnerCount, BlockSize);
+    const size_t OutputBlocks = OuterCount * ColumnBlocks;
+
+    //
+    // Limit the number of threads so that each one reduces enough elements
+    // to amortize the dispatch.
+    //
+
+    const double TotalElements = double(OuterCount) * double(ReduceCount) * double(InnerCount);
+
+    size_t TargetThreadCount = size_t(MlasGetMaximumThreadCount(ThreadPool));
+
+    if (TotalElements < double(TargetThreadCount) * double(MLAS_REDUCE_THREAD_ELEMENTS)) {
+        TargetThreadCount = size_t(TotalElements / double(MLAS_REDUCE_THREAD_ELEMENTS)) + 1;
+    }
+
+    //
+    // Split the reduced axis into segments when there are not enough blocks
+    // of outputs to occupy the threads.
+    //
+
+    size_t SegmentCount = 1;
+    size_t SegmentLength = ReduceCount;
+
+    if (OutputBlocks < TargetThreadCount) {
+
+        const size_t MinimumSegmentLength = MlasDivRoundup(MLAS_REDUCE_THREAD_ELEMENTS, BlockSize);
+
+        SegmentCount = std::min(MlasDivRoundup(TargetThreadCount, OutputBlocks),
+                                ReduceCount / MinimumSegmentLength);
+
+        if (SegmentCount > 1) {
+            SegmentLength = MlasDivRoundup(ReduceCount, SegmentCount);
+            SegmentCount = MlasDivRoundup(ReduceCount, SegmentLength);
+        } else {
+            SegmentCount = 1;
+        }
+    }
+
+    std::vector<float> Partial;
+    float* SegmentOutput = Output;
+
+    if (SegmentCount > 1) {
+        Partial.resize(OuterCount * SegmentCount * InnerCount);
+        SegmentOutput = Partial.data();
+    }
+
+    const size_t WorkBlocks = OutputBlocks * SegmentCount;
+    const ptrdiff_t ThreadCount = ptrdiff_t(std::max<size_t>(std::min(TargetThreadCount, WorkBlocks), 1));
+
+    MlasTrySimpleParallel(ThreadPool, ThreadCount, [&](ptrdiff_t tid) {
+        size_t WorkIndex;
+        size_t WorkRemaining;
+
+        MlasPartitionWork(tid, ThreadCount, WorkBlocks, &WorkIndex, &WorkRemaining);
+
+        for (size_t w = WorkIndex; w < WorkIndex + WorkRemaining; w++) {
+            const size_t Column = (w % ColumnBlocks) * BlockSize;
+            const size_t Segment = (w / ColumnBlocks) % SegmentCount;
+            const size_t Outer = w / (ColumnBlocks * SegmentCount);
+            const size_t Row = Segment * SegmentLength;
+
+            MlasReduceBlock(ReduceKind,
+                            Input + (Outer * ReduceCount + Row) * InnerCount + Column,
+                            SegmentOutput + (Outer * SegmentCount + Segment) * InnerCount + Column,
+                            std::min(SegmentLength, ReduceCount - Row),
+                            InnerCount,
+                            std::min(BlockSize, InnerCount - Column));
+        }
+    });
+
+    //
+    // Reduce the partial results of the segments. The partial sums of squares
+    // are added together.
+    //
+
+    if (SegmentCount > 1) {
+        MlasReduce(ReduceKind == MlasReduceSumSquare ? MlasReduceSum : ReduceKind,
+                   Partial.data(), Output, OuterCount, SegmentCount, InnerCount, nullptr);
+    }
+}
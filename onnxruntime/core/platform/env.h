@@ -90,6 +90,12 @@ struct ThreadOptions {
   void* custom_thread_creation_options = nullptr;
   OrtCustomJoinThreadFn custom_join_thread_fn = nullptr;
   int dynamic_block_base_ = 0;
+
+  // Weights of the priority classes of parallel loops, indexed by ThreadPool::PriorityClass.  When set, the
+  // workers are shared between the classes that have loops running in proportion to these weights, see
+  // ThreadPool::PriorityClass.  A class with a weight of 0 only gets the workers no other class needs.
+  // Empty to run the loops in the order their work reaches the workers.
+  std::vector<int> priority_class_weights;
 };
 
 std::ostream& operator<<(std::ostream& os, const LogicalProcessors&);
@@ -146,6 +152,14 @@ class Env {
 
   virtual std::vector<LogicalProcessors> GetDefaultThreadAffinities() const = 0;
 
+  /// <summary>
+  /// Returns the logical processors of every NUMA node, indexed by node id.
+  /// An empty result means that the topology is unknown and every processor is treated as part of a single node.
+  /// </summary>
+  virtual std::vector<LogicalProcessors> GetNumaNodeProcessors() const {
+    return {};
+  }
+
   virtual int GetL2CacheSize() const = 0;
 
   /// \brief Returns the number of micro-seconds since the Unix epoch.
@@ -193,6 +207,23 @@ class Env {
   virtual common::Status MapFileIntoMemory(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
                                            MappedMemoryPtr& mapped_memory) const = 0;
 
+  /**
+   * Maps the content of the file into read-only memory.
+   * The pages are shared with the file system cache and with every other process mapping
+   * the same file, writing into them is an access violation.
+   * The platform is advised to read the range ahead and to back it with huge pages when it can.
+   * The default implementation falls back to MapFileIntoMemory.
+   * @param file_path The path to the file.
+   * @param offset The file offset from which to start the mapping.
+   * @param length The length in bytes of the mapping.
+   * @param[out] mapped_memory A smart pointer to the mapped memory which
+   *             unmaps the memory (unless release()'d) when destroyed.
+   */
+  virtual common::Status MapFileIntoMemoryReadOnly(_In_z_ const ORTCHAR_T* file_path, FileOffsetType offset,
+                                                   size_t length, MappedMemoryPtr& mapped_memory) const {
+    return MapFileIntoMemory(file_path, offset, length, mapped_memory);
+  }
+
 #ifdef _WIN32
   /// \brief Returns true if the directory exists.
   virtual bool FolderExists(const std::wstring& path) const = 0;
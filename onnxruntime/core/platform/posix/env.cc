@@ -31,10 +31,14 @@ limitations under the License.
 #endif
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <thread>
+#include <unordered_map>
 #include <utility>  // for std::forward
 #include <vector>
 
@@ -118,6 +122,67 @@ struct Freer {
 
 using MallocdStringPtr = std::unique_ptr<char, Freer<char> >;
 
+#if defined(__linux__)
+// Parses a sysfs cpu list such as "0-3,8,10-11". Returns false if the list is malformed.
+bool ParseCpuList(const std::string& cpu_list, LogicalProcessors& processors) {
+  processors.clear();
+  const char* p = cpu_list.c_str();
+  while (*p != '\0' && *p != '\n') {
+    char* end = nullptr;
+    const long from = strtol(p, &end, 10);
+    if (end == p || from < 0) {
+      return false;
+    }
+    long to = from;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      to = strtol(p, &end, 10);
+      if (end == p || to < from) {
+        return false;
+      }
+      p = end;
+    }
+    for (long id = from; id <= to; ++id) {
+      processors.push_back(static_cast<int>(id));
+    }
+    if (*p == ',') {
+      ++p;
+    }
+  }
+  return true;
+}
+
+// Reads the logical processors of every NUMA node from /sys/devices/system/node/node<N>/cpulist.
+// Node ids are not always contiguous (e.g. memory-only nodes or offlined sockets), missing ones are
+// left empty.
+std::vector<LogicalProcessors> ReadNumaNodeProcessors() {
+  std::vector<LogicalProcessors> nodes;
+  std::error_code ec;
+  const std::filesystem::path node_root{"/sys/devices/system/node"};
+  for (const auto& entry : std::filesystem::directory_iterator(node_root, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+        !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      continue;
+    }
+    const size_t node_id = static_cast<size_t>(strtoul(name.c_str() + 4, nullptr, 10));
+    std::ifstream cpu_list_file{entry.path() / "cpulist"};
+    std::string cpu_list;
+    LogicalProcessors processors;
+    if (!std::getline(cpu_list_file, cpu_list) || !ParseCpuList(cpu_list, processors)) {
+      LOGS_DEFAULT(INFO) << "Unable to read the processors of NUMA node " << node_id;
+      return {};
+    }
+    if (node_id >= nodes.size()) {
+      nodes.resize(node_id + 1);
+    }
+    nodes[node_id] = std::move(processors);
+  }
+  return nodes;
+}
+#endif
+
 class PosixThread : public EnvThread {
  private:
   struct Param {
@@ -291,6 +356,25 @@ class PosixEnv : public Env {
         }
         ret.push_back(std::move(th_aff));
       }
+#if defined(__linux__)
+      // Keep the cores of a NUMA node next to each other so that consecutive workers share a node.
+      const auto numa_nodes = GetNumaNodeProcessors();
+      if (numa_nodes.size() > 1) {
+        std::unordered_map<int, size_t> node_of_processor;
+        for (size_t node = 0; node < numa_nodes.size(); ++node) {
+          for (int processor : numa_nodes[node]) {
+            node_of_processor[processor] = node;
+          }
+        }
+        auto node_of_core = [&node_of_processor](const LogicalProcessors& core) {
+          auto it = core.empty() ? node_of_processor.end() : node_of_processor.find(core.front());
+          return it == node_of_processor.end() ? std::numeric_limits<size_t>::max() : it->second;
+        };
+        std::stable_sort(ret.begin(), ret.end(), [&](const LogicalProcessors& a, const LogicalProcessors& b) {
+          return node_of_core(a) < node_of_core(b);
+        });
+      }
+#endif
     }
 #endif
     // Just the size of the thread-pool
@@ -300,6 +384,14 @@ class PosixEnv : public Env {
     return ret;
   }
 
+#if defined(__linux__)
+  std::vector<LogicalProcessors> GetNumaNodeProcessors() const override {
+    // The topology does not change while the process runs.
+    static const std::vector<LogicalProcessors> numa_nodes = ReadNumaNodeProcessors();
+    return numa_nodes;
+  }
+#endif
+
   int GetL2CacheSize() const override {
 #ifdef _SC_LEVEL2_CACHE_SIZE
     return static_cast<int>(sysconf(_SC_LEVEL2_CACHE_SIZE));
@@ -417,6 +509,18 @@ class PosixEnv : public Env {
 
   Status MapFileIntoMemory(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
                            MappedMemoryPtr& mapped_memory) const override {
+    return MapFile(file_path, offset, length, /*read_only*/ false, mapped_memory);
+  }
+
+  Status MapFileIntoMemoryReadOnly(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length,
+                                   MappedMemoryPtr& mapped_memory) const override {
+    return MapFile(file_path, offset, length, /*read_only*/ true, mapped_memory);
+  }
+
+  // read_only == false: private copy-on-write mapping.
+  // read_only == true: shared read-only mapping, advised for read-ahead and transparent huge pages.
+  static Status MapFile(const ORTCHAR_T* file_path, FileOffsetType offset, size_t length, bool read_only,
+                        MappedMemoryPtr& mapped_memory) {
     ORT_RETURN_IF_NOT(file_path, "file_path == nullptr");
     ORT_RETURN_IF_NOT(offset >= 0, "offset < 0");
 
@@ -435,12 +539,22 @@ class PosixEnv : public Env {
     const size_t mapped_length = length + static_cast<size_t>(offset_to_page);
     const FileOffsetType mapped_offset = offset - offset_to_page;
     void* const mapped_base =
-        mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor.Get(), mapped_offset);
+        read_only ? mmap(nullptr, mapped_length, PROT_READ, MAP_SHARED, file_descriptor.Get(), mapped_offset)
+                  : mmap(nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor.Get(),
+                         mapped_offset);
 
     if (mapped_base == MAP_FAILED) {
       return ReportSystemError("mmap", file_path);
     }
 
+    if (read_only) {
+      // Both are hints, the mapping is usable whether or not the kernel honors them.
+#if defined(MADV_HUGEPAGE)
+      madvise(mapped_base, mapped_length, MADV_HUGEPAGE);
+#endif
+      madvise(mapped_base, mapped_length, MADV_WILLNEED);
+    }
+
     mapped_memory =
         MappedMemoryPtr{reinterpret_cast<char*>(mapped_base) + offset_to_page,
                         [mapped_base, mapped_length](void*) {
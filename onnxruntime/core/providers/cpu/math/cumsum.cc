@@ -1,7 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <functional>
+#include <numeric>
 
 #include "cumsum.h"
 #include "core/providers/common.h"
@@ -36,6 +38,42 @@ Status GetAxis(const Tensor* axis_tensor, int64_t input_rank, int64_t& axis_out)
 
 }  // namespace cumsum_op
 
+namespace {
+
+// number of adjacent columns scanned together by one unit of work
+constexpr int64_t kColumnBlockSize = 1024;
+
+// Scan 'count' adjacent columns of one slice along the axis. consecutive positions along the axis are 'pitch'
+// elements apart. the additions happen in the same order as a serial scan, so the results don't depend on how the
+// work is split.
+template <typename T>
+void CumSumColumns(const T* input, T* output, int64_t dim, int64_t pitch, int64_t count,
+                   bool exclusive, bool reverse) {
+  // in reverse we start from the end of the axis and walk backwards
+  const int64_t step = reverse ? -pitch : pitch;
+  if (reverse) {
+    input += (dim - 1) * pitch;
+    output += (dim - 1) * pitch;
+  }
+
+  if (exclusive) {
+    std::fill_n(output, count, T{0});
+  } else {
+    std::copy_n(input, count, output);
+  }
+
+  for (int64_t i = 1; i < dim; ++i) {
+    const T* in = input + (exclusive ? i - 1 : i) * step;
+    const T* prev = output + (i - 1) * step;
+    T* out = output + i * step;
+    for (int64_t c = 0; c < count; ++c) {
+      out[c] = prev[c] + in[c];
+    }
+  }
+}
+
+}  // namespace
+
 ONNX_CPU_OPERATOR_VERSIONED_TYPED_KERNEL(
     CumSum,
     11,
@@ -166,81 +204,43 @@ Status CumSum<T>::Compute(OpKernelContext* ctx) const {
   // 1) out[upper_dims...][0][lower_dims...] = 0
   // 2) out[upper_dims...][i][lower_dims...] =
   //      in[upper_dims...][i-1][lower_dims...] + out[upper_dims...][i-1][lower_dims...]
-  // we loop through the [upper_dims...] and start applying the identity in each slice
-  // since the [lower_dims...] are adjecent in memory, so we can add them like vectors
+  // each slice of [upper_dims...] is independent, and so is each column of [lower_dims...] within it.
+  // we split the slices into blocks of adjacent columns and scan the blocks in parallel. the columns of a
+  // block are adjacent in memory, so each step along the axis adds them like vectors.
 
   const auto input_shape = input->Shape().GetDims();
   const size_t axis = onnxruntime::narrow<size_t>(axis_input);
   const int64_t dim = input->Shape()[axis];  // dimension size for the axis
-  const int64_t upper_dim_count =            // number of slices we can walk through iteratively
+  const int64_t upper_dim_count =            // number of independent slices
       std::accumulate(input_shape.begin(), input_shape.begin() + axis, static_cast<int64_t>(1), std::multiplies<int64_t>());
   const int64_t lower_dim_size =  // sizes of the slices we can treat as 1D arrays
       std::accumulate(input_shape.begin() + axis + 1, input_shape.end(), static_cast<int64_t>(1), std::multiplies<int64_t>());
 
-  if (!reverse_) {
-    const auto* input_iter = input->Data<T>();
-    auto* output_iter = output_tensor.MutableData<T>();
-    const auto* prev_output_iter = output_iter;
-
-    if (exclusive_) {
-      for (int64_t outer = 0; outer < upper_dim_count; outer++) {
-        prev_output_iter = output_iter;
-        for (int64_t inner = 0; inner < lower_dim_size; inner++) {
-          *(output_iter++) = 0;
+  const int64_t column_block_size = std::min(lower_dim_size, kColumnBlockSize);
+  const int64_t column_blocks = (lower_dim_size + column_block_size - 1) / column_block_size;
+  const int64_t slice_size = dim * lower_dim_size;
+
+  const T* input_data = input->Data<T>();
+  T* output_data = output_tensor.MutableData<T>();
+  const bool exclusive = exclusive_ != 0;
+  const bool reverse = reverse_ != 0;
+
+  const double block_elements = static_cast<double>(dim * column_block_size);
+  const TensorOpCost cost{static_cast<double>(sizeof(T)) * block_elements,
+                          static_cast<double>(sizeof(T)) * block_elements,
+                          block_elements};
+
+  concurrency::ThreadPool::TryParallelFor(
+      ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(upper_dim_count * column_blocks), cost,
+      [=](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (std::ptrdiff_t block = first; block < last; ++block) {
+          const int64_t outer = block / column_blocks;
+          const int64_t column = (block % column_blocks) * column_block_size;
+          const int64_t offset = outer * slice_size + column;
+          CumSumColumns(input_data + offset, output_data + offset, dim, lower_dim_size,
+                        std::min(column_block_size, lower_dim_size - column), exclusive, reverse);
         }
-        for (int64_t cum_axis = 1; cum_axis < dim; cum_axis++) {
-          for (int64_t inner = 0; inner < lower_dim_size; inner++) {
-            *(output_iter++) = *(prev_output_iter++) + *(input_iter++);
-          }
-        }
-        input_iter += lower_dim_size;
-      }
-    } else {
-      for (int64_t outer = 0; outer < upper_dim_count; outer++) {
-        prev_output_iter = output_iter;
-        for (int64_t inner = 0; inner < lower_dim_size; inner++) {
-          *(output_iter++) = *(input_iter++);
-        }
-        for (int64_t cum_axis = 1; cum_axis < dim; cum_axis++) {
-          for (int64_t inner = 0; inner < lower_dim_size; inner++) {
-            *(output_iter++) = *(prev_output_iter++) + *(input_iter++);
-          }
-        }
-      }
-    }
-  } else {
-    // in this case the logic is mostly the same, but we start from the end
-    const auto* input_iter = input->Data<T>() + input->Shape().Size();
-    auto* output_iter = output_tensor.MutableData<T>() + output_shape.Size();
-    const auto* prev_output_iter = output_iter;
-
-    if (exclusive_) {
-      for (int64_t outer = upper_dim_count - 1; outer >= 0; outer--) {
-        prev_output_iter = output_iter;
-        for (int64_t inner = lower_dim_size - 1; inner >= 0; inner--) {
-          *(--output_iter) = 0;
-        }
-        for (int64_t cum_axis = dim - 1; cum_axis > 0; cum_axis--) {
-          for (int64_t inner = lower_dim_size - 1; inner >= 0; inner--) {
-            *(--output_iter) = *(--prev_output_iter) + *(--input_iter);
-          }
-        }
-        input_iter -= lower_dim_size;
-      }
-    } else {
-      for (int64_t outer = upper_dim_count - 1; outer >= 0; outer--) {
-        prev_output_iter = output_iter;
-        for (int64_t inner = lower_dim_size - 1; inner >= 0; inner--) {
-          *(--output_iter) = *(--input_iter);
-        }
-        for (int64_t cum_axis = dim - 1; cum_axis > 0; cum_axis--) {
-          for (int64_t inner = lower_dim_size - 1; inner >= 0; inner--) {
-            *(--output_iter) = *(--prev_output_iter) + *(--input_iter);
-          }
-        }
-      }
-    }
-  }
+      });
 
   return Status::OK();
 }
@@ -5,9 +5,12 @@
 
 #include <mutex>
 #include "core/platform/threadpool.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "tree_ensemble_helper.h"
 #include "tree_ensemble_attribute.h"
 #include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_flat_layout.h"
+#include "tree_ensemble_quickscorer.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -54,6 +57,7 @@ class TreeEnsembleCommonAttributes {
         n_trees_(0),
         same_mode_(true),
         has_missing_tracks_(false),
+        allow_quick_scorer_(true),
         parallel_tree_(80),
         parallel_tree_N_(128),
         parallel_N_(50) {}
@@ -68,6 +72,8 @@ class TreeEnsembleCommonAttributes {
   int64_t n_trees_;
   bool same_mode_;
   bool has_missing_tracks_;
+  // false if disabled by kOrtSessionOptionsTreeEnsembleQuickScorer
+  bool allow_quick_scorer_;
   int parallel_tree_;    // starts parallelizing the computing by trees if n_tree >= parallel_tree_
   int parallel_tree_N_;  // batch size if parallelizing by trees
   int parallel_N_;       // starts parallelizing the computing by rows if n_rows <= parallel_N_
@@ -87,6 +93,12 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
   std::vector<TreeCategorySet<int32_t, InputType>> category_sets_;
+  // Feature-major bitvector layout used instead of roots_ when every tree fits (see TreeEnsembleQuickScorer).
+  TreeEnsembleQuickScorer<InputType, ThresholdType> quick_scorer_;
+  bool use_quick_scorer_ = false;
+  // Breadth-first structure-of-arrays copy of the trees used when the quick scorer cannot be.
+  TreeEnsembleFlatLayout<InputType, ThresholdType> flat_layout_;
+  bool use_flat_layout_ = false;
 
  public:
   TreeEnsembleCommon() {}
@@ -106,6 +118,14 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 
+  template <typename AGG>
+  void ComputeAggQuickScorer(concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+                             OutputType* z_data, int64_t* label_data, const AGG& agg) const;
+
+  template <typename AGG>
+  void ComputeAggFlatLayout(concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+                            OutputType* z_data, int64_t* label_data, const AGG& agg) const;
+
   inline const TreeCategorySet<int32_t, InputType>& GetCategorySet(const ThresholdType& set_id) const {
     return category_sets_[static_cast<size_t>(set_id)];
   }
@@ -156,6 +176,8 @@ std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t> bit_cast_i
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, false);
+  this->allow_quick_scorer_ =
+      info.GetConfigOptions().GetConfigEntry(kOrtSessionOptionsTreeEnsembleQuickScorer) != "0";
   return Init(80, 128, 50, attributes);
 }
 
@@ -368,8 +390,18 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
     }
   }
 
+  // Shallow trees with only BRANCH_LEQ or only BRANCH_LT nodes are evaluated
+  // with bitvectors, TreeEnsembleQuickScorer::Init rejects any other ensemble.
+  use_quick_scorer_ = allow_quick_scorer_ && same_mode_ && category_sets_.empty() &&
+                      quick_scorer_.Init(gsl::make_span(roots_), has_missing_tracks_);
+  // Otherwise deeper trees with a single comparison rule are copied into a flattened layout.
+  use_flat_layout_ = !use_quick_scorer_ && same_mode_ && category_sets_.empty() &&
+                     flat_layout_.Init(gsl::make_span(roots_), has_missing_tracks_);
+
 #if defined(_TREE_DEBUG)
   std::cout << "TreeEnsemble:same_mode_=" << (same_mode_ ? 1 : 0) << "\n";
+  std::cout << "TreeEnsemble:use_quick_scorer_=" << (use_quick_scorer_ ? 1 : 0) << "\n";
+  std::cout << "TreeEnsemble:use_flat_layout_=" << (use_flat_layout_ ? 1 : 0) << "\n";
   for (auto& node : nodes_) {
     std::cout << node.str() << "\n";
   }
@@ -565,6 +597,15 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
 
   const InputType* x_data = X->Data<InputType>();
   int64_t* label_data = label == nullptr ? nullptr : label->MutableData<int64_t>();
+  if (use_quick_scorer_) {
+    ComputeAggQuickScorer(ttp, x_data, N, stride, z_data, label_data, agg);
+    return;
+  }
+  if (use_flat_layout_) {
+    ComputeAggFlatLayout(ttp, x_data, N, stride, z_data, label_data, agg);
+    return;
+  }
+
   auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
 
   if (n_targets_or_classes_ == 1) {
@@ -781,6 +822,185 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
   }
 }  // namespace detail
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggQuickScorer(
+    concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+    OutputType* z_data, int64_t* label_data, const AGG& agg) const {
+  // Trees are aggregated in the same order as the other paths.
+  auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
+  const size_t n_targets = onnxruntime::narrow<size_t>(n_targets_or_classes_);
+
+  if (N <= parallel_N_ && n_trees_ > parallel_tree_ && max_num_threads > 1) {
+    // Not enough rows to parallelize but enough trees: the blocks of trees are split among threads,
+    // each thread evaluates its blocks on every row, then the scores are merged in tree order.
+    auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(quick_scorer_.n_blocks()));
+    const size_t n_scores = SafeInt<size_t>(num_threads) * N;
+    std::vector<ScoreValue<ThresholdType>> scores1(n_targets == 1 ? n_scores : 0, {0, 0});
+    std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(n_targets == 1 ? 0 : n_scores);
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        ttp,
+        num_threads,
+        [this, &agg, &scores1, &scores, num_threads, n_targets, x_data, N, stride](ptrdiff_t batch_num) {
+          std::vector<uint64_t> leaf_masks(quick_scorer_.n_trees());
+          auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, quick_scorer_.n_blocks());
+          for (int64_t i = 0; i < N; ++i) {
+            const size_t k = SafeInt<size_t>(batch_num) * N + i;
+            if (n_targets != 1) {
+              scores[k].resize(n_targets, {0, 0});
+            }
+            for (auto block = work.start; block < work.end; ++block) {
+              quick_scorer_.ComputeLeafMasks(x_data + i * stride, leaf_masks.data(), block);
+              const auto trees = quick_scorer_.BlockTrees(block);
+              for (size_t j = trees.first; j < trees.second; ++j) {
+                if (n_targets == 1) {
+                  agg.ProcessTreeNodePrediction1(scores1[k], quick_scorer_.GetLeaf(j, leaf_masks[j]));
+                } else {
+                  agg.ProcessTreeNodePrediction(scores[k], quick_scorer_.GetLeaf(j, leaf_masks[j]), weights_);
+                }
+              }
+            }
+          }
+        });
+
+    for (int64_t i = 0; i < N; ++i) {
+      for (int64_t t = 1; t < num_threads; ++t) {
+        if (n_targets == 1) {
+          agg.MergePrediction1(scores1[i], scores1[t * SafeInt<ptrdiff_t>(N) + i]);
+        } else {
+          agg.MergePrediction(scores[i], scores[t * SafeInt<ptrdiff_t>(N) + i]);
+        }
+      }
+      if (n_targets == 1) {
+        agg.FinalizeScores1(z_data + i, scores1[i], label_data == nullptr ? nullptr : (label_data + i));
+      } else {
+        agg.FinalizeScores(scores[i], z_data + i * n_targets_or_classes_, -1,
+                           label_data == nullptr ? nullptr : (label_data + i));
+      }
+    }
+    return;
+  }
+
+  // Otherwise every row evaluates all trees at once and the computation is parallelized by rows.
+  auto num_threads = N <= parallel_N_ ? 1 : std::min<int32_t>(max_num_threads, SafeInt<int32_t>(N));
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ttp,
+      num_threads,
+      [this, &agg, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
+        std::vector<uint64_t> leaf_masks(quick_scorer_.n_trees());
+        InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
+        auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads),
+                                                           onnxruntime::narrow<ptrdiff_t>(N));
+        for (auto i = work.start; i < work.end; ++i) {
+          quick_scorer_.ComputeLeafMasks(x_data + i * stride, leaf_masks.data());
+          if (n_targets_or_classes_ == 1) {
+            ScoreValue<ThresholdType> score = {0, 0};
+            for (size_t j = 0; j < leaf_masks.size(); ++j) {
+              agg.ProcessTreeNodePrediction1(score, quick_scorer_.GetLeaf(j, leaf_masks[j]));
+            }
+            agg.FinalizeScores1(z_data + i, score, label_data == nullptr ? nullptr : (label_data + i));
+          } else {
+            std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
+            for (size_t j = 0; j < leaf_masks.size(); ++j) {
+              agg.ProcessTreeNodePrediction(scores, quick_scorer_.GetLeaf(j, leaf_masks[j]), weights_);
+            }
+            agg.FinalizeScores(scores, z_data + i * n_targets_or_classes_, -1,
+                               label_data == nullptr ? nullptr : (label_data + i));
+          }
+        }
+      });
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggFlatLayout(
+    concurrency::ThreadPool* ttp, const InputType* x_data, int64_t N, int64_t stride,
+    OutputType* z_data, int64_t* label_data, const AGG& agg) const {
+  auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
+  const size_t n_targets = onnxruntime::narrow<size_t>(n_targets_or_classes_);
+
+  if (N == 1) {
+    // One row: the trees are split among threads if there are enough of them, scores are merged in tree order.
+    auto num_threads = n_trees_ <= parallel_tree_ ? 1 : std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
+    std::vector<ScoreValue<ThresholdType>> scores1(num_threads, {0, 0});
+    std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(n_targets == 1 ? 0 : num_threads);
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        ttp,
+        num_threads,
+        [this, &agg, &scores1, &scores, num_threads, n_targets, x_data](ptrdiff_t batch_num) {
+          auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<size_t>(n_trees_));
+          if (n_targets == 1) {
+            for (auto j = work.start; j < work.end; ++j) {
+              agg.ProcessTreeNodePrediction1(scores1[batch_num], flat_layout_.ComputeLeaf(static_cast<size_t>(j), x_data));
+            }
+          } else {
+            scores[batch_num].resize(n_targets, {0, 0});
+            for (auto j = work.start; j < work.end; ++j) {
+              agg.ProcessTreeNodePrediction(scores[batch_num], flat_layout_.ComputeLeaf(static_cast<size_t>(j), x_data), weights_);
+            }
+          }
+        });
+    if (n_targets == 1) {
+      for (size_t i = 1; i < scores1.size(); ++i) {
+        agg.MergePrediction1(scores1[0], scores1[i]);
+      }
+      agg.FinalizeScores1(z_data, scores1[0], label_data);
+    } else {
+      for (size_t i = 1; i < scores.size(); ++i) {
+        agg.MergePrediction(scores[0], scores[i]);
+      }
+      agg.FinalizeScores(scores[0], z_data, -1, label_data);
+    }
+    return;
+  }
+
+  // Several rows: rows are split among threads, every thread processes its rows in batches of parallel_tree_N_ rows
+  // (see section C in ComputeAgg) and moves blocks of TreeEnsembleFlatLayout::kRowBlock rows through every tree.
+  auto num_threads = N <= parallel_N_ ? 1 : std::min<int32_t>(max_num_threads, SafeInt<int32_t>(N));
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ttp,
+      num_threads,
+      [this, &agg, num_threads, n_targets, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
+        constexpr size_t row_block = TreeEnsembleFlatLayout<InputType, ThresholdType>::kRowBlock;
+        const TreeNodeElement<ThresholdType>* leaves[row_block];
+        std::vector<ScoreValue<ThresholdType>> scores1(n_targets == 1 ? parallel_tree_N_ : 0);
+        std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(n_targets == 1 ? 0 : parallel_tree_N_);
+        auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads),
+                                                           onnxruntime::narrow<ptrdiff_t>(N));
+        for (auto batch = work.start; batch < work.end; batch += parallel_tree_N_) {
+          auto batch_end = std::min(work.end, batch + static_cast<ptrdiff_t>(parallel_tree_N_));
+          for (auto i = batch; i < batch_end; ++i) {
+            if (n_targets == 1) {
+              scores1[i - batch] = {0, 0};
+            } else {
+              scores[i - batch].assign(n_targets, {0, 0});
+            }
+          }
+          for (size_t j = 0; j < static_cast<size_t>(n_trees_); ++j) {
+            for (auto block = batch; block < batch_end; block += static_cast<ptrdiff_t>(row_block)) {
+              size_t n_rows = std::min(row_block, static_cast<size_t>(batch_end - block));
+              flat_layout_.ComputeLeaves(j, x_data + block * stride, stride, n_rows, leaves);
+              for (size_t r = 0; r < n_rows; ++r) {
+                if (n_targets == 1) {
+                  agg.ProcessTreeNodePrediction1(scores1[block - batch + r], *leaves[r]);
+                } else {
+                  agg.ProcessTreeNodePrediction(scores[block - batch + r], *leaves[r], weights_);
+                }
+              }
+            }
+          }
+          for (auto i = batch; i < batch_end; ++i) {
+            if (n_targets == 1) {
+              agg.FinalizeScores1(z_data + i, scores1[i - batch], label_data == nullptr ? nullptr : (label_data + i));
+            } else {
+              agg.FinalizeScores(scores[i - batch], z_data + i * n_targets_or_classes_, -1,
+                                 label_data == nullptr ? nullptr : (label_data + i));
+            }
+          }
+        }
+      });
+}
+
 #define TREE_FIND_VALUE(CMP)                                                                           \
   if (has_missing_tracks_) {                                                                           \
     while (root->is_not_leaf()) {                                                                      \
@@ -954,6 +1174,8 @@ class TreeEnsembleCommonClassifier : public TreeEnsembleCommon<InputType, Thresh
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommonClassifier<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, true);
+  this->allow_quick_scorer_ =
+      info.GetConfigOptions().GetConfigEntry(kOrtSessionOptionsTreeEnsembleQuickScorer) != "0";
   return Init(80, 128, 50, attributes);
 }
 
@@ -1034,6 +1256,8 @@ class TreeEnsembleCommonV5 : public TreeEnsembleCommon<IOType, ThresholdType, IO
 template <typename IOType, typename ThresholdType>
 Status TreeEnsembleCommonV5<IOType, ThresholdType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV5<ThresholdType> attributes(info);
+  this->allow_quick_scorer_ =
+      info.GetConfigOptions().GetConfigEntry(kOrtSessionOptionsTreeEnsembleQuickScorer) != "0";
   return Init(80, 128, 50, attributes);
 }
 
@@ -0,0 +1,277 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <limits>
+#include <new>
+#include <unordered_set>
+#include <vector>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+inline void TreeEnsemblePrefetch(const void* address) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+  __builtin_prefetch(address, 0, 3);
+#else
+  (void)address;
+#endif
+}
+
+// std::allocator only guarantees the alignment of the type,
+// this one aligns every array on a cache line.
+template <typename T>
+struct CacheLineAllocator {
+  using value_type = T;
+  static constexpr std::size_t kAlignment = 64;
+
+  CacheLineAllocator() = default;
+  template <typename U>
+  CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+  }
+  void deallocate(T* p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t(kAlignment));
+  }
+  template <typename U>
+  bool operator==(const CacheLineAllocator<U>&) const noexcept { return true; }
+  template <typename U>
+  bool operator!=(const CacheLineAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * Structure-of-arrays copy of a tree ensemble. Every tree is stored breadth-first starting
+ * on a cache line, the two children of a node are consecutive (true branch first) so a node only
+ * stores the index of its true child. Leaves have a negative feature id and store the position
+ * of the original leaf in leaves_.
+ *
+ * ComputeLeaves moves a block of rows through the same tree one level at a time:
+ * the loads of one row overlap with the comparisons of the others, and the next node
+ * of each row is prefetched before switching to the next row.
+ *
+ * Only ensembles where every split uses the same comparison (BRANCH_LEQ, BRANCH_LT,
+ * BRANCH_GTE, BRANCH_GT, BRANCH_EQ or BRANCH_NEQ) and where no subtree is shared are supported.
+ */
+template <typename InputType, typename ThresholdType>
+class TreeEnsembleFlatLayout {
+ public:
+  // Number of rows moved together through a tree.
+  static constexpr size_t kRowBlock = 8;
+
+  // Builds the flattened arrays. Returns false and leaves the object empty
+  // if the ensemble cannot be represented.
+  bool Init(gsl::span<TreeNodeElement<ThresholdType>* const> roots, bool has_missing_tracks);
+
+  // Evaluates tree `tree` on n_rows <= kRowBlock rows starting at x_data.
+  void ComputeLeaves(size_t tree, const InputType* x_data, int64_t stride, size_t n_rows,
+                     const TreeNodeElement<ThresholdType>** leaves) const;
+
+  inline const TreeNodeElement<ThresholdType>& ComputeLeaf(size_t tree, const InputType* x_data) const {
+    const TreeNodeElement<ThresholdType>* leaf;
+    ComputeLeaves(tree, x_data, 0, 1, &leaf);
+    return *leaf;
+  }
+
+  size_t n_trees() const { return tree_offsets_.size(); }
+
+ private:
+  template <NODE_MODE_ORT Mode>
+  static inline bool Compare(InputType val, ThresholdType threshold) {
+    if constexpr (Mode == NODE_MODE_ORT::BRANCH_LEQ) {
+      return val <= threshold;
+    } else if constexpr (Mode == NODE_MODE_ORT::BRANCH_LT) {
+      return val < threshold;
+    } else if constexpr (Mode == NODE_MODE_ORT::BRANCH_GTE) {
+      return val >= threshold;
+    } else if constexpr (Mode == NODE_MODE_ORT::BRANCH_GT) {
+      return val > threshold;
+    } else if constexpr (Mode == NODE_MODE_ORT::BRANCH_EQ) {
+      return val == threshold;
+    } else {
+      return val != threshold;
+    }
+  }
+
+  template <NODE_MODE_ORT Mode>
+  void ComputeLeavesImpl(size_t tree, const InputType* x_data, int64_t stride, size_t n_rows,
+                         const TreeNodeElement<ThresholdType>** leaves) const;
+
+  void Clear();
+
+  NODE_MODE_ORT mode_ = NODE_MODE_ORT::BRANCH_LEQ;
+  bool has_missing_tracks_ = false;
+  std::vector<int32_t, CacheLineAllocator<int32_t>> features_;
+  std::vector<ThresholdType, CacheLineAllocator<ThresholdType>> thresholds_;
+  std::vector<uint32_t, CacheLineAllocator<uint32_t>> children_;
+  std::vector<uint8_t, CacheLineAllocator<uint8_t>> missing_tracks_true_;
+  std::vector<uint32_t> tree_offsets_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+};
+
+template <typename InputType, typename ThresholdType>
+void TreeEnsembleFlatLayout<InputType, ThresholdType>::Clear() {
+  features_.clear();
+  thresholds_.clear();
+  children_.clear();
+  missing_tracks_true_.clear();
+  tree_offsets_.clear();
+  leaves_.clear();
+}
+
+template <typename InputType, typename ThresholdType>
+bool TreeEnsembleFlatLayout<InputType, ThresholdType>::Init(gsl::span<TreeNodeElement<ThresholdType>* const> roots,
+                                                            bool has_missing_tracks) {
+  Clear();
+  if (roots.empty()) {
+    return false;
+  }
+  mode_ = NODE_MODE_ORT::BRANCH_LEQ;
+  for (auto* root : roots) {
+    if (root->is_not_leaf()) {
+      mode_ = root->mode();
+      break;
+    }
+  }
+  switch (mode_) {
+    case NODE_MODE_ORT::BRANCH_LEQ:
+    case NODE_MODE_ORT::BRANCH_LT:
+    case NODE_MODE_ORT::BRANCH_GTE:
+    case NODE_MODE_ORT::BRANCH_GT:
+    case NODE_MODE_ORT::BRANCH_EQ:
+    case NODE_MODE_ORT::BRANCH_NEQ:
+      break;
+    default:
+      return false;
+  }
+  has_missing_tracks_ = has_missing_tracks;
+
+  // Every tree starts on a cache line in features_, thresholds_ and children_.
+  constexpr size_t padding = CacheLineAllocator<int32_t>::kAlignment / sizeof(int32_t);
+  std::unordered_set<const TreeNodeElement<ThresholdType>*> visited;
+  std::vector<const TreeNodeElement<ThresholdType>*> level;
+  tree_offsets_.reserve(roots.size());
+  for (auto* root : roots) {
+    size_t start = (features_.size() + padding - 1) / padding * padding;
+    if (start + 1 > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
+      Clear();
+      return false;
+    }
+    features_.resize(start, -1);
+    thresholds_.resize(start, 0);
+    children_.resize(start, 0);
+    missing_tracks_true_.resize(start, 0);
+    tree_offsets_.push_back(static_cast<uint32_t>(start));
+
+    // Breadth-first order, position i of `level` is stored at start + i.
+    level.clear();
+    level.push_back(root);
+    for (size_t i = 0; i < level.size(); ++i) {
+      const TreeNodeElement<ThresholdType>* node = level[i];
+      if (!visited.insert(node).second ||
+          start + level.size() + 2 > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
+        Clear();
+        return false;
+      }
+      if (node->is_not_leaf()) {
+        if (node->mode() != mode_ || node->feature_id < 0) {
+          Clear();
+          return false;
+        }
+        features_.push_back(node->feature_id);
+        thresholds_.push_back(node->value_or_unique_weight);
+        children_.push_back(static_cast<uint32_t>(start + level.size()));
+        missing_tracks_true_.push_back(node->is_missing_track_true() ? 1 : 0);
+        level.push_back(node->truenode_or_weight.ptr);
+        level.push_back(node + 1);
+      } else {
+        features_.push_back(-1);
+        thresholds_.push_back(0);
+        children_.push_back(static_cast<uint32_t>(leaves_.size()));
+        missing_tracks_true_.push_back(0);
+        leaves_.push_back(node);
+      }
+    }
+  }
+  return true;
+}
+
+template <typename InputType, typename ThresholdType>
+template <NODE_MODE_ORT Mode>
+void TreeEnsembleFlatLayout<InputType, ThresholdType>::ComputeLeavesImpl(
+    size_t tree, const InputType* x_data, int64_t stride, size_t n_rows,
+    const TreeNodeElement<ThresholdType>** leaves) const {
+  const int32_t* features = features_.data();
+  const ThresholdType* thresholds = thresholds_.data();
+  const uint32_t* children = children_.data();
+  const uint8_t* missing_tracks_true = missing_tracks_true_.data();
+
+  uint32_t index[kRowBlock];
+  for (size_t r = 0; r < n_rows; ++r) {
+    index[r] = tree_offsets_[tree];
+  }
+  bool moved = true;
+  while (moved) {
+    moved = false;
+    for (size_t r = 0; r < n_rows; ++r) {
+      uint32_t i = index[r];
+      int32_t feature = features[i];
+      if (feature < 0) {
+        continue;
+      }
+      InputType val = x_data[r * stride + feature];
+      bool true_branch = Compare<Mode>(val, thresholds[i]) ||
+                         (has_missing_tracks_ && missing_tracks_true[i] && _isnan_(val));
+      i = children[i] + (true_branch ? 0 : 1);
+      TreeEnsemblePrefetch(features + i);
+      TreeEnsemblePrefetch(thresholds + i);
+      index[r] = i;
+      moved = true;
+    }
+  }
+  for (size_t r = 0; r < n_rows; ++r) {
+    leaves[r] = leaves_[children[index[r]]];
+  }
+}
+
+template <typename InputType, typename ThresholdType>
+void TreeEnsembleFlatLayout<InputType, ThresholdType>::ComputeLeaves(
+    size_t tree, const InputType* x_data, int64_t stride, size_t n_rows,
+    const TreeNodeElement<ThresholdType>** leaves) const {
+  switch (mode_) {
+    case NODE_MODE_ORT::BRANCH_LEQ:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_LEQ>(tree, x_data, stride, n_rows, leaves);
+      break;
+    case NODE_MODE_ORT::BRANCH_LT:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_LT>(tree, x_data, stride, n_rows, leaves);
+      break;
+    case NODE_MODE_ORT::BRANCH_GTE:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_GTE>(tree, x_data, stride, n_rows, leaves);
+      break;
+    case NODE_MODE_ORT::BRANCH_GT:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_GT>(tree, x_data, stride, n_rows, leaves);
+      break;
+    case NODE_MODE_ORT::BRANCH_EQ:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_EQ>(tree, x_data, stride, n_rows, leaves);
+      break;
+    case NODE_MODE_ORT::BRANCH_NEQ:
+      ComputeLeavesImpl<NODE_MODE_ORT::BRANCH_NEQ>(tree, x_data, stride, n_rows, leaves);
+      break;
+    default:
+      ORT_THROW("Unexpected node mode in TreeEnsembleFlatLayout: ", static_cast<int>(mode_));
+  }
+}
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
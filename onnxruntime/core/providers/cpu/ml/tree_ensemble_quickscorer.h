@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_attribute.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+inline uint32_t QuickScorerLowestBit(uint64_t mask) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return static_cast<uint32_t>(index);
+#elif defined(_MSC_VER)
+  uint32_t index = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++index;
+  }
+  return index;
+#else
+  return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+}
+
+/**
+ * Evaluates a tree ensemble with the QuickScorer algorithm (Lucchese et al., SIGIR 2015).
+ * Every tree has at most 64 leaves, numbered in depth-first order visiting the true branch first.
+ * Every node stores a bitmask clearing the leaves of its true subtree. Nodes are grouped by feature
+ * and sorted by threshold so that, for one row, the nodes evaluating to false are a prefix
+ * of every feature group. The leaf reached in a tree is the lowest bit still set
+ * once the masks of all false nodes were applied. The evaluation does not depend
+ * on any data-dependent branch per tree level and reads the thresholds sequentially.
+ *
+ * Trees are grouped in blocks of kTreesPerBlock consecutive trees, each block having its own feature-major
+ * layout, so that the blocks of one row can be evaluated by different threads.
+ *
+ * Only ensembles whose nodes are all BRANCH_LEQ or all BRANCH_LT are supported.
+ */
+template <typename InputType, typename ThresholdType>
+class TreeEnsembleQuickScorer {
+ public:
+  static constexpr size_t kMaxLeaves = 64;
+  static constexpr size_t kTreesPerBlock = 32;
+
+  // Builds the feature-major structure. Returns false and leaves the object empty
+  // if the ensemble cannot be evaluated with this algorithm.
+  bool Init(gsl::span<TreeNodeElement<ThresholdType>* const> roots, bool has_missing_tracks);
+
+  // Computes one bitmask per tree for row x_data, leaf_masks must contain n_trees elements.
+  void ComputeLeafMasks(const InputType* x_data, uint64_t* leaf_masks) const {
+    for (size_t block = 0; block < n_blocks(); ++block) {
+      ComputeLeafMasks(x_data, leaf_masks, block);
+    }
+  }
+
+  // Computes the bitmasks of the trees of one block, see BlockTrees.
+  void ComputeLeafMasks(const InputType* x_data, uint64_t* leaf_masks, size_t block) const;
+
+  inline const TreeNodeElement<ThresholdType>& GetLeaf(size_t tree, uint64_t leaf_mask) const {
+    return *leaves_[leaf_offsets_[tree] + QuickScorerLowestBit(leaf_mask)];
+  }
+
+  size_t n_trees() const { return leaf_offsets_.size(); }
+  size_t n_blocks() const { return (n_trees() + kTreesPerBlock - 1) / kTreesPerBlock; }
+
+  // The trees of a block are [first, second).
+  std::pair<size_t, size_t> BlockTrees(size_t block) const {
+    return {block * kTreesPerBlock, std::min(n_trees(), (block + 1) * kTreesPerBlock)};
+  }
+
+ private:
+  struct Condition {
+    ThresholdType threshold;
+    uint32_t tree_id;
+    uint64_t mask;
+    bool missing_track_true;
+  };
+
+  bool AddTree(TreeNodeElement<ThresholdType>* node, uint32_t tree_id, size_t first_leaf,
+               std::unordered_set<const TreeNodeElement<ThresholdType>*>& visited,
+               std::vector<std::vector<Condition>>& conditions);
+  void Clear();
+
+  bool strict_ = false;  // BRANCH_LT if true, BRANCH_LEQ otherwise
+  bool has_missing_tracks_ = false;
+  // Feature-major layout: the conditions on features_[f] are stored
+  // in [feature_offsets_[f], feature_offsets_[f + 1]) sorted by increasing threshold.
+  // The features of block b are features_[block_offsets_[b]: block_offsets_[b + 1]].
+  std::vector<int64_t> features_;
+  std::vector<size_t> feature_offsets_;
+  std::vector<size_t> block_offsets_;
+  std::vector<ThresholdType> thresholds_;
+  std::vector<uint32_t> tree_ids_;
+  std::vector<uint64_t> masks_;
+  std::vector<uint8_t> missing_tracks_true_;
+  // Leaves of tree t are leaves_[leaf_offsets_[t]: leaf_offsets_[t + 1]].
+  std::vector<size_t> leaf_offsets_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+};
+
+template <typename InputType, typename ThresholdType>
+void TreeEnsembleQuickScorer<InputType, ThresholdType>::Clear() {
+  features_.clear();
+  feature_offsets_.clear();
+  block_offsets_.clear();
+  thresholds_.clear();
+  tree_ids_.clear();
+  masks_.clear();
+  missing_tracks_true_.clear();
+  leaf_offsets_.clear();
+  leaves_.clear();
+}
+
+template <typename InputType, typename ThresholdType>
+bool TreeEnsembleQuickScorer<InputType, ThresholdType>::AddTree(
+    TreeNodeElement<ThresholdType>* node, uint32_t tree_id, size_t first_leaf,
+    std::unordered_set<const TreeNodeElement<ThresholdType>*>& visited,
+    std::vector<std::vector<Condition>>& conditions) {
+  // A node shared by two branches (a DAG) cannot be given a single leaf range.
+  if (!visited.insert(node).second) {
+    return false;
+  }
+  if (!node->is_not_leaf()) {
+    if (leaves_.size() - first_leaf >= kMaxLeaves) {
+      return false;
+    }
+    leaves_.push_back(node);
+    return true;
+  }
+  if (node->mode() != (strict_ ? NODE_MODE_ORT::BRANCH_LT : NODE_MODE_ORT::BRANCH_LEQ) ||
+      node->feature_id < 0 || _isnan_(node->value_or_unique_weight)) {
+    return false;
+  }
+
+  size_t true_begin = leaves_.size() - first_leaf;
+  if (!AddTree(node->truenode_or_weight.ptr, tree_id, first_leaf, visited, conditions)) {
+    return false;
+  }
+  size_t true_end = leaves_.size() - first_leaf;
+  if (!AddTree(node + 1, tree_id, first_leaf, visited, conditions)) {
+    return false;
+  }
+
+  // true_end - true_begin < 64 because the false branch holds at least one leaf.
+  uint64_t true_leaves = ((uint64_t(1) << (true_end - true_begin)) - 1) << true_begin;
+  if (static_cast<size_t>(node->feature_id) >= conditions.size()) {
+    conditions.resize(static_cast<size_t>(node->feature_id) + 1);
+  }
+  conditions[static_cast<size_t>(node->feature_id)].push_back(
+      {node->value_or_unique_weight, tree_id, ~true_leaves, node->is_missing_track_true()});
+  return true;
+}
+
+template <typename InputType, typename ThresholdType>
+bool TreeEnsembleQuickScorer<InputType, ThresholdType>::Init(gsl::span<TreeNodeElement<ThresholdType>* const> roots,
+                                                             bool has_missing_tracks) {
+  Clear();
+  if (roots.empty()) {
+    return false;
+  }
+
+  // The mode of the first split decides the comparison, AddTree rejects any other mode.
+  strict_ = false;
+  for (auto* root : roots) {
+    if (root->is_not_leaf()) {
+      strict_ = root->mode() == NODE_MODE_ORT::BRANCH_LT;
+      break;
+    }
+  }
+  has_missing_tracks_ = has_missing_tracks;
+
+  // conditions[b][f] holds the conditions on feature f of the trees of block b.
+  const size_t n_blocks = (roots.size() + kTreesPerBlock - 1) / kTreesPerBlock;
+  std::vector<std::vector<std::vector<Condition>>> conditions(n_blocks);
+  std::unordered_set<const TreeNodeElement<ThresholdType>*> visited;
+  leaf_offsets_.reserve(roots.size());
+  for (size_t tree_id = 0; tree_id < roots.size(); ++tree_id) {
+    leaf_offsets_.push_back(leaves_.size());
+    if (!AddTree(roots[tree_id], static_cast<uint32_t>(tree_id), leaves_.size(), visited,
+                 conditions[tree_id / kTreesPerBlock])) {
+      Clear();
+      return false;
+    }
+  }
+
+  size_t n_conditions = 0;
+  for (const auto& block_conditions : conditions) {
+    for (const auto& c : block_conditions) {
+      n_conditions += c.size();
+    }
+  }
+  thresholds_.reserve(n_conditions);
+  tree_ids_.reserve(n_conditions);
+  masks_.reserve(n_conditions);
+  missing_tracks_true_.reserve(n_conditions);
+  feature_offsets_.push_back(0);
+  block_offsets_.push_back(0);
+  for (auto& block_conditions : conditions) {
+    for (size_t f = 0; f < block_conditions.size(); ++f) {
+      auto& feature_conditions = block_conditions[f];
+      if (feature_conditions.empty()) {
+        continue;
+      }
+      std::stable_sort(feature_conditions.begin(), feature_conditions.end(),
+                       [](const Condition& a, const Condition& b) { return a.threshold < b.threshold; });
+      for (const auto& c : feature_conditions) {
+        thresholds_.push_back(c.threshold);
+        tree_ids_.push_back(c.tree_id);
+        masks_.push_back(c.mask);
+        missing_tracks_true_.push_back(c.missing_track_true ? 1 : 0);
+      }
+      features_.push_back(static_cast<int64_t>(f));
+      feature_offsets_.push_back(thresholds_.size());
+    }
+    block_offsets_.push_back(features_.size());
+  }
+  return true;
+}
+
+template <typename InputType, typename ThresholdType>
+void TreeEnsembleQuickScorer<InputType, ThresholdType>::ComputeLeafMasks(const InputType* x_data,
+                                                                         uint64_t* leaf_masks, size_t block) const {
+  const auto trees = BlockTrees(block);
+  std::fill(leaf_masks + trees.first, leaf_masks + trees.second, ~uint64_t(0));
+  const ThresholdType* thresholds = thresholds_.data();
+  const uint32_t* tree_ids = tree_ids_.data();
+  const uint64_t* masks = masks_.data();
+  for (size_t f = block_offsets_[block], f_end = block_offsets_[block + 1]; f < f_end; ++f) {
+    const InputType val = x_data[features_[f]];
+    size_t k = feature_offsets_[f];
+    const size_t end = feature_offsets_[f + 1];
+    if (_isnan_(val)) {
+      // Every comparison with NaN is false, the node follows the true branch only if the missing value tracks it.
+      for (; k < end; ++k) {
+        if (!has_missing_tracks_ || !missing_tracks_true_[k]) {
+          leaf_masks[tree_ids[k]] &= masks[k];
+        }
+      }
+    } else if (strict_) {
+      // val < threshold is false.
+      for (; k < end && thresholds[k] <= val; ++k) {
+        leaf_masks[tree_ids[k]] &= masks[k];
+      }
+    } else {
+      // val <= threshold is false.
+      for (; k < end && thresholds[k] < val; ++k) {
+        leaf_masks[tree_ids[k]] &= masks[k];
+      }
+    }
+  }
+}
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -19,6 +19,7 @@
 
 #include "core/common/narrow.h"
 #include "core/common/safeint.h"
+#include "core/framework/tensorprotoutils.h"
 #include "core/util/math_cpuonly.h"
 
 namespace onnxruntime {
@@ -153,6 +154,116 @@ Status Conv<T>::Compute(OpKernelContext* context) const {
   return Status::OK();
 }
 
+Status Conv<float>::PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                            /*out*/ bool& is_packed,
+                            /*out*/ PrePackedWeights* /*prepacked_weights*/) {
+  is_packed = false;
+
+  // Only the Winograd and FFT algorithms use a transformed filter, and which one MLAS selects depends on the
+  // input shape, so the filter is only transformed here if the spatial dimensions of X are static. Otherwise it
+  // is transformed by the first run that selects one of them.
+  if (input_idx != 1 || !allow_fast_algorithms_) {
+    return Status::OK();
+  }
+
+  filter_is_constant_ = true;
+  transformed_filter_alloc_ = alloc;
+
+  const auto* x_shape_proto = OpKernel::Node().InputDefs()[0]->Shape();
+  if (x_shape_proto == nullptr) {
+    return Status::OK();
+  }
+
+  const TensorShape x_shape = utils::GetTensorShapeFromTensorShapeProto(*x_shape_proto);
+  const auto& W_shape = tensor.Shape();
+  if (x_shape.NumDimensions() != W_shape.NumDimensions() || W_shape.NumDimensions() < 3) {
+    return Status::OK();
+  }
+
+  TensorShape input_shape = x_shape.Slice(2);
+  for (size_t i = 0; i < input_shape.NumDimensions(); i++) {
+    if (input_shape[i] <= 0) {
+      return Status::OK();
+    }
+  }
+
+  TensorShapeVector kernel_shape;
+  ORT_RETURN_IF_ERROR(conv_attrs_.ComputeKernelShape(W_shape, kernel_shape));
+
+  const size_t kernel_rank = kernel_shape.size();
+  if (kernel_rank < 1 || kernel_rank > 3) {
+    return Status::OK();
+  }
+
+  ConvPadVector pads(conv_attrs_.pads);
+  if (pads.empty()) {
+    pads.resize(kernel_rank * 2, 0);
+  }
+  TensorShapeVector dilations(conv_attrs_.dilations);
+  if (dilations.empty()) {
+    dilations.resize(kernel_rank, 1);
+  }
+  TensorShapeVector strides(conv_attrs_.strides);
+  if (strides.empty()) {
+    strides.resize(kernel_rank, 1);
+  }
+
+  const int64_t M = W_shape[0];
+  const int64_t C = W_shape[1] * conv_attrs_.group;
+
+  // The batch size does not affect the algorithm or the transformed filter.
+  TensorShapeVector Y_dims({1, M});
+  ORT_RETURN_IF_ERROR(conv_attrs_.InferPadsAndOutputShape(input_shape, kernel_shape, strides, dilations, pads,
+                                                          Y_dims));
+  TensorShape output_shape = TensorShape(Y_dims).Slice(2);
+  if (output_shape.Size() <= 0) {
+    return Status::OK();
+  }
+
+  MLAS_CONV_PARAMETERS Parameters{};
+  size_t WorkingBufferSize;
+  MlasConvPrepare(&Parameters,
+                  kernel_rank,
+                  1,
+                  narrow<size_t>(conv_attrs_.group),
+                  narrow<size_t>(C / conv_attrs_.group),
+                  input_shape.GetDims().data(),
+                  kernel_shape.data(),
+                  dilations.data(),
+                  pads.data(),
+                  strides.data(),
+                  output_shape.GetDims().data(),
+                  narrow<size_t>(M / conv_attrs_.group),
+                  &activation_,
+                  &WorkingBufferSize,
+                  0.0f,
+                  nullptr,
+                  true);
+
+  if (MlasConvPackFilterSize(&Parameters) > 0) {
+    GetTransformedFilter(Parameters, tensor.Data<float>());
+  }
+
+  return Status::OK();
+}
+
+const float* Conv<float>::GetTransformedFilter(const MLAS_CONV_PARAMETERS& parameters, const float* filter) const {
+  std::lock_guard<std::mutex> lock(transformed_filters_mutex_);
+
+  for (const auto& transformed_filter : transformed_filters_) {
+    if (transformed_filter.algorithm == parameters.Algorithm &&
+        transformed_filter.transform_size == parameters.u.Transform.TransformSize) {
+      return static_cast<const float*>(transformed_filter.data.get());
+    }
+  }
+
+  auto data = IAllocator::MakeUniquePtr<void>(transformed_filter_alloc_, MlasConvPackFilterSize(&parameters), true);
+  MlasConvPackFilter(&parameters, filter, data.get());
+  transformed_filters_.push_back({parameters.Algorithm, parameters.u.Transform.TransformSize, std::move(data)});
+
+  return static_cast<const float*>(transformed_filters_.back().data.get());
+}
+
 Status Conv<float>::Compute(OpKernelContext* context) const {
   size_t num_inputs = OpKernel::Node().InputDefs().size();
   const Tensor* X = context->Input<Tensor>(0);
@@ -214,7 +325,7 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
   concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
 
   if (kernel_rank >= 1 && kernel_rank <= 3) {
-    MLAS_CONV_PARAMETERS Parameters;
+    MLAS_CONV_PARAMETERS Parameters{};
     size_t WorkingBufferSize;
     MlasConvPrepare(&Parameters,
                     kernel_rank,
@@ -231,7 +342,14 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
                     &activation_,
                     &WorkingBufferSize,
                     Beta,
-                    thread_pool);
+                    thread_pool,
+                    allow_fast_algorithms_ && filter_is_constant_);
+
+    // The Winograd and FFT algorithms use a transformed filter.
+    const float* filter_data = W->Data<float>();
+    if (MlasConvPackFilterSize(&Parameters) > 0) {
+      filter_data = GetTransformedFilter(Parameters, filter_data);
+    }
 
     auto* working_data = WorkingBufferSize > 0 ? alloc->Alloc(sizeof(float) * SafeInt<size_t>(WorkingBufferSize))
                                                : nullptr;
@@ -239,7 +357,7 @@ Status Conv<float>::Compute(OpKernelContext* context) const {
 
     MlasConv(&Parameters,
              Xdata.data(),
-             W->Data<float>(),
+             filter_data,
              Bdata,
              static_cast<float*>(working_buffer.get()),
              Ydata.data(),
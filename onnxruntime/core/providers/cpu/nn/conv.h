@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "core/framework/op_kernel.h"
 #include "core/providers/cpu/nn/conv_attributes.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 namespace onnxruntime {
 
@@ -26,14 +29,43 @@ class Conv<float> : public OpKernel {
  public:
   Conv(const OpKernelInfo& info) : OpKernel(info), conv_attrs_(info) {
     activation_.ActivationKind = MlasIdentityActivation;
+    allow_fast_algorithms_ =
+        info.GetConfigOptions().GetConfigEntry(kOrtSessionOptionsMlasConvFastAlgorithms) == "1";
   }
 
+  Status PrePack(const Tensor& tensor, int input_idx, AllocatorPtr alloc,
+                 /*out*/ bool& is_packed,
+                 /*out*/ PrePackedWeights* prepacked_weights) override;
+
   Status Compute(OpKernelContext* context) const override;
 
  protected:
   MLAS_ACTIVATION activation_;
 
   ConvAttributes conv_attrs_;
+
+ private:
+  // Returns the filter transformed for the Winograd or FFT algorithm of the parameters, transforming it on first
+  // use. The filter is a constant initializer, so every transform is kept for later runs.
+  const float* GetTransformedFilter(const MLAS_CONV_PARAMETERS& parameters, const float* filter) const;
+
+  // Whether MLAS may select the Winograd and FFT algorithms.
+  bool allow_fast_algorithms_{false};
+
+  // Whether the filter is a constant initializer, which PrePack was called for. The Winograd and FFT algorithms
+  // are only selected then, as the transform of the filter is not included in their cost.
+  bool filter_is_constant_{false};
+
+  // Filters transformed for each algorithm and transform size selected so far. There are at most a few of them,
+  // one per Winograd tile or FFT size. The filter input is kept for the other algorithms.
+  struct TransformedFilter {
+    MLAS_CONV_ALGORITHM algorithm;
+    size_t transform_size;
+    IAllocatorUniquePtr<void> data;
+  };
+  AllocatorPtr transformed_filter_alloc_;
+  mutable InlinedVector<TransformedFilter> transformed_filters_;
+  mutable std::mutex transformed_filters_mutex_;
 };
 
 }  // namespace onnxruntime
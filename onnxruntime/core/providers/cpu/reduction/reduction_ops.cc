@@ -6,6 +6,7 @@
 #include "core/common/inlined_containers.h"
 #include "core/common/narrow.h"
 #include "core/common/span_utils.h"
+#include "core/mlas/inc/mlas.h"
 #include "core/providers/common.h"
 // TODO: fix the warnings
 #if defined(_MSC_VER) && !defined(__clang__)
@@ -382,6 +383,128 @@ void ReduceAggregatorBase::FastReduceRKR(const Tensor&, const gsl::span<const in
   ValidateMustBeOverloaded();
 }
 
+// Reduces the axes fast_axes of a float tensor whose shape was compressed into fast_shape by
+// OptimizeShapeForFastReduce. Every group of reduced axes is the middle of an [outer, reduced, inner] view,
+// the groups are reduced one after the other from the innermost one. Each pass reads its input sequentially
+// and its output is smaller than its input by the size of the group. The intermediate passes write into two
+// scratch buffers taken in turn from the kernel's temp-space allocator.
+static void MlasFastReduceAxes(MLAS_REDUCE_KIND kind, const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                               const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                               concurrency::ThreadPool* tp) {
+  TensorShapeVector shape = ToShapeVector(fast_shape);
+  int64_t output_size = 1;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    if (std::find(fast_axes.begin(), fast_axes.end(), static_cast<int64_t>(i)) == fast_axes.end()) {
+      output_size *= shape[i];
+    }
+  }
+  ORT_ENFORCE(!fast_axes.empty(), "No axis to reduce.");
+  ORT_ENFORCE(output_size == output.Shape().Size(), "Output size mismatch.");
+
+  // The outputs shrink pass after pass, each buffer is sized by the first pass writing into it.
+  size_t buffer_sizes[2] = {0, 0};
+  TensorShapeVector pass_shape = shape;
+  for (size_t i = fast_axes.size(); i-- > 1;) {
+    pass_shape[onnxruntime::narrow<size_t>(fast_axes[i])] = 1;
+    if (buffer_sizes[i % 2] == 0) {
+      SafeInt<size_t> pass_size = 1;
+      for (auto d : pass_shape) {
+        pass_size *= d;
+      }
+      buffer_sizes[i % 2] = pass_size;
+    }
+  }
+  IAllocatorUniquePtr<float> buffer;
+  if (fast_axes.size() > 1) {
+    buffer = IAllocator::MakeUniquePtr<float>(std::move(allocator), SafeInt<size_t>(buffer_sizes[0]) + buffer_sizes[1]);
+  }
+  float* buffers[2] = {buffer.get(), buffer.get() + buffer_sizes[0]};
+
+  const float* from_data = input.Data<float>();
+  for (size_t i = fast_axes.size(); i-- > 0;) {
+    const size_t axis = onnxruntime::narrow<size_t>(fast_axes[i]);
+    int64_t outer = 1;
+    int64_t inner = 1;
+    for (size_t d = 0; d < axis; ++d) {
+      outer *= shape[d];
+    }
+    for (size_t d = axis + 1; d < shape.size(); ++d) {
+      inner *= shape[d];
+    }
+
+    float* to_data = output.MutableData<float>();
+    if (i > 0) {
+      to_data = buffers[i % 2];
+    }
+
+    // The partial sums of squares are added together, the other reductions are their own combination.
+    MLAS_REDUCE_KIND pass_kind = kind;
+    if (i + 1 < fast_axes.size() && kind == MlasReduceSumSquare) {
+      pass_kind = MlasReduceSum;
+    }
+    MlasReduce(pass_kind, from_data, to_data, onnxruntime::narrow<size_t>(outer),
+               onnxruntime::narrow<size_t>(shape[axis]), onnxruntime::narrow<size_t>(inner), tp);
+
+    shape[axis] = 1;
+    from_data = to_data;
+  }
+}
+
+template <>
+void ReduceAggregatorSum<float>::FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                                                const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                                AllocatorPtr allocator, concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceSum, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+}
+
+template <>
+void ReduceAggregatorSumSquare<float, float>::FastReduceAxes(const Tensor& input,
+                                                             const gsl::span<const int64_t>& fast_shape,
+                                                             const gsl::span<const int64_t>& fast_axes,
+                                                             Tensor& output, AllocatorPtr allocator,
+                                                             concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceSumSquare, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+}
+
+template <>
+void ReduceAggregatorMean<float>::FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                                                 const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                                 AllocatorPtr allocator, concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceSum, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+  int64_t reduced_size = 1;
+  for (auto a : fast_axes) {
+    reduced_size *= fast_shape[onnxruntime::narrow<size_t>(a)];
+  }
+  float div = static_cast<float>(reduced_size);
+  float* out = output.MutableData<float>();
+  float* end = out + output.Shape().Size();
+  for (; out != end; ++out) {
+    *out /= div;
+  }
+}
+
+template <>
+void ReduceAggregatorMax<float>::FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                                                const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                                AllocatorPtr allocator, concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceMaximum, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+}
+
+template <>
+void ReduceAggregatorMin<float>::FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                                                const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                                AllocatorPtr allocator, concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceMinimum, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+}
+
+template <>
+void ReduceAggregatorLogSumExp<float>::FastReduceAxes(const Tensor& input,
+                                                      const gsl::span<const int64_t>& fast_shape,
+                                                      const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                                      AllocatorPtr allocator, concurrency::ThreadPool* tp) {
+  MlasFastReduceAxes(MlasReduceLogSumExp, input, fast_shape, fast_axes, output, std::move(allocator), tp);
+}
+
 void NoTransposePrepareForReduce(const TensorShape& new_input_shape,
                                  gsl::span<const int64_t> reduced_axes,
                                  ResultsNoTransposePrepareForReduce& results) {
@@ -771,6 +894,10 @@ bool CommonFastReduceCopy(OpKernelContext* ctx, TensorShapeVector& input_axes, b
 typedef void fast_reduce_fct(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
                              Tensor& output, concurrency::ThreadPool* tp);
 
+typedef void fast_reduce_axes_fct(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                                  const gsl::span<const int64_t>& fast_axes, Tensor& output,
+                                  AllocatorPtr allocator, concurrency::ThreadPool* tp);
+
 bool CommonFastReduceSwitch(OpKernelContext* ctx,
                             const gsl::span<const int64_t>& axes_,
                             int64_t keepdims_,
@@ -783,7 +910,8 @@ bool CommonFastReduceSwitch(OpKernelContext* ctx,
                             fast_reduce_fct* case_kr,
                             fast_reduce_fct* case_rk,
                             fast_reduce_fct* case_krk,
-                            fast_reduce_fct* case_rkr) {
+                            fast_reduce_fct* case_rkr,
+                            fast_reduce_axes_fct* case_axes) {
   const Tensor* input = ctx->Input<Tensor>(0);
   auto reduced_dims = input->Shape().GetDims();
   TensorShapeVector input_axes;
@@ -795,6 +923,14 @@ bool CommonFastReduceSwitch(OpKernelContext* ctx,
   fast_kind = OptimizeShapeForFastReduce(
       reduced_dims, input_axes.empty() ? axes_ : input_axes,
       fast_shape, output_shape, fast_axes, keepdims_ != 0, noop_with_empty_axes);
+  if (case_axes != nullptr && fast_kind != FastReduceKind::kEmpty && fast_kind != FastReduceKind::kK) {
+    // Every layout is reduced the same way, the size heuristics below do not apply.
+    Tensor* output = ctx->Output(0, output_shape);
+    AllocatorPtr allocator;
+    ORT_THROW_IF_ERROR(ctx->GetTempSpaceAllocator(&allocator));
+    case_axes(*input, fast_shape, fast_axes, *output, std::move(allocator), ctx->GetOperatorThreadPool());
+    return true;
+  }
   if (which_fast_reduce != FastReduceKind::kNone) {
     if (IsFastReduceKindAvailable(fast_kind, which_fast_reduce)) {
       Tensor* output = ctx->Output(0, output_shape);
@@ -854,10 +990,14 @@ bool CommonFastReduce(OpKernelContext* ctx,
                       TensorShapeVector& fast_shape,
                       TensorShapeVector& output_shape,
                       TensorShapeVector& fast_axes) {
+  fast_reduce_axes_fct* case_axes = nullptr;
+  if constexpr (AGG::HasFastReduceAxes()) {
+    case_axes = &AGG::FastReduceAxes;
+  }
   return CommonFastReduceSwitch(ctx, axes_, keepdims_, noop_with_empty_axes,
                                 fast_kind, fast_shape, output_shape, fast_axes,
                                 AGG::WhichFastReduce(), &AGG::FastReduceKR, &AGG::FastReduceRK,
-                                &AGG::FastReduceKRK, &AGG::FastReduceRKR);
+                                &AGG::FastReduceKRK, &AGG::FastReduceRKR, case_axes);
 }
 
 static void ValidateKeepDims(const TensorShape& shape, int64_t keepdims) {
@@ -1132,6 +1272,13 @@ std::unique_ptr<Tensor> ReduceSum<T>::Impl(const Tensor& input, gsl::span<const
     return output;
   }
 
+  if constexpr (ReduceAggregatorSum<T>::HasFastReduceAxes()) {
+    if (fast_kind != FastReduceKind::kK) {
+      ReduceAggregatorSum<T>::FastReduceAxes(input, fast_shape, fast_axes, *output, allocator, tp);
+      return output;
+    }
+  }
+
   if (IsFastReduceKindAvailable(fast_kind, ReduceAggregatorSum<T>::WhichFastReduce())) {
     switch (fast_kind) {
       case FastReduceKind::kKR: {
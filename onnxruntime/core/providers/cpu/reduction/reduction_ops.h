@@ -159,6 +159,13 @@ class ReduceAggregatorBase {
   static void FastReduceRK(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
   static void FastReduceKRK(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
   static void FastReduceRKR(const Tensor&, const gsl::span<const int64_t>&, Tensor&, concurrency::ThreadPool*);
+  // Aggregators returning true implement
+  //   static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+  //                              const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+  //                              concurrency::ThreadPool*);
+  // which reduces any combination of axes and replaces the cases above. The intermediate passes take their
+  // scratch buffers from allocator, the kernel's temp-space allocator.
+  static constexpr bool HasFastReduceAxes() { return false; }
 };
 
 template <typename T, typename TVAL = T>
@@ -224,6 +231,12 @@ class ReduceAggregatorSum : public ReduceAggregator<T, T> {
     EigenMap<T>(output).array() = static_cast<T>(0);
   }
 
+  // Fast reduction of any combination of axes with MLAS.
+  static constexpr bool HasFastReduceAxes() { return std::is_same_v<T, float>; }
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
+
   // Fast reduction
   static inline FastReduceKind WhichFastReduce() {
     return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK | FastReduceKind::kRKR;
@@ -300,6 +313,12 @@ class ReduceAggregatorSumSquare : public ReduceAggregator<T, TVAL> {
   static void fill_for_empty_set(Tensor& output) {
     EigenMap<T>(output).array() = static_cast<T>(0);
   }
+
+  // Fast reduction of any combination of axes with MLAS.
+  static constexpr bool HasFastReduceAxes() { return std::is_same_v<T, float> && std::is_same_v<TVAL, float>; }
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
 };
 
 template <typename T>
@@ -314,6 +333,11 @@ class ReduceAggregatorMean : public ReduceAggregatorSum<T> {
   }
   inline T get_value() { return this->accumulator_ / static_cast<T>(this->N_); }
 
+  // HasFastReduceAxes() already defined in ReduceAggregatorSum
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
+
   // Fast reduction
   // WhichFastReduce() already defined in ReduceAggregatorSum
 
@@ -392,6 +416,12 @@ class ReduceAggregatorMax : public ReduceAggregator<T> {
     }
   }
 
+  // Fast reduction of any combination of axes with MLAS.
+  static constexpr bool HasFastReduceAxes() { return std::is_same_v<T, float>; }
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
+
   // Fast reduction
   static inline FastReduceKind WhichFastReduce() {
     return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK | FastReduceKind::kRKR;
@@ -602,6 +632,12 @@ class ReduceAggregatorMin : public ReduceAggregator<T, T> {
     }
   }
 
+  // Fast reduction of any combination of axes with MLAS.
+  static constexpr bool HasFastReduceAxes() { return std::is_same_v<T, float>; }
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
+
   // Fast reduction
   static inline FastReduceKind WhichFastReduce() {
     return FastReduceKind::kKR | FastReduceKind::kRK | FastReduceKind::kKRK | FastReduceKind::kRKR;
@@ -782,8 +818,40 @@ class ReduceAggregatorLogSumExp : public ReduceAggregator<T, T> {
   static void fill_for_empty_set(Tensor& output) {
     EigenMap<T>(output).array() = -std::numeric_limits<T>::infinity();
   }
+
+  // Fast reduction of any combination of axes with MLAS.
+  static constexpr bool HasFastReduceAxes() { return std::is_same_v<T, float>; }
+  static void FastReduceAxes(const Tensor& input, const gsl::span<const int64_t>& fast_shape,
+                             const gsl::span<const int64_t>& fast_axes, Tensor& output, AllocatorPtr allocator,
+                             concurrency::ThreadPool* tp);
 };
 
+// The float reductions of any combination of axes run on MLAS kernels.
+template <>
+void ReduceAggregatorSum<float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                const gsl::span<const int64_t>&, Tensor&, AllocatorPtr,
+                                                concurrency::ThreadPool*);
+template <>
+void ReduceAggregatorSumSquare<float, float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                             const gsl::span<const int64_t>&, Tensor&,
+                                                             AllocatorPtr, concurrency::ThreadPool*);
+template <>
+void ReduceAggregatorMean<float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                 const gsl::span<const int64_t>&, Tensor&, AllocatorPtr,
+                                                 concurrency::ThreadPool*);
+template <>
+void ReduceAggregatorMax<float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                const gsl::span<const int64_t>&, Tensor&, AllocatorPtr,
+                                                concurrency::ThreadPool*);
+template <>
+void ReduceAggregatorMin<float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                const gsl::span<const int64_t>&, Tensor&, AllocatorPtr,
+                                                concurrency::ThreadPool*);
+template <>
+void ReduceAggregatorLogSumExp<float>::FastReduceAxes(const Tensor&, const gsl::span<const int64_t>&,
+                                                      const gsl::span<const int64_t>&, Tensor&,
+                                                      AllocatorPtr, concurrency::ThreadPool*);
+
 // Traits indicating whether a reduction aggregator applies element-wise transforms
 // in addition to reduction.
 // For axes=[] with noop_with_empty_axes=1, no reduction is performed; we either
@@ -3,6 +3,8 @@
 
 #include "core/providers/cpu/tensor/concat.h"
 
+#include <algorithm>
+
 #include "core/framework/element_type_lists.h"
 #include "core/framework/TensorSeq.h"
 #include "core/framework/copy.h"
@@ -245,11 +247,66 @@ TensorShapeVector StridesForStack(const TensorShapeVector& full_strides, uint64_
   }
   return strides;
 }
+
+// Below the concat axis every input is a contiguous block of 'axis_pitch' elements per outer index, and the blocks
+// of all the inputs are adjacent in each output row. Copy them in a single parallel pass over the output so the work
+// is balanced regardless of the number and sizes of the inputs, instead of one parallel copy per input.
+// Returns false if the blocks don't tile the output rows (empty inputs with a non-zero concat axis).
+bool ConcatContiguousBlocks(const Prepare& p, concurrency::ThreadPool* thread_pool) {
+  const size_t input_count = p.inputs.size();
+  const int64_t row_size = p.output_axis_pitch;
+
+  // offsets of the blocks of each input within an output row
+  InlinedVector<int64_t, Prepare::kExpectedNumberOfInputs + 1> block_offsets;
+  block_offsets.reserve(input_count + 1);
+  block_offsets.push_back(0);
+  for (const auto& input : p.inputs) {
+    block_offsets.push_back(block_offsets.back() + (input.num_elements == 0 ? 0 : input.axis_pitch));
+  }
+
+  if (block_offsets.back() != row_size) {
+    return false;
+  }
+
+  const size_t element_size = p.output_tensor->DataType()->Size();
+  auto* output = static_cast<uint8_t*>(p.output_tensor->MutableDataRaw());
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, onnxruntime::narrow<std::ptrdiff_t>(p.output_num_elements),
+      {static_cast<double>(element_size), static_cast<double>(element_size), 1.0},
+      [&p, &block_offsets, row_size, element_size, output](std::ptrdiff_t first, std::ptrdiff_t last) {
+        while (first < last) {
+          const int64_t row = first / row_size;
+          const int64_t column = first % row_size;
+
+          // the input with the block containing 'column'. empty blocks are skipped as they share their offset
+          // with the next block.
+          const auto input_index = static_cast<size_t>(
+              std::upper_bound(block_offsets.begin(), block_offsets.end(), column) - block_offsets.begin() - 1);
+          const int64_t block_begin = block_offsets[input_index];
+          const int64_t block_size = block_offsets[input_index + 1] - block_begin;
+          const int64_t count = std::min<int64_t>(block_begin + block_size - column, last - first);
+
+          const auto* input = static_cast<const uint8_t*>(p.inputs[input_index].tensor->DataRaw());
+          memcpy(output + first * element_size,
+                 input + (row * block_size + column - block_begin) * element_size,
+                 onnxruntime::narrow<size_t>(count) * element_size);
+
+          first += onnxruntime::narrow<std::ptrdiff_t>(count);
+        }
+      });
+
+  return true;
+}
 }  // namespace
 
 // This method computes the output tensor for Concat/ConcatFromSequence ops
 Status ConcatBase::ComputeImpl(Prepare& p, OpKernelContext* ctx) const {
   int input_count = static_cast<int>(p.inputs.size());
+
+  if (!p.is_string_type && ConcatContiguousBlocks(p, ctx->GetOperatorThreadPool())) {
+    return Status::OK();
+  }
   int64_t initial_output_offset = 0;  // initial offset for each input
 
   auto output_strides_full = StridesForTensor(*p.output_tensor);
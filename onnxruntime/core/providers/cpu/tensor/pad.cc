@@ -9,6 +9,7 @@
 #include "core/providers/op_kernel_type_control.h"
 #include "core/util/math.h"
 
+#include <algorithm>
 #include <functional>
 
 // there's no way to use a raw pointer as the copy destination with std::copy_n
@@ -492,6 +493,60 @@ static void PadAxisConstant(OutputSink<T>& sink, T* output, T constant, size_t s
   }
 }
 
+// Constant padding, split across the thread pool. The output is treated as rows along the innermost axis. A row in
+// the padding of an outer axis is all constant. Every other row is a run of the input with the innermost padding
+// before and after it. Partitions are ranges of elements rather than rows, so a few large rows split as well as many
+// small ones.
+template <typename T>
+static void PadConstant(concurrency::ThreadPool* thread_pool, const T* input, T* output, size_t total_output_elems,
+                        gsl::span<const int64_t> output_dims, gsl::span<const int64_t> input_dims,
+                        gsl::span<const int64_t> pads, gsl::span<const int64_t> input_starts,
+                        gsl::span<const int64_t> input_extents, T value) {
+  const size_t inner_axis = output_dims.size() - 1;
+  const std::ptrdiff_t row_size = narrow<std::ptrdiff_t>(output_dims[inner_axis]);
+  const std::ptrdiff_t pre_pad = narrow<std::ptrdiff_t>(pads[inner_axis]);
+  const std::ptrdiff_t copy_end = pre_pad + narrow<std::ptrdiff_t>(input_extents[inner_axis]);
+  const TensorPitches input_pitches(input_dims);
+
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, narrow<std::ptrdiff_t>(total_output_elems),
+      {static_cast<double>(sizeof(T)), static_cast<double>(sizeof(T)), 1.0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        while (first < last) {
+          const std::ptrdiff_t begin = first % row_size;
+          const std::ptrdiff_t end = std::min<std::ptrdiff_t>(row_size, begin + (last - first));
+          T* output_row = output + (first - begin);
+
+          // find the input row, unless the row is in the padding of an outer axis
+          const T* input_row = input;
+          int64_t row = first / row_size;
+          for (size_t axis = inner_axis; axis-- > 0;) {
+            const int64_t index = row % output_dims[axis] - pads[axis];
+            row /= output_dims[axis];
+            if (index < 0 || index >= input_extents[axis]) {
+              input_row = nullptr;
+              break;
+            }
+            input_row += (index + input_starts[axis]) * input_pitches[axis];
+          }
+
+          if (input_row == nullptr) {
+            std::fill(output_row + begin, output_row + end, value);
+          } else {
+            const std::ptrdiff_t copy_begin_in_range = std::clamp(pre_pad, begin, end);
+            const std::ptrdiff_t copy_end_in_range = std::clamp(copy_end, begin, end);
+            std::fill(output_row + begin, output_row + copy_begin_in_range, value);
+            std::copy(input_row + input_starts[inner_axis] + (copy_begin_in_range - pre_pad),
+                      input_row + input_starts[inner_axis] + (copy_end_in_range - pre_pad),
+                      output_row + copy_begin_in_range);
+            std::fill(output_row + copy_end_in_range, output_row + end, value);
+          }
+
+          first += end - begin;
+        }
+      });
+}
+
 template <typename T>
 static Status PadImpl(OpKernelContext* ctx,
                       const PadsVector& pads,
@@ -627,47 +682,9 @@ static Status PadImpl(OpKernelContext* ctx,
 
   switch (mode) {
     case Mode::Constant:
-      // Loop over the output tensor, writing out padding between the blocks of copied data
-      // On loop entry, 'pad' is already set to the first continuous block of padding, and
-      // after every pass through the inner loop it gets set to the next continuous pad size.
-      while (input_counters) {
-        output += align_skip;
-        {
-          T* axis_start = output;
-          // Compute the actual number of data elements to copy on the innermost axis (after cropping).
-          const size_t inner_extent = onnxruntime::narrow<size_t>(effective_input_extents[inner_axis]);
-
-          // Copy innermost block. IMPORTANT: do not rely on the returned 'output' to be end-of-the extent.
-          ORT_IGNORE_RETURN_VALUE(input.CopyInnermostAxisSolitaryInnerStep(output));
-
-          const SafeInt<size_t> pre_pad = reshaped_pad[inner_axis];
-          const SafeInt<size_t> post_pad = reshaped_pad[inner_axis + new_dims_count];
-          if (pre_pad > 0) {
-            /// Pre-pad(innermost) retro-fill remains valid(write before row_start).
-            PadAxisConstant(sink, axis_start - static_cast<size_t>(pre_pad), value, pre_pad);
-          }
-          if (post_pad > 0) {
-            PadAxisConstant(sink, axis_start + inner_extent, value, post_pad);
-          }
-          output = axis_start + inner_extent + static_cast<size_t>(post_pad);
-          align_skip = pre_pad;
-        }
-        // Calculate the size of the next block of padding (skipping over the innermost axis since that's already done)
-        while (input_counters.Increment()) {
-          ptrdiff_t inner_pitch = onnxruntime::narrow<std::ptrdiff_t>(output_pitches[input_counters.Axis()]);
-          T* axis_start = output - inner_pitch * effective_input_extents[input_counters.Axis()];
-          const SafeInt<size_t> pre_pad = reshaped_pad[input_counters.Axis()];
-          const SafeInt<size_t> post_pad = reshaped_pad[input_counters.Axis() + new_dims_count];
-          if (pre_pad > 0) {
-            PadAxisConstant(sink, axis_start - static_cast<ptrdiff_t>(pre_pad * inner_pitch), value, pre_pad * inner_pitch);
-          }
-          if (post_pad > 0) {
-            PadAxisConstant(sink, output, value, post_pad * inner_pitch);
-          }
-          output += inner_pitch * post_pad;
-          align_skip += inner_pitch * pre_pad;
-        }
-      }
+      PadConstant<T>(ctx->GetOperatorThreadPool(), reinterpret_cast<const T*>(input_tensor.DataRaw()), output,
+                     total_output_elems, reshaped_output_dims, reshaped_input_dims, reshaped_pad, input_starts,
+                     effective_input_extents, value);
       break;
 
     case Mode::Edge:
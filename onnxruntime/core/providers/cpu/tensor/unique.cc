@@ -2,12 +2,20 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/tensor/unique.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <map>
+#include <numeric>
+#include <type_traits>
 #include <core/common/safeint.h>
 #include <gsl/gsl>
 #include "core/framework/op_kernel_type_control_utils.h"
 #include "core/providers/common.h"
 #include "core/providers/op_kernel_type_control.h"
+#include "core/platform/threadpool.h"
 
 namespace onnxruntime {
 
@@ -144,74 +152,408 @@ class Subtensor {
   std::vector<T> items_;
 };
 
-template <typename T>
-static void CreateFlattenedOutput(OpKernelContext& context,
-                                  const std::map<const T, int64_t>& offsets,         // map sorted key to unsorted idx
-                                  const std::vector<std::vector<int64_t>>& indices,  // unsorted
-                                  const std::vector<int64_t>& inverse_index,         // unsorted
-                                  bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
-  Tensor& Y = *context.Output(0, {num_unique});
-  Tensor* indices_out = context.Output(1, {num_unique});
-  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(inverse_index.size())});
-  Tensor* counts = context.Output(3, {num_unique});
+namespace {
 
-  auto Y_data = Y.MutableDataAsSpan<T>();
-  gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
-                                                           : gsl::span<int64_t>();
-  gsl::span<int64_t> inverse_indices_data = inverse_indices != nullptr ? inverse_indices->MutableDataAsSpan<int64_t>()
-                                                                       : gsl::span<int64_t>();
-  gsl::span<int64_t> counts_data = counts != nullptr ? counts->MutableDataAsSpan<int64_t>()
-                                                     : gsl::span<int64_t>();
+// Hashing, equality and ordering of the values of the flattened input. Floating point values are handled so that
+// -0 and +0 are the same value, and so that all NaNs are the same value, which sorts after all the other values.
+template <typename T>
+struct UniqueValueTraits {
+  static T Canonicalize(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      if (value == T(0)) {
+        return T(0);
+      }
+      if (std::isnan(value)) {
+        return std::numeric_limits<T>::quiet_NaN();
+      }
+    }
+    return value;
+  }
 
-  // iterate using 'offsets' which is sorted, but contains the offset of the unsorted entry
-  auto offsets_iter = offsets.begin();
-  for (int64_t i = 0, end = num_unique; i < end; ++i, ++offsets_iter) {
-    // write sequentially if we want sorted output, use the unsorted_idx if not
-    auto unsorted_idx = offsets_iter->second;
-    auto output_idx = sorted ? i : unsorted_idx;
+  static uint64_t Hash(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      const T canonical = Canonicalize(value);
+      if constexpr (sizeof(T) == sizeof(uint64_t)) {
+        uint64_t bits;
+        memcpy(&bits, &canonical, sizeof(bits));
+        return bits;
+      } else if constexpr (sizeof(T) == sizeof(uint32_t)) {
+        uint32_t bits;
+        memcpy(&bits, &canonical, sizeof(bits));
+        return bits;
+      } else {
+        return static_cast<uint64_t>(canonical);
+      }
+    } else {
+      return std::hash<T>{}(value);
+    }
+  }
 
-    Y_data[onnxruntime::narrow<size_t>(output_idx)] = offsets_iter->first;
+  static bool Equal(const T& a, const T& b) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return a == b || (std::isnan(a) && std::isnan(b));
+    } else {
+      return a == b;
+    }
+  }
 
-    if (indices_out) {
-      indices_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].front();
+  static bool Less(const T& a, const T& b) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return std::isnan(b) ? !std::isnan(a) : a < b;
+    } else {
+      return a < b;
     }
+  }
+};
 
-    if (counts) {
-      counts_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].size();
+template <typename T>
+using UniqueRadixKey = std::conditional_t<
+    sizeof(T) == 1, uint8_t,
+    std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+// Maps a value to an unsigned integer with the same ordering.
+template <typename T>
+UniqueRadixKey<T> ToRadixKey(T value) {
+  using TKey = UniqueRadixKey<T>;
+  constexpr TKey sign_bit = TKey(1) << (sizeof(TKey) * 8 - 1);
+
+  const T canonical = UniqueValueTraits<T>::Canonicalize(value);
+  TKey bits;
+  memcpy(&bits, &canonical, sizeof(bits));
+
+  if constexpr (std::is_floating_point_v<T>) {
+    return (bits & sign_bit) ? TKey(~bits) : TKey(bits | sign_bit);
+  } else if constexpr (std::is_signed_v<T>) {
+    return TKey(bits ^ sign_bit);
+  } else {
+    return bits;
+  }
+}
+
+// Number of slots for a hash table of up to 'count' values, keeping the load factor below 2/3.
+size_t UniqueHashTableCapacity(size_t count) {
+  size_t capacity = 2;
+  while (capacity < count + count / 2 + 1) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+// Open addressing hash table with linear probing, of the unique values of a span. The values are not copied: the
+// slots hold 1 + the id of a unique value, and the ids are assigned in the order of insertion. first[id] is the
+// position in the span of the value, and counts[id] the number of times it was inserted.
+template <typename T, typename TSlot>
+class UniqueHashTable {
+ public:
+  UniqueHashTable(gsl::span<const T> data, gsl::span<TSlot> slots,
+                  gsl::span<int64_t> first, gsl::span<int64_t> counts)
+      : data_(data), slots_(slots), first_(first), counts_(counts), mask_(slots.size() - 1) {
+    assert((slots.size() & mask_) == 0);
+    shift_ = 64;
+    for (size_t capacity = slots.size(); capacity > 1; capacity /= 2) {
+      --shift_;
     }
+    std::fill(slots_.begin(), slots_.end(), TSlot(0));
   }
 
-  if (inverse_indices) {
-    if (sorted) {
-      // need to convert unsorted entries in the inverse index to their sorted values
-      std::vector<int64_t> unsorted_to_sorted;
-      unsorted_to_sorted.resize(onnxruntime::narrow<size_t>(num_unique));
-      int64_t sorted_idx = 0;
-      for (const auto& offset : offsets) {
-        unsorted_to_sorted[onnxruntime::narrow<size_t>(offset.second)] = sorted_idx++;
+  // Inserts the value at 'position' in the span 'count' times, and returns its id.
+  int64_t Insert(int64_t position, int64_t count) {
+    const T& value = data_[onnxruntime::narrow<size_t>(position)];
+    // Fibonacci hashing, to spread keys that differ in their low bits only, like consecutive IDs.
+    size_t slot = static_cast<size_t>((UniqueValueTraits<T>::Hash(value) * 0x9E3779B97F4A7C15ull) >> shift_);
+
+    for (;;) {
+      const TSlot entry = slots_[slot];
+      if (entry == 0) {
+        const size_t id = num_unique_++;
+        slots_[slot] = static_cast<TSlot>(id + 1);
+        first_[id] = position;
+        counts_[id] = count;
+        return static_cast<int64_t>(id);
       }
 
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[onnxruntime::narrow<size_t>(i)] = unsorted_to_sorted[onnxruntime::narrow<size_t>(inverse_index[i])];
+      const size_t id = static_cast<size_t>(entry - 1);
+      if (UniqueValueTraits<T>::Equal(data_[onnxruntime::narrow<size_t>(first_[id])], value)) {
+        counts_[id] += count;
+        return static_cast<int64_t>(id);
       }
-    } else {
-      for (size_t i = 0, end = inverse_index.size(); i < end; ++i) {
-        inverse_indices_data[i] = inverse_index[i];
+
+      slot = (slot + 1) & mask_;
+    }
+  }
+
+  size_t Size() const { return num_unique_; }
+
+ private:
+  gsl::span<const T> data_;
+  gsl::span<TSlot> slots_;
+  gsl::span<int64_t> first_;
+  gsl::span<int64_t> counts_;
+  size_t mask_;
+  int shift_;
+  size_t num_unique_{0};
+};
+
+// Sorts 'ids' by value with a LSD radix sort over the bytes of the keys, skipping the bytes that all the keys
+// share. The keys are recomputed from the values on each pass instead of being moved along with the ids.
+template <typename T>
+void RadixSortUniqueIds(gsl::span<const T> data, gsl::span<const int64_t> first,
+                        gsl::span<int64_t> ids, gsl::span<int64_t> scratch) {
+  constexpr size_t kNumDigits = sizeof(UniqueRadixKey<T>);
+  const size_t num_ids = ids.size();
+
+  auto key_of = [&](int64_t id) {
+    return ToRadixKey(data[onnxruntime::narrow<size_t>(first[onnxruntime::narrow<size_t>(id)])]);
+  };
+
+  std::vector<std::array<size_t, 256>> histograms(kNumDigits, std::array<size_t, 256>{});
+  for (const int64_t id : ids) {
+    const auto key = key_of(id);
+    for (size_t digit = 0; digit < kNumDigits; ++digit) {
+      ++histograms[digit][static_cast<uint8_t>(key >> (digit * 8))];
+    }
+  }
+
+  gsl::span<int64_t> src = ids;
+  gsl::span<int64_t> dst = scratch.first(num_ids);
+
+  for (size_t digit = 0; digit < kNumDigits; ++digit) {
+    auto& histogram = histograms[digit];
+    if (std::any_of(histogram.begin(), histogram.end(), [num_ids](size_t count) { return count == num_ids; })) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (auto& count : histogram) {
+      const size_t bucket_size = count;
+      count = offset;
+      offset += bucket_size;
+    }
+
+    for (const int64_t id : src) {
+      dst[histogram[static_cast<uint8_t>(key_of(id) >> (digit * 8))]++] = id;
+    }
+
+    std::swap(src, dst);
+  }
+
+  if (src.data() != ids.data()) {
+    std::copy(src.begin(), src.end(), ids.begin());
+  }
+}
+
+// Returns in 'order' the ids of the unique values in ascending order of value.
+template <typename T>
+void SortUniqueIds(gsl::span<const T> data, gsl::span<const int64_t> first,
+                   gsl::span<int64_t> order, gsl::span<int64_t> scratch) {
+  // Below this count, a comparison sort is cheaper than the histogram and passes of the radix sort.
+  constexpr size_t kMinRadixSortCount = 256;
+
+  std::iota(order.begin(), order.end(), int64_t{0});
+
+  if constexpr (std::is_arithmetic_v<T>) {
+    if (order.size() >= kMinRadixSortCount) {
+      RadixSortUniqueIds(data, first, order, scratch);
+      return;
+    }
+  }
+
+  ORT_UNUSED_PARAMETER(scratch);
+  std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return UniqueValueTraits<T>::Less(data[onnxruntime::narrow<size_t>(first[onnxruntime::narrow<size_t>(a)])],
+                                      data[onnxruntime::narrow<size_t>(first[onnxruntime::narrow<size_t>(b)])]);
+  });
+}
+
+// Minimum number of values per partition of the flattened input, so that the hash table of a partition is not
+// dominated by the cost of merging it.
+constexpr size_t kUniqueMinPartitionSize = 32 * 1024;
+
+// Computes the unique values of the flattened input with hash tables, without copying the values or keeping lists
+// of indices. Large inputs are split into partitions that are deduplicated in parallel, and whose unique values are
+// then merged in partition order, which keeps the ids in the order of first occurrence. TSlot is the type of the
+// hash table slots, which must be able to hold 1 + the number of values.
+template <typename T, typename TSlot>
+Status ComputeFlattenedUnique(OpKernelContext& context, gsl::span<const T> data, bool sorted) {
+  const size_t num_values = data.size();
+  concurrency::ThreadPool* thread_pool = context.GetOperatorThreadPool();
+
+  const size_t num_partitions = std::max<size_t>(
+      1, std::min<size_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool),
+                          num_values / kUniqueMinPartitionSize));
+  auto partition_begin = [num_values, num_partitions](size_t partition) -> size_t {
+    return SafeInt<size_t>(num_values) * partition / num_partitions;
+  };
+
+  Tensor* inverse_indices = context.Output(2, {static_cast<int64_t>(num_values)});
+
+  // All the working memory comes from a single allocation: the ids and counts of the unique values (and of the
+  // unique values of each partition when partitioned), the inverse indices if not an output, the sort buffers,
+  // and the hash table slots, which are shared by the partitions and then reused for the merged table.
+  size_t num_slots = UniqueHashTableCapacity(num_values);
+  if (num_partitions > 1) {
+    size_t partition_slots = 0;
+    for (size_t partition = 0; partition < num_partitions; ++partition) {
+      partition_slots += UniqueHashTableCapacity(partition_begin(partition + 1) - partition_begin(partition));
+    }
+    num_slots = std::max(num_slots, partition_slots);
+  }
+
+  size_t num_int64 = 2 * num_values;
+  if (num_partitions > 1) {
+    num_int64 += 2 * num_values;
+  }
+  if (inverse_indices == nullptr) {
+    num_int64 += num_values;
+  }
+  if (sorted) {
+    num_int64 += 2 * num_values;
+  }
+
+  AllocatorPtr alloc;
+  ORT_RETURN_IF_ERROR(context.GetTempSpaceAllocator(&alloc));
+  auto arena = IAllocator::MakeUniquePtr<int64_t>(
+      alloc, SafeInt<size_t>(num_int64) + (SafeInt<size_t>(num_slots) * sizeof(TSlot) + 7) / 8);
+
+  int64_t* arena_next = arena.get();
+  auto take = [&arena_next](size_t count) {
+    gsl::span<int64_t> buffer(arena_next, count);
+    arena_next += count;
+    return buffer;
+  };
+
+  gsl::span<int64_t> first = take(num_values);
+  gsl::span<int64_t> counts = take(num_values);
+  gsl::span<int64_t> inverse = inverse_indices != nullptr ? inverse_indices->MutableDataAsSpan<int64_t>()
+                                                          : take(num_values);
+  gsl::span<int64_t> partition_first = num_partitions > 1 ? take(num_values) : gsl::span<int64_t>();
+  gsl::span<int64_t> partition_counts = num_partitions > 1 ? take(num_values) : gsl::span<int64_t>();
+  gsl::span<int64_t> order = sorted ? take(num_values) : gsl::span<int64_t>();
+  gsl::span<int64_t> sort_scratch = sorted ? take(num_values) : gsl::span<int64_t>();
+  gsl::span<TSlot> slots(reinterpret_cast<TSlot*>(arena_next), num_slots);
+
+  size_t num_unique = 0;
+
+  if (num_partitions == 1) {
+    UniqueHashTable<T, TSlot> table(data, slots.first(UniqueHashTableCapacity(num_values)), first, counts);
+    for (size_t i = 0; i < num_values; ++i) {
+      inverse[i] = table.Insert(static_cast<int64_t>(i), 1);
+    }
+    num_unique = table.Size();
+  } else {
+    std::vector<size_t> partition_slots_begin(num_partitions + 1, 0);
+    for (size_t partition = 0; partition < num_partitions; ++partition) {
+      partition_slots_begin[partition + 1] =
+          partition_slots_begin[partition] +
+          UniqueHashTableCapacity(partition_begin(partition + 1) - partition_begin(partition));
+    }
+
+    // Deduplicate each partition. inverse receives the ids within the partition.
+    std::vector<size_t> partition_num_unique(num_partitions);
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_partitions), [&](std::ptrdiff_t p) {
+          const size_t partition = static_cast<size_t>(p);
+          const size_t begin = partition_begin(partition);
+          const size_t end = partition_begin(partition + 1);
+          UniqueHashTable<T, TSlot> table(
+              data,
+              slots.subspan(partition_slots_begin[partition],
+                            partition_slots_begin[partition + 1] - partition_slots_begin[partition]),
+              partition_first.subspan(begin, end - begin), partition_counts.subspan(begin, end - begin));
+          for (size_t i = begin; i < end; ++i) {
+            inverse[i] = table.Insert(static_cast<int64_t>(i), 1);
+          }
+          partition_num_unique[partition] = table.Size();
+        });
+
+    // Merge the unique values of the partitions in order. partition_first receives the merged ids.
+    size_t num_partition_unique = 0;
+    for (const size_t count : partition_num_unique) {
+      num_partition_unique += count;
+    }
+
+    UniqueHashTable<T, TSlot> table(data, slots.first(UniqueHashTableCapacity(num_partition_unique)), first, counts);
+    for (size_t partition = 0; partition < num_partitions; ++partition) {
+      const size_t begin = partition_begin(partition);
+      for (size_t j = begin, end = begin + partition_num_unique[partition]; j < end; ++j) {
+        partition_first[j] = table.Insert(partition_first[j], partition_counts[j]);
       }
     }
+    num_unique = table.Size();
+
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool, static_cast<std::ptrdiff_t>(num_partitions), [&](std::ptrdiff_t p) {
+          const size_t partition = static_cast<size_t>(p);
+          const size_t begin = partition_begin(partition);
+          const size_t end = partition_begin(partition + 1);
+          for (size_t i = begin; i < end; ++i) {
+            inverse[i] = partition_first[begin + onnxruntime::narrow<size_t>(inverse[i])];
+          }
+        });
+  }
+
+  first = first.first(num_unique);
+  counts = counts.first(num_unique);
+
+  if (sorted) {
+    order = order.first(num_unique);
+    SortUniqueIds<T>(data, first, order, sort_scratch);
+
+    // Map the ids of the inverse indices to their rank.
+    gsl::span<int64_t> rank = sort_scratch.first(num_unique);
+    for (size_t i = 0; i < num_unique; ++i) {
+      rank[onnxruntime::narrow<size_t>(order[i])] = static_cast<int64_t>(i);
+    }
+
+    if (inverse_indices != nullptr) {
+      concurrency::ThreadPool::TryParallelFor(
+          thread_pool, static_cast<std::ptrdiff_t>(num_values), TensorOpCost{8.0, 8.0, 1.0},
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+            for (size_t i = static_cast<size_t>(begin); i < static_cast<size_t>(end); ++i) {
+              inverse[i] = rank[onnxruntime::narrow<size_t>(inverse[i])];
+            }
+          });
+    }
+  }
+
+  Tensor& Y = *context.Output(0, {static_cast<int64_t>(num_unique)});
+  Tensor* indices_out = context.Output(1, {static_cast<int64_t>(num_unique)});
+  Tensor* counts_out = context.Output(3, {static_cast<int64_t>(num_unique)});
+
+  auto Y_data = Y.MutableDataAsSpan<T>();
+  gsl::span<int64_t> indices_data = indices_out != nullptr ? indices_out->MutableDataAsSpan<int64_t>()
+                                                           : gsl::span<int64_t>();
+  gsl::span<int64_t> counts_data = counts_out != nullptr ? counts_out->MutableDataAsSpan<int64_t>()
+                                                         : gsl::span<int64_t>();
+
+  for (size_t i = 0; i < num_unique; ++i) {
+    const size_t id = sorted ? onnxruntime::narrow<size_t>(order[i]) : i;
+    Y_data[i] = data[onnxruntime::narrow<size_t>(first[id])];
+
+    if (indices_out) {
+      indices_data[i] = first[id];
+    }
+
+    if (counts_out) {
+      counts_data[i] = counts[id];
+    }
   }
+
+  return Status::OK();
 }
 
+}  // namespace
+
 template <typename T>
 static void CreateOutput(OpKernelContext& context,
                          const TensorShape& subtensor_shape,
                          int64_t axis,
                          const std::map<const Subtensor<T>, int64_t>& offsets,  // map sorted key to unsorted idx
-                         const std::vector<std::vector<int64_t>>& indices,      // unsorted
+                         const std::vector<int64_t>& first_index,               // unsorted
+                         const std::vector<int64_t>& counts_index,              // unsorted
                          const std::vector<int64_t>& inverse_index,             // unsorted
                          bool sorted) {
-  int64_t num_unique = static_cast<int64_t>(indices.size());
+  int64_t num_unique = static_cast<int64_t>(first_index.size());
 
   // rows and columns for the slice along axis, flattened to 2D by merging the dimensions before and after the axis
   int64_t num_cols = subtensor_shape.SizeFromDimension(onnxruntime::narrow<size_t>(axis));
@@ -269,11 +611,11 @@ static void CreateOutput(OpKernelContext& context,
     assert(item == items.cend());
 
     if (indices_out) {
-      indices_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].front();
+      indices_data[onnxruntime::narrow<size_t>(output_idx)] = first_index[onnxruntime::narrow<size_t>(unsorted_idx)];
     }
 
     if (counts) {
-      counts_data[onnxruntime::narrow<size_t>(output_idx)] = indices[onnxruntime::narrow<size_t>(unsorted_idx)].size();
+      counts_data[onnxruntime::narrow<size_t>(output_idx)] = counts_index[onnxruntime::narrow<size_t>(unsorted_idx)];
     }
   }
 
@@ -308,30 +650,12 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
   auto data = input.DataAsSpan<T>();
 
   if (flatten_) {
-    std::map<const T, int64_t> offsets;  // offset of entry in indices. provides map between sorted and unsorted values
-    std::vector<std::vector<int64_t>> indices;
-    std::vector<int64_t> inverse_index;
-
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
-    int64_t num_unique = 0;
-
-    for (int64_t i = 0, end = input.Shape().Size(); i < end; ++i) {
-      auto entry = offsets.find(data[onnxruntime::narrow<size_t>(i)]);
-      if (entry == offsets.end()) {
-        offsets[data[onnxruntime::narrow<size_t>(i)]] = num_unique;
-        inverse_index.push_back({num_unique});
-        indices.push_back({i});
-        ++num_unique;
-      } else {
-        size_t indices_idx = onnxruntime::narrow<size_t>(entry->second);
-        indices[indices_idx].push_back(i);
-        inverse_index.push_back(onnxruntime::narrow<int64_t>(indices_idx));
-      }
+    // The ids of the unique values are stored in the hash table slots, as 1 + id.
+    if (data.size() < std::numeric_limits<uint32_t>::max()) {
+      ORT_RETURN_IF_ERROR((ComputeFlattenedUnique<T, uint32_t>(context, data, sort_)));
+    } else {
+      ORT_RETURN_IF_ERROR((ComputeFlattenedUnique<T, uint64_t>(context, data, sort_)));
     }
-
-    CreateFlattenedOutput(context, offsets, indices, inverse_index, sort_);
   } else {
     const auto& input_shape = input.Shape();
     const int64_t input_dims = static_cast<int64_t>(input_shape.NumDimensions());
@@ -346,15 +670,15 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
     TensorShape subtensor_shape(std::move(subtensor_dims));
 
     std::map<const Subtensor<T>, int64_t> offsets;
-    std::vector<std::vector<int64_t>> indices;
+    std::vector<int64_t> first_index;
+    std::vector<int64_t> counts_index;
     std::vector<int64_t> inverse_index;
 
-    indices.reserve(data.size() / 2);  // arbitrary value. at worst 1 realloc but could be too large
-    inverse_index.reserve(data.size());
-
     int64_t num_unique = 0;
     int64_t n_axis = input_shape[onnxruntime::narrow<size_t>(axis)];
 
+    inverse_index.reserve(onnxruntime::narrow<size_t>(n_axis));
+
     for (int64_t i = 0; i < n_axis; ++i) {
       Subtensor<T> s(data, subtensor_shape, axis, n_axis, i);
 
@@ -362,16 +686,17 @@ Status Unique::ComputeImpl(OpKernelContext& context) const {
       if (entry == offsets.end()) {
         offsets[std::move(s)] = num_unique;
         inverse_index.push_back({num_unique});
-        indices.push_back({i});
+        first_index.push_back(i);
+        counts_index.push_back(1);
         ++num_unique;
       } else {
         size_t indices_idx = onnxruntime::narrow<size_t>(entry->second);
-        indices[indices_idx].push_back(i);
+        ++counts_index[indices_idx];
         inverse_index.push_back(onnxruntime::narrow<int64_t>(indices_idx));
       }
     }
 
-    CreateOutput(context, subtensor_shape, axis, offsets, indices, inverse_index, sort_);
+    CreateOutput(context, subtensor_shape, axis, offsets, first_index, counts_index, inverse_index, sort_);
   }
 
   return Status::OK();
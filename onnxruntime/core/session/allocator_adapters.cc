@@ -102,6 +102,9 @@ std::unordered_map<std::string, std::string> OrtAllocatorImplWrappingIAllocator:
     entries.insert_or_assign("NumArenaExtensions", std::to_string(stats.num_arena_extensions));
     entries.insert_or_assign("NumArenaShrinkages", std::to_string(stats.num_arena_shrinkages));
     entries.insert_or_assign("MaxAllocSize", std::to_string(stats.max_alloc_size));
+    entries.insert_or_assign("NumThreadCacheHits", std::to_string(stats.num_thread_cache_hits));
+    entries.insert_or_assign("NumThreadCacheMisses", std::to_string(stats.num_thread_cache_misses));
+    entries.insert_or_assign("ThreadCacheBytes", std::to_string(stats.thread_cache_bytes));
   }
   return entries;
 }
@@ -183,6 +186,12 @@ void IAllocatorImplWrappingOrtAllocator::GetStats(AllocatorStats* stats) {
         stats->num_arena_shrinkages = std::stoll(values[i]);
       } else if (strcmp(keys[i], "MaxAllocSize") == 0) {
         stats->max_alloc_size = std::stoll(values[i]);
+      } else if (strcmp(keys[i], "NumThreadCacheHits") == 0) {
+        stats->num_thread_cache_hits = std::stoll(values[i]);
+      } else if (strcmp(keys[i], "NumThreadCacheMisses") == 0) {
+        stats->num_thread_cache_misses = std::stoll(values[i]);
+      } else if (strcmp(keys[i], "ThreadCacheBytes") == 0) {
+        stats->thread_cache_bytes = std::stoll(values[i]);
       }
     }
   }
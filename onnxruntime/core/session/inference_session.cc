@@ -4,6 +4,7 @@
 #include "core/graph/onnx_protobuf.h"
 #include "core/session/inference_session.h"
 
+#include <chrono>
 #include <memory>
 #include <sstream>
 #include <list>
@@ -75,6 +76,7 @@
 #include "core/session/inference_session_utils.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/session/onnxruntime_run_options_config_keys.h"
+#include "core/session/run_queue.h"
 #include "core/session/user_logging_sink.h"
 #include "core/util/protobuf_parsing_utils.h"
 #include "core/util/thread_utils.h"
@@ -138,6 +140,39 @@ inline std::basic_string<T> GetCurrentTimeString() {
   return ss.str();
 }
 
+Status ParsePriorityClass(const std::string& name, concurrency::ThreadPool::PriorityClass& priority_class) {
+  if (name == "high") {
+    priority_class = concurrency::ThreadPool::PriorityClass::kHigh;
+  } else if (name == "normal") {
+    priority_class = concurrency::ThreadPool::PriorityClass::kNormal;
+  } else if (name == "low") {
+    priority_class = concurrency::ThreadPool::PriorityClass::kLow;
+  } else {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Invalid priority class '", name,
+                           "', expected high, normal or low.");
+  }
+  return Status::OK();
+}
+
+// Parses "<high>;<normal>;<low>" weights, an empty string leaves weights empty.
+Status ParsePriorityClassWeights(const std::string& weights_str, std::vector<int>& weights) {
+  weights.clear();
+  if (weights_str.empty()) {
+    return Status::OK();
+  }
+  for (const auto& weight_str : utils::SplitString(weights_str, ";")) {
+    int weight = 0;
+    ORT_RETURN_IF_NOT(TryParseStringWithClassicLocale(std::string(weight_str), weight) && weight >= 0,
+                      "Invalid priority class weight '", weight_str, "' in '", weights_str, "'.");
+    weights.push_back(weight);
+  }
+  ORT_RETURN_IF_NOT(weights.size() == concurrency::ThreadPool::kNumPriorityClasses,
+                    "Expected one weight per priority class, high;normal;low, got '", weights_str, "'.");
+  ORT_RETURN_IF(std::all_of(weights.begin(), weights.end(), [](int weight) { return weight == 0; }),
+                "At least one priority class weight must be positive.");
+  return Status::OK();
+}
+
 #if !defined(ORT_MINIMAL_BUILD)
 
 static bool HasControlflowNodes(const Graph& graph) {
@@ -450,6 +485,9 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
         to.allow_spinning = allow_intra_op_spinning;
         to.dynamic_block_base_ = std::stoi(session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigDynamicBlockBase, "0"));
         LOGS(*session_logger_, INFO) << "Dynamic block base set to " << to.dynamic_block_base_;
+        ORT_THROW_IF_ERROR(ParsePriorityClassWeights(
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsIntraOpPriorityClassWeights, ""),
+            to.priority_class_weights));
 
         // Set custom threading functions
         to.custom_create_thread_fn = session_options_.custom_create_thread_fn;
@@ -519,6 +557,8 @@ void InferenceSession::ConstructorCommon(const SessionOptions& session_options,
   }
 
   session_profiler_.Initialize(session_logger_);
+  session_profiler_.EnableHardwareCounters(
+      session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsProfileHardwareCounters, "0") == "1");
   if (session_options_.enable_profiling) {
     StartProfiling(session_options_.profile_file_prefix);
   }
@@ -736,6 +776,9 @@ InferenceSession::InferenceSession(const SessionOptions& session_options, const
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
 InferenceSession::~InferenceSession() {
+  // Complete the asynchronous runs while the rest of the session is alive.
+  run_queue_.reset();
+
   if (session_options_.enable_profiling) {
     ORT_TRY {
       EndProfiling();
@@ -2560,6 +2603,24 @@ common::Status InferenceSession::Initialize() {
     // Resolve memory pattern flags of the main graph and subgraph session states
     ResolveMemoryPatternFlags(*session_state_);
 
+    uint32_t sampling_rate = 0;
+    uint32_t sampling_interval_ms = 0;
+    ORT_RETURN_IF_ERROR_SESSIONID_(ParseStringWithClassicLocale(
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsSamplingProfilerRate, "0"),
+        sampling_rate));
+    ORT_RETURN_IF_ERROR_SESSIONID_(ParseStringWithClassicLocale(
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsSamplingProfilerIntervalMs, "0"),
+        sampling_interval_ms));
+    if (sampling_rate > 0 || sampling_interval_ms > 0) {
+      session_profiler_.EnableSampling(graph.MaxNodeIndex(), sampling_rate, sampling_interval_ms);
+    }
+
+    ORT_RETURN_IF_ERROR_SESSIONID_(CreateRunQueue(graph));
+
+    ORT_RETURN_IF_ERROR_SESSIONID_(ParsePriorityClass(
+        session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsIntraOpPriorityClass, "normal"),
+        intra_op_priority_class_));
+
     is_inited_ = true;
 
     if (!using_ort_model_bytes_for_initializers_) {
@@ -2984,6 +3045,20 @@ Status InferenceSession::Run(const RunOptions& run_options,
                              gsl::span<const std::string> feed_names, gsl::span<const OrtValue> feeds,
                              gsl::span<const std::string> output_names, std::vector<OrtValue>* p_fetches,
                              const std::vector<OrtDevice>* p_fetches_device_info) {
+  // With micro-batching, the call waits in the run queue to be merged with concurrent calls. The dispatchers of
+  // the queue come back here to execute, and IOBinding outputs on devices are not merged.
+  if (micro_batching_ && run_queue_ && p_fetches != nullptr && p_fetches_device_info == nullptr &&
+      !RunQueue::IsDispatcherThread()) {
+    RunQueue::Request request;
+    request.run_options = &run_options;
+    request.feed_names.assign(feed_names.begin(), feed_names.end());
+    request.feeds.assign(feeds.begin(), feeds.end());
+    request.fetch_names.assign(output_names.begin(), output_names.end());
+    request.fetches = *p_fetches;
+    request.fetches.resize(output_names.size());
+    return run_queue_->SubmitAndWait(std::move(request), *p_fetches);
+  }
+
   // Ignore run-level profiling request if session-level profiling is already enabled.
   std::optional<profiling::Profiler> run_profiler;
   if (run_options.enable_profiling && session_profiler_.IsEnabled()) {
@@ -2993,6 +3068,7 @@ Status InferenceSession::Run(const RunOptions& run_options,
   if (run_options.enable_profiling && !session_profiler_.IsEnabled()) {
     run_profiler.emplace();
     run_profiler->Initialize(session_logger_);
+    run_profiler->EnableHardwareCounters(session_profiler_.HardwareCountersEnabled());
     std::basic_string<ORTCHAR_T> profile_file = GenerateProfileFilePath(run_options.profile_file_prefix);
     for (auto& ep : execution_providers_) {
       run_profiler->AddEpProfilers(ep->GetProfiler());
@@ -3025,6 +3101,15 @@ Status InferenceSession::Run(const RunOptions& run_options,
     }
   }
 
+  // The parallel loops of the kernels run on this thread in the priority class of the run.
+  auto priority_class = intra_op_priority_class_;
+  const std::string& priority_class_str =
+      run_options.config_options.GetConfigOrDefault(kOrtRunOptionsConfigIntraOpPriorityClass, "");
+  if (!priority_class_str.empty()) {
+    ORT_RETURN_IF_ERROR(ParsePriorityClass(priority_class_str, priority_class));
+  }
+  concurrency::ThreadPool::PriorityScope priority_scope(priority_class);
+
   // Increment/decrement concurrent_num_runs_ and control
   // session threads spinning as configured. Do nothing for graph replay except the counter.
   const bool control_spinning = use_per_session_threads_ &&
@@ -3335,6 +3420,70 @@ Status InferenceSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+common::Status InferenceSession::CreateRunQueue(const Graph& graph) {
+  const auto& config_options = session_options_.config_options;
+  micro_batching_ = config_options.GetConfigOrDefault(kOrtSessionOptionsRunMicroBatching, "0") == "1";
+
+  RunQueue::Options options;
+  size_t max_delay_us = 0;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsRunAsyncMaxConcurrency, micro_batching_ ? "1" : "0"),
+      options.max_concurrency));
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsRunAsyncMaxBatchSize, "1"), options.max_batch_size));
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsRunAsyncBatchAxis, "0"), options.batch_axis));
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options.GetConfigOrDefault(kOrtSessionOptionsRunAsyncMaxDelayUs, "0"), max_delay_us));
+  options.max_delay = std::chrono::microseconds(max_delay_us);
+  if (options.max_concurrency == 0) {
+    ORT_RETURN_IF(micro_batching_, "Micro-batching requires a RunAsync concurrency of at least 1.");
+    return Status::OK();
+  }
+
+  if (options.max_batch_size > 1) {
+    // Merged requests are concatenated along the batch axis, which must not have a fixed size.
+    const auto batch_axis = static_cast<int>(options.batch_axis);
+    auto has_batch_dimension = [batch_axis](const NodeArg* node_arg) {
+      const auto* shape = node_arg->Shape();
+      return shape == nullptr || (shape->dim_size() > batch_axis && !shape->dim(batch_axis).has_dim_value());
+    };
+    if (!std::all_of(graph.GetInputs().begin(), graph.GetInputs().end(), has_batch_dimension) ||
+        !std::all_of(graph.GetOutputs().begin(), graph.GetOutputs().end(), has_batch_dimension)) {
+      LOGS(*session_logger_, WARNING) << "Not all the inputs and outputs of the model have a dynamic dimension "
+                                      << batch_axis << ", requests will not be merged.";
+      options.max_batch_size = 1;
+    }
+  }
+  if (micro_batching_ && options.max_batch_size <= 1) {
+    LOGS(*session_logger_, WARNING) << "Micro-batching is enabled but requests cannot be merged, Run calls will "
+                                       "only be queued.";
+  }
+
+  // The dispatcher threads are created with the custom thread creation functions of the session.
+  ThreadOptions to;
+  to.custom_create_thread_fn = session_options_.custom_create_thread_fn;
+  to.custom_thread_creation_options = session_options_.custom_thread_creation_options;
+  to.custom_join_thread_fn = session_options_.custom_join_thread_fn;
+  std::basic_stringstream<ORTCHAR_T> ss;
+  ss << ORT_TSTR("session-") << session_id_ << ORT_TSTR("-run-async");
+  run_queue_thread_name_ = ss.str();
+
+  auto run_fn = [this](const RunOptions& run_options, gsl::span<const std::string> feed_names,
+                       gsl::span<const OrtValue> feeds, gsl::span<const std::string> fetch_names,
+                       std::vector<OrtValue>& fetches) {
+    return Run(run_options, feed_names, feeds, fetch_names, &fetches);
+  };
+  run_queue_ = std::make_unique<RunQueue>(run_queue_thread_name_.c_str(), to, options,
+                                          session_state_->GetAllocator(OrtDevice()), std::move(run_fn),
+                                          *session_logger_);
+  LOGS(*session_logger_, INFO) << (micro_batching_ ? "Run and RunAsync use" : "RunAsync uses") << " a queue with "
+                               << options.max_concurrency << " dispatchers, a maximum batch size of "
+                               << options.max_batch_size << " along axis " << options.batch_axis
+                               << " and a maximum delay of " << max_delay_us << "us";
+  return Status::OK();
+}
+
 common::Status InferenceSession::RunAsync(const RunOptions* run_options,
                                           gsl::span<const char* const> feed_names,
                                           gsl::span<const OrtValue* const> feeds,
@@ -3343,6 +3492,41 @@ common::Status InferenceSession::RunAsync(const RunOptions* run_options,
                                           RunAsyncCallbackFn callback,
                                           void* user_data) {
   size_t num_fetches = fetch_names.size();
+  if (run_queue_) {
+    RunQueue::Request request;
+    request.run_options = run_options;
+    for (size_t i = 0; i != feed_names.size(); ++i) {
+      if (feed_names[i] == nullptr || feed_names[i][0] == '\0') {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "input name cannot be empty");
+      }
+      if (!feeds[i]) {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "NULL input supplied for input ", feed_names[i]);
+      }
+      request.feed_names.emplace_back(feed_names[i]);
+      request.feeds.emplace_back(*feeds[i]);
+    }
+    for (size_t i = 0; i != num_fetches; ++i) {
+      if (fetch_names[i] == nullptr || fetch_names[i][0] == '\0') {
+        return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "output name cannot be empty");
+      }
+      request.fetch_names.emplace_back(fetch_names[i]);
+      request.fetches.emplace_back(fetches[i] != nullptr ? *fetches[i] : OrtValue());
+    }
+    request.callback = [fetches, num_fetches, callback, user_data](const Status& status,
+                                                                   std::vector<OrtValue>& results) {
+      if (status.IsOK()) {
+        for (size_t i = 0; i != num_fetches; ++i) {
+          // Pre-allocated outputs were written in place.
+          if (fetches[i] == nullptr) {
+            fetches[i] = std::make_unique<OrtValue>(std::move(results[i])).release();
+          }
+        }
+      }
+      callback(user_data, fetches.data(), status.IsOK() ? num_fetches : 0, ToOrtStatus(status));
+    };
+    return run_queue_->Submit(std::move(request));
+  }
+
   auto* tp = GetIntraOpThreadPoolToUse();
   if (!tp || concurrency::ThreadPool::DegreeOfParallelism(tp) < 2) {
     return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "intra op thread pool must have at least one thread for RunAsync");
@@ -3680,6 +3864,46 @@ const profiling::Profiler& InferenceSession::GetProfiling() const {
   return session_profiler_;
 }
 
+common::Status InferenceSession::GetSampledNodeLatency(const std::string& node_name, double percentile,
+                                                       uint64_t& latency_ns) const {
+  if (!is_inited_) {
+    return Status(common::ONNXRUNTIME, common::FAIL, "Session not initialized.");
+  }
+  const auto* sampling_profiler = session_profiler_.GetSamplingProfiler();
+  if (sampling_profiler == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "The sampling profiler is not enabled, set ", kOrtSessionOptionsSamplingProfilerRate,
+                           " or ", kOrtSessionOptionsSamplingProfilerIntervalMs, ".");
+  }
+  if (percentile < 0.0 || percentile > 100.0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Percentile must be in [0, 100], got ", percentile);
+  }
+
+  for (const auto& node : session_state_->GetGraphViewer().Nodes()) {
+    if (node.Name() == node_name) {
+      latency_ns = sampling_profiler->GetNodeHistogram(node.Index())->Percentile(percentile);
+      return Status::OK();
+    }
+  }
+  return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "No node named '", node_name, "' in the main graph.");
+}
+
+common::Status InferenceSession::GetIntraOpQueueingDelay(concurrency::ThreadPool::PriorityClass priority_class,
+                                                         double percentile, uint64_t& delay_ns) const {
+  const auto* histogram = concurrency::ThreadPool::GetQueueingDelayHistogram(GetIntraOpThreadPoolToUse(),
+                                                                             priority_class);
+  if (histogram == nullptr) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT,
+                           "The intra-op thread pool has no priority class weights, set ",
+                           kOrtSessionOptionsIntraOpPriorityClassWeights, " or the global thread pool weights.");
+  }
+  if (percentile < 0.0 || percentile > 100.0) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, INVALID_ARGUMENT, "Percentile must be in [0, 100], got ", percentile);
+  }
+  delay_ns = histogram->Percentile(percentile);
+  return Status::OK();
+}
+
 #if !defined(ORT_MINIMAL_BUILD)
 std::vector<TuningResults> InferenceSession::GetTuningResults() const {
   std::vector<TuningResults> ret;
@@ -57,6 +57,7 @@ class Environment;
 class GraphTransformer;
 class IExecutionProvider;
 class IOBinding;
+class RunQueue;
 struct Notification;
 
 void reset_saturation_count();
@@ -373,6 +374,12 @@ class InferenceSession {
                                    gsl::span<const char* const> fetch_names,
                                    gsl::span<OrtValue*> fetches);
 
+  /**
+   * Run the model asynchronously, callback is called with the outputs when the run completes.
+   * By default the run is scheduled on the intra-op thread pool. If the session config entry
+   * session.run_async_max_concurrency is set, the request goes to a queue served by threads of its own,
+   * which can merge requests into batches, see RunQueue.
+   */
   [[nodiscard]] common::Status RunAsync(const RunOptions* run_options,
                                         gsl::span<const char* const> feed_names,
                                         gsl::span<const OrtValue* const> feeds,
@@ -570,6 +577,27 @@ class InferenceSession {
     */
   const profiling::Profiler& GetProfiling() const;
 
+  /**
+   * Get a percentile of the latency of a node of the main graph, measured by the sampling profiler.
+   * @param node_name Name of the node.
+   * @param percentile Percentile in [0, 100], e.g. 50 or 99.
+   * @param latency_ns The latency in nanoseconds, 0 if no run was sampled yet.
+   * @return OK if success, an error if the sampling profiler is not enabled or the node does not exist.
+   */
+  common::Status GetSampledNodeLatency(const std::string& node_name, double percentile, uint64_t& latency_ns) const;
+
+  /**
+   * Get a percentile of the queueing delay of the parallel loops of a priority class in the intra-op thread pool:
+   * the time between a kernel entering a loop and the first worker joining it. The pool is shared with the other
+   * sessions when the session uses the global thread pools.
+   * @param priority_class Priority class of the loops.
+   * @param percentile Percentile in [0, 100], e.g. 50 or 99.
+   * @param delay_ns The delay in nanoseconds, 0 if no loop of the class was joined yet.
+   * @return OK if success, an error if the pool has no priority class weights.
+   */
+  common::Status GetIntraOpQueueingDelay(concurrency::ThreadPool::PriorityClass priority_class, double percentile,
+                                         uint64_t& delay_ns) const;
+
 #if !defined(ORT_MINIMAL_BUILD)
   /**
    * Get the TuningResults of TunableOp for every execution providers.
@@ -814,6 +842,9 @@ class InferenceSession {
 
   void InitLogger(logging::LoggingManager* logging_manager);
 
+  // Creates run_queue_ if the session config asks for a RunAsync queue or for micro-batching.
+  [[nodiscard]] common::Status CreateRunQueue(const Graph& graph);
+
   static void TraceSessionOptions(const SessionOptions& session_options, bool captureState, const logging::Logger& logger);
 
   [[nodiscard]] common::Status CheckShapes(const std::string& input_name, const TensorShape& input_shape,
@@ -915,6 +946,15 @@ class InferenceSession {
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> thread_pool_;
   std::unique_ptr<onnxruntime::concurrency::ThreadPool> inter_op_thread_pool_;
 
+  // Queue of the RunAsync requests, with its own threads. nullptr if RunAsync uses the intra-op thread pool.
+  std::basic_string<ORTCHAR_T> run_queue_thread_name_;
+  std::unique_ptr<RunQueue> run_queue_;
+  // Whether the synchronous Run calls go through run_queue_ to be merged.
+  bool micro_batching_ = false;
+
+  // Priority class of the parallel loops of the runs that do not set one in their run options.
+  concurrency::ThreadPool::PriorityClass intra_op_priority_class_ = concurrency::ThreadPool::PriorityClass::kNormal;
+
   // Global threadpools. These are intialized and used when use_per_session_threads is false *and*
   // the environment is created with create_global_thread_pools = true.
   onnxruntime::concurrency::ThreadPool* intra_op_thread_pool_from_env_{};
@@ -2463,6 +2463,29 @@ ORT_API_STATUS_IMPL(OrtApis::SessionGetProfilingStartTimeNs, _In_ const OrtSessi
   API_IMPL_END
 }
 
+ORT_API_STATUS_IMPL(OrtApis::SessionGetSampledNodeLatency, _In_ const OrtSession* sess, _In_ const char* node_name,
+                    _In_ double percentile, _Out_ uint64_t* latency_ns) {
+  API_IMPL_BEGIN
+  const auto* session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  ORT_API_RETURN_IF_STATUS_NOT_OK(session->GetSampledNodeLatency(node_name, percentile, *latency_ns));
+  return nullptr;
+  API_IMPL_END
+}
+
+ORT_API_STATUS_IMPL(OrtApis::SessionGetIntraOpQueueingDelay, _In_ const OrtSession* sess, _In_ int priority_class,
+                    _In_ double percentile, _Out_ uint64_t* delay_ns) {
+  API_IMPL_BEGIN
+  if (priority_class < 0 ||
+      priority_class >= static_cast<int>(onnxruntime::concurrency::ThreadPool::kNumPriorityClasses)) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "priority_class must be 0 (high), 1 (normal) or 2 (low)");
+  }
+  const auto* session = reinterpret_cast<const ::onnxruntime::InferenceSession*>(sess);
+  ORT_API_RETURN_IF_STATUS_NOT_OK(session->GetIntraOpQueueingDelay(
+      static_cast<onnxruntime::concurrency::ThreadPool::PriorityClass>(priority_class), percentile, *delay_ns));
+  return nullptr;
+  API_IMPL_END
+}
+
 // End support for non-tensor types
 
 ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfg, _In_ size_t max_mem, int arena_extend_strategy, int initial_chunk_size_bytes,
@@ -2508,6 +2531,8 @@ ORT_API_STATUS_IMPL(OrtApis::CreateArenaCfgV2, _In_reads_(num_keys) const char*
       cfg->cuda_mempool_release_threshold = static_cast<uint64_t>(arena_config_values[i]);
     } else if (strcmp(arena_config_keys[i], "cuda_mempool_bytes_to_keep_on_shrink") == 0) {
       cfg->cuda_mempool_bytes_to_keep_on_shrink = static_cast<size_t>(arena_config_values[i]);
+    } else if (strcmp(arena_config_keys[i], "thread_cache_bytes") == 0) {
+      cfg->thread_cache_bytes = static_cast<int64_t>(arena_config_values[i]);
     } else {
       std::ostringstream oss;
       oss << "Invalid key found: " << arena_config_keys[i];
@@ -4807,6 +4832,9 @@ static constexpr OrtApi ort_api_1_to_25 = {
 
     &OrtApis::RunOptionsEnableProfiling,
     &OrtApis::RunOptionsDisableProfiling,
+    &OrtApis::SessionGetSampledNodeLatency,
+    &OrtApis::SetGlobalIntraOpPriorityClassWeights,
+    &OrtApis::SessionGetIntraOpQueueingDelay,
 };
 
 // OrtApiBase can never change as there is no way to know what version of OrtApiBase is returned by OrtGetApiBase.
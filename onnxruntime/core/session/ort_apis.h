@@ -815,4 +815,11 @@ ORT_API_STATUS_IMPL(GetTensorElementTypeAndShapeDataReference, _In_ const OrtVal
                     _Out_ ONNXTensorElementDataType* elem_type,
                     _Outptr_result_maybenull_ const int64_t** shape_data,
                     _Out_ size_t* shape_data_count);
+
+ORT_API_STATUS_IMPL(SessionGetSampledNodeLatency, _In_ const OrtSession* session, _In_ const char* node_name,
+                    _In_ double percentile, _Out_ uint64_t* latency_ns);
+ORT_API_STATUS_IMPL(SetGlobalIntraOpPriorityClassWeights, _Inout_ OrtThreadingOptions* tp_options,
+                    _In_reads_(num_weights) const int* weights, _In_ size_t num_weights);
+ORT_API_STATUS_IMPL(SessionGetIntraOpQueueingDelay, _In_ const OrtSession* session, _In_ int priority_class,
+                    _In_ double percentile, _Out_ uint64_t* delay_ns);
 }  // namespace OrtApis
@@ -0,0 +1,429 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/run_queue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+#include "core/common/narrow.h"
+#include "core/framework/tensor.h"
+#include "core/platform/EigenNonBlockingThreadPool.h"
+
+namespace onnxruntime {
+
+namespace {
+
+thread_local bool is_dispatcher_thread = false;
+
+// Copies count elements of src, starting at element src_offset, to dst starting at element dst_offset.
+void CopyElements(const Tensor& src, size_t src_offset, Tensor& dst, size_t dst_offset, size_t count) {
+  if (src.IsDataTypeString()) {
+    const auto* src_data = src.Data<std::string>() + src_offset;
+    std::copy(src_data, src_data + count, dst.MutableData<std::string>() + dst_offset);
+  } else {
+    const size_t element_size = src.DataType()->Size();
+    std::memcpy(static_cast<char*>(dst.MutableDataRaw()) + dst_offset * element_size,
+                static_cast<const char*>(src.DataRaw()) + src_offset * element_size,
+                count * element_size);
+  }
+}
+
+// The "allocator" of the outputs that are views of a merged output. It keeps the merged output alive as long as
+// one of the views uses it.
+class MergedOutputAllocator : public IAllocator {
+ public:
+  explicit MergedOutputAllocator(const OrtValue& merged)
+      : IAllocator(merged.Get<Tensor>().Location()), merged_(merged) {}
+
+  void* Alloc(size_t /*size*/) override {
+    ORT_THROW("MergedOutputAllocator does not allocate.");
+  }
+
+  void Free(void* /*p*/) override {}
+
+ private:
+  const OrtValue merged_;
+};
+
+}  // namespace
+
+// Env::CreateThread passes an Eigen thread pool to the threads it starts, the dispatchers get their queue instead.
+class RunQueue::DispatcherThreadParam : public Eigen::ThreadPoolInterface {
+ public:
+  explicit DispatcherThreadParam(RunQueue& queue) : queue_(queue) {}
+
+  void Schedule(std::function<void()> /*fn*/) override {
+    ORT_THROW("The dispatchers of a RunQueue do not run tasks.");
+  }
+
+  int NumThreads() const override {
+    return static_cast<int>(queue_.options_.max_concurrency);
+  }
+
+  int CurrentThreadId() const override {
+    return -1;
+  }
+
+  RunQueue& Queue() const { return queue_; }
+
+ private:
+  RunQueue& queue_;
+};
+
+RunQueue::RunQueue(const ORTCHAR_T* thread_name_prefix, const ThreadOptions& thread_options, const Options& options,
+                   AllocatorPtr cpu_allocator, RunFn run_fn, const logging::Logger& logger)
+    : options_(options),
+      cpu_allocator_(std::move(cpu_allocator)),
+      run_fn_(std::move(run_fn)),
+      logger_(logger),
+      dispatcher_thread_param_(std::make_unique<DispatcherThreadParam>(*this)) {
+  ORT_ENFORCE(options_.max_concurrency > 0, "RunQueue requires a concurrency of at least 1");
+  ORT_ENFORCE(options_.max_batch_size <= 1 || cpu_allocator_ != nullptr, "Merging requests requires a CPU allocator");
+
+  // One thread per request that can run at the same time, so that a request never waits for a dispatcher while
+  // another one is blocked in a run.
+  ORT_TRY {
+    dispatchers_.reserve(options_.max_concurrency);
+    for (size_t i = 0; i < options_.max_concurrency; ++i) {
+      dispatchers_.emplace_back(Env::Default().CreateThread(thread_name_prefix, static_cast<int>(i),
+                                                            DispatcherThreadMain, dispatcher_thread_param_.get(),
+                                                            thread_options));
+    }
+  }
+  ORT_CATCH(...) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      StopDispatchers();
+      ORT_RETHROW;
+    });
+  }
+}
+
+RunQueue::~RunQueue() {
+  std::deque<QueuedRequest> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    cancelled.swap(queue_);
+  }
+
+  const auto status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "The session was released before the request ran.");
+  for (auto& queued : cancelled) {
+    queued.request.callback(status, queued.request.fetches);
+  }
+
+  // Waits for the running requests.
+  StopDispatchers();
+}
+
+void RunQueue::StopDispatchers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    dispatcher_wakeup_.notify_all();
+    request_queued_.notify_all();
+  }
+  dispatchers_.clear();
+}
+
+unsigned RunQueue::DispatcherThreadMain(int /*index*/, Eigen::ThreadPoolInterface* param) {
+  static_cast<DispatcherThreadParam*>(param)->Queue().Dispatch();
+  return 0;
+}
+
+bool RunQueue::IsDispatcherThread() {
+  return is_dispatcher_thread;
+}
+
+Status RunQueue::Submit(Request&& request) {
+  ORT_RETURN_IF_NOT(request.fetches.size() == request.fetch_names.size(),
+                    "Expected one fetch per fetch name, got ", request.fetches.size(), " fetches for ",
+                    request.fetch_names.size(), " names.");
+  ORT_RETURN_IF_NOT(request.feeds.size() == request.feed_names.size(),
+                    "Expected one feed per feed name, got ", request.feeds.size(), " feeds for ",
+                    request.feed_names.size(), " names.");
+
+  QueuedRequest queued;
+  queued.request = std::move(request);
+  queued.batch_size = options_.max_batch_size > 1 ? GetBatchSize(queued.request) : 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shutting_down_) {
+    return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "The session is being released.");
+  }
+  queued.enqueue_time = std::chrono::steady_clock::now();
+  queue_.push_back(std::move(queued));
+  if (num_waiting_to_merge_ > 0) {
+    // The waiting dispatchers take the request, or wake an idle dispatcher for it.
+    request_queued_.notify_all();
+  } else {
+    dispatcher_wakeup_.notify_one();
+  }
+  return Status::OK();
+}
+
+Status RunQueue::SubmitAndWait(Request&& request, std::vector<OrtValue>& fetches) {
+  std::promise<Status> completed;
+  auto completed_future = completed.get_future();
+  request.callback = [&completed, &fetches](const Status& status, std::vector<OrtValue>& results) {
+    if (status.IsOK()) {
+      fetches = std::move(results);
+    }
+    completed.set_value(status);
+  };
+  ORT_RETURN_IF_ERROR(Submit(std::move(request)));
+  return completed_future.get();
+}
+
+void RunQueue::Dispatch() {
+  is_dispatcher_thread = true;
+
+  for (;;) {
+    std::vector<QueuedRequest> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      dispatcher_wakeup_.wait(lock, [this]() { return shutting_down_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+      size_t total_batch_size = TakeMergeable(batch, batch.front().batch_size);
+
+      if (options_.max_delay.count() > 0 && total_batch_size > 0 && total_batch_size < options_.max_batch_size) {
+        // Wait for more requests to merge, up to max_delay after the first request was queued.
+        const auto deadline = batch.front().enqueue_time + options_.max_delay;
+        ++num_waiting_to_merge_;
+        while (total_batch_size < options_.max_batch_size && !shutting_down_ && !merging_disabled_ &&
+               request_queued_.wait_until(lock, deadline) == std::cv_status::no_timeout) {
+          total_batch_size = TakeMergeable(batch, total_batch_size);
+          // The requests that cannot be merged need another dispatcher.
+          if (!queue_.empty()) {
+            dispatcher_wakeup_.notify_one();
+          }
+        }
+        --num_waiting_to_merge_;
+        TakeMergeable(batch, total_batch_size);
+      }
+      if (!queue_.empty()) {
+        dispatcher_wakeup_.notify_one();
+      }
+    }
+
+    if (batch.size() > 1) {
+      const auto status = RunMerged(batch);
+      if (status.IsOK()) {
+        continue;
+      }
+      LOGS(logger_, VERBOSE) << "Running " << batch.size() << " merged requests failed, running them one by one: "
+                             << status.ErrorMessage();
+    }
+
+    for (auto& queued : batch) {
+      RunOne(queued);
+    }
+  }
+}
+
+size_t RunQueue::TakeMergeable(std::vector<QueuedRequest>& batch, size_t total_batch_size) {
+  if (total_batch_size == 0 || merging_disabled_) {
+    return total_batch_size;
+  }
+
+  for (auto it = queue_.begin(); it != queue_.end() && total_batch_size < options_.max_batch_size;) {
+    if (CanMerge(batch.front(), *it) && total_batch_size + it->batch_size <= options_.max_batch_size) {
+      total_batch_size += it->batch_size;
+      batch.push_back(std::move(*it));
+      it = queue_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return total_batch_size;
+}
+
+Status RunQueue::Run(const RunOptions* run_options, gsl::span<const std::string> feed_names,
+                     gsl::span<const OrtValue> feeds, gsl::span<const std::string> fetch_names,
+                     std::vector<OrtValue>& fetches) {
+  Status status;
+  ORT_TRY {
+    status = run_fn_(run_options ? *run_options : default_run_options_, feed_names, feeds, fetch_names, fetches);
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, ex.what());
+    });
+  }
+  ORT_CATCH(...) {
+    status = ORT_MAKE_STATUS(ONNXRUNTIME, RUNTIME_EXCEPTION, "unknown exception");
+  }
+  return status;
+}
+
+void RunQueue::RunOne(QueuedRequest& queued) {
+  auto& request = queued.request;
+  const auto status = Run(request.run_options, request.feed_names, request.feeds, request.fetch_names,
+                          request.fetches);
+  request.callback(status, request.fetches);
+}
+
+Status RunQueue::RunMerged(std::vector<QueuedRequest>& batch) {
+  const size_t axis = options_.batch_axis;
+  const auto& first = batch.front().request;
+  size_t total_batch_size = 0;
+  for (const auto& queued : batch) {
+    total_batch_size += queued.batch_size;
+  }
+
+  // The tensors are seen as [outer, batch, inner], the requests are concatenated along batch.
+  InlinedVector<OrtValue> feeds(first.feeds.size());
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    const auto& first_feed = first.feeds[i].Get<Tensor>();
+    auto dims = first_feed.Shape().AsShapeVector();
+    dims[axis] = static_cast<int64_t>(total_batch_size);
+    Tensor::InitOrtValue(first_feed.DataType(), TensorShape(dims), cpu_allocator_, feeds[i]);
+
+    auto& merged = *feeds[i].GetMutable<Tensor>();
+    const auto outer_size = narrow<size_t>(merged.Shape().SizeToDimension(axis));
+    const auto inner_size = narrow<size_t>(merged.Shape().SizeFromDimension(axis + 1));
+    size_t offset = 0;
+    for (const auto& queued : batch) {
+      const auto& feed = queued.request.feeds[i].Get<Tensor>();
+      const size_t count = queued.batch_size * inner_size;
+      for (size_t outer = 0; outer < outer_size; ++outer) {
+        CopyElements(feed, outer * count, merged, (outer * total_batch_size + offset) * inner_size, count);
+      }
+      offset += queued.batch_size;
+    }
+  }
+
+  std::vector<OrtValue> fetches(first.fetch_names.size());
+  ORT_RETURN_IF_ERROR(Run(first.run_options, first.feed_names, feeds, first.fetch_names, fetches));
+
+  std::vector<std::vector<OrtValue>> outputs(batch.size(), std::vector<OrtValue>(fetches.size()));
+  for (size_t i = 0; i < fetches.size(); ++i) {
+    const bool batched = fetches[i].IsTensor() &&
+                         fetches[i].Get<Tensor>().Location().device.Type() == OrtDevice::CPU &&
+                         fetches[i].Get<Tensor>().Shape().NumDimensions() > axis &&
+                         fetches[i].Get<Tensor>().Shape()[axis] == static_cast<int64_t>(total_batch_size);
+    if (!batched) {
+      // The model does not keep the batch axis in its outputs, merging cannot work for it.
+      merging_disabled_ = true;
+      LOGS(logger_, WARNING) << "Output " << first.fetch_names[i] << " is not batched along axis " << axis
+                             << ", stopped merging requests.";
+      return ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Output ", first.fetch_names[i], " is not batched.");
+    }
+
+    const auto& merged = fetches[i].Get<Tensor>();
+    const auto outer_size = narrow<size_t>(merged.Shape().SizeToDimension(axis));
+    const auto inner_size = narrow<size_t>(merged.Shape().SizeFromDimension(axis + 1));
+    // The part of each request is contiguous when there is nothing before the batch axis, so the outputs can be
+    // views of the merged output. Not for strings, the views would destroy them.
+    std::shared_ptr<IAllocator> view_allocator;
+    if (outer_size == 1 && !merged.IsDataTypeString()) {
+      view_allocator = std::make_shared<MergedOutputAllocator>(fetches[i]);
+    }
+
+    auto dims = merged.Shape().AsShapeVector();
+    size_t offset = 0;
+    for (size_t r = 0; r < batch.size(); ++r) {
+      dims[axis] = static_cast<int64_t>(batch[r].batch_size);
+      const size_t count = batch[r].batch_size * inner_size;
+      if (view_allocator) {
+        Tensor::InitOrtValue(merged.DataType(), TensorShape(dims), const_cast<void*>(merged.DataRaw()),
+                             view_allocator, outputs[r][i],
+                             static_cast<ptrdiff_t>(offset * inner_size * merged.DataType()->Size()));
+      } else {
+        Tensor::InitOrtValue(merged.DataType(), TensorShape(dims), cpu_allocator_, outputs[r][i]);
+        auto& output = *outputs[r][i].GetMutable<Tensor>();
+        for (size_t outer = 0; outer < outer_size; ++outer) {
+          CopyElements(merged, (outer * total_batch_size + offset) * inner_size, output, outer * count, count);
+        }
+      }
+      offset += batch[r].batch_size;
+    }
+  }
+
+  for (size_t r = 0; r < batch.size(); ++r) {
+    batch[r].request.callback(Status::OK(), outputs[r]);
+  }
+  return Status::OK();
+}
+
+size_t RunQueue::GetBatchSize(const Request& request) const {
+  if (request.feeds.empty()) {
+    return 0;
+  }
+  for (const auto& fetch : request.fetches) {
+    if (fetch.IsAllocated()) {
+      // Pre-allocated outputs are written in place by the run.
+      return 0;
+    }
+  }
+
+  size_t batch_size = 0;
+  for (const auto& feed : request.feeds) {
+    if (!feed.IsTensor()) {
+      return 0;
+    }
+    const auto& tensor = feed.Get<Tensor>();
+    if (tensor.Location().device.Type() != OrtDevice::CPU ||
+        tensor.Shape().NumDimensions() <= options_.batch_axis ||
+        tensor.Shape()[options_.batch_axis] <= 0) {
+      return 0;
+    }
+    const auto feed_batch_size = narrow<size_t>(tensor.Shape()[options_.batch_axis]);
+    if (batch_size != 0 && feed_batch_size != batch_size) {
+      return 0;
+    }
+    batch_size = feed_batch_size;
+  }
+  return batch_size;
+}
+
+bool RunQueue::CanShareRunOptions(const RunOptions* a, const RunOptions* b) const {
+  if (a == b) {
+    return true;
+  }
+
+  const RunOptions& lhs = a ? *a : default_run_options_;
+  const RunOptions& rhs = b ? *b : default_run_options_;
+  // Options that act on one run in particular cannot be shared.
+  if (lhs.terminate || rhs.terminate || lhs.enable_profiling || rhs.enable_profiling ||
+      !lhs.active_adapters.empty() || !rhs.active_adapters.empty() ||
+      lhs.sync_stream != nullptr || rhs.sync_stream != nullptr) {
+    return false;
+  }
+  return lhs.run_tag == rhs.run_tag &&
+         lhs.run_log_severity_level == rhs.run_log_severity_level &&
+         lhs.run_log_verbosity_level == rhs.run_log_verbosity_level &&
+         lhs.only_execute_path_to_fetches == rhs.only_execute_path_to_fetches &&
+         lhs.config_options.configurations == rhs.config_options.configurations;
+}
+
+bool RunQueue::CanMerge(const QueuedRequest& a, const QueuedRequest& b) const {
+  if (a.batch_size == 0 || b.batch_size == 0 ||
+      !CanShareRunOptions(a.request.run_options, b.request.run_options) ||
+      a.request.feed_names != b.request.feed_names ||
+      a.request.fetch_names != b.request.fetch_names) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.request.feeds.size(); ++i) {
+    const auto& a_shape = a.request.feeds[i].Get<Tensor>().Shape();
+    const auto& b_shape = b.request.feeds[i].Get<Tensor>().Shape();
+    if (a.request.feeds[i].Get<Tensor>().DataType() != b.request.feeds[i].Get<Tensor>().DataType() ||
+        a_shape.NumDimensions() != b_shape.NumDimensions()) {
+      return false;
+    }
+    for (size_t d = 0; d < a_shape.NumDimensions(); ++d) {
+      if (d != options_.batch_axis && a_shape[d] != b_shape[d]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/logging/logging.h"
+#include "core/framework/allocator.h"
+#include "core/framework/ort_value.h"
+#include "core/framework/run_options.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+/**
+ * Queue of the Run requests of an InferenceSession, used by RunAsync and, with micro-batching, by Run.
+ *
+ * The requests are run by max_concurrency dispatcher threads owned by the queue, which wait for requests on a
+ * condition variable. Requests that arrive while all of them are busy wait in the queue without holding a thread,
+ * so RunAsync does not take threads away from the kernels in the intra-op thread pool.
+ *
+ * When max_batch_size is greater than 1, a dispatcher that takes a request from the queue also takes the queued
+ * requests that can be merged with it, waiting up to max_delay for more of them to arrive. It concatenates their
+ * inputs along batch_axis, runs once, and splits the outputs back along batch_axis. That is only correct for
+ * models whose inputs and outputs all have the batch on that axis, and whose batch items are independent. If the
+ * merged run fails or an output is not batched, the requests are run one by one instead.
+ */
+class RunQueue {
+ public:
+  using RunFn = std::function<Status(const RunOptions& run_options,
+                                     gsl::span<const std::string> feed_names,
+                                     gsl::span<const OrtValue> feeds,
+                                     gsl::span<const std::string> fetch_names,
+                                     std::vector<OrtValue>& fetches)>;
+
+  // Called on a dispatcher thread when the request completes. fetches holds the outputs if status is OK.
+  using CallbackFn = std::function<void(const Status& status, std::vector<OrtValue>& fetches)>;
+
+  struct Options {
+    // Maximum number of requests running at the same time, which is the number of dispatcher threads.
+    size_t max_concurrency{1};
+    // Maximum size of the batch axis of merged requests, 1 to not merge requests.
+    size_t max_batch_size{1};
+    // Axis the inputs are concatenated along and the outputs are split along.
+    size_t batch_axis{0};
+    // How long a request may wait for other requests to merge with. 0 to only merge the requests already queued.
+    std::chrono::microseconds max_delay{0};
+  };
+
+  struct Request {
+    // nullptr to use the default run options. Must stay alive until the callback is called.
+    // A merged run uses the run options of its first request.
+    const RunOptions* run_options{nullptr};
+    InlinedVector<std::string> feed_names;
+    InlinedVector<OrtValue> feeds;
+    InlinedVector<std::string> fetch_names;
+    // One entry per fetch name, either pre-allocated or empty.
+    std::vector<OrtValue> fetches;
+    CallbackFn callback;
+  };
+
+  /**
+   * @param thread_name_prefix Name of the dispatcher threads, must outlive the queue.
+   * @param thread_options Options of the dispatcher threads, such as the custom thread creation functions.
+   * @param cpu_allocator Allocator of the merged inputs and of the outputs that cannot be views of the merged ones.
+   */
+  RunQueue(const ORTCHAR_T* thread_name_prefix, const ThreadOptions& thread_options, const Options& options,
+           AllocatorPtr cpu_allocator, RunFn run_fn, const logging::Logger& logger);
+
+  // Fails the requests that did not start yet, and waits for the others to complete.
+  ~RunQueue();
+
+  Status Submit(Request&& request);
+
+  // Submits the request, ignoring its callback, and waits for it to complete. fetches receives the outputs.
+  Status SubmitAndWait(Request&& request, std::vector<OrtValue>& fetches);
+
+  const Options& GetOptions() const { return options_; }
+
+  // Whether the calling thread is one of the dispatchers of a queue.
+  static bool IsDispatcherThread();
+
+ private:
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(RunQueue);
+
+  struct QueuedRequest {
+    Request request;
+    // Size of the batch axis shared by all the inputs, 0 if the request cannot be merged.
+    size_t batch_size{0};
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  // Passed to the dispatcher threads, which Env starts like the threads of an Eigen thread pool.
+  class DispatcherThreadParam;
+  static unsigned DispatcherThreadMain(int index, Eigen::ThreadPoolInterface* param);
+
+  // Runs requests until the queue shuts down.
+  void Dispatch();
+
+  // Stops the dispatchers and joins them.
+  void StopDispatchers();
+
+  // Moves the queued requests that can be merged with batch.front() into batch, and returns the new total batch
+  // size. Called with mutex_ held.
+  size_t TakeMergeable(std::vector<QueuedRequest>& batch, size_t total_batch_size);
+
+  // Calls run_fn_, turning exceptions into a status.
+  Status Run(const RunOptions* run_options, gsl::span<const std::string> feed_names,
+             gsl::span<const OrtValue> feeds, gsl::span<const std::string> fetch_names,
+             std::vector<OrtValue>& fetches);
+
+  void RunOne(QueuedRequest& queued);
+  Status RunMerged(std::vector<QueuedRequest>& batch);
+
+  size_t GetBatchSize(const Request& request) const;
+  bool CanMerge(const QueuedRequest& a, const QueuedRequest& b) const;
+  bool CanShareRunOptions(const RunOptions* a, const RunOptions* b) const;
+
+  const Options options_;
+  const AllocatorPtr cpu_allocator_;
+  const RunFn run_fn_;
+  const logging::Logger& logger_;
+  const RunOptions default_run_options_;
+
+  std::mutex mutex_;
+  // Notified when a request is queued, for the idle dispatchers.
+  std::condition_variable dispatcher_wakeup_;
+  // Notified when a request is queued, for the dispatchers waiting for requests to merge. They get the request
+  // first, and wake an idle dispatcher for what they leave in the queue.
+  std::condition_variable request_queued_;
+  std::deque<QueuedRequest> queue_;
+  size_t num_waiting_to_merge_{0};
+  bool shutting_down_{false};
+  // Set when a merged run produced an output that is not batched.
+  std::atomic<bool> merging_disabled_{false};
+
+  std::unique_ptr<DispatcherThreadParam> dispatcher_thread_param_;
+  // Joined by the destructor before the members above are destroyed.
+  std::vector<std::unique_ptr<EnvThread>> dispatchers_;
+};
+
+}  // namespace onnxruntime
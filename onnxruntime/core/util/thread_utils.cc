@@ -24,6 +24,10 @@ std::ostream& operator<<(std::ostream& os, const OrtThreadPoolParams& params) {
   os << " affinity_str: " << params.affinity_str;
   // os << " name: " << (params.name ? params.name : L"nullptr");
   os << " set_denormal_as_zero: " << params.set_denormal_as_zero;
+  os << " priority_class_weights:";
+  for (int weight : params.priority_class_weights) {
+    os << " " << weight;
+  }
   // os << " custom_create_thread_fn: " << (params.custom_create_thread_fn ? "set" : "nullptr");
   // os << " custom_thread_creation_options: " << (params.custom_thread_creation_options ? "set" : "nullptr");
   // os << " custom_join_thread_fn: " << (params.custom_join_thread_fn ? "set" : "nullptr");
@@ -151,6 +155,7 @@ CreateThreadPoolHelper(Env* env, OrtThreadPoolParams options) {
   to.custom_thread_creation_options = options.custom_thread_creation_options;
   to.custom_join_thread_fn = options.custom_join_thread_fn;
   to.dynamic_block_base_ = options.dynamic_block_base_;
+  to.priority_class_weights = options.priority_class_weights;
   if (to.custom_create_thread_fn) {
     ORT_ENFORCE(to.custom_join_thread_fn, "custom join thread function not set");
   }
@@ -246,6 +251,23 @@ ORT_API_STATUS_IMPL(SetGlobalCustomJoinThreadFn, _Inout_ OrtThreadingOptions* tp
   return nullptr;
 }
 
+ORT_API_STATUS_IMPL(SetGlobalIntraOpPriorityClassWeights, _Inout_ OrtThreadingOptions* tp_options,
+                    _In_reads_(num_weights) const int* weights, _In_ size_t num_weights) {
+  if (!tp_options) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Received null OrtThreadingOptions");
+  }
+  if (num_weights != onnxruntime::concurrency::ThreadPool::kNumPriorityClasses || !weights) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT, "Expected one weight per priority class: high, normal, low");
+  }
+  if (std::any_of(weights, weights + num_weights, [](int weight) { return weight < 0; }) ||
+      std::all_of(weights, weights + num_weights, [](int weight) { return weight == 0; })) {
+    return OrtApis::CreateStatus(ORT_INVALID_ARGUMENT,
+                                 "Priority class weights must not be negative, and at least one must be positive");
+  }
+  tp_options->intra_op_thread_pool_params.priority_class_weights.assign(weights, weights + num_weights);
+  return nullptr;
+}
+
 ORT_API_STATUS_IMPL(SetGlobalIntraOpThreadAffinity, _Inout_ OrtThreadingOptions* tp_options, const char* affinity_string) {
 #if defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
   ORT_UNUSED_PARAMETER(tp_options);
@@ -6,6 +6,7 @@
 #include "core/session/onnxruntime_c_api.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 struct OrtThreadPoolParams {
   // 0: Use default setting. (All the physical cores or half of the logical cores)
@@ -52,6 +53,9 @@ struct OrtThreadPoolParams {
   OrtCustomCreateThreadFn custom_create_thread_fn = nullptr;
   void* custom_thread_creation_options = nullptr;
   OrtCustomJoinThreadFn custom_join_thread_fn = nullptr;
+
+  // Weights of the priority classes of parallel loops, see ThreadOptions::priority_class_weights.
+  std::vector<int> priority_class_weights;
 };
 
 std::ostream& operator<<(std::ostream& os, const OrtThreadPoolParams& params);
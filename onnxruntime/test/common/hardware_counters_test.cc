@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/hardware_counters.h"
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(HardwareCountersTest, CountersIncrease) {
+  profiling::HardwareCounterValues begin;
+  if (!profiling::HardwareCounters::Read(begin)) {
+    GTEST_SKIP() << "Hardware counters are not available.";
+  }
+
+  volatile uint64_t sum = 0;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    sum = sum + i;
+  }
+
+  profiling::HardwareCounterValues end;
+  ASSERT_TRUE(profiling::HardwareCounters::Read(end));
+  const auto counters = end - begin;
+  EXPECT_GT(counters.cycles, 0u);
+  // Every counter is monotonic.
+  EXPECT_GE(end.instructions, begin.instructions);
+  EXPECT_GE(end.llc_misses, begin.llc_misses);
+  EXPECT_GE(end.branch_misses, begin.branch_misses);
+
+  profiling::HardwareCounterValues total;
+  total += counters;
+  total += counters;
+  EXPECT_EQ(total.cycles, 2 * counters.cycles);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
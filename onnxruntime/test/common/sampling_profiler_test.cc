@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/sampling_profiler.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+using profiling::LatencyHistogram;
+using profiling::SamplingProfiler;
+
+TEST(SamplingProfilerTest, HistogramBuckets) {
+  // Small values have a bucket of their own.
+  for (uint64_t value = 0; value < 2 * LatencyHistogram::kSubBuckets; ++value) {
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(value)), value);
+  }
+
+  // Larger values are within 1/kSubBuckets of the upper bound of their bucket.
+  for (uint64_t value : {17ull, 100ull, 1000ull, 123456ull, 987654321ull, (1ull << 40) - 1}) {
+    const auto upper_bound = LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketIndex(value));
+    EXPECT_GE(upper_bound, value);
+    EXPECT_LE(upper_bound - value, value / LatencyHistogram::kSubBuckets);
+  }
+
+  EXPECT_EQ(LatencyHistogram::BucketIndex(1ull << 50), LatencyHistogram::kNumBuckets - 1);
+  EXPECT_LT(LatencyHistogram::BucketIndex((1ull << 40) - 1), LatencyHistogram::kNumBuckets);
+}
+
+TEST(SamplingProfilerTest, HistogramPercentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(50), 0u);
+
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.Record(value * 1000);
+  }
+  EXPECT_EQ(histogram.Count(), 1000u);
+
+  const auto p50 = histogram.Percentile(50);
+  const auto p99 = histogram.Percentile(99);
+  EXPECT_GE(p50, 500000u);
+  EXPECT_LE(p50, 500000u + 500000u / LatencyHistogram::kSubBuckets);
+  EXPECT_GE(p99, 990000u);
+  EXPECT_LE(p99, 990000u + 990000u / LatencyHistogram::kSubBuckets);
+  EXPECT_GE(histogram.Percentile(100), 1000000u);
+}
+
+TEST(SamplingProfilerTest, ConcurrentRecording) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram]() {
+      for (int i = 0; i < 10000; ++i) {
+        histogram.Record(i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.Count(), 40000u);
+}
+
+TEST(SamplingProfilerTest, SampleByRate) {
+  SamplingProfiler profiler(/*num_nodes*/ 2, /*sampling_rate*/ 4, /*sampling_interval_ms*/ 0);
+  int sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    sampled += profiler.ShouldSample() ? 1 : 0;
+  }
+  EXPECT_EQ(sampled, 25);
+  EXPECT_EQ(profiler.NumSampledRuns(), 25u);
+
+  profiler.RecordNodeLatency(1, 1000);
+  // Out of range indices are ignored.
+  profiler.RecordNodeLatency(2, 1000);
+  EXPECT_EQ(profiler.GetNodeHistogram(0)->Count(), 0u);
+  EXPECT_EQ(profiler.GetNodeHistogram(1)->Count(), 1u);
+  EXPECT_EQ(profiler.GetNodeHistogram(2), nullptr);
+}
+
+TEST(SamplingProfilerTest, SampleByInterval) {
+  SamplingProfiler profiler(/*num_nodes*/ 1, /*sampling_rate*/ 0, /*sampling_interval_ms*/ 60 * 60 * 1000);
+  // The first run is sampled, the next ones are within the interval.
+  EXPECT_TRUE(profiler.ShouldSample());
+  EXPECT_FALSE(profiler.ShouldSample());
+  EXPECT_FALSE(profiler.ShouldSample());
+  EXPECT_EQ(profiler.NumSampledRuns(), 1u);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
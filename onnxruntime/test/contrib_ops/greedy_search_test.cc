@@ -1,10 +1,15 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/graph/model.h"
+#include "core/graph/onnx_protobuf.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
 
@@ -17,6 +22,121 @@ extern std::unique_ptr<Ort::Env> ort_env;
 namespace onnxruntime {
 namespace test {
 
+namespace {
+
+// Returns the GreedySearch model at model_path with the eos_token_id attribute of its GreedySearch node set to
+// eos_token_id.
+std::string CreateGreedySearchModelWithEos(const ORTCHAR_T* model_path, int64_t eos_token_id) {
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ORT_THROW_IF_ERROR(Model::Load(model_path, model_proto));
+
+  auto* nodes = model_proto.mutable_graph()->mutable_node();
+  auto node = std::find_if(nodes->begin(), nodes->end(),
+                           [](const ONNX_NAMESPACE::NodeProto& n) { return n.op_type() == "GreedySearch"; });
+  ORT_ENFORCE(node != nodes->end(), "The model has no GreedySearch node");
+
+  auto* attributes = node->mutable_attribute();
+  auto eos = std::find_if(attributes->begin(), attributes->end(),
+                          [](const ONNX_NAMESPACE::AttributeProto& a) { return a.name() == "eos_token_id"; });
+  ORT_ENFORCE(eos != attributes->end(), "The GreedySearch node has no eos_token_id");
+  eos->set_i(eos_token_id);
+
+  std::string model_data;
+  model_proto.SerializeToString(&model_data);
+  return model_data;
+}
+
+// Returns the GreedySearch model at model_path without its init_decoder subgraph. If num_speculative_tokens is not
+// negative, the model also gets a draft_decoder subgraph, which is the decoder subgraph with perturbed weights so
+// that the decoder rejects some of its proposals.
+std::string CreateSpeculativeGreedySearchModel(const ORTCHAR_T* model_path, int64_t num_speculative_tokens) {
+  ONNX_NAMESPACE::ModelProto model_proto;
+  ORT_THROW_IF_ERROR(Model::Load(model_path, model_proto));
+
+  auto* nodes = model_proto.mutable_graph()->mutable_node();
+  auto node = std::find_if(nodes->begin(), nodes->end(),
+                           [](const ONNX_NAMESPACE::NodeProto& n) { return n.op_type() == "GreedySearch"; });
+  ORT_ENFORCE(node != nodes->end(), "The model has no GreedySearch node");
+
+  auto* attributes = node->mutable_attribute();
+  attributes->erase(std::remove_if(attributes->begin(), attributes->end(),
+                                   [](const ONNX_NAMESPACE::AttributeProto& a) { return a.name() == "init_decoder"; }),
+                    attributes->end());
+  if (num_speculative_tokens < 0) {
+    std::string model_data;
+    model_proto.SerializeToString(&model_data);
+    return model_data;
+  }
+
+  auto decoder = std::find_if(attributes->begin(), attributes->end(),
+                              [](const ONNX_NAMESPACE::AttributeProto& a) { return a.name() == "decoder"; });
+  ORT_ENFORCE(decoder != attributes->end(), "The GreedySearch node has no decoder subgraph");
+  ONNX_NAMESPACE::GraphProto draft_decoder = decoder->g();
+
+  // Scales the weights by 0.5, 1 or 1.5.
+  auto perturb = [](float value, size_t i) { return value * (0.5f + 0.5f * static_cast<float>(i % 3)); };
+  for (auto& initializer : *draft_decoder.mutable_initializer()) {
+    if (initializer.data_type() != ONNX_NAMESPACE::TensorProto_DataType_FLOAT) {
+      continue;
+    }
+    for (int i = 0; i < initializer.float_data_size(); i++) {
+      initializer.set_float_data(i, perturb(initializer.float_data(i), static_cast<size_t>(i)));
+    }
+    std::string& raw_data = *initializer.mutable_raw_data();
+    for (size_t offset = 0; offset + sizeof(float) <= raw_data.size(); offset += sizeof(float)) {
+      float value;
+      std::memcpy(&value, raw_data.data() + offset, sizeof(float));
+      value = perturb(value, offset / sizeof(float));
+      std::memcpy(raw_data.data() + offset, &value, sizeof(float));
+    }
+  }
+
+  auto* draft_decoder_attribute = node->add_attribute();
+  draft_decoder_attribute->set_name("draft_decoder");
+  draft_decoder_attribute->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_GRAPH);
+  *draft_decoder_attribute->mutable_g() = std::move(draft_decoder);
+
+  auto* num_speculative_tokens_attribute = node->add_attribute();
+  num_speculative_tokens_attribute->set_name("num_speculative_tokens");
+  num_speculative_tokens_attribute->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INT);
+  num_speculative_tokens_attribute->set_i(num_speculative_tokens);
+
+  std::string model_data;
+  model_proto.SerializeToString(&model_data);
+  return model_data;
+}
+
+// Runs a GreedySearch model on the CPU and returns the generated sequences.
+std::vector<int32_t> RunGreedySearch(const std::string& model_data, const std::vector<int64_t>& input_ids_shape,
+                                     std::vector<int32_t> input_ids, int32_t max_length) {
+  std::vector<int64_t> parameter_shape{1};
+  std::vector<int32_t> max_length_data{max_length};
+  std::vector<int32_t> min_length{1};
+  std::vector<float> repetition_penalty{1.0f};
+
+  Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  std::vector<Ort::Value> ort_inputs;
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, input_ids.data(), input_ids.size(), input_ids_shape.data(),
+                                                input_ids_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, max_length_data.data(), max_length_data.size(),
+                                                parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, min_length.data(), min_length.size(), parameter_shape.data(),
+                                                parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, repetition_penalty.data(), repetition_penalty.size(),
+                                                parameter_shape.data(), parameter_shape.size()));
+  const char* input_names[] = {"input_ids", "max_length", "min_length", "repetition_penalty"};
+  const char* const output_names[] = {"sequences"};
+
+  Ort::Session session(*ort_env, model_data.data(), model_data.size(), Ort::SessionOptions{});
+  auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                 output_names, 1);
+
+  const auto* sequences = ort_outputs[0].GetTensorData<int32_t>();
+  return std::vector<int32_t>(sequences, sequences + ort_outputs[0].GetTensorTypeAndShapeInfo().GetElementCount());
+}
+
+}  // namespace
+
 TEST(GreedySearchTest, GptGreedySearchFp16_VocabPadded) {
   std::vector<int64_t> input_ids_shape{2, 4};
   std::vector<int32_t> input_ids{
@@ -167,5 +287,72 @@ TEST(GreedySearchTest, GptGreedySearchFp32) {
   }
 }
 
+TEST(GreedySearchTest, GptSpeculativeMatchesGreedySearch) {
+  const ORTCHAR_T* model_path = ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx");
+  const std::vector<int64_t> input_ids_shape{1, 4};
+  constexpr int32_t max_length = 24;
+
+  const std::string greedy_model = CreateSpeculativeGreedySearchModel(model_path, -1);
+  for (const auto& input_ids : {std::vector<int32_t>{0, 0, 195, 731}, std::vector<int32_t>{12, 52, 409, 7}}) {
+    const auto expected = RunGreedySearch(greedy_model, input_ids_shape, input_ids, max_length);
+    ASSERT_EQ(expected.size(), static_cast<size_t>(max_length));
+
+    // 0 falls back to decoding without the draft decoder.
+    for (int64_t num_speculative_tokens : {0, 1, 3, 4, 30}) {
+      const std::string speculative_model = CreateSpeculativeGreedySearchModel(model_path, num_speculative_tokens);
+      EXPECT_EQ(RunGreedySearch(speculative_model, input_ids_shape, input_ids, max_length), expected)
+          << "num_speculative_tokens " << num_speculative_tokens;
+    }
+  }
+}
+
+TEST(GreedySearchTest, GptStaggeredEosMatchesPerRowGreedySearch) {
+  const ORTCHAR_T* model_path = ORT_TSTR("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx");
+  constexpr int64_t prompt_length = 4;
+  constexpr int32_t max_length = 16;
+  constexpr int32_t pad_token_id = 98;
+  const std::vector<std::vector<int32_t>> prompts{{0, 0, 0, 52}, {0, 0, 195, 731}, {12, 52, 409, 7}};
+  const int64_t batch_size = static_cast<int64_t>(prompts.size());
+
+  // Decode every row alone with an EOS that is never generated, so each reference holds the whole greedy path.
+  const std::string reference_model = CreateGreedySearchModelWithEos(model_path, int64_t{1} << 30);
+  std::vector<std::vector<int32_t>> references;
+  for (const auto& prompt : prompts) {
+    references.push_back(RunGreedySearch(reference_model, {1, prompt_length}, prompt, max_length));
+    ASSERT_EQ(references.back().size(), static_cast<size_t>(max_length));
+  }
+
+  // The second token generated for the second row is the EOS, so that row is dropped from the batch early while
+  // the others keep decoding.
+  const int32_t eos_token_id = references[1][prompt_length + 1];
+  std::vector<int32_t> input_ids;
+  std::vector<int32_t> expected;
+  std::vector<int64_t> eos_steps;
+  for (size_t row = 0; row < prompts.size(); row++) {
+    input_ids.insert(input_ids.end(), prompts[row].begin(), prompts[row].end());
+
+    auto eos = std::find(references[row].begin() + prompt_length, references[row].end(), eos_token_id);
+    eos_steps.push_back(eos - references[row].begin());
+    expected.insert(expected.end(), references[row].begin(), eos);
+    expected.insert(expected.end(), static_cast<size_t>(references[row].end() - eos), pad_token_id);
+  }
+  const int64_t last_eos_step = *std::max_element(eos_steps.begin(), eos_steps.end());
+  ASSERT_NE(*std::min_element(eos_steps.begin(), eos_steps.end()), last_eos_step)
+      << "The rows must meet EOS at different steps";
+
+  // Decoding stops once every row met EOS, and the sequences after that step are not written.
+  const int64_t compared_length = std::min<int64_t>(last_eos_step + 1, max_length);
+
+  const auto sequences = RunGreedySearch(CreateGreedySearchModelWithEos(model_path, eos_token_id),
+                                         {batch_size, prompt_length}, input_ids, max_length);
+  ASSERT_EQ(sequences.size(), expected.size());
+  for (size_t row = 0; row < prompts.size(); row++) {
+    const auto offset = static_cast<std::ptrdiff_t>(row * max_length);
+    EXPECT_TRUE(std::equal(expected.begin() + offset, expected.begin() + offset + compared_length,
+                           sequences.begin() + offset))
+        << "row " << row << " meeting EOS at " << eos_steps[row];
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
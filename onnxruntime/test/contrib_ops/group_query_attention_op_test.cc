@@ -0,0 +1,346 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/common/random_generator.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+struct QuantizedKVTestConfig {
+  int num_heads = 4;
+  int kv_num_heads = 2;
+  int head_size = 16;
+  int sequence_length = 1;
+  int past_buffer_length = 0;  // 0 means no past_key/past_value inputs
+  int bit_width = 8;
+  bool k_per_channel = false;
+  bool v_per_channel = false;
+  int local_window_size = -1;
+  int zero_channel = -1;              // channel of every KV head that is all zero, with a zero per-channel scale
+  std::vector<int32_t> past_seqlens;  // valid past length of every batch entry
+};
+
+int CacheHeadSize(const QuantizedKVTestConfig& config) {
+  return config.bit_width == 4 ? (config.head_size + 1) / 2 : config.head_size;
+}
+
+// Quantized value of channel h in a cache row, following the symmetric int8 / packed int4 format of the op.
+int LoadQuantized(const QuantizedKVTestConfig& config, const std::vector<uint8_t>& cache, size_t row_offset, int h) {
+  if (config.bit_width == 4) {
+    const uint8_t packed = cache[row_offset + h / 2];
+    return (h % 2 == 0 ? (packed & 0x0F) : (packed >> 4)) - 8;
+  }
+  return static_cast<int8_t>(cache[row_offset + h]);
+}
+
+void StoreQuantized(const QuantizedKVTestConfig& config, std::vector<uint8_t>& cache, size_t row_offset, int h,
+                    float x, float scale) {
+  const float qmax = config.bit_width == 4 ? 7.0f : 127.0f;
+  const float inv_scale = scale == 0.0f ? 0.0f : 1.0f / scale;
+  const int q = static_cast<int>(std::clamp(std::nearbyint(x * inv_scale), -qmax - 1.0f, qmax));
+  if (config.bit_width == 4) {
+    uint8_t& packed = cache[row_offset + h / 2];
+    packed = h % 2 == 0 ? static_cast<uint8_t>((packed & 0xF0) | (q + 8))
+                        : static_cast<uint8_t>((packed & 0x0F) | ((q + 8) << 4));
+  } else {
+    cache[row_offset + h] = static_cast<uint8_t>(static_cast<int8_t>(q));
+  }
+}
+
+// Appends the new keys and values to the quantized cache and computes causal grouped query attention on the
+// dequantized cache.
+void ComputeReference(const QuantizedKVTestConfig& config,
+                      const std::vector<float>& query,    // (B, S, N * H)
+                      const std::vector<float>& key,      // (B, S, N_kv * H)
+                      const std::vector<float>& value,    // (B, S, N_kv * H)
+                      const std::vector<float>& k_scale,  // 1 or N_kv * H
+                      const std::vector<float>& v_scale,  // 1 or N_kv * H
+                      std::vector<uint8_t>& key_cache,    // (B, N_kv, T, H'), past rows filled in
+                      std::vector<uint8_t>& value_cache,  // (B, N_kv, T, H'), past rows filled in
+                      int present_length,
+                      std::vector<float>& output) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int S = config.sequence_length;
+  const int H = config.head_size;
+  const int cache_head_size = CacheHeadSize(config);
+  const float alpha = 1.0f / std::sqrt(static_cast<float>(H));
+
+  auto row_offset = [&](int b, int n_kv, int t) {
+    return (static_cast<size_t>(b * config.kv_num_heads + n_kv) * present_length + t) * cache_head_size;
+  };
+  auto scale_of = [&](const std::vector<float>& scale, bool per_channel, int n_kv, int h) {
+    return per_channel ? scale[n_kv * H + h] : scale[0];
+  };
+
+  for (int b = 0; b < batch_size; b++) {
+    for (int n_kv = 0; n_kv < config.kv_num_heads; n_kv++) {
+      for (int s = 0; s < S; s++) {
+        const size_t input_offset = (static_cast<size_t>(b) * S + s) * config.kv_num_heads * H + n_kv * H;
+        const size_t offset = row_offset(b, n_kv, config.past_seqlens[b] + s);
+        for (int h = 0; h < H; h++) {
+          StoreQuantized(config, key_cache, offset, h, key[input_offset + h],
+                         scale_of(k_scale, config.k_per_channel, n_kv, h));
+          StoreQuantized(config, value_cache, offset, h, value[input_offset + h],
+                         scale_of(v_scale, config.v_per_channel, n_kv, h));
+        }
+      }
+    }
+  }
+
+  output.assign(static_cast<size_t>(batch_size) * S * config.num_heads * H, 0.0f);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < config.num_heads; n++) {
+      const int n_kv = n / (config.num_heads / config.kv_num_heads);
+      for (int s = 0; s < S; s++) {
+        const int causal_length = config.past_seqlens[b] + s + 1;
+        const int start = config.local_window_size >= 0 ? std::max(0, causal_length - config.local_window_size) : 0;
+        const float* q = query.data() + (static_cast<size_t>(b) * S + s) * config.num_heads * H + n * H;
+
+        std::vector<float> probs(causal_length, 0.0f);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int t = start; t < causal_length; t++) {
+          float dot = 0.0f;
+          for (int h = 0; h < H; h++) {
+            dot += q[h] * LoadQuantized(config, key_cache, row_offset(b, n_kv, t), h) *
+                   scale_of(k_scale, config.k_per_channel, n_kv, h);
+          }
+          probs[t] = dot * alpha;
+          max_score = std::max(max_score, probs[t]);
+        }
+        float sum = 0.0f;
+        for (int t = start; t < causal_length; t++) {
+          probs[t] = std::exp(probs[t] - max_score);
+          sum += probs[t];
+        }
+
+        float* out = output.data() + (static_cast<size_t>(b) * S + s) * config.num_heads * H + n * H;
+        for (int t = start; t < causal_length; t++) {
+          for (int h = 0; h < H; h++) {
+            out[h] += probs[t] / sum * LoadQuantized(config, value_cache, row_offset(b, n_kv, t), h) *
+                      scale_of(v_scale, config.v_per_channel, n_kv, h);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+std::vector<T> Convert(const std::vector<float>& data);
+
+template <>
+std::vector<float> Convert<float>(const std::vector<float>& data) {
+  return data;
+}
+
+template <>
+std::vector<MLFloat16> Convert<MLFloat16>(const std::vector<float>& data) {
+  return ToFloat16(data);
+}
+
+// Rounds the values to what the op sees for inputs of type T.
+template <typename T>
+void RoundTo(std::vector<float>& data) {
+  if constexpr (std::is_same_v<T, MLFloat16>) {
+    for (float& x : data) {
+      x = MLFloat16(x).ToFloat();
+    }
+  }
+}
+
+template <typename T>
+void RunQuantizedKVTest(const QuantizedKVTestConfig& config) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int S = config.sequence_length;
+  const int hidden_size = config.num_heads * config.head_size;
+  const int kv_hidden_size = config.kv_num_heads * config.head_size;
+  const int cache_head_size = CacheHeadSize(config);
+
+  int total_sequence_length = 0;
+  std::vector<int32_t> seqlens_k(batch_size);
+  for (int b = 0; b < batch_size; b++) {
+    seqlens_k[b] = config.past_seqlens[b] + S - 1;
+    total_sequence_length = std::max(total_sequence_length, config.past_seqlens[b] + S);
+  }
+  const int present_length = std::max(total_sequence_length, config.past_buffer_length);
+
+  RandomValueGenerator random{1234};
+  std::vector<int64_t> q_dims{batch_size, S, hidden_size};
+  std::vector<int64_t> kv_dims{batch_size, S, kv_hidden_size};
+  std::vector<float> query = random.Uniform<float>(q_dims, -1.0f, 1.0f);
+  std::vector<float> key = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  std::vector<float> value = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  RoundTo<T>(query);
+  RoundTo<T>(key);
+  RoundTo<T>(value);
+
+  const int64_t k_scale_size = config.k_per_channel ? kv_hidden_size : 1;
+  const int64_t v_scale_size = config.v_per_channel ? kv_hidden_size : 1;
+  const float scale_base = config.bit_width == 4 ? 0.15f : 0.008f;
+  std::vector<float> k_scale =
+      random.Uniform<float>(std::vector<int64_t>{k_scale_size}, scale_base, 2.0f * scale_base);
+  std::vector<float> v_scale =
+      random.Uniform<float>(std::vector<int64_t>{v_scale_size}, scale_base, 2.0f * scale_base);
+
+  // A channel that is zero in every new key and value gets a calibrated scale of zero.
+  if (config.zero_channel >= 0) {
+    for (int n = 0; n < config.kv_num_heads; n++) {
+      const int channel = n * config.head_size + config.zero_channel;
+      for (int r = 0; r < batch_size * S; r++) {
+        key[static_cast<size_t>(r) * kv_hidden_size + channel] = 0.0f;
+        value[static_cast<size_t>(r) * kv_hidden_size + channel] = 0.0f;
+      }
+      if (config.k_per_channel) {
+        k_scale[channel] = 0.0f;
+      }
+      if (config.v_per_channel) {
+        v_scale[channel] = 0.0f;
+      }
+    }
+  }
+
+  // Past rows hold random quantized values, the padding holds zeros.
+  const uint8_t zero = config.bit_width == 4 ? 0x88 : 0;
+  std::vector<int64_t> past_dims{batch_size, config.kv_num_heads, config.past_buffer_length, cache_head_size};
+  std::vector<uint8_t> past_key(static_cast<size_t>(batch_size) * config.kv_num_heads * config.past_buffer_length *
+                                    cache_head_size,
+                                zero);
+  std::vector<uint8_t> past_value = past_key;
+  std::vector<uint8_t> expected_key(static_cast<size_t>(batch_size) * config.kv_num_heads * present_length *
+                                        cache_head_size,
+                                    zero);
+  std::vector<uint8_t> expected_value = expected_key;
+  std::vector<int> random_bytes =
+      random.Uniform<int>(std::vector<int64_t>{static_cast<int64_t>(past_key.size() * 2)}, 0, 256);
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < config.kv_num_heads; n++) {
+      for (int t = 0; t < config.past_seqlens[b]; t++) {
+        const size_t head_index = static_cast<size_t>(b) * config.kv_num_heads + n;
+        for (int h = 0; h < cache_head_size; h++) {
+          const size_t past_index = (head_index * config.past_buffer_length + t) * cache_head_size + h;
+          const size_t present_index = (head_index * present_length + t) * cache_head_size + h;
+          past_key[past_index] = expected_key[present_index] = static_cast<uint8_t>(random_bytes[2 * past_index]);
+          past_value[past_index] = expected_value[present_index] =
+              static_cast<uint8_t>(random_bytes[2 * past_index + 1]);
+        }
+      }
+    }
+  }
+
+  std::vector<float> expected_output;
+  ComputeReference(config, query, key, value, k_scale, v_scale, expected_key, expected_value, present_length,
+                   expected_output);
+
+  OpTester test("GroupQueryAttention", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("num_heads", config.num_heads);
+  test.AddAttribute<int64_t>("kv_num_heads", config.kv_num_heads);
+  test.AddAttribute<int64_t>("local_window_size", config.local_window_size);
+  test.AddAttribute<std::string>("k_quant_type", config.k_per_channel ? "PER_CHANNEL" : "PER_TENSOR");
+  test.AddAttribute<std::string>("v_quant_type", config.v_per_channel ? "PER_CHANNEL" : "PER_TENSOR");
+  test.AddAttribute<int64_t>("kv_cache_bit_width", config.bit_width);
+
+  test.AddInput<T>("query", q_dims, Convert<T>(query));
+  test.AddInput<T>("key", kv_dims, Convert<T>(key));
+  test.AddInput<T>("value", kv_dims, Convert<T>(value));
+  auto add_cache_input = [&](const char* name, const std::vector<uint8_t>& data) {
+    if (config.past_buffer_length == 0) {
+      test.AddOptionalInputEdge<int8_t>();
+    } else if (config.bit_width == 4) {
+      test.AddInput<uint8_t>(name, past_dims, data);
+    } else {
+      test.AddInput<int8_t>(name, past_dims, std::vector<int8_t>(data.begin(), data.end()));
+    }
+  };
+  add_cache_input("past_key", past_key);
+  add_cache_input("past_value", past_value);
+  test.AddInput<int32_t>("seqlens_k", {batch_size}, seqlens_k);
+  test.AddInput<int32_t>("total_sequence_length", {1}, {total_sequence_length});
+  test.AddOptionalInputEdge<T>();        // cos_cache
+  test.AddOptionalInputEdge<T>();        // sin_cache
+  test.AddOptionalInputEdge<int64_t>();  // position_ids
+  test.AddOptionalInputEdge<T>();        // attention_bias
+  test.AddOptionalInputEdge<T>();        // head_sink
+  test.AddInput<float>("k_scale", {k_scale_size}, k_scale);
+  test.AddInput<float>("v_scale", {v_scale_size}, v_scale);
+
+  std::vector<int64_t> present_dims{batch_size, config.kv_num_heads, present_length, cache_head_size};
+  test.AddOutput<T>("output", q_dims, Convert<T>(expected_output));
+  if (config.bit_width == 4) {
+    test.AddOutput<uint8_t>("present_key", present_dims, expected_key);
+    test.AddOutput<uint8_t>("present_value", present_dims, expected_value);
+  } else {
+    test.AddOutput<int8_t>("present_key", present_dims, std::vector<int8_t>(expected_key.begin(), expected_key.end()));
+    test.AddOutput<int8_t>("present_value", present_dims,
+                           std::vector<int8_t>(expected_value.begin(), expected_value.end()));
+  }
+  test.SetOutputAbsErr("output", std::is_same_v<T, float> ? 1e-4f : 5e-3f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+}  // namespace
+
+TEST(GroupQueryAttentionTest, QuantizedKV_Int8_PerTensor_Decode) {
+  QuantizedKVTestConfig config;
+  config.past_buffer_length = 6;
+  config.past_seqlens = {5, 3};
+  RunQuantizedKVTest<float>(config);
+}
+
+TEST(GroupQueryAttentionTest, QuantizedKV_Int8_PerChannel_Prompt) {
+  QuantizedKVTestConfig config;
+  config.sequence_length = 5;
+  config.k_per_channel = true;
+  config.v_per_channel = true;
+  config.past_seqlens = {0};
+  RunQuantizedKVTest<float>(config);
+}
+
+TEST(GroupQueryAttentionTest, QuantizedKV_Int4_PerChannel_LocalWindow) {
+  QuantizedKVTestConfig config;
+  config.bit_width = 4;
+  config.k_per_channel = true;
+  config.past_buffer_length = 8;
+  config.past_seqlens = {7, 2};
+  config.local_window_size = 4;
+  RunQuantizedKVTest<float>(config);
+}
+
+TEST(GroupQueryAttentionTest, QuantizedKV_Int8_PerTensor_Decode_Float16) {
+  QuantizedKVTestConfig config;
+  config.past_buffer_length = 6;
+  config.past_seqlens = {5, 3};
+  RunQuantizedKVTest<MLFloat16>(config);
+}
+
+TEST(GroupQueryAttentionTest, QuantizedKV_ZeroScaleChannel) {
+  for (int bit_width : {8, 4}) {
+    QuantizedKVTestConfig config;
+    config.bit_width = bit_width;
+    config.k_per_channel = true;
+    config.v_per_channel = true;
+    config.zero_channel = 3;
+    config.sequence_length = 2;
+    config.past_buffer_length = 4;
+    config.past_seqlens = {2};
+    RunQuantizedKVTest<float>(config);
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -3,6 +3,7 @@
 
 #ifndef ORT_MINIMAL_BUILD
 
+#include <filesystem>
 #include <optional>
 
 #include "gtest/gtest.h"
@@ -23,6 +24,7 @@
 #include "test/unittest_util/graph_transform_test_builder.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/scoped_env_vars.h"
+#include "test/util/include/temp_dir.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "core/session/ort_env.h"
 #include "core/util/qmath.h"
@@ -254,7 +256,8 @@ void TestMatMul2BitsTyped(float abs_error = 0.1f, float rel_error = 0.02f) {
 
 template <typename AType>
 void TestMatMul2BitsLutGemm(int64_t M, int64_t N, int64_t K, int64_t block_size,
-                            bool has_zero_point, float abs_error = 0.15f, float rel_error = 0.05f) {
+                            bool has_zero_point, float abs_error = 0.15f, float rel_error = 0.05f,
+                            bool share_prepacked_weights = false) {
   if (K % 32 != 0 || N % 128 != 0 || block_size % 32 != 0) {
     GTEST_SKIP() << "LUT GEMM requires K multiple of 32, N multiple of 128, block_size multiple of 32";
   }
@@ -356,9 +359,41 @@ void TestMatMul2BitsLutGemm(int64_t M, int64_t N, int64_t K, int64_t block_size,
   SessionOptions so;
   ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsMlasLutGemm, "1"));
 
+  if (!share_prepacked_weights) {
+    test.Config(so)
+        .ConfigEp(DefaultCpuExecutionProvider())
+        .RunWithConfig();
+    return;
+  }
+
+  // Set up B as a shared initializer and map the pre-packed weights read-only from the disk cache,
+  // so that any write into the shared buffer faults.
+  OrtValue b;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<uint8_t>(), TensorShape({q_cols, k_blocks, q_rows / k_blocks}),
+                       input1_vals.data(), OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator), b);
+  ASSERT_STATUS_OK(so.AddInitializer("B", &b));
+  TemporaryDirectory cache_dir{ORT_TSTR("matmul_2bits_lut_prepacked_weights_cache")};
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsPrePackedWeightsCacheDir,
+                                                    std::filesystem::path(cache_dir.Path()).string().c_str()));
+  test.EnableSharingOfPrePackedWeightsAcrossSessions();
+
+  size_t number_of_pre_packed_weights_counter_session_1 = 0;
+  size_t number_of_shared_pre_packed_weights_counter = 0;
   test.Config(so)
       .ConfigEp(DefaultCpuExecutionProvider())
-      .RunWithConfig();
+      .RunWithConfig(&number_of_pre_packed_weights_counter_session_1, &number_of_shared_pre_packed_weights_counter);
+  ASSERT_EQ(number_of_shared_pre_packed_weights_counter, static_cast<size_t>(0));
+
+  // The scales and zero points are packed together with B, which is the only shared buffer.
+  ASSERT_EQ(test.GetNumPrePackedWeightsShared(), static_cast<size_t>(1));
+
+  // Session 2 uses the shared buffer as is and must produce the same result.
+  size_t number_of_pre_packed_weights_counter_session_2 = 0;
+  test.Config(so)
+      .ConfigEp(DefaultCpuExecutionProvider())
+      .RunWithConfig(&number_of_pre_packed_weights_counter_session_2, &number_of_shared_pre_packed_weights_counter);
+  ASSERT_EQ(number_of_pre_packed_weights_counter_session_1, number_of_pre_packed_weights_counter_session_2);
+  ASSERT_EQ(number_of_shared_pre_packed_weights_counter, static_cast<size_t>(1));
 }
 
 TEST(MatMulNBitsLutGemm, Float32_2Bits_Symmetric_128x128) {
@@ -396,6 +431,13 @@ TEST(MatMulNBitsLutGemm, Float32_2Bits_Asymmetric_128x256_BlkLen128) {
   TestMatMul2BitsLutGemm<float>(1, 128, 256, 128, true);
 }
 
+#ifndef ENABLE_TRAINING
+// Prepacking is disabled in full training build so no need to test the feature in a training build.
+TEST(MatMulNBitsLutGemm, Float32_2Bits_Asymmetric_128x128_SharedPrepackedWeights) {
+  TestMatMul2BitsLutGemm<float>(1, 128, 128, 32, true, 0.15f, 0.05f, /*share_prepacked_weights*/ true);
+}
+#endif
+
 // Batch tests (M > 1)
 TEST(MatMulNBitsLutGemm, Float32_2Bits_Symmetric_Batch32_128x128) {
   TestMatMul2BitsLutGemm<float>(32, 128, 128, 32, false);
@@ -425,6 +425,110 @@ TEST(MatMulNBits, Float32_4b_Accuracy4) {
   TestMatMulNBitsTyped<float, 100, 288, 1234, 16, 4>();
 }
 
+#ifndef ENABLE_TRAINING
+// Prepacking is disabled in full training build so no need to test the feature in a training build.
+TEST(MatMulNBits, SharedPrepackedWeights) {
+  constexpr int64_t M = 4, N = 32, K = 64, block_size = 32;
+  constexpr int64_t k_blocks = (K + block_size - 1) / block_size;
+  constexpr int64_t blob_size = (block_size * QBits + 7) / 8;
+  constexpr int64_t zero_point_blob_size = (k_blocks * QBits + 7) / 8;
+
+  RandomValueGenerator random{1234};
+  std::vector<float> a_vals(random.Gaussian<float>(AsSpan({M, K}), 0.0f, 0.25f));
+  std::vector<float> b_f_vals(random.Gaussian<float>(AsSpan({K, N}), 0.0f, 0.25f));
+
+  std::vector<uint8_t> b_vals(static_cast<size_t>(N * k_blocks * blob_size));
+  std::vector<float> scales(static_cast<size_t>(N * k_blocks));
+  std::vector<uint8_t> zp(static_cast<size_t>(N * zero_point_blob_size));
+  QuantizeDequantize(b_f_vals, b_vals, scales, &zp,
+                     static_cast<int32_t>(N), static_cast<int32_t>(K), static_cast<int32_t>(block_size));
+
+  std::vector<float> expected_vals(M * N);
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t n = 0; n < N; n++) {
+      float sum = 0.0f;
+      for (int64_t k = 0; k < K; k++) {
+        sum += a_vals[m * K + k] * b_f_vals[n * K + k];
+      }
+      expected_vals[m * N + n] = sum;
+    }
+  }
+
+  OpTester test("MatMulNBits", 1, kMSDomain);
+  test.AddAttribute<int64_t>("K", K);
+  test.AddAttribute<int64_t>("N", N);
+  test.AddAttribute<int64_t>("block_size", block_size);
+  test.AddAttribute<int64_t>("bits", QBits);
+  // Accuracy level 4 also packs the scales and zero points into the pre-packed B on x86.
+  test.AddAttribute<int64_t>("accuracy_level", int64_t{4});
+
+  test.AddInput<float>("A", {M, K}, a_vals);
+  // B is to be an initializer for triggering pre-packing
+  test.AddInput<uint8_t>("B", {N, k_blocks, blob_size}, b_vals, true);
+  test.AddInput<float>("scales", {N, k_blocks}, scales, true);
+  test.AddInput<uint8_t>("zero_points", {N, zero_point_blob_size}, zp, true);
+  test.AddOutput<float>("Y", {M, N}, expected_vals);
+  test.SetOutputAbsErr("Y", 0.1f);
+  test.SetOutputRelErr("Y", 0.02f);
+
+  OrtValue b;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<uint8_t>(), TensorShape({N, k_blocks, blob_size}),
+                       b_vals.data(), OrtMemoryInfo(CPU, OrtAllocatorType::OrtDeviceAllocator), b);
+
+  SessionOptions so;
+  // Set up B as a shared initializer to be shared between sessions
+  ASSERT_EQ(so.AddInitializer("B", &b), Status::OK());
+
+  // We want all sessions running using this OpTester to be able to share pre-packed weights if applicable
+  test.EnableSharingOfPrePackedWeightsAcrossSessions();
+
+  // Pre-packing is limited just to the CPU EP for now and we will only test the CPU EP
+  // and we want to ensure that it is available in this build
+  auto cpu_ep = []() -> std::vector<std::unique_ptr<IExecutionProvider>> {
+    std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+    execution_providers.push_back(DefaultCpuExecutionProvider());
+    return execution_providers;
+  };
+
+  size_t number_of_pre_packed_weights_counter_session_1 = 0;
+  size_t number_of_shared_pre_packed_weights_counter = 0;
+
+  // Session 1
+  {
+    test.Config(so)
+        .ConfigEps(cpu_ep())
+        .RunWithConfig(&number_of_pre_packed_weights_counter_session_1, &number_of_shared_pre_packed_weights_counter);
+    // Assert that no pre-packed weights have been shared thus far
+    ASSERT_EQ(number_of_shared_pre_packed_weights_counter, static_cast<size_t>(0));
+  }
+
+  // Only B is pre-packed into a shared buffer; the scales and zero points are folded into it.
+  auto number_of_elements_in_shared_prepacked_buffers_container =
+      test.GetNumPrePackedWeightsShared();
+  ASSERT_LE(number_of_elements_in_shared_prepacked_buffers_container, static_cast<size_t>(1));
+
+  // MLAS may not support this configuration on some platforms, in which case nothing is pre-packed
+  // and there is nothing to share.
+  if (number_of_elements_in_shared_prepacked_buffers_container == 0)
+    return;
+
+  // Session 2
+  {
+    size_t number_of_pre_packed_weights_counter_session_2 = 0;
+    test.Config(so)
+        .ConfigEps(cpu_ep())
+        .RunWithConfig(&number_of_pre_packed_weights_counter_session_2, &number_of_shared_pre_packed_weights_counter);
+
+    // Assert that the same number of weights were pre-packed in both sessions
+    ASSERT_EQ(number_of_pre_packed_weights_counter_session_1, number_of_pre_packed_weights_counter_session_2);
+
+    // Assert that the pre-packed B of the first session was reused by the second one
+    ASSERT_EQ(number_of_elements_in_shared_prepacked_buffers_container,
+              static_cast<size_t>(number_of_shared_pre_packed_weights_counter));
+  }
+}
+#endif
+
 #if defined(MLAS_TARGET_AMD64_IX86) || defined(MLAS_TARGET_ARM64)
 #if !defined(USE_DML)
 // Actual and expected difference is over 0.01 with DmlExecutionProvider.
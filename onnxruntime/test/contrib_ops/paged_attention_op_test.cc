@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/common/random_generator.h"
+#include "test/common/tensor_op_test_utils.h"
+#include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+struct PagedAttentionTestConfig {
+  int num_heads = 4;
+  int kv_num_heads = 2;
+  int head_size = 8;
+  int num_blocks = 8;
+  int block_size = 4;
+  int local_window_size = -1;
+  bool packed_qkv = false;
+  bool cache_outputs = true;
+  std::vector<int32_t> past_seqlens;
+  std::vector<int32_t> new_seqlens;
+  std::vector<int32_t> block_table;  // (batch_size, max_num_blocks_per_seq)
+};
+
+// Reference implementation that gathers each sequence out of the paged cache and runs plain causal attention on it.
+void ComputeReference(const PagedAttentionTestConfig& config,
+                      const std::vector<float>& query,   // (token_count, hidden_size)
+                      const std::vector<float>& key,     // (token_count, kv_hidden_size)
+                      const std::vector<float>& value,   // (token_count, kv_hidden_size)
+                      std::vector<float>& key_cache,     // updated in place
+                      std::vector<float>& value_cache,   // updated in place
+                      std::vector<float>& output) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int head_size = config.head_size;
+  const int hidden_size = config.num_heads * head_size;
+  const int kv_hidden_size = config.kv_num_heads * head_size;
+  const int max_num_blocks_per_seq = static_cast<int>(config.block_table.size()) / batch_size;
+  const float scale = 1.0f / std::sqrt(static_cast<float>(head_size));
+
+  auto slot_of = [&](int b, int position) {
+    const int block = config.block_table[b * max_num_blocks_per_seq + position / config.block_size];
+    return block * config.block_size + position % config.block_size;
+  };
+
+  int token_offset = 0;
+  for (int b = 0; b < batch_size; b++) {
+    for (int s = 0; s < config.new_seqlens[b]; s++) {
+      const int slot = slot_of(b, config.past_seqlens[b] + s);
+      std::copy_n(key.begin() + (token_offset + s) * kv_hidden_size, kv_hidden_size,
+                  key_cache.begin() + slot * kv_hidden_size);
+      std::copy_n(value.begin() + (token_offset + s) * kv_hidden_size, kv_hidden_size,
+                  value_cache.begin() + slot * kv_hidden_size);
+    }
+    token_offset += config.new_seqlens[b];
+  }
+
+  output.assign(static_cast<size_t>(token_offset) * hidden_size, 0.0f);
+  token_offset = 0;
+  for (int b = 0; b < batch_size; b++) {
+    for (int n = 0; n < config.num_heads; n++) {
+      const int kv_head = n / (config.num_heads / config.kv_num_heads);
+      for (int s = 0; s < config.new_seqlens[b]; s++) {
+        const int causal_length = config.past_seqlens[b] + s + 1;
+        const int start = config.local_window_size >= 0 ? std::max(0, causal_length - config.local_window_size) : 0;
+        const float* q = query.data() + (token_offset + s) * hidden_size + n * head_size;
+
+        std::vector<float> probs(causal_length, 0.0f);
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int t = start; t < causal_length; t++) {
+          const float* k = key_cache.data() + slot_of(b, t) * kv_hidden_size + kv_head * head_size;
+          float dot = 0.0f;
+          for (int h = 0; h < head_size; h++) {
+            dot += q[h] * k[h];
+          }
+          probs[t] = dot * scale;
+          max_score = std::max(max_score, probs[t]);
+        }
+        float sum = 0.0f;
+        for (int t = start; t < causal_length; t++) {
+          probs[t] = std::exp(probs[t] - max_score);
+          sum += probs[t];
+        }
+
+        float* out = output.data() + (token_offset + s) * hidden_size + n * head_size;
+        for (int t = start; t < causal_length; t++) {
+          const float* v = value_cache.data() + slot_of(b, t) * kv_hidden_size + kv_head * head_size;
+          for (int h = 0; h < head_size; h++) {
+            out[h] += probs[t] / sum * v[h];
+          }
+        }
+      }
+    }
+    token_offset += config.new_seqlens[b];
+  }
+}
+
+template <typename T>
+std::vector<T> Convert(const std::vector<float>& data);
+
+template <>
+std::vector<float> Convert<float>(const std::vector<float>& data) {
+  return data;
+}
+
+template <>
+std::vector<MLFloat16> Convert<MLFloat16>(const std::vector<float>& data) {
+  return ToFloat16(data);
+}
+
+template <typename T>
+void RunPagedAttentionTest(const PagedAttentionTestConfig& config) {
+  const int batch_size = static_cast<int>(config.past_seqlens.size());
+  const int hidden_size = config.num_heads * config.head_size;
+  const int kv_hidden_size = config.kv_num_heads * config.head_size;
+  const int max_num_blocks_per_seq = static_cast<int>(config.block_table.size()) / batch_size;
+
+  std::vector<int32_t> cumulative_seqlens(batch_size + 1, 0);
+  for (int b = 0; b < batch_size; b++) {
+    cumulative_seqlens[b + 1] = cumulative_seqlens[b] + config.new_seqlens[b];
+  }
+  const int64_t token_count = cumulative_seqlens[batch_size];
+
+  RandomValueGenerator random{123};
+  std::vector<int64_t> q_dims{token_count, hidden_size};
+  std::vector<int64_t> kv_dims{token_count, kv_hidden_size};
+  std::vector<int64_t> cache_dims{config.num_blocks, config.block_size, config.kv_num_heads, config.head_size};
+  std::vector<float> query = random.Uniform<float>(q_dims, -1.0f, 1.0f);
+  std::vector<float> key = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  std::vector<float> value = random.Uniform<float>(kv_dims, -1.0f, 1.0f);
+  std::vector<float> key_cache = random.Uniform<float>(cache_dims, -1.0f, 1.0f);
+  std::vector<float> value_cache = random.Uniform<float>(cache_dims, -1.0f, 1.0f);
+
+  std::vector<float> expected_key_cache = key_cache;
+  std::vector<float> expected_value_cache = value_cache;
+  std::vector<float> expected_output;
+  ComputeReference(config, query, key, value, expected_key_cache, expected_value_cache, expected_output);
+
+  OpTester test("PagedAttention", 1, onnxruntime::kMSDomain);
+  test.AddAttribute<int64_t>("num_heads", config.num_heads);
+  test.AddAttribute<int64_t>("kv_num_heads", config.kv_num_heads);
+  test.AddAttribute<int64_t>("local_window_size", config.local_window_size);
+
+  if (config.packed_qkv) {
+    std::vector<float> packed_qkv;
+    for (int64_t t = 0; t < token_count; t++) {
+      packed_qkv.insert(packed_qkv.end(), query.begin() + t * hidden_size, query.begin() + (t + 1) * hidden_size);
+      packed_qkv.insert(packed_qkv.end(), key.begin() + t * kv_hidden_size, key.begin() + (t + 1) * kv_hidden_size);
+      packed_qkv.insert(packed_qkv.end(), value.begin() + t * kv_hidden_size, value.begin() + (t + 1) * kv_hidden_size);
+    }
+    test.AddInput<T>("query", {token_count, hidden_size + 2 * kv_hidden_size}, Convert<T>(packed_qkv));
+    test.AddOptionalInputEdge<T>();
+    test.AddOptionalInputEdge<T>();
+  } else {
+    test.AddInput<T>("query", q_dims, Convert<T>(query));
+    test.AddInput<T>("key", kv_dims, Convert<T>(key));
+    test.AddInput<T>("value", kv_dims, Convert<T>(value));
+  }
+  test.AddInput<T>("key_cache", cache_dims, Convert<T>(key_cache));
+  test.AddInput<T>("value_cache", cache_dims, Convert<T>(value_cache));
+  test.AddInput<int32_t>("cumulative_sequence_length", {batch_size + 1}, cumulative_seqlens);
+  test.AddInput<int32_t>("past_seqlens", {batch_size}, config.past_seqlens);
+  test.AddInput<int32_t>("block_table", {batch_size, max_num_blocks_per_seq}, config.block_table);
+  test.AddOptionalInputEdge<T>();
+  test.AddOptionalInputEdge<T>();
+
+  test.AddOutput<T>("output", q_dims, Convert<T>(expected_output));
+  if (config.cache_outputs) {
+    test.AddOutput<T>("key_cache_out", cache_dims, Convert<T>(expected_key_cache));
+    test.AddOutput<T>("value_cache_out", cache_dims, Convert<T>(expected_value_cache));
+  }
+  test.SetOutputAbsErr("output", std::is_same_v<T, float> ? 1e-5f : 5e-3f);
+
+  std::vector<std::unique_ptr<IExecutionProvider>> execution_providers;
+  execution_providers.push_back(DefaultCpuExecutionProvider());
+  test.Run(OpTester::ExpectResult::kExpectSuccess, "", {}, nullptr, &execution_providers);
+}
+
+// Batch with a decoding sequence spread over two non-adjacent pages and a prompt that fits in one page.
+PagedAttentionTestConfig MixedBatchConfig() {
+  PagedAttentionTestConfig config;
+  config.past_seqlens = {5, 0};
+  config.new_seqlens = {1, 3};
+  config.block_table = {6, 1,
+                        3, 0};
+  return config;
+}
+
+}  // namespace
+
+TEST(PagedAttentionTest, Float_MixedPromptAndDecode) {
+  RunPagedAttentionTest<float>(MixedBatchConfig());
+}
+
+TEST(PagedAttentionTest, Float_PromptAcrossPages) {
+  PagedAttentionTestConfig config;
+  config.past_seqlens = {2, 0};
+  config.new_seqlens = {7, 5};
+  config.block_table = {4, 7, 2,
+                        0, 5, 1};
+  RunPagedAttentionTest<float>(config);
+}
+
+TEST(PagedAttentionTest, Float_LocalWindow) {
+  PagedAttentionTestConfig config;
+  config.past_seqlens = {9, 1};
+  config.new_seqlens = {2, 4};
+  config.block_table = {2, 6, 5,
+                        7, 0, 3};
+  config.local_window_size = 3;
+  RunPagedAttentionTest<float>(config);
+}
+
+TEST(PagedAttentionTest, Float_PackedQKV) {
+  PagedAttentionTestConfig config = MixedBatchConfig();
+  config.packed_qkv = true;
+  RunPagedAttentionTest<float>(config);
+}
+
+// The new keys and values still take part in the attention when the updated cache is not returned.
+TEST(PagedAttentionTest, Float_WithoutCacheOutputs) {
+  PagedAttentionTestConfig config = MixedBatchConfig();
+  config.cache_outputs = false;
+  RunPagedAttentionTest<float>(config);
+}
+
+TEST(PagedAttentionTest, Float16_MixedPromptAndDecode) {
+  RunPagedAttentionTest<MLFloat16>(MixedBatchConfig());
+}
+
+}  // namespace test
+}  // namespace onnxruntime
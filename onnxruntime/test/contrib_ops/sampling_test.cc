@@ -1,11 +1,18 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <random>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/providers/cpu/generator/random.h"
 #include "core/session/onnxruntime_cxx_api.h"
+#include "contrib_ops/cpu/transformers/generation_shared.h"
+#include "contrib_ops/cpu/transformers/sampling_cpu_helper.h"
 #include "test/common/cuda_op_test_utils.h"
 
 #ifdef USE_CUDA
@@ -159,5 +166,105 @@ TEST(SamplingTest, Gpt2Sampling_CPU) {
   ASSERT_TRUE(std::equal(expected_output.cbegin(), expected_output.cend(), result_span.begin(), result_span.end()));
 }
 #endif
+
+namespace {
+
+contrib::transformers::IGenerationParameters TopPParameters(int vocab_size, float top_p, bool custom_sampling,
+                                                            int min_tokens_to_keep = 1) {
+  contrib::transformers::IGenerationParameters parameters{};
+  parameters.batch_size = 1;
+  parameters.vocab_size = vocab_size;
+  parameters.top_p = top_p;
+  parameters.custom_sampling = custom_sampling;
+  parameters.min_tokens_to_keep = min_tokens_to_keep;
+  parameters.filter_value = -std::numeric_limits<float>::infinity();
+  return parameters;
+}
+
+std::vector<float> FilterTopP(std::vector<float> scores,
+                              const contrib::transformers::IGenerationParameters& parameters) {
+  std::vector<float> probs(scores.size());
+  std::vector<int32_t> candidates(scores.size());
+  contrib::SamplingCpuHelper::FilterTopP<float>(scores, probs, candidates, &parameters);
+  return scores;
+}
+
+// Filters the whole vocabulary after a stable sort of it, in descending order of the probabilities for the custom
+// filter and in ascending order for the default one.
+std::vector<float> FilterTopPBySorting(std::vector<float> scores,
+                                       const contrib::transformers::IGenerationParameters& parameters) {
+  const size_t vocab_size = scores.size();
+  std::vector<float> probs(vocab_size);
+  MlasComputeSoftmax(scores.data(), probs.data(), 1, vocab_size, false, false, 0.0f, nullptr);
+
+  std::vector<size_t> sorted(vocab_size);
+  std::iota(sorted.begin(), sorted.end(), size_t{0});
+  std::stable_sort(sorted.begin(), sorted.end(), [&](size_t i1, size_t i2) {
+    return parameters.custom_sampling ? probs[i1] > probs[i2] : probs[i1] < probs[i2];
+  });
+
+  float cumulative_prob = 0.0f;
+  if (parameters.custom_sampling) {
+    for (size_t j = 0; j + 1 < vocab_size; j++) {
+      cumulative_prob += probs[sorted[j]];
+      if (cumulative_prob > parameters.top_p) {
+        scores[sorted[j + 1]] = parameters.filter_value;
+      }
+    }
+  } else {
+    for (size_t j = 0; j < vocab_size - static_cast<size_t>(parameters.min_tokens_to_keep); j++) {
+      cumulative_prob += probs[sorted[j]];
+      if (cumulative_prob <= 1.0f - parameters.top_p) {
+        scores[sorted[j]] = parameters.filter_value;
+      }
+    }
+  }
+  return scores;
+}
+
+}  // namespace
+
+TEST(SamplingTest, FilterTopPMatchesSortedFilter) {
+  std::default_random_engine generator{1234};
+  std::normal_distribution<float> distribution{0.0f, 4.0f};
+  for (int vocab_size : {1, 2, 7, 64, 1000}) {
+    std::vector<float> scores(static_cast<size_t>(vocab_size));
+    std::generate(scores.begin(), scores.end(), [&]() { return distribution(generator); });
+    for (bool custom_sampling : {false, true}) {
+      for (float top_p : {0.1f, 0.5f, 0.9f, 0.999f}) {
+        for (int min_tokens_to_keep : {1, 3}) {
+          if (min_tokens_to_keep > vocab_size) {
+            continue;
+          }
+          const auto parameters = TopPParameters(vocab_size, top_p, custom_sampling, min_tokens_to_keep);
+          EXPECT_EQ(FilterTopP(scores, parameters), FilterTopPBySorting(scores, parameters))
+              << "vocab_size " << vocab_size << " custom_sampling " << custom_sampling << " top_p " << top_p
+              << " min_tokens_to_keep " << min_tokens_to_keep;
+        }
+      }
+    }
+  }
+}
+
+TEST(SamplingTest, FilterTopPKeepsTiesInIndexOrder) {
+  constexpr float filtered = -std::numeric_limits<float>::infinity();
+  const std::vector<float> scores(8, 1.0f);
+
+  // The default filter removes the tokens with the lowest indices first.
+  EXPECT_EQ(FilterTopP(scores, TopPParameters(8, 0.5f, false)),
+            (std::vector<float>{filtered, filtered, filtered, filtered, 1.0f, 1.0f, 1.0f, 1.0f}));
+
+  // The custom filter keeps the tokens with the lowest indices first, and the one after the top_p mass.
+  EXPECT_EQ(FilterTopP(scores, TopPParameters(8, 0.5f, true)),
+            (std::vector<float>{1.0f, 1.0f, 1.0f, 1.0f, 1.0f, filtered, filtered, filtered}));
+
+  // Ties below the highest probability are ordered the same way.
+  const std::vector<float> tied_scores{2.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+  EXPECT_EQ(FilterTopP(tied_scores, TopPParameters(5, 0.5f, false)),
+            (std::vector<float>{2.0f, filtered, filtered, filtered, 1.0f}));
+  EXPECT_EQ(FilterTopP(tied_scores, TopPParameters(5, 0.5f, true)),
+            (std::vector<float>{2.0f, 1.0f, filtered, filtered, filtered}));
+}
+
 }  // namespace test
 }  // namespace onnxruntime
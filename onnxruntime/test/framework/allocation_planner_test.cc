@@ -24,6 +24,7 @@ using json = nlohmann::json;
 #include "core/util/thread_utils.h"
 
 #include "test/test_environment.h"
+#include "test/unittest_util/framework_test_utils.h"
 #include "test/util/include/asserts.h"
 #include "test/util/include/default_providers.h"
 #ifdef USE_CUDA
@@ -1906,6 +1907,72 @@ TEST_F(PlannerTest, TestMultiStreamConfig) {
               graph_partitioner_cpu_gpu->Streams() == 2);
 }
 
+// The two branches after maxpool_0 of the simplified SSD model run on different CPU streams
+// and the parallel run produces the same output as a sequential one.
+TEST_F(PlannerTest, TestCriticalPathPartitioner) {
+  auto partitioner = IGraphPartitioner::CreateGraphPartitioner(
+      DefaultLoggingManager().DefaultLogger(),
+      ORT_TSTR("./testdata/multi_stream_models/simplified_ssd_critical_path.json"));
+  ASSERT_TRUE(partitioner && strcmp(partitioner->Type(), "CriticalPathPartitioner") == 0 &&
+              partitioner->Streams() == 2);
+
+  std::vector<float> input_data(3 * 3 * 300 * 300);
+  for (size_t i = 0; i < input_data.size(); ++i) {
+    input_data[i] = static_cast<float>(i % 17) / 17.f;
+  }
+  OrtValue input;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], {3, 3, 300, 300}, input_data,
+                       &input);
+  NameMLValMap feeds{{"graph_in", input}};
+  const std::vector<std::string> output_names{"graph_out"};
+
+  auto run = [&](SessionOptions& so, std::vector<OrtValue>& fetches, const SequentialExecutionPlan** plan,
+                 std::unique_ptr<InferenceSession>& sess) {
+    so.graph_optimization_level = TransformerLevel::Default;
+    sess = std::make_unique<InferenceSession>(so, GetEnvironment(),
+                                              ORT_TSTR("./testdata/multi_stream_models/simplified_ssd.onnx"));
+    ASSERT_STATUS_OK(sess->RegisterExecutionProvider(DefaultCpuExecutionProvider()));
+    ASSERT_STATUS_OK(sess->Load());
+    ASSERT_STATUS_OK(sess->Initialize());
+    ASSERT_STATUS_OK(sess->Run(RunOptions{}, feeds, output_names, &fetches));
+    *plan = sess->GetSessionState().GetExecutionPlan();
+  };
+
+  SessionOptions sequential_options;
+  std::vector<OrtValue> expected;
+  const SequentialExecutionPlan* sequential_plan = nullptr;
+  std::unique_ptr<InferenceSession> sequential_session;
+  run(sequential_options, expected, &sequential_plan, sequential_session);
+
+  SessionOptions parallel_options;
+  parallel_options.execution_mode = ExecutionMode::ORT_PARALLEL;
+  ASSERT_STATUS_OK(parallel_options.config_options.AddConfigEntry(
+      kNodePartitionConfigFile, "./testdata/multi_stream_models/simplified_ssd_critical_path.json"));
+  std::vector<OrtValue> actual;
+  const SequentialExecutionPlan* parallel_plan = nullptr;
+  std::unique_ptr<InferenceSession> parallel_session;
+  run(parallel_options, actual, &parallel_plan, parallel_session);
+
+  ASSERT_EQ(parallel_plan->execution_plan.size(), 2u);
+  const auto& graph_viewer = parallel_session->GetSessionState().GetGraphViewer();
+  std::unordered_map<std::string, size_t> stream_of;
+  for (const auto& node : graph_viewer.Nodes()) {
+    stream_of[node.Name()] = parallel_plan->node_stream_map_[node.Index()];
+  }
+  ASSERT_NE(stream_of["conv_3"], stream_of["conv_4"]);
+  ASSERT_EQ(stream_of["conv_1"], stream_of["conv_2"]);
+
+  ASSERT_EQ(actual.size(), 1u);
+  const auto& expected_tensor = expected[0].Get<Tensor>();
+  const auto& actual_tensor = actual[0].Get<Tensor>();
+  ASSERT_EQ(expected_tensor.Shape(), actual_tensor.Shape());
+  const auto expected_values = expected_tensor.DataAsSpan<float>();
+  const auto actual_values = actual_tensor.DataAsSpan<float>();
+  for (size_t i = 0; i < expected_values.size(); ++i) {
+    ASSERT_EQ(expected_values[i], actual_values[i]) << "at " << i;
+  }
+}
+
 // Save partition config to a file and check its completeness
 TEST_F(PlannerTest, TestMultiStreamSaveConfig) {
   const char* config_file_path = "./testdata/multi_stream_models/conv_add_relu_single_stream.json";
@@ -7,6 +7,9 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include "core/framework/stream_handles.h"
 
 namespace onnxruntime {
@@ -482,5 +485,58 @@ TEST(BFCArenaTest, TestExtendStrategy) {
   ASSERT_EQ(extend_delta_bytes, extend_limit);
 }
 
+TEST(BFCArenaTest, ThreadCache) {
+  BFCArena a(std::unique_ptr<IAllocator>(new CPUAllocator()), 1 << 30, ArenaExtendStrategy::kNextPowerOfTwo,
+             BFCArena::DEFAULT_INITIAL_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_DEAD_BYTES_PER_CHUNK,
+             BFCArena::DEFAULT_INITIAL_GROWTH_CHUNK_SIZE_BYTES, BFCArena::DEFAULT_MAX_POWER_OF_TWO_EXTEND_BYTES,
+             /*thread_cache_bytes*/ 1 << 20);
+
+  // Small blocks are rounded up to a power of two, a freed block is reused by the next allocation.
+  void* p = a.Alloc(300);
+  EXPECT_EQ(a.AllocatedSize(p), 512u);
+  a.Free(p);
+  void* q = a.Alloc(400);
+  EXPECT_EQ(p, q);
+
+  // Larger allocations bypass the thread caches.
+  void* large = a.Alloc(1 << 17);
+  EXPECT_EQ(a.AllocatedSize(large), static_cast<size_t>(1 << 17));
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.num_thread_cache_misses, 1);
+  EXPECT_EQ(stats.num_thread_cache_hits, 1);
+  EXPECT_EQ(stats.bytes_in_use, 512 + (1 << 17));
+
+  // Blocks freed by other threads, or by exiting threads, go back to the arena.
+  std::vector<void*> ptrs;
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&a, &ptrs, &mutex]() {
+      for (size_t size = 1; size <= 1 << 16; size *= 2) {
+        void* block = a.Alloc(size);
+        std::memset(block, 1, size);
+        std::lock_guard<std::mutex> guard(mutex);
+        ptrs.push_back(block);
+      }
+      a.Free(a.Alloc(1000));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (void* block : ptrs) {
+    a.Free(block);
+  }
+  a.Free(q);
+  a.Free(large);
+
+  a.GetStats(&stats);
+  EXPECT_EQ(stats.bytes_in_use, 0);
+  EXPECT_EQ(stats.num_thread_cache_hits + stats.num_thread_cache_misses, 2 + 4 * 18);
+  EXPECT_GT(stats.thread_cache_bytes, 0);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
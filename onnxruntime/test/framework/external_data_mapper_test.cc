@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/external_data_mapper.h"
+#include "core/framework/prepacked_weights_container.h"
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/onnx_protobuf.h"
+#include "core/platform/env.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/temp_dir.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+TEST(ExternalDataMapperTest, SlicesShareOneMapping) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("external_data_mapper_test_tmp_dir")};
+  const std::filesystem::path file_path = std::filesystem::path(tmp_dir.Path()) / ORT_TSTR("weights.bin");
+
+  std::vector<char> content(10000);
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>(i * 7);
+  }
+  {
+    std::ofstream out(file_path, std::ios::binary);
+    out.write(content.data(), content.size());
+  }
+
+  IAllocatorUniquePtr<void> first, second;
+  {
+    std::optional<ExternalDataMapper> mapper;
+    mapper.emplace();
+    ASSERT_STATUS_OK(mapper->GetData(Env::Default(), file_path, 100, 1000, first));
+    ASSERT_STATUS_OK(mapper->GetData(Env::Default(), file_path, 5000, 5000, second));
+
+    IAllocatorUniquePtr<void> out_of_range;
+    ASSERT_STATUS_NOT_OK(mapper->GetData(Env::Default(), file_path, 9000, 1001, out_of_range));
+    ASSERT_STATUS_NOT_OK(mapper->GetData(Env::Default(), file_path, -1, 10, out_of_range));
+  }
+
+  // Both slices come from the same mapping, which outlives the mapper.
+  ASSERT_EQ(static_cast<char*>(second.get()) - static_cast<char*>(first.get()), 4900);
+  ASSERT_EQ(std::memcmp(first.get(), content.data() + 100, 1000), 0);
+  ASSERT_EQ(std::memcmp(second.get(), content.data() + 5000, 5000), 0);
+}
+
+// Kernels may write into the pre-packed buffers handed to them, so pre-packed blobs must not be slices of the
+// read-only mapping even when the initializer itself is.
+TEST(ExternalDataMapperTest, PrePackedBlobsAreWritable) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("external_data_mapper_test_tmp_dir")};
+  const std::filesystem::path dir_path(tmp_dir.Path());
+
+  std::vector<float> content(64);
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<float>(i);
+  }
+  {
+    std::ofstream out(dir_path / ORT_TSTR("weights.bin"), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(content.data()), content.size() * sizeof(float));
+  }
+
+  // The initializer is the first 16 floats, the pre-packed blob the remaining 48.
+  ONNX_NAMESPACE::TensorProto tensor_proto;
+  tensor_proto.set_name("weight");
+  tensor_proto.set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  tensor_proto.add_dims(16);
+  tensor_proto.set_data_location(ONNX_NAMESPACE::TensorProto_DataLocation_EXTERNAL);
+  auto add_entry = [&tensor_proto](const std::string& key, const std::string& value) {
+    auto* entry = tensor_proto.add_external_data();
+    entry->set_key(key);
+    entry->set_value(value);
+  };
+  add_entry("location", "weights.bin");
+  add_entry("offset", "0");
+  add_entry("length", std::to_string(16 * sizeof(float)));
+  add_entry("prepacked_0", "packed_key|" + std::to_string(16 * sizeof(float)) + ";" +
+                               std::to_string(48 * sizeof(float)) + ";0");
+
+  PrepackedKeyToBlobMap key_to_blobs;
+  PrepackedWeightsForGraph prepacked_for_graph(key_to_blobs, false);
+  ExternalDataMapper mapper;
+  OrtValue ort_value;
+  ASSERT_STATUS_OK(utils::GetExtDataFromTensorProto(Env::Default(), dir_path / ORT_TSTR("model.onnx"), tensor_proto,
+                                                    ort_value, &prepacked_for_graph, &mapper));
+
+  const auto* prepacked = prepacked_for_graph.GetPrepackedWeights("packed_key");
+  ASSERT_NE(prepacked, nullptr);
+  ASSERT_EQ(prepacked->buffers_.size(), 1u);
+  ASSERT_EQ(prepacked->buffer_sizes_[0], 48 * sizeof(float));
+
+  float* packed = static_cast<float*>(prepacked->buffers_[0].get());
+  ASSERT_EQ(packed[0], 16.f);
+  packed[0] = -1.f;
+
+  // The write stays private to the process.
+  std::vector<float> on_disk(content.size());
+  {
+    std::ifstream in(dir_path / ORT_TSTR("weights.bin"), std::ios::binary);
+    in.read(reinterpret_cast<char*>(on_disk.data()), on_disk.size() * sizeof(float));
+  }
+  ASSERT_EQ(on_disk, content);
+  ASSERT_EQ(ort_value.Get<Tensor>().Data<float>()[15], 15.f);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -16,6 +16,7 @@
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include "core/common/denormal.h"
+#include "core/common/hardware_counters.h"
 #include "core/common/logging/logging.h"
 #include "core/common/logging/sinks/clog_sink.h"
 #include "core/common/profiler.h"
@@ -443,6 +444,51 @@ TEST(InferenceSessionTests, CheckRunProfilerWithSessionOptions) {
 #endif
 }
 
+TEST(InferenceSessionTests, CheckRunProfilerWithHardwareCounters) {
+  profiling::HardwareCounterValues values;
+  if (!profiling::HardwareCounters::Read(values)) {
+    GTEST_SKIP() << "Hardware counters are not available.";
+  }
+
+  SessionOptions so;
+  so.session_logid = "CheckRunProfilerWithHardwareCounters";
+  so.enable_profiling = true;
+  so.profile_file_prefix = ORT_TSTR("onnxprofile_hardware_counters_test");
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsProfileHardwareCounters, "1"));
+
+  InferenceSession session_object(so, GetEnvironment());
+  ASSERT_STATUS_OK(session_object.Load(MODEL_URI));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  RunOptions run_options;
+  run_options.run_tag = "RunTag";
+  RunModel(session_object, run_options);
+  RunModel(session_object, run_options);
+  std::string profile_file = session_object.EndProfiling();
+
+  std::ifstream profile(profile_file);
+  ASSERT_TRUE(profile);
+  std::string line;
+  size_t num_kernel_events = 0;
+  size_t num_summary_events = 0;
+  while (std::getline(profile, line)) {
+    // Every kernel event carries the counters of its node.
+    if (line.find("_kernel_time") != std::string::npos) {
+      ++num_kernel_events;
+      EXPECT_NE(line.find("\"cycles\" : "), std::string::npos) << line;
+      EXPECT_NE(line.find("\"instructions\" : "), std::string::npos) << line;
+    }
+    // EndProfiling adds one event per op type with the totals of all the runs.
+    if (line.find("\"Mul_hardware_counters\"") != std::string::npos) {
+      ++num_summary_events;
+      EXPECT_NE(line.find("\"calls\" : \"2\""), std::string::npos) << line;
+      EXPECT_NE(line.find("\"counted_threads\" : \"calling thread only\""), std::string::npos) << line;
+    }
+  }
+  EXPECT_EQ(num_kernel_events, 2u);
+  EXPECT_EQ(num_summary_events, 1u);
+}
+
 TEST(InferenceSessionTests, CheckRunProfilerWithSessionOptions2) {
   SessionOptions so;
 
@@ -2007,6 +2053,66 @@ TEST(InferenceSessionTests, ModelThatTriggersAllocationPlannerToReuseDoubleTenso
   VerifyOutputs(fetches[2].Get<Tensor>(), expected_dims_res3, expected_values_res3);
 }
 
+// Z = Neg(Add(Abs(X), Abs(Y))) with X [1, 4] broadcast against Y [2, 4]. Abs(X) and the Add output round up to
+// the same aligned size, but the Add output must not be computed in place of the broadcast input.
+TEST(InferenceSessionTests, StaticMemoryPlanningDoesNotReuseBroadcastInput) {
+  onnxruntime::Model model("static_memory_planning", false, ModelMetaData(), PathString(),
+                           IOnnxRuntimeOpSchemaRegistryList(), {{kOnnxDomain, 12}}, {},
+                           DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  auto make_float_tensor = [](std::initializer_list<int64_t> dims) {
+    ONNX_NAMESPACE::TypeProto type;
+    type.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    for (int64_t dim : dims) {
+      type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(dim);
+    }
+    return type;
+  };
+  const auto row_tensor = make_float_tensor({1, 4});
+  const auto matrix_tensor = make_float_tensor({2, 4});
+
+  auto& x = graph.GetOrCreateNodeArg("X", &row_tensor);
+  auto& y = graph.GetOrCreateNodeArg("Y", &matrix_tensor);
+  auto& abs_x = graph.GetOrCreateNodeArg("abs_x", &row_tensor);
+  auto& abs_y = graph.GetOrCreateNodeArg("abs_y", &matrix_tensor);
+  auto& sum = graph.GetOrCreateNodeArg("sum", &matrix_tensor);
+  auto& z = graph.GetOrCreateNodeArg("Z", &matrix_tensor);
+  graph.AddNode("abs_x", "Abs", "", {&x}, {&abs_x});
+  graph.AddNode("abs_y", "Abs", "", {&y}, {&abs_y});
+  graph.AddNode("add", "Add", "", {&abs_x, &abs_y}, {&sum});
+  graph.AddNode("neg", "Neg", "", {&sum}, {&z});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  ASSERT_TRUE(model.ToProto().SerializeToString(&model_data));
+
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.StaticMemoryPlanningDoesNotReuseBroadcastInput";
+  so.graph_optimization_level = TransformerLevel::Default;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsStaticMemoryPlanning, "1"));
+
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_data.data(), static_cast<int>(model_data.size())));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  auto allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  OrtValue x_value;
+  OrtValue y_value;
+  CreateMLValue<float>(allocator, {1, 4}, {1.f, -2.f, 3.f, -4.f}, &x_value);
+  CreateMLValue<float>(allocator, {2, 4}, {10.f, 20.f, 30.f, 40.f, -50.f, -60.f, -70.f, -80.f}, &y_value);
+  NameMLValMap feeds{{"X", x_value}, {"Y", y_value}};
+
+  // Run twice, the second run uses the memory pattern cached for the input shapes.
+  for (int run = 0; run < 2; ++run) {
+    std::vector<OrtValue> fetches;
+    ASSERT_STATUS_OK(session_object.Run(RunOptions{}, feeds, {"Z"}, &fetches));
+    ASSERT_EQ(1u, fetches.size());
+    VerifyOutputs(fetches[0].Get<Tensor>(), std::vector<int64_t>{2, 4},
+                  std::vector<float>{-11.f, -22.f, -33.f, -44.f, -51.f, -62.f, -73.f, -84.f});
+  }
+}
+
 // The following test is to cover the feature of InferenceSession that allows some session options
 // to flow in from a model file, and use defaults for missing session options/session options not supported for parsing
 // from the model
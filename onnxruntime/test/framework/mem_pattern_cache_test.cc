@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/mem_pattern_cache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "core/framework/allocator.h"
+#include "core/framework/data_types.h"
+#include "core/framework/tensor.h"
+
+namespace onnxruntime {
+namespace test {
+
+static std::vector<OrtValue> MakeFeeds(const std::vector<TensorShape>& shapes) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  std::vector<OrtValue> feeds(shapes.size());
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), shapes[i], allocator, feeds[i]);
+  }
+  return feeds;
+}
+
+// An entry whose only inferred shape is the 1-D shape {dim}, which tells the entries apart.
+static MemoryPatternCache::Entry MakeEntry(int64_t dim) {
+  MemoryPatternCache::Entry entry;
+  entry.patterns.locations.push_back(OrtDevice());
+  entry.patterns.patterns.emplace_back();
+  entry.inferred_shapes.emplace(0, TensorShape({dim}));
+  return entry;
+}
+
+TEST(MemoryPatternCacheTest, KeyDistinguishesShapes) {
+  // The previous key xor-ed all the dimensions together, all these collided.
+  const auto a = MemoryPatternCache::MakeKey(MakeFeeds({{2, 3}, {4}}));
+  const auto b = MemoryPatternCache::MakeKey(MakeFeeds({{2}, {3, 4}}));
+  const auto c = MemoryPatternCache::MakeKey(MakeFeeds({{3, 2}, {4}}));
+  const auto d = MemoryPatternCache::MakeKey(MakeFeeds({{2, 3, 4}}));
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_NE(a, d);
+  EXPECT_NE(b, d);
+  EXPECT_EQ(a, MemoryPatternCache::MakeKey(MakeFeeds({{2, 3}, {4}})));
+}
+
+TEST(MemoryPatternCacheTest, HitsAndMisses) {
+  MemoryPatternCache cache;
+  const auto key = MemoryPatternCache::MakeKey(MakeFeeds({{1, 8}}));
+
+  EXPECT_EQ(cache.Find(key), nullptr);
+  auto inserted = cache.Insert(key, MakeEntry(8));
+  ASSERT_NE(inserted, nullptr);
+  EXPECT_EQ(cache.Find(key), inserted);
+  EXPECT_EQ(cache.Find(key), inserted);
+
+  // An existing entry is not replaced.
+  EXPECT_EQ(cache.Insert(key, MakeEntry(16)), inserted);
+  EXPECT_EQ(cache.Find(key)->inferred_shapes.at(0), TensorShape({8}));
+
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 3u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.size, 1u);
+}
+
+TEST(MemoryPatternCacheTest, EvictsLeastRecentlyUsed) {
+  MemoryPatternCache cache(2);
+  const MemoryPatternCache::Key k1{1, 1};
+  const MemoryPatternCache::Key k2{1, 2};
+  const MemoryPatternCache::Key k3{1, 3};
+
+  cache.Insert(k1, MakeEntry(1));
+  auto e2 = cache.Insert(k2, MakeEntry(2));
+  // k1 becomes the most recently used, k2 is evicted next.
+  ASSERT_NE(cache.Find(k1), nullptr);
+  cache.Insert(k3, MakeEntry(3));
+
+  EXPECT_NE(cache.Find(k1), nullptr);
+  EXPECT_EQ(cache.Find(k2), nullptr);
+  EXPECT_NE(cache.Find(k3), nullptr);
+
+  // The evicted entry stays valid for whoever still holds it.
+  EXPECT_EQ(e2->inferred_shapes.at(0), TensorShape({2}));
+  EXPECT_EQ(e2.use_count(), 1);
+
+  const auto stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.size, 2u);
+  EXPECT_EQ(cache.Capacity(), 2u);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
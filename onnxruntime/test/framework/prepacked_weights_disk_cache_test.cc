@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepacked_weights_disk_cache.h"
+#include "core/platform/env.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/temp_dir.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+PrePackedWeights MakeWeights(std::vector<float>& data0, std::vector<uint8_t>& data1) {
+  PrePackedWeights weights;
+  weights.buffers_.push_back(BufferUniquePtr(data0.data(), BufferDeleter(nullptr)));
+  weights.buffer_sizes_.push_back(data0.size() * sizeof(float));
+  weights.buffers_.push_back(BufferUniquePtr(data1.data(), BufferDeleter(nullptr)));
+  weights.buffer_sizes_.push_back(data1.size());
+  return weights;
+}
+
+}  // namespace
+
+TEST(PrepackedWeightsDiskCacheTest, StoreThenMap) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("prepacked_weights_disk_cache_test_tmp_dir")};
+  PrepackedWeightsDiskCache cache(tmp_dir.Path());
+
+  std::vector<float> data0 = {1.f, 2.f, 3.f, 4.f, 5.f};
+  std::vector<uint8_t> data1(5000, 7);
+  const std::string key = "MatMul+1234";
+
+  PrePackedWeights first = MakeWeights(data0, data1);
+  ASSERT_STATUS_OK(cache.MapOrStore(Env::Default(), key, first));
+  ASSERT_TRUE(std::filesystem::exists(cache.GetFilePath(key)));
+  ASSERT_EQ(first.buffers_.size(), 2u);
+  ASSERT_NE(first.buffers_[0].get(), static_cast<void*>(data0.data()));
+  ASSERT_NE(first.buffers_[1].get(), static_cast<void*>(data1.data()));
+  ASSERT_EQ(std::memcmp(first.buffers_[0].get(), data0.data(), data0.size() * sizeof(float)), 0);
+  ASSERT_EQ(std::memcmp(first.buffers_[1].get(), data1.data(), data1.size()), 0);
+  // Every buffer is mapped on its own page.
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(first.buffers_[1].get()) % PrepackedWeightsDiskCache::kBufferAlignment, 0u);
+
+  // A second session finds the file and maps it again.
+  PrePackedWeights second = MakeWeights(data0, data1);
+  ASSERT_STATUS_OK(cache.MapOrStore(Env::Default(), key, second));
+  ASSERT_NE(second.buffers_[0].get(), static_cast<void*>(data0.data()));
+  ASSERT_EQ(std::memcmp(second.buffers_[1].get(), data1.data(), data1.size()), 0);
+}
+
+TEST(PrepackedWeightsDiskCacheTest, ContentMismatchKeepsBuffers) {
+  TemporaryDirectory tmp_dir{ORT_TSTR("prepacked_weights_disk_cache_test_tmp_dir")};
+  PrepackedWeightsDiskCache cache(tmp_dir.Path());
+
+  std::vector<float> data0 = {1.f, 2.f, 3.f};
+  std::vector<uint8_t> data1 = {1, 2, 3};
+  const std::string key = "Conv+42";
+  PrePackedWeights stored = MakeWeights(data0, data1);
+  ASSERT_STATUS_OK(cache.MapOrStore(Env::Default(), key, stored));
+
+  std::vector<float> other0 = {1.f, 2.f, 4.f};
+  PrePackedWeights other = MakeWeights(other0, data1);
+  ASSERT_FALSE(cache.MapOrStore(Env::Default(), key, other).IsOK());
+  ASSERT_EQ(other.buffers_[0].get(), static_cast<void*>(other0.data()));
+  ASSERT_EQ(other.buffers_[1].get(), static_cast<void*>(data1.data()));
+}
+
+}  // namespace test
+}  // namespace onnxruntime
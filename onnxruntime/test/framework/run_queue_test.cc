@@ -0,0 +1,522 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/session/run_queue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "core/framework/allocator.h"
+#include "core/framework/error_code_helper.h"
+#include "core/framework/tensor.h"
+#include "core/graph/model.h"
+#include "core/platform/env.h"
+#include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+
+OrtValue MakeFloatTensor(const AllocatorPtr& allocator, const std::vector<int64_t>& dims, float value) {
+  OrtValue ort_value;
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape(dims), allocator, ort_value);
+  auto span = ort_value.GetMutable<Tensor>()->MutableDataAsSpan<float>();
+  std::fill(span.begin(), span.end(), value);
+  return ort_value;
+}
+
+// Runs Y = X * 2, waiting for Release before running, and records the batch sizes along batch_axis.
+class FakeSession {
+ public:
+  explicit FakeSession(AllocatorPtr allocator, size_t batch_axis = 0)
+      : allocator_(std::move(allocator)), batch_axis_(batch_axis) {}
+
+  RunQueue::RunFn GetRunFn() {
+    return [this](const RunOptions&, gsl::span<const std::string>, gsl::span<const OrtValue> feeds,
+                  gsl::span<const std::string>, std::vector<OrtValue>& fetches) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        batch_sizes_.push_back(feeds[0].Get<Tensor>().Shape()[batch_axis_]);
+        cv_.wait(lock, [this]() { return released_; });
+      }
+      const auto& x = feeds[0].Get<Tensor>();
+      Tensor::InitOrtValue(x.DataType(), x.Shape(), allocator_, fetches[0]);
+      auto input = x.DataAsSpan<float>();
+      auto output = fetches[0].GetMutable<Tensor>()->MutableDataAsSpan<float>();
+      for (size_t i = 0; i < input.size(); ++i) {
+        output[i] = input[i] * 2;
+      }
+      return Status::OK();
+    };
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  std::vector<int64_t> BatchSizes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batch_sizes_;
+  }
+
+ private:
+  AllocatorPtr allocator_;
+  size_t batch_axis_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool released_{false};
+  std::vector<int64_t> batch_sizes_;
+};
+
+struct Completion {
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t num_completed{0};
+  std::vector<Status> statuses;
+  std::vector<std::vector<OrtValue>> outputs;
+
+  explicit Completion(size_t num_requests) : statuses(num_requests), outputs(num_requests) {}
+
+  RunQueue::CallbackFn GetCallback(size_t index) {
+    return [this, index](const Status& status, std::vector<OrtValue>& fetches) {
+      std::lock_guard<std::mutex> lock(mutex);
+      statuses[index] = status;
+      outputs[index] = fetches;
+      ++num_completed;
+      cv.notify_all();
+    };
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return num_completed == statuses.size(); });
+  }
+};
+
+std::unique_ptr<RunQueue> CreateRunQueue(const RunQueue::Options& options, const AllocatorPtr& allocator,
+                                         FakeSession& session) {
+  return std::make_unique<RunQueue>(ORT_TSTR("run-queue-test"), ThreadOptions{}, options, allocator,
+                                    session.GetRunFn(), DefaultLoggingManager().DefaultLogger());
+}
+
+RunQueue::Options MakeOptions(size_t max_batch_size, size_t batch_axis = 0,
+                              std::chrono::microseconds max_delay = std::chrono::microseconds(0)) {
+  RunQueue::Options options;
+  options.max_concurrency = 1;
+  options.max_batch_size = max_batch_size;
+  options.batch_axis = batch_axis;
+  options.max_delay = max_delay;
+  return options;
+}
+
+RunQueue::Request MakeRequest(const AllocatorPtr& allocator, const std::vector<int64_t>& dims, float value,
+                              RunQueue::CallbackFn callback) {
+  RunQueue::Request request;
+  request.feed_names.push_back("X");
+  request.feeds.push_back(MakeFloatTensor(allocator, dims, value));
+  request.fetch_names.push_back("Y");
+  request.fetches.resize(1);
+  request.callback = std::move(callback);
+  return request;
+}
+
+// Y = X + ReduceSum(X, axis 0). Every row of Y depends on the whole batch, so the outputs show which requests
+// ran merged. Without dynamic_batch, X has a fixed batch of 1.
+std::string CreateBatchSumModel(bool dynamic_batch) {
+  onnxruntime::Model model("batch_sum", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                           {{kOnnxDomain, 12}}, {}, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  ONNX_NAMESPACE::TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  auto* batch_dim = float_tensor.mutable_tensor_type()->mutable_shape()->add_dim();
+  if (dynamic_batch) {
+    batch_dim->set_dim_param("batch");
+  } else {
+    batch_dim->set_dim_value(1);
+  }
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+
+  auto& x = graph.GetOrCreateNodeArg("X", &float_tensor);
+  auto& sum = graph.GetOrCreateNodeArg("sum", nullptr);
+  auto& y = graph.GetOrCreateNodeArg("Y", &float_tensor);
+  auto& reduce = graph.AddNode("reduce", "ReduceSum", "", {&x}, {&sum});
+  reduce.AddAttribute("axes", std::vector<int64_t>{0});
+  graph.AddNode("add", "Add", "", {&x, &sum}, {&y});
+  ORT_THROW_IF_ERROR(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+  return model_data;
+}
+
+std::unique_ptr<InferenceSession> CreateSession(const std::string& model_data,
+                                                const std::vector<std::pair<const char*, const char*>>& config) {
+  SessionOptions so;
+  for (const auto& [key, value] : config) {
+    ORT_THROW_IF_ERROR(so.config_options.AddConfigEntry(key, value));
+  }
+  auto session = std::make_unique<InferenceSession>(so, GetEnvironment());
+  ORT_THROW_IF_ERROR(session->Load(model_data.data(), static_cast<int>(model_data.size())));
+  return session;
+}
+
+// Runs one batch-1 request per thread through InferenceSession::Run, with X filled with thread index + 1.
+void RunConcurrently(InferenceSession& session, const AllocatorPtr& allocator, size_t num_threads,
+                     std::vector<Status>& statuses, std::vector<std::vector<OrtValue>>& outputs) {
+  statuses.resize(num_threads);
+  outputs.resize(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      RunOptions run_options;
+      std::vector<OrtValue> feeds{MakeFloatTensor(allocator, {1, 3}, static_cast<float>(i + 1))};
+      statuses[i] = session.Run(run_options, AsSpan<std::string>({"X"}), feeds, AsSpan<std::string>({"Y"}),
+                                &outputs[i], nullptr);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Collects the results of InferenceSession::RunAsync calls.
+struct AsyncRuns {
+  struct Run {
+    AsyncRuns* runs{nullptr};
+    OrtValue* output{nullptr};
+    Status status;
+  };
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t num_completed{0};
+  std::vector<Run> runs;
+
+  explicit AsyncRuns(size_t num_runs) : runs(num_runs) {
+    for (auto& run : runs) {
+      run.runs = this;
+    }
+  }
+
+  ~AsyncRuns() {
+    for (auto& run : runs) {
+      delete run.output;
+    }
+  }
+
+  static void Callback(void* user_data, OrtValue** /*outputs*/, size_t /*num_outputs*/, OrtStatusPtr status) {
+    auto* run = static_cast<Run*>(user_data);
+    std::lock_guard<std::mutex> lock(run->runs->mutex);
+    run->status = ToStatusAndRelease(status);
+    ++run->runs->num_completed;
+    run->runs->cv.notify_all();
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return num_completed == runs.size(); });
+  }
+};
+
+}  // namespace
+
+TEST(RunQueueTest, MergeQueuedRequests) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  Completion completion(4);
+  {
+    auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 8), allocator, session);
+
+    // The first request holds the only dispatcher, the others wait in the queue.
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 0.f, completion.GetCallback(0))));
+    while (session.BatchSizes().empty()) {
+      std::this_thread::yield();
+    }
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 1.f, completion.GetCallback(1))));
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 3}, 2.f, completion.GetCallback(2))));
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {3, 3}, 3.f, completion.GetCallback(3))));
+    session.Release();
+    completion.Wait();
+  }
+
+  EXPECT_EQ(session.BatchSizes(), (std::vector<int64_t>{1, 6}));
+  const std::vector<int64_t> expected_batch_sizes{1, 1, 2, 3};
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_STATUS_OK(completion.statuses[i]);
+    const auto& y = completion.outputs[i][0].Get<Tensor>();
+    EXPECT_EQ(y.Shape(), TensorShape({expected_batch_sizes[i], 3}));
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, 2.f * i);
+    }
+  }
+}
+
+TEST(RunQueueTest, RequestStartsWhileOtherRunsAreBlocked) {
+  constexpr size_t kMaxConcurrency = 4;
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  Completion completion(kMaxConcurrency);
+  {
+    auto options = MakeOptions(/*max_batch_size*/ 1);
+    options.max_concurrency = kMaxConcurrency;
+    auto queue = CreateRunQueue(options, allocator, session);
+
+    // Every dispatcher but one is blocked in a run.
+    for (size_t i = 0; i + 1 < kMaxConcurrency; ++i) {
+      ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, static_cast<float>(i),
+                                                 completion.GetCallback(i))));
+    }
+    while (session.BatchSizes().size() < kMaxConcurrency - 1) {
+      std::this_thread::yield();
+    }
+
+    // The last dispatcher starts the next request.
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, static_cast<float>(kMaxConcurrency - 1),
+                                               completion.GetCallback(kMaxConcurrency - 1))));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (session.BatchSizes().size() < kMaxConcurrency && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(session.BatchSizes().size(), kMaxConcurrency);
+
+    session.Release();
+    completion.Wait();
+  }
+
+  for (size_t i = 0; i < kMaxConcurrency; ++i) {
+    ASSERT_STATUS_OK(completion.statuses[i]);
+    EXPECT_EQ(completion.outputs[i][0].Get<Tensor>().DataAsSpan<float>()[0], 2.f * i);
+  }
+}
+
+TEST(RunQueueTest, IncompatibleRequestsRunSeparately) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  Completion completion(3);
+  {
+    auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 2), allocator, session);
+
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 0.f, completion.GetCallback(0))));
+    while (session.BatchSizes().empty()) {
+      std::this_thread::yield();
+    }
+    // Together these exceed the maximum batch size.
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 3}, 1.f, completion.GetCallback(1))));
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 2.f, completion.GetCallback(2))));
+    session.Release();
+    completion.Wait();
+  }
+
+  EXPECT_EQ(session.BatchSizes(), (std::vector<int64_t>{1, 2, 1}));
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_STATUS_OK(completion.statuses[i]);
+    EXPECT_EQ(completion.outputs[i][0].Get<Tensor>().DataAsSpan<float>()[0], 2.f * i);
+  }
+}
+
+TEST(RunQueueTest, PendingRequestsFailOnDestruction) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  Completion completion(2);
+  std::thread release;
+  {
+    auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 1), allocator, session);
+
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 0.f, completion.GetCallback(0))));
+    while (session.BatchSizes().empty()) {
+      std::this_thread::yield();
+    }
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 1.f, completion.GetCallback(1))));
+    // The queued request fails when the queue is destroyed, the running one completes.
+    release = std::thread([&session]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      session.Release();
+    });
+  }
+  release.join();
+  completion.Wait();
+
+  ASSERT_STATUS_OK(completion.statuses[0]);
+  EXPECT_FALSE(completion.statuses[1].IsOK());
+  EXPECT_EQ(session.BatchSizes().size(), 1u);
+}
+
+TEST(RunQueueTest, WaitForRequestsToMerge) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  session.Release();
+  Completion completion(2);
+  {
+    // The first request waits for the second one, until the batch is full.
+    auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 3, /*batch_axis*/ 0, std::chrono::seconds(60)),
+                                allocator, session);
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {1, 3}, 0.f, completion.GetCallback(0))));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 3}, 1.f, completion.GetCallback(1))));
+    completion.Wait();
+  }
+
+  EXPECT_EQ(session.BatchSizes(), (std::vector<int64_t>{3}));
+  for (size_t i = 0; i < 2; ++i) {
+    ASSERT_STATUS_OK(completion.statuses[i]);
+    const auto& y = completion.outputs[i][0].Get<Tensor>();
+    EXPECT_EQ(y.Shape(), TensorShape({static_cast<int64_t>(i) + 1, 3}));
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, 2.f * i);
+    }
+  }
+}
+
+TEST(RunQueueTest, MergeAlongBatchAxis) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator, /*batch_axis*/ 1);
+  Completion completion(3);
+  {
+    auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 8, /*batch_axis*/ 1), allocator, session);
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 1, 3}, 0.f, completion.GetCallback(0))));
+    while (session.BatchSizes().empty()) {
+      std::this_thread::yield();
+    }
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 1, 3}, 1.f, completion.GetCallback(1))));
+    ASSERT_STATUS_OK(queue->Submit(MakeRequest(allocator, {2, 2, 3}, 2.f, completion.GetCallback(2))));
+    session.Release();
+    completion.Wait();
+  }
+
+  EXPECT_EQ(session.BatchSizes(), (std::vector<int64_t>{1, 3}));
+  const std::vector<int64_t> expected_batch_sizes{1, 1, 2};
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_STATUS_OK(completion.statuses[i]);
+    const auto& y = completion.outputs[i][0].Get<Tensor>();
+    EXPECT_EQ(y.Shape(), TensorShape({2, expected_batch_sizes[i], 3}));
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, 2.f * i);
+    }
+  }
+}
+
+TEST(RunQueueTest, SubmitAndWait) {
+  auto allocator = std::make_shared<CPUAllocator>();
+  FakeSession session(allocator);
+  session.Release();
+  auto queue = CreateRunQueue(MakeOptions(/*max_batch_size*/ 4), allocator, session);
+
+  std::vector<OrtValue> fetches;
+  ASSERT_STATUS_OK(queue->SubmitAndWait(MakeRequest(allocator, {2, 3}, 1.f, nullptr), fetches));
+  ASSERT_EQ(fetches.size(), 1u);
+  EXPECT_EQ(fetches[0].Get<Tensor>().Shape(), TensorShape({2, 3}));
+  EXPECT_EQ(fetches[0].Get<Tensor>().DataAsSpan<float>()[0], 2.f);
+  EXPECT_FALSE(RunQueue::IsDispatcherThread());
+}
+
+// The requests wait for each other up to a delay long enough to never expire, so they always run as one batch.
+TEST(RunQueueTest, SessionRunAsyncMergesRequests) {
+  constexpr size_t kNumRequests = 4;
+  auto session = CreateSession(CreateBatchSumModel(/*dynamic_batch*/ true),
+                               {{kOrtSessionOptionsRunAsyncMaxConcurrency, "1"},
+                                {kOrtSessionOptionsRunAsyncMaxBatchSize, "4"},
+                                {kOrtSessionOptionsRunAsyncMaxDelayUs, "600000000"}});
+  ASSERT_STATUS_OK(session->Initialize());
+
+  auto allocator = std::make_shared<CPUAllocator>();
+  AsyncRuns async_runs(kNumRequests);
+  std::vector<OrtValue> feeds;
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    feeds.push_back(MakeFloatTensor(allocator, {1, 3}, static_cast<float>(i + 1)));
+  }
+  const char* const feed_names[] = {"X"};
+  const char* const fetch_names[] = {"Y"};
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    const OrtValue* const request_feeds[] = {&feeds[i]};
+    auto& run = async_runs.runs[i];
+    ASSERT_STATUS_OK(session->RunAsync(nullptr, feed_names, request_feeds, fetch_names,
+                                       gsl::span<OrtValue*>(&run.output, 1), &AsyncRuns::Callback, &run));
+  }
+  async_runs.Wait();
+
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    const auto& run = async_runs.runs[i];
+    ASSERT_STATUS_OK(run.status);
+    ASSERT_NE(run.output, nullptr);
+    const auto& y = run.output->Get<Tensor>();
+    EXPECT_EQ(y.Shape(), TensorShape({1, 3}));
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, static_cast<float>(i + 1) + 10.f);
+    }
+  }
+}
+
+// The dispatcher runs the merged batch through InferenceSession::Run, which must not queue it again.
+TEST(RunQueueTest, SessionMicroBatchingMergesConcurrentRuns) {
+  constexpr size_t kNumThreads = 4;
+  auto session = CreateSession(CreateBatchSumModel(/*dynamic_batch*/ true),
+                               {{kOrtSessionOptionsRunMicroBatching, "1"},
+                                {kOrtSessionOptionsRunAsyncMaxBatchSize, "4"},
+                                {kOrtSessionOptionsRunAsyncMaxDelayUs, "600000000"}});
+  ASSERT_STATUS_OK(session->Initialize());
+
+  std::vector<Status> statuses;
+  std::vector<std::vector<OrtValue>> outputs;
+  RunConcurrently(*session, std::make_shared<CPUAllocator>(), kNumThreads, statuses, outputs);
+
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    ASSERT_STATUS_OK(statuses[i]);
+    ASSERT_EQ(outputs[i].size(), 1u);
+    const auto& y = outputs[i][0].Get<Tensor>();
+    EXPECT_EQ(y.Shape(), TensorShape({1, 3}));
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, static_cast<float>(i + 1) + 10.f);
+    }
+  }
+  EXPECT_FALSE(RunQueue::IsDispatcherThread());
+}
+
+// Requests are not merged, and do not wait for each other, when the model has no dynamic batch axis.
+TEST(RunQueueTest, SessionMicroBatchingWithoutDynamicBatchAxis) {
+  constexpr size_t kNumThreads = 4;
+  auto session = CreateSession(CreateBatchSumModel(/*dynamic_batch*/ false),
+                               {{kOrtSessionOptionsRunMicroBatching, "1"},
+                                {kOrtSessionOptionsRunAsyncMaxBatchSize, "4"},
+                                {kOrtSessionOptionsRunAsyncMaxDelayUs, "600000000"}});
+  ASSERT_STATUS_OK(session->Initialize());
+
+  std::vector<Status> statuses;
+  std::vector<std::vector<OrtValue>> outputs;
+  RunConcurrently(*session, std::make_shared<CPUAllocator>(), kNumThreads, statuses, outputs);
+
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    ASSERT_STATUS_OK(statuses[i]);
+    const auto& y = outputs[i][0].Get<Tensor>();
+    for (float value : y.DataAsSpan<float>()) {
+      EXPECT_EQ(value, 2.f * static_cast<float>(i + 1));
+    }
+  }
+}
+
+TEST(RunQueueTest, SessionRejectsInvalidRunQueueConfig) {
+  const std::string model_data = CreateBatchSumModel(/*dynamic_batch*/ true);
+  EXPECT_FALSE(CreateSession(model_data, {{kOrtSessionOptionsRunMicroBatching, "1"},
+                                          {kOrtSessionOptionsRunAsyncMaxConcurrency, "0"}})
+                   ->Initialize()
+                   .IsOK());
+  EXPECT_FALSE(CreateSession(model_data, {{kOrtSessionOptionsRunAsyncMaxConcurrency, "1"},
+                                          {kOrtSessionOptionsRunAsyncMaxBatchSize, "many"}})
+                   ->Initialize()
+                   .IsOK());
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/static_mem_pattern_planner.h"
+#include "gtest/gtest.h"
+
+namespace onnxruntime {
+namespace test {
+
+static void ExpectNoOverlap(const MemoryPattern& pattern, int idx_1, int idx_2) {
+  const auto* block_1 = pattern.GetBlock(idx_1);
+  const auto* block_2 = pattern.GetBlock(idx_2);
+  ASSERT_NE(block_1, nullptr);
+  ASSERT_NE(block_2, nullptr);
+  EXPECT_TRUE(block_1->offset_ + block_1->size_ <= block_2->offset_ ||
+              block_2->offset_ + block_2->size_ <= block_1->offset_)
+      << idx_1 << " and " << idx_2 << " overlap";
+}
+
+TEST(StaticMemPatternPlannerTest, DisjointLifetimesShareMemory) {
+  StaticMemPatternPlanner planner;
+  // A chain where each buffer is freed by the step after the one that produced it.
+  planner.AddBuffer(0, 1024, 0, 1);
+  planner.AddBuffer(1, 1024, 1, 2);
+  planner.AddBuffer(2, 1024, 2, 3);
+  planner.AddBuffer(3, 1024, 3, 4);
+
+  for (auto strategy : {StaticMemPatternPlanner::Strategy::kGreedyBySize,
+                        StaticMemPatternPlanner::Strategy::kBestFit}) {
+    auto pattern = planner.GeneratePattern(strategy);
+    EXPECT_EQ(pattern.PeakSize(), 2048u);
+    ExpectNoOverlap(pattern, 0, 1);
+    ExpectNoOverlap(pattern, 1, 2);
+    ExpectNoOverlap(pattern, 2, 3);
+  }
+  EXPECT_EQ(planner.NaivePeakSize(), 4096u);
+}
+
+TEST(StaticMemPatternPlannerTest, GreedyBySizeBeatsAllocationOrder) {
+  StaticMemPatternPlanner planner;
+  // In allocation order, 0 and 1 are placed first and 2 can't fit in the hole left by 0.
+  // Placing the largest buffer first lets 0 and 3 share its neighbourhood.
+  planner.AddBuffer(0, 256, 0, 1);
+  planner.AddBuffer(1, 256, 0, 3);
+  planner.AddBuffer(2, 512, 2, 3);
+  planner.AddBuffer(3, 256, 4, 5);
+
+  auto best_fit = planner.GeneratePattern(StaticMemPatternPlanner::Strategy::kBestFit);
+  auto by_size = planner.GeneratePattern(StaticMemPatternPlanner::Strategy::kGreedyBySize);
+  EXPECT_EQ(best_fit.PeakSize(), 1024u);
+  EXPECT_EQ(by_size.PeakSize(), 768u);
+  ExpectNoOverlap(by_size, 0, 1);
+  ExpectNoOverlap(by_size, 1, 2);
+
+  auto best = planner.GeneratePattern();
+  EXPECT_EQ(best.PeakSize(), 768u);
+  EXPECT_EQ(planner.NaivePeakSize(), 1280u);
+}
+
+TEST(StaticMemPatternPlannerTest, ShareBufferForInPlaceOutput) {
+  StaticMemPatternPlanner planner;
+  planner.AddBuffer(0, 512, 0, 1);
+  // 1 is computed in place of 0 at step 1 and used until step 3.
+  planner.ShareBuffer(1, 0, 3);
+  planner.AddBuffer(2, 512, 2, 3);
+
+  auto pattern = planner.GeneratePattern();
+  ASSERT_NE(pattern.GetBlock(1), nullptr);
+  EXPECT_EQ(pattern.GetBlock(0)->offset_, pattern.GetBlock(1)->offset_);
+  ExpectNoOverlap(pattern, 1, 2);
+  EXPECT_EQ(pattern.PeakSize(), 1024u);
+  EXPECT_EQ(planner.NumBuffers(), 2u);
+  EXPECT_EQ(planner.NaivePeakSize(), 1536u);
+}
+
+}  // namespace test
+}  // namespace onnxruntime
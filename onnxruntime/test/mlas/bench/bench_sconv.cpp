@@ -5,6 +5,7 @@
 #include "bench_util.h"
 #include "core/util/thread_utils.h"
 
+#include <iterator>
 #include <stdexcept>
 #include <numeric>
 
@@ -94,7 +95,7 @@ void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
 
   MLAS_ACTIVATION activation;
   activation.ActivationKind = MlasIdentityActivation;
-  MLAS_CONV_PARAMETERS Parameters;
+  MLAS_CONV_PARAMETERS Parameters{};
   size_t WorkingBufferSize = 0;
   MlasConvPrepare(&Parameters,
                   static_cast<size_t>(rank),
@@ -111,7 +112,8 @@ void SCONV_NCHW(benchmark::State& state, const char* /*dummy*/) {
                   &activation,
                   &WorkingBufferSize,
                   0.0f,
-                  nullptr);
+                  nullptr,
+                  false);
 
   auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
   auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
@@ -201,7 +203,7 @@ void SCONV_NCHW_THREADED(benchmark::State& state, const char* /*dummy*/) {
 
   MLAS_ACTIVATION activation;
   activation.ActivationKind = MlasIdentityActivation;
-  MLAS_CONV_PARAMETERS Parameters;
+  MLAS_CONV_PARAMETERS Parameters{};
   size_t WorkingBufferSize = 0;
   MlasConvPrepare(&Parameters,
                   static_cast<size_t>(rank),
@@ -218,7 +220,8 @@ void SCONV_NCHW_THREADED(benchmark::State& state, const char* /*dummy*/) {
                   &activation,
                   &WorkingBufferSize,
                   0.0f,
-                  tp);
+                  tp,
+                  false);
 
   auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
   auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
@@ -246,6 +249,115 @@ void SCONV_NCHW_THREADED(benchmark::State& state, const char* /*dummy*/) {
   }
 }
 
+// Algorithms compared by SCONV_NCHW_ALGORITHM, selected by its last argument.
+static const struct {
+  MLAS_CONV_ALGORITHM algorithm;
+  size_t transform_size;
+} kConvAlgorithms[] = {
+    {MlasConvAlgorithmExpandThenGemmSegmented, 0},  // im2col + GEMM
+    {MlasConvAlgorithmWinograd, 6},                 // F(4x4,3x3)
+    {MlasConvAlgorithmWinograd, 8},                 // F(6x6,3x3)
+    {MlasConvAlgorithmFft, 16},
+    {MlasConvAlgorithmFft, 32},
+};
+
+void SCONV_NCHW_ALGORITHM(benchmark::State& state, const char* /*dummy*/) {
+  MLAS_THREADPOOL* tp = GetMlasThreadPoolForConvBenchmark();
+
+  const int64_t batch_size = state.range(1);                 // N
+  const int64_t groups = state.range(2);                     // G
+  const int64_t input_channels_per_group = state.range(3);   // Cpg
+  const int64_t output_channels_per_group = state.range(4);  // Fpg
+
+  size_t arg_position = 5;
+  const auto input_shape = BenchArgsVector(state, arg_position, 2);
+  const auto kernel_shape = BenchArgsVector(state, arg_position, 2);
+  const auto paddings = BenchArgsVector(state, arg_position, 4);
+  const auto strides = BenchArgsVector(state, arg_position, 2);
+  const auto dilations = BenchArgsVector(state, arg_position, 2);
+  const auto algorithm_index = static_cast<size_t>(state.range(static_cast<int>(arg_position)));
+
+  if (algorithm_index >= std::size(kConvAlgorithms)) {
+    throw std::invalid_argument("Algo must be less than the number of compared algorithms!");
+  }
+
+  const int64_t GC = groups * input_channels_per_group;
+  const int64_t GF = groups * output_channels_per_group;
+  std::vector<int64_t> x_shape = {batch_size, GC};
+  x_shape.insert(x_shape.end(), input_shape.begin(), input_shape.end());
+  std::vector<int64_t> f_shape = {GF, input_channels_per_group};
+  f_shape.insert(f_shape.end(), kernel_shape.begin(), kernel_shape.end());
+
+  std::vector<int64_t> output_shape(2);
+  for (size_t i = 0; i < 2; ++i) {
+    auto km = 1 + dilations[i] * (kernel_shape[i] - 1);
+    output_shape[i] = (paddings[i] + paddings[i + 2] + input_shape[i] - km) / strides[i] + 1;
+  }
+  std::vector<int64_t> y_shape = {batch_size, GF};
+  y_shape.insert(y_shape.end(), output_shape.begin(), output_shape.end());
+
+  MLAS_ACTIVATION activation;
+  activation.ActivationKind = MlasIdentityActivation;
+  MLAS_CONV_PARAMETERS Parameters{};
+  size_t WorkingBufferSize = 0;
+  MlasConvPrepare(&Parameters,
+                  2,
+                  static_cast<size_t>(batch_size),
+                  static_cast<size_t>(groups),
+                  static_cast<size_t>(input_channels_per_group),
+                  input_shape.data(),
+                  kernel_shape.data(),
+                  dilations.data(),
+                  paddings.data(),
+                  strides.data(),
+                  output_shape.data(),
+                  static_cast<size_t>(output_channels_per_group),
+                  &activation,
+                  &WorkingBufferSize,
+                  0.0f,
+                  tp,
+                  true);
+
+  const auto& algorithm = kConvAlgorithms[algorithm_index];
+  if (!MlasConvSetAlgorithm(&Parameters, algorithm.algorithm, algorithm.transform_size, &WorkingBufferSize, tp)) {
+    state.SkipWithError("The algorithm does not support the convolution.");
+    return;
+  }
+
+  auto X = RandomVectorUniform(x_shape, -2.0, 2.0);
+  auto F = RandomVectorUniform(f_shape, -1.0, 1.0);
+  int64_t y_size = std::accumulate(y_shape.begin(), y_shape.end(), 1LL, std::multiplies<int64_t>());
+  std::vector<float> Y(static_cast<size_t>(y_size));
+  std::vector<float> working_buffer(WorkingBufferSize);
+
+  // The filter is packed once, as the Conv kernel does when it is a constant.
+  std::vector<float> packed_filter(MlasConvPackFilterSize(&Parameters) / sizeof(float));
+  const float* filter = F.data();
+  if (!packed_filter.empty()) {
+    MlasConvPackFilter(&Parameters, F.data(), packed_filter.data());
+    filter = packed_filter.data();
+  }
+
+  // warm up first round.
+  MlasConv(&Parameters,
+           X.data(),
+           filter,
+           nullptr,
+           working_buffer.data(),
+           Y.data(),
+           tp);
+
+  for (auto _ : state) {
+    MlasConv(&Parameters,
+             X.data(),
+             filter,
+             nullptr,
+             working_buffer.data(),
+             Y.data(),
+             tp);
+  }
+}
+
 static void ResNet50(benchmark::internal::Benchmark* b) {
   b->ArgNames(ArgNamesForConv(2));
 
@@ -358,3 +470,32 @@ static void General_Conv2d(benchmark::internal::Benchmark* b) {
 }
 
 BENCHMARK_CAPTURE(SCONV_NCHW, 2d, "")->Apply(General_Conv2d)->UseRealTime();
+
+static void FastConvAlgorithms(benchmark::internal::Benchmark* b) {
+  std::vector<std::string> names = ArgNamesForConv(2);
+  names.push_back("Algo");
+  b->ArgNames(names);
+
+  const std::vector<std::vector<int64_t>> shapes = {
+      //Rank, N, G, Cpg, Fpg,  I,   , K, , P, , , , S, , D, ,
+      {2, 1, 1, 64, 64, 56, 56, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},      // ResNet50 conv 2.X
+      {2, 1, 1, 128, 128, 28, 28, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},    // ResNet50 conv 3.X
+      {2, 1, 1, 256, 256, 14, 14, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},    // ResNet50 conv 4.X
+      {2, 1, 1, 512, 512, 7, 7, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},      // ResNet50 conv 5.X
+      {2, 1, 1, 32, 64, 160, 160, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},    // YOLO backbone at 640x640
+      {2, 1, 1, 128, 128, 40, 40, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},    // YOLO backbone at 640x640
+      {2, 1, 1, 64, 64, 56, 56, 7, 7, 3, 3, 3, 3, 1, 1, 1, 1},      // large kernel
+      {2, 1, 1, 32, 32, 64, 64, 9, 9, 4, 4, 4, 4, 1, 1, 1, 1},      // large kernel
+      {2, 1, 1, 96, 96, 56, 56, 13, 13, 6, 6, 6, 6, 1, 1, 1, 1},    // large kernel
+  };
+
+  for (const auto& shape : shapes) {
+    for (int64_t algorithm = 0; algorithm < static_cast<int64_t>(std::size(kConvAlgorithms)); algorithm++) {
+      auto args = shape;
+      args.push_back(algorithm);
+      b->Args(args);
+    }
+  }
+}
+
+BENCHMARK_CAPTURE(SCONV_NCHW_ALGORITHM, FastConvAlgorithms, "")->Apply(FastConvAlgorithms)->UseRealTime();
@@ -40,7 +40,7 @@ class MlasConv2DTest : public MlasTestBase {
     MLAS_ACTIVATION Activation;
     Activation.ActivationKind = MlasIdentityActivation;
 
-    MLAS_CONV_PARAMETERS Parameters;
+    MLAS_CONV_PARAMETERS Parameters{};
     size_t WorkingBufferSize;
 
     MlasConvPrepare(&Parameters,
@@ -58,7 +58,8 @@ class MlasConv2DTest : public MlasTestBase {
                     &Activation,
                     &WorkingBufferSize,
                     0.0f,
-                    threadpool_);
+                    threadpool_,
+                    false);
 
     MlasConv(&Parameters,
              Input,
@@ -0,0 +1,213 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+//
+// Tests the Winograd and FFT convolution algorithms, which round differently
+// from the direct computation and are compared with a tolerance.
+//
+template <bool Threaded>
+class MlasConv2DTransformTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferFilter;
+  MatrixGuardBuffer<float> BufferPackedFilter;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+  MatrixGuardBuffer<float> BufferWorking;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  float* GetRandomBuffer(MatrixGuardBuffer<float>& Buffer, size_t Elements, unsigned Seed) {
+    return Buffer.GetFilledBuffer(Elements, [Seed](float* start, size_t size) {
+      std::default_random_engine generator(Seed);
+      std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+      for (size_t i = 0; i < size; i++) {
+        start[i] = distribution(generator);
+      }
+    });
+  }
+
+  void ReferenceConv2D(size_t BatchCount, size_t GroupCount, size_t InputChannels,
+                       size_t InputHeight, size_t InputWidth, size_t FilterCount,
+                       size_t KernelHeight, size_t KernelWidth, size_t PaddingTop, size_t PaddingLeft,
+                       size_t OutputHeight, size_t OutputWidth, float Beta,
+                       const float* Input, const float* Filter, const float* Bias, float* Output) {
+    for (size_t b = 0; b < BatchCount; b++) {
+      for (size_t g = 0; g < GroupCount; g++) {
+        const float* input = Input + (b * GroupCount + g) * InputChannels * InputHeight * InputWidth;
+        float* output = Output + (b * GroupCount + g) * FilterCount * OutputHeight * OutputWidth;
+
+        for (size_t f = 0; f < FilterCount; f++) {
+          const float* filter = Filter + (g * FilterCount + f) * InputChannels * KernelHeight * KernelWidth;
+
+          for (size_t oh = 0; oh < OutputHeight; oh++) {
+            for (size_t ow = 0; ow < OutputWidth; ow++) {
+              double sum = Bias[g * FilterCount + f];
+
+              for (size_t c = 0; c < InputChannels; c++) {
+                for (size_t kh = 0; kh < KernelHeight; kh++) {
+                  size_t ih = oh + kh - PaddingTop;
+                  if (ih >= InputHeight) continue;
+
+                  for (size_t kw = 0; kw < KernelWidth; kw++) {
+                    size_t iw = ow + kw - PaddingLeft;
+                    if (iw >= InputWidth) continue;
+
+                    sum += double(input[(c * InputHeight + ih) * InputWidth + iw]) *
+                           double(filter[(c * KernelHeight + kh) * KernelWidth + kw]);
+                  }
+                }
+              }
+
+              float& out = output[(f * OutputHeight + oh) * OutputWidth + ow];
+              out = float(sum + double(Beta) * double(out));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void Test(MLAS_CONV_ALGORITHM Algorithm, size_t TransformSize,
+            size_t BatchCount, size_t GroupCount, size_t InputChannels,
+            size_t InputHeight, size_t InputWidth, size_t FilterCount,
+            size_t KernelHeight, size_t KernelWidth,
+            size_t PaddingTop, size_t PaddingLeft, size_t PaddingBottom, size_t PaddingRight,
+            float Beta) {
+    const size_t OutputHeight = InputHeight + PaddingTop + PaddingBottom - KernelHeight + 1;
+    const size_t OutputWidth = InputWidth + PaddingLeft + PaddingRight - KernelWidth + 1;
+
+    const size_t InputElements = BatchCount * GroupCount * InputChannels * InputHeight * InputWidth;
+    const size_t FilterElements = GroupCount * FilterCount * InputChannels * KernelHeight * KernelWidth;
+    const size_t OutputElements = BatchCount * GroupCount * FilterCount * OutputHeight * OutputWidth;
+
+    const float* Input = GetRandomBuffer(BufferInput, InputElements, 1);
+    const float* Filter = GetRandomBuffer(BufferFilter, FilterElements, 2);
+    const float* Bias = GetRandomBuffer(BufferBias, GroupCount * FilterCount, 3);
+    float* Output = GetRandomBuffer(BufferOutput, OutputElements, 4);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+    std::copy_n(Output, OutputElements, OutputReference);
+
+    int64_t InputShape[] = {int64_t(InputHeight), int64_t(InputWidth)};
+    int64_t KernelShape[] = {int64_t(KernelHeight), int64_t(KernelWidth)};
+    int64_t DilationShape[] = {1, 1};
+    int64_t Padding[] = {int64_t(PaddingTop), int64_t(PaddingLeft), int64_t(PaddingBottom), int64_t(PaddingRight)};
+    int64_t StrideShape[] = {1, 1};
+    int64_t OutputShape[] = {int64_t(OutputHeight), int64_t(OutputWidth)};
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters{};
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters, 2, BatchCount, GroupCount, InputChannels, InputShape, KernelShape,
+                    DilationShape, Padding, StrideShape, OutputShape, FilterCount, &Activation,
+                    &WorkingBufferSize, Beta, threadpool_, true);
+
+    ASSERT_TRUE(MlasConvSetAlgorithm(&Parameters, Algorithm, TransformSize, &WorkingBufferSize, threadpool_));
+
+    const size_t PackedFilterSize = MlasConvPackFilterSize(&Parameters);
+    ASSERT_GT(PackedFilterSize, 0u);
+
+    float* PackedFilter = BufferPackedFilter.GetBuffer(PackedFilterSize / sizeof(float));
+    MlasConvPackFilter(&Parameters, Filter, PackedFilter);
+
+    MlasConv(&Parameters, Input, PackedFilter, Bias, BufferWorking.GetBuffer(WorkingBufferSize), Output,
+             threadpool_);
+
+    ReferenceConv2D(BatchCount, GroupCount, InputChannels, InputHeight, InputWidth, FilterCount,
+                    KernelHeight, KernelWidth, PaddingTop, PaddingLeft, OutputHeight, OutputWidth, Beta,
+                    Input, Filter, Bias, OutputReference);
+
+    // The error grows with the number of accumulated products and, for
+    // F(6x6,3x3), with the magnitude of the transform coefficients.
+    const float Tolerance = 1e-5f * float(InputChannels * KernelHeight * KernelWidth);
+
+    for (size_t i = 0; i < OutputElements; i++) {
+      ASSERT_NEAR(Output[i], OutputReference[i], Tolerance)
+          << "Algorithm" << int(Algorithm) << "/"
+          << "TransformSize" << TransformSize << "/"
+          << "B" << BatchCount << "/"
+          << "G" << GroupCount << "/"
+          << "Cpg" << InputChannels << "/"
+          << "Fpg" << FilterCount << "/"
+          << "H" << InputHeight << "/"
+          << "W" << InputWidth << "/"
+          << "KH" << KernelHeight << "/"
+          << "KW" << KernelWidth << "/"
+          << "Pad" << PaddingTop << "," << PaddingLeft << "," << PaddingBottom << "," << PaddingRight << "/"
+          << "Beta" << Beta << " @ " << i;
+    }
+  }
+
+  MLAS_CONV_ALGORITHM Select(size_t InputChannels, size_t InputSize, size_t FilterCount, size_t KernelSize,
+                             bool AllowFastAlgorithms) {
+    const size_t Padding = KernelSize / 2;
+
+    int64_t InputShape[] = {int64_t(InputSize), int64_t(InputSize)};
+    int64_t KernelShape[] = {int64_t(KernelSize), int64_t(KernelSize)};
+    int64_t DilationShape[] = {1, 1};
+    int64_t Paddings[] = {int64_t(Padding), int64_t(Padding), int64_t(Padding), int64_t(Padding)};
+    int64_t StrideShape[] = {1, 1};
+    int64_t OutputShape[] = {int64_t(InputSize), int64_t(InputSize)};
+
+    MLAS_ACTIVATION Activation;
+    Activation.ActivationKind = MlasIdentityActivation;
+
+    MLAS_CONV_PARAMETERS Parameters{};
+    size_t WorkingBufferSize;
+
+    MlasConvPrepare(&Parameters, 2, 1, 1, InputChannels, InputShape, KernelShape, DilationShape, Paddings,
+                    StrideShape, OutputShape, FilterCount, &Activation, &WorkingBufferSize, 0.0f, threadpool_,
+                    AllowFastAlgorithms);
+
+    return Parameters.Algorithm;
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "Conv2dTransform_Threaded" : "Conv2dTransform_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasConv2DTransformTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (size_t TransformSize : {6, 8}) {
+      Test(MlasConvAlgorithmWinograd, TransformSize, 1, 1, 16, 13, 17, 24, 3, 3, 1, 1, 1, 1, 0.0f);
+      Test(MlasConvAlgorithmWinograd, TransformSize, 2, 2, 8, 9, 11, 8, 3, 3, 0, 1, 1, 0, 1.0f);
+      Test(MlasConvAlgorithmWinograd, TransformSize, 1, 1, 32, 28, 28, 32, 3, 3, 1, 1, 1, 1, 0.0f);
+      Test(MlasConvAlgorithmWinograd, TransformSize, 1, 1, 8, 3, 4, 8, 3, 3, 2, 2, 2, 2, 0.0f);
+    }
+
+    for (size_t TransformSize : {16, 32}) {
+      Test(MlasConvAlgorithmFft, TransformSize, 1, 1, 8, 23, 19, 9, 7, 7, 3, 3, 3, 3, 0.0f);
+      Test(MlasConvAlgorithmFft, TransformSize, 2, 2, 8, 40, 37, 8, 5, 9, 2, 4, 2, 4, 0.5f);
+      Test(MlasConvAlgorithmFft, TransformSize, 1, 1, 16, 5, 5, 8, 9, 9, 4, 4, 4, 4, 0.0f);
+      Test(MlasConvAlgorithmFft, TransformSize, 1, 1, 8, 33, 33, 8, 3, 3, 1, 1, 1, 1, 0.0f);
+    }
+
+    // The fast algorithms are only selected when allowed and cheaper. Skip
+    // the checks when the platform overrides the selection.
+    if (Select(64, 56, 64, 3, false) == MlasConvAlgorithmExpandThenGemmSegmented) {
+      EXPECT_EQ(Select(64, 56, 64, 3, true), MlasConvAlgorithmWinograd);
+      EXPECT_EQ(Select(64, 56, 64, 7, true), MlasConvAlgorithmFft);
+      EXPECT_EQ(Select(3, 224, 64, 3, true), MlasConvAlgorithmExpandThenGemmSegmented);
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasConv2DTransformTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasConv2DTransformTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+#include "core/mlas/lib/mlasi.h"
+
+#include <limits>
+
+class MlasFlashAttentionTest : public MlasTestBase {
+ private:
+  struct Config {
+    int batch_size = 1;
+    int num_heads = 2;
+    int kv_num_heads = 0;
+    int q_sequence_length = 1;
+    int kv_sequence_length = 1;
+    int head_size = 16;
+    int q_block_size = 4;
+    int kv_block_size = 8;
+    size_t q_batch_stride = 0;
+    bool use_kv_valid_lengths = false;
+    bool is_causal = false;
+    int local_window_size = -1;
+    float softcap = 0.0f;
+    bool use_smooth_softmax = false;
+    bool use_head_sink = false;
+  };
+
+  MatrixGuardBuffer<float> BufferQuery;
+  MatrixGuardBuffer<float> BufferKey;
+  MatrixGuardBuffer<float> BufferValue;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+  MatrixGuardBuffer<float> BufferWorkspace;
+  MLAS_THREADPOOL* threadpool_;
+
+  static void Reference(const Config& config, const float* query, size_t q_batch_stride, const float* key,
+                        const float* value, const int32_t* kv_valid_lengths, const float* head_sink, float scale,
+                        float* output) {
+    const int kv_num_heads = config.kv_num_heads > 0 ? config.kv_num_heads : config.num_heads;
+    const int H = config.head_size;
+    std::vector<float> scores(config.kv_sequence_length);
+
+    for (int b = 0; b < config.batch_size; b++) {
+      const int kv_valid = kv_valid_lengths != nullptr ? kv_valid_lengths[b] : config.kv_sequence_length;
+      const int past = config.is_causal ? std::max(kv_valid - config.q_sequence_length, 0) : 0;
+      for (int n = 0; n < config.num_heads; n++) {
+        const int n_kv = n / (config.num_heads / kv_num_heads);
+        const float* k = key + static_cast<size_t>(b * kv_num_heads + n_kv) * config.kv_sequence_length * H;
+        const float* v = value + static_cast<size_t>(b * kv_num_heads + n_kv) * config.kv_sequence_length * H;
+        for (int s = 0; s < config.q_sequence_length; s++) {
+          const float* q = query + b * q_batch_stride + static_cast<size_t>(n * config.q_sequence_length + s) * H;
+          float* out = output + (static_cast<size_t>(b * config.q_sequence_length + s) * config.num_heads + n) * H;
+
+          int end = kv_valid;
+          if (config.is_causal) {
+            end = std::min(end, past + s + 1);
+          }
+          int start = 0;
+          if (config.local_window_size >= 0) {
+            start = std::max(past + s + 1 - config.local_window_size, 0);
+          }
+
+          float max_score = config.use_smooth_softmax ? (head_sink != nullptr ? head_sink[n] : 0.0f)
+                                                      : std::numeric_limits<float>::lowest();
+          for (int t = start; t < end; t++) {
+            float dot = 0.0f;
+            for (int h = 0; h < H; h++) {
+              dot += q[h] * k[t * H + h];
+            }
+            dot *= scale;
+            if (config.softcap > 0.0f) {
+              dot = config.softcap * std::tanh(dot / config.softcap);
+            }
+            scores[t] = dot;
+            max_score = std::max(max_score, dot);
+          }
+
+          float sum = config.use_smooth_softmax
+                          ? std::exp((head_sink != nullptr ? head_sink[n] : 0.0f) - max_score)
+                          : 0.0f;
+          for (int t = start; t < end; t++) {
+            scores[t] = std::exp(scores[t] - max_score);
+            sum += scores[t];
+          }
+
+          for (int h = 0; h < H; h++) {
+            out[h] = 0.0f;
+          }
+          for (int t = start; t < end; t++) {
+            for (int h = 0; h < H; h++) {
+              out[h] += scores[t] / sum * v[t * H + h];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void Test(const Config& config) {
+    const int kv_num_heads = config.kv_num_heads > 0 ? config.kv_num_heads : config.num_heads;
+    const int H = config.head_size;
+    const size_t q_batch_stride = config.q_batch_stride > 0
+                                      ? config.q_batch_stride
+                                      : static_cast<size_t>(config.num_heads) * config.q_sequence_length * H;
+    const size_t query_size = q_batch_stride * config.batch_size;
+    const size_t kv_size = static_cast<size_t>(config.batch_size) * kv_num_heads * config.kv_sequence_length * H;
+    const size_t output_size = static_cast<size_t>(config.batch_size) * config.q_sequence_length * config.num_heads * H;
+
+    float* query = BufferQuery.GetBuffer(query_size);
+    float* key = BufferKey.GetBuffer(kv_size);
+    float* value = BufferValue.GetBuffer(kv_size);
+    float* output = BufferOutput.GetBuffer(output_size);
+    float* output_reference = BufferOutputReference.GetBuffer(output_size);
+
+    std::default_random_engine generator(static_cast<unsigned>(query_size + kv_size));
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (size_t i = 0; i < query_size; i++) {
+      query[i] = distribution(generator);
+    }
+    for (size_t i = 0; i < kv_size; i++) {
+      key[i] = distribution(generator);
+      value[i] = distribution(generator);
+    }
+
+    std::vector<int32_t> kv_valid_lengths;
+    if (config.use_kv_valid_lengths) {
+      for (int b = 0; b < config.batch_size; b++) {
+        kv_valid_lengths.push_back(std::max(config.kv_sequence_length - 3 * b, config.q_sequence_length));
+      }
+    }
+    std::vector<float> head_sink;
+    if (config.use_head_sink) {
+      for (int n = 0; n < config.num_heads; n++) {
+        head_sink.push_back(distribution(generator));
+      }
+    }
+
+    MlasFlashAttentionThreadedArgs args;
+    args.batch_size = config.batch_size;
+    args.num_heads = config.num_heads;
+    args.q_sequence_length = config.q_sequence_length;
+    args.kv_sequence_length = config.kv_sequence_length;
+    args.qk_head_size = H;
+    args.v_head_size = H;
+    args.q_block_size = config.q_block_size;
+    args.kv_block_size = config.kv_block_size;
+    args.scale = 1.0f / std::sqrt(static_cast<float>(H));
+    args.thread_count = MlasGetMaximumThreadCount(threadpool_);
+    args.buffer_size_per_thread = (static_cast<size_t>(config.q_block_size) * 2 +
+                                   static_cast<size_t>(config.q_block_size) * config.kv_block_size +
+                                   static_cast<size_t>(config.q_block_size) * H) *
+                                  sizeof(float);
+    args.buffer = BufferWorkspace.GetBuffer(args.buffer_size_per_thread * args.thread_count / sizeof(float));
+    args.query = query;
+    args.key = key;
+    args.value = value;
+    args.output = output;
+    args.kv_num_heads = config.kv_num_heads;
+    args.q_batch_stride = config.q_batch_stride;
+    args.kv_valid_lengths = config.use_kv_valid_lengths ? kv_valid_lengths.data() : nullptr;
+    args.is_causal = config.is_causal;
+    args.local_window_size = config.local_window_size;
+    args.softcap = config.softcap;
+    args.use_smooth_softmax = config.use_smooth_softmax;
+    args.head_sink = config.use_head_sink ? head_sink.data() : nullptr;
+
+    MlasFlashAttention(&args, threadpool_);
+
+    Reference(config, query, q_batch_stride, key, value, args.kv_valid_lengths, args.head_sink, args.scale,
+              output_reference);
+
+    constexpr float AbsoluteTolerance = 1e-5f;
+    for (size_t i = 0; i < output_size; i++) {
+      ASSERT_TRUE(std::fabs(output[i] - output_reference[i]) <= AbsoluteTolerance)
+          << " @" << i << " of " << output_size << ", got: " << output[i] << ", expecting: " << output_reference[i];
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name("FlashAttention");
+    return suite_name.c_str();
+  }
+
+  MlasFlashAttentionTest() : threadpool_(GetMlasThreadPool()) {}
+
+  void ExecuteShort(void) override {
+    Config config;
+
+    // Plain multi-head attention, as used by MultiHeadAttention.
+    config.batch_size = 2;
+    config.q_sequence_length = 7;
+    config.kv_sequence_length = 19;
+    Test(config);
+
+    // Grouped query attention with causal masking over a longer past.
+    config.num_heads = 4;
+    config.kv_num_heads = 2;
+    config.is_causal = true;
+    Test(config);
+
+    // Per batch valid lengths of the present K/V buffer.
+    config.use_kv_valid_lengths = true;
+    Test(config);
+
+    // Causal prompt without past and a local window that skips whole K/V blocks.
+    config.q_sequence_length = 19;
+    config.local_window_size = 5;
+    Test(config);
+    config.local_window_size = 11;
+    Test(config);
+
+    // Softcap and smooth softmax.
+    config.local_window_size = -1;
+    config.softcap = 2.0f;
+    Test(config);
+    config.softcap = 0.0f;
+    config.use_smooth_softmax = true;
+    Test(config);
+    config.use_head_sink = true;
+    Test(config);
+
+    // Query taken from a packed QKV buffer.
+    config.use_smooth_softmax = false;
+    config.use_head_sink = false;
+    config.q_batch_stride = static_cast<size_t>(config.num_heads + 2 * config.kv_num_heads) *
+                            config.q_sequence_length * config.head_size;
+    Test(config);
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasFlashAttentionTest>::RegisterShortExecute();
+  }
+  return count;
+});
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+#include "core/common/float16.h"
+
+template <typename T>
+class MlasLayerNormTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<T> BufferInput;
+  MatrixGuardBuffer<float> BufferSkip;
+  MatrixGuardBuffer<float> BufferBias;
+  MatrixGuardBuffer<float> BufferScale;
+  MatrixGuardBuffer<float> BufferShift;
+  MatrixGuardBuffer<T> BufferOutput;
+  MatrixGuardBuffer<T> BufferSumOutput;
+  MatrixGuardBuffer<int8_t> BufferQuantizedOutput;
+  MatrixGuardBuffer<float> BufferQuantizedScale;
+
+  static void Fill(float* start, size_t size, float low, float high) {
+    std::default_random_engine generator(static_cast<unsigned>(size));
+    std::uniform_real_distribution<float> distribution(low, high);
+    for (size_t i = 0; i < size; i++) {
+      start[i] = distribution(generator);
+    }
+  }
+
+  void Test(size_t N, bool Simplified, bool HasSkip, bool HasShift, size_t QuantizedBlockSize) {
+    constexpr float Epsilon = 1e-5f;
+
+    std::vector<float> InputFloat(N);
+    Fill(InputFloat.data(), N, -2.0f, 3.0f);
+    T* Input = BufferInput.GetBuffer(N);
+    for (size_t i = 0; i < N; i++) {
+      Input[i] = T(InputFloat[i]);
+      InputFloat[i] = float(Input[i]);
+    }
+
+    const auto FillSmall = [](float* start, size_t size) { Fill(start, size, -1.0f, 1.0f); };
+    const auto FillScale = [](float* start, size_t size) { Fill(start, size, 0.5f, 1.5f); };
+    const float* Skip = HasSkip ? BufferSkip.GetFilledBuffer(N, FillSmall) : nullptr;
+    const float* Bias = HasSkip ? BufferBias.GetFilledBuffer(N, FillSmall) : nullptr;
+    const float* Scale = BufferScale.GetFilledBuffer(N, FillScale);
+    const float* Shift = HasShift ? BufferShift.GetFilledBuffer(N, FillSmall) : nullptr;
+
+    T* Output = BufferOutput.GetBuffer(N);
+    T* SumOutput = HasSkip ? BufferSumOutput.GetBuffer(N) : nullptr;
+    int8_t* QuantizedOutput = QuantizedBlockSize != 0 ? BufferQuantizedOutput.GetBuffer(N) : nullptr;
+    float* QuantizedScale = QuantizedBlockSize != 0 ? BufferQuantizedScale.GetBuffer(N) : nullptr;
+
+    float Mean;
+    float InvStdDev;
+    MlasLayerNormalization<T>(Input, Skip, Bias, Scale, Shift, N, Epsilon, Simplified,
+                              Output, SumOutput, QuantizedOutput, QuantizedScale, QuantizedBlockSize,
+                              &Mean, &InvStdDev);
+
+    std::vector<double> x(N);
+    double Sum = 0.0;
+    double SumSquare = 0.0;
+    for (size_t i = 0; i < N; i++) {
+      x[i] = double(InputFloat[i]) + (HasSkip ? double(Skip[i]) + double(Bias[i]) : 0.0);
+      Sum += x[i];
+      SumSquare += x[i] * x[i];
+    }
+    const double ReferenceMean = Simplified ? 0.0 : Sum / N;
+    const double ReferenceInvStdDev =
+        1.0 / std::sqrt(std::max(SumSquare / N - ReferenceMean * ReferenceMean, 0.0) + Epsilon);
+
+    std::vector<double> y(N);
+    for (size_t i = 0; i < N; i++) {
+      y[i] = (x[i] - ReferenceMean) * ReferenceInvStdDev * Scale[i] + (HasShift ? Shift[i] : 0.0);
+    }
+
+    const float Tolerance = std::is_same_v<T, float> ? 1e-4f : 1e-2f;
+    const auto Description = [&]() {
+      std::stringstream ss;
+      ss << "N" << N << "/Simplified" << Simplified << "/Skip" << HasSkip << "/Shift" << HasShift
+         << "/QuantizedBlockSize" << QuantizedBlockSize;
+      return ss.str();
+    };
+
+    ASSERT_NEAR(Mean, ReferenceMean, 1e-4) << Description();
+    ASSERT_NEAR(InvStdDev, ReferenceInvStdDev, 1e-3 * ReferenceInvStdDev) << Description();
+
+    for (size_t i = 0; i < N; i++) {
+      ASSERT_NEAR(float(Output[i]), y[i], Tolerance * (1.0 + std::fabs(y[i]))) << Description() << " @ " << i;
+      if (SumOutput != nullptr) {
+        ASSERT_NEAR(float(SumOutput[i]), x[i], Tolerance * (1.0 + std::fabs(x[i]))) << Description() << " @ " << i;
+      }
+    }
+
+    if (QuantizedOutput == nullptr) {
+      return;
+    }
+
+    for (size_t b = 0; b < N; b += QuantizedBlockSize) {
+      const size_t BlockEnd = std::min(b + QuantizedBlockSize, N);
+      double Maximum = 0.0;
+      for (size_t i = b; i < BlockEnd; i++) {
+        Maximum = std::max(Maximum, std::fabs(y[i]));
+      }
+      const float BlockScale = QuantizedScale[b / QuantizedBlockSize];
+      ASSERT_NEAR(BlockScale, Maximum / 127.0, 1e-4 * (1.0 + Maximum)) << Description() << " @ block " << b;
+      for (size_t i = b; i < BlockEnd; i++) {
+        ASSERT_LE(std::abs(int(QuantizedOutput[i])), 127) << Description() << " @ " << i;
+        ASSERT_NEAR(QuantizedOutput[i] * BlockScale, y[i], BlockScale * 0.5 + 1e-4 * (1.0 + std::fabs(y[i])))
+            << Description() << " @ " << i;
+      }
+    }
+
+    // The quantized output alone must match the quantized output computed alongside the normalized row.
+    std::vector<int8_t> QuantizedOnly(N);
+    std::vector<float> QuantizedOnlyScale((N + QuantizedBlockSize - 1) / QuantizedBlockSize);
+    MlasLayerNormalization<T>(Input, Skip, Bias, Scale, Shift, N, Epsilon, Simplified,
+                              nullptr, nullptr, QuantizedOnly.data(), QuantizedOnlyScale.data(), QuantizedBlockSize,
+                              nullptr, nullptr);
+    for (size_t i = 0; i < N; i++) {
+      ASSERT_EQ(QuantizedOnly[i], QuantizedOutput[i]) << Description() << " @ " << i;
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(std::is_same_v<T, float> ? "LayerNorm_fp32" : "LayerNorm_fp16");
+    return suite_name.c_str();
+  }
+
+  void ExecuteShort(void) override {
+    for (size_t N : {1, 3, 4, 17, 256, 257, 768, 4099}) {
+      for (bool Simplified : {false, true}) {
+        for (bool HasSkip : {false, true}) {
+          for (bool HasShift : {false, true}) {
+            for (size_t QuantizedBlockSize : {0, 32, 100, 1000000}) {
+              Test(N, Simplified, HasSkip, HasShift, QuantizedBlockSize);
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<float>>::RegisterShortExecute();
+    count += MlasDirectShortExecuteTests<MlasLayerNormTest<MLAS_FP16>>::RegisterShortExecute();
+  }
+  return count;
+});
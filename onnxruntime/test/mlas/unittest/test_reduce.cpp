@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "test_util.h"
+
+template <bool Threaded>
+class MlasReduceTest : public MlasTestBase {
+ private:
+  MatrixGuardBuffer<float> BufferInput;
+  MatrixGuardBuffer<float> BufferOutput;
+  MatrixGuardBuffer<float> BufferOutputReference;
+
+  MLAS_THREADPOOL* threadpool_;
+
+  void ReferenceReduce(MLAS_REDUCE_KIND ReduceKind, const float* Input, float* Output,
+                       size_t OuterCount, size_t ReduceCount, size_t InnerCount) {
+    for (size_t o = 0; o < OuterCount; o++) {
+      for (size_t i = 0; i < InnerCount; i++) {
+        const float* input = Input + o * ReduceCount * InnerCount + i;
+        double Maximum = input[0];
+        double Minimum = input[0];
+        for (size_t r = 0; r < ReduceCount; r++) {
+          Maximum = std::max(Maximum, double(input[r * InnerCount]));
+          Minimum = std::min(Minimum, double(input[r * InnerCount]));
+        }
+        double Accumulation = 0.0;
+        for (size_t r = 0; r < ReduceCount; r++) {
+          const double value = input[r * InnerCount];
+          switch (ReduceKind) {
+            case MlasReduceSum:
+              Accumulation += value;
+              break;
+            case MlasReduceSumSquare:
+              Accumulation += value * value;
+              break;
+            case MlasReduceLogSumExp:
+              Accumulation += std::exp(value - Maximum);
+              break;
+            default:
+              break;
+          }
+        }
+        float& out = Output[o * InnerCount + i];
+        switch (ReduceKind) {
+          case MlasReduceMaximum:
+            out = float(Maximum);
+            break;
+          case MlasReduceMinimum:
+            out = float(Minimum);
+            break;
+          case MlasReduceLogSumExp:
+            out = float(Maximum + std::log(Accumulation));
+            break;
+          default:
+            out = float(Accumulation);
+            break;
+        }
+      }
+    }
+  }
+
+  void Test(MLAS_REDUCE_KIND ReduceKind, size_t OuterCount, size_t ReduceCount, size_t InnerCount) {
+    const size_t InputElements = OuterCount * ReduceCount * InnerCount;
+    const size_t OutputElements = OuterCount * InnerCount;
+
+    const float* Input = BufferInput.GetFilledBuffer(InputElements, [](float* start, size_t size) {
+      std::default_random_engine generator(static_cast<unsigned>(size));
+      std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+      for (size_t i = 0; i < size; i++) {
+        start[i] = distribution(generator);
+      }
+    });
+    float* Output = BufferOutput.GetBuffer(OutputElements);
+    float* OutputReference = BufferOutputReference.GetBuffer(OutputElements);
+
+    MlasReduce(ReduceKind, Input, Output, OuterCount, ReduceCount, InnerCount, threadpool_);
+    ReferenceReduce(ReduceKind, Input, OutputReference, OuterCount, ReduceCount, InnerCount);
+
+    // The sums are accumulated in a different order than the reference.
+    const float Tolerance = 1e-6f * float(ReduceCount) * 16.0f;
+
+    for (size_t i = 0; i < OutputElements; i++) {
+      ASSERT_NEAR(Output[i], OutputReference[i], Tolerance + std::fabs(OutputReference[i]) * 1e-5f)
+          << "Kind" << int(ReduceKind) << "/"
+          << "Outer" << OuterCount << "/"
+          << "Reduce" << ReduceCount << "/"
+          << "Inner" << InnerCount << " @ " << i;
+    }
+  }
+
+  void TestInfinity(MLAS_REDUCE_KIND ReduceKind, size_t InnerCount) {
+    constexpr float Infinity = std::numeric_limits<float>::infinity();
+    const size_t ReduceCount = 5;
+
+    float* Input = BufferInput.GetBuffer(ReduceCount * InnerCount * 3);
+    float* Output = BufferOutput.GetBuffer(InnerCount * 3);
+
+    // Slice 0 holds negative infinities only, slice 1 holds a positive
+    // infinity and slice 2 mixes a negative infinity with finite values.
+    for (size_t r = 0; r < ReduceCount; r++) {
+      for (size_t i = 0; i < InnerCount; i++) {
+        Input[(0 * ReduceCount + r) * InnerCount + i] = -Infinity;
+        Input[(1 * ReduceCount + r) * InnerCount + i] = r == 2 ? Infinity : 1.0f;
+        Input[(2 * ReduceCount + r) * InnerCount + i] = r == 0 ? -Infinity : 0.0f;
+      }
+    }
+
+    MlasReduce(ReduceKind, Input, Output, 3, ReduceCount, InnerCount, threadpool_);
+
+    for (size_t i = 0; i < InnerCount; i++) {
+      EXPECT_EQ(Output[0 * InnerCount + i], ReduceKind == MlasReduceSumSquare ? Infinity : -Infinity);
+      EXPECT_EQ(Output[1 * InnerCount + i], ReduceKind == MlasReduceMinimum ? 1.0f : Infinity);
+      if (ReduceKind == MlasReduceLogSumExp) {
+        EXPECT_NEAR(Output[2 * InnerCount + i], std::log(4.0f), 1e-5f);
+      }
+    }
+  }
+
+ public:
+  static const char* GetTestSuiteName() {
+    static const std::string suite_name(Threaded ? "Reduce_Threaded" : "Reduce_SingleThread");
+    return suite_name.c_str();
+  }
+
+  MlasReduceTest() : threadpool_(Threaded ? GetMlasThreadPool() : nullptr) {}
+
+  void ExecuteShort(void) override {
+    for (MLAS_REDUCE_KIND ReduceKind : {MlasReduceSum, MlasReduceSumSquare, MlasReduceMaximum,
+                                        MlasReduceMinimum, MlasReduceLogSumExp}) {
+      for (size_t ReduceCount : {1, 3, 4, 15, 16, 17, 67}) {
+        for (size_t InnerCount : {1, 2, 5, 16, 35}) {
+          Test(ReduceKind, 3, ReduceCount, InnerCount);
+        }
+      }
+
+      // Long rows and columns are split into segments over the threads.
+      Test(ReduceKind, 1, 100003, 1);
+      Test(ReduceKind, 2, 40000, 3);
+      Test(ReduceKind, 7, 300, 1100);
+      Test(ReduceKind, 1, 200, 5000);
+
+      TestInfinity(ReduceKind, 1);
+      TestInfinity(ReduceKind, 6);
+    }
+  }
+};
+
+static UNUSED_VARIABLE bool added_to_main = AddTestRegister([](bool is_short_execute) {
+  size_t count = 0;
+  if (is_short_execute) {
+    count += MlasDirectShortExecuteTests<MlasReduceTest<false>>::RegisterShortExecute();
+    if (GetMlasThreadPool() != nullptr) {
+      count += MlasDirectShortExecuteTests<MlasReduceTest<true>>::RegisterShortExecute();
+    }
+  }
+  return count;
+});
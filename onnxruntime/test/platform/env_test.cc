@@ -5,6 +5,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <unordered_set>
 
 #include "gtest/gtest.h"
 
@@ -55,5 +56,23 @@ TEST(PlatformEnvTest, GetErrnoInfo) {
 #endif
 }
 
+TEST(PlatformEnvTest, GetNumaNodeProcessors) {
+  const auto numa_nodes = Env::Default().GetNumaNodeProcessors();
+#if defined(__linux__)
+  // Every Linux kernel built with NUMA support exposes at least node0.
+  if (std::filesystem::exists("/sys/devices/system/node/node0/cpulist")) {
+    ASSERT_FALSE(numa_nodes.empty());
+  }
+#endif
+  // A logical processor belongs to a single node.
+  std::unordered_set<int> seen;
+  for (const auto& processors : numa_nodes) {
+    for (int processor : processors) {
+      ASSERT_GE(processor, 0);
+      ASSERT_TRUE(seen.insert(processor).second) << "processor " << processor << " is in more than one node";
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
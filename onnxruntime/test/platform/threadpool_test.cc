@@ -11,9 +11,13 @@
 #endif
 
 #include "gtest/gtest.h"
+#include "core/common/sampling_profiler.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -510,6 +514,111 @@ TEST(ThreadPoolTest, TestStagedMultiLoopSections_4Thread_100Loop) {
   TestStagedMultiLoopSections("TestStagedMultiLoopSections_4Thread_100Loop", 4, 100);
 }
 
+TEST(ThreadPoolTest, TestPriorityClassesRunAllIterations) {
+  ThreadOptions to;
+  to.priority_class_weights = {4, 2, 1};
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), to, nullptr, 4, true);
+  const ThreadPool::PriorityClass classes[] = {ThreadPool::PriorityClass::kHigh, ThreadPool::PriorityClass::kNormal,
+                                               ThreadPool::PriorityClass::kLow};
+  std::vector<std::unique_ptr<TestData>> test_data;
+  std::vector<std::thread> threads;
+  for (auto priority_class : classes) {
+    test_data.push_back(CreateTestData(10000));
+    threads.emplace_back([&tp, &data = *test_data.back(), priority_class]() {
+      ThreadPool::PriorityScope priority_scope(priority_class);
+      for (int loop = 0; loop < 10; ++loop) {
+        ThreadPool::TryParallelFor(tp.get(), 1000, 1000.0, [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            IncrementElement(data, loop * 1000 + i);
+          }
+        });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& data : test_data) {
+    ValidateTestData(*data);
+  }
+  for (auto priority_class : classes) {
+    ASSERT_NE(ThreadPool::GetQueueingDelayHistogram(tp.get(), priority_class), nullptr);
+  }
+}
+
+TEST(ThreadPoolTest, TestLowPriorityLoopYieldsWorkers) {
+  ThreadOptions to;
+  // The low priority class only gets the workers the high priority class does not need.
+  to.priority_class_weights = {1, 1, 0};
+  // A degree of parallelism of 3 creates 2 worker threads.
+  constexpr int kNumWorkers = 2;
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), to, nullptr, kNumWorkers + 1, true);
+
+  // The thread running the low priority loop holds its first iteration until the high priority loop has been
+  // joined, so the low priority loop cannot end first. The workers hold their first iteration until the high
+  // priority loop has started, so they are all busy with the low priority loop when it starts.
+  constexpr int kNumLowIterations = 1000;
+  auto low_data = CreateTestData(kNumLowIterations);
+  std::atomic<std::ptrdiff_t> low_iterations_started{0};
+  std::atomic<int> workers_in_low{0};
+  std::atomic<bool> high_started{false};
+  std::atomic<bool> high_joined{false};
+  std::thread low_thread([&]() {
+    const auto low_thread_id = std::this_thread::get_id();
+    ThreadPool::PriorityScope priority_scope(ThreadPool::PriorityClass::kLow);
+    ThreadPool::TrySimpleParallelFor(tp.get(), kNumLowIterations, [&](std::ptrdiff_t i) {
+      ++low_iterations_started;
+      if (std::this_thread::get_id() == low_thread_id) {
+        while (!high_joined) {
+          std::this_thread::yield();
+        }
+      } else if (!high_started) {
+        ++workers_in_low;
+        while (!high_started) {
+          std::this_thread::yield();
+        }
+      }
+      IncrementElement(*low_data, i);
+    });
+  });
+  while (workers_in_low < kNumWorkers) {
+    std::this_thread::yield();
+  }
+
+  // The workers leave the low priority loop between iterations to help this one, long before it runs out of
+  // iterations. This thread holds the high priority loop until a worker joins it.
+  const auto high_thread_id = std::this_thread::get_id();
+  std::atomic<bool> worker_joined_high{false};
+  std::atomic<std::ptrdiff_t> low_iterations_started_when_joined{0};
+  {
+    ThreadPool::PriorityScope priority_scope(ThreadPool::PriorityClass::kHigh);
+    ThreadPool::TrySimpleParallelFor(tp.get(), 20, [&](std::ptrdiff_t) {
+      if (std::this_thread::get_id() != high_thread_id) {
+        if (!worker_joined_high.exchange(true)) {
+          low_iterations_started_when_joined = low_iterations_started.load();
+        }
+        return;
+      }
+      high_started = true;
+      while (!worker_joined_high) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  high_joined = true;
+  low_thread.join();
+
+  EXPECT_LT(low_iterations_started_when_joined, kNumLowIterations);
+  ValidateTestData(*low_data);
+  EXPECT_GT(ThreadPool::GetQueueingDelayHistogram(tp.get(), ThreadPool::PriorityClass::kHigh)->Count(), 0u);
+}
+
+TEST(ThreadPoolTest, TestQueueingDelayNeedsPriorityWeights) {
+  auto tp = std::make_unique<ThreadPool>(&onnxruntime::Env::Default(), ThreadOptions(), nullptr, 2, true);
+  EXPECT_EQ(ThreadPool::GetQueueingDelayHistogram(tp.get(), ThreadPool::PriorityClass::kNormal), nullptr);
+  EXPECT_EQ(ThreadPool::GetQueueingDelayHistogram(nullptr, ThreadPool::PriorityClass::kNormal), nullptr);
+}
+
 #ifdef _WIN32
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
 #pragma warning(push)
@@ -257,5 +257,41 @@ TEST(CumSumTest, _1DTestLong) {
   test.AddOutput<int32_t>("y", {N}, output_value);
   test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
 }
+TEST(CumSumTest, _3DTestLargeInnerDims) {
+  // the slices are scanned in parallel in blocks of columns, so use several slices with a partial last block
+  constexpr int64_t upper = 3, dim = 5, lower = 2500;
+  std::vector<int64_t> input_value(upper * dim * lower);
+  std::iota(input_value.begin(), input_value.end(), int64_t{0});
+
+  for (int64_t exclusive = 0; exclusive < 2; ++exclusive) {
+    for (int64_t reverse = 0; reverse < 2; ++reverse) {
+      std::vector<int64_t> output_value(input_value.size());
+      for (int64_t u = 0; u < upper; ++u) {
+        for (int64_t l = 0; l < lower; ++l) {
+          int64_t sum = 0;
+          for (int64_t step = 0; step < dim; ++step) {
+            const int64_t i = reverse ? dim - 1 - step : step;
+            const size_t offset = static_cast<size_t>((u * dim + i) * lower + l);
+            if (exclusive) {
+              output_value[offset] = sum;
+              sum += input_value[offset];
+            } else {
+              sum += input_value[offset];
+              output_value[offset] = sum;
+            }
+          }
+        }
+      }
+
+      OpTester test("CumSum", 11, onnxruntime::kOnnxDomain);
+      test.AddAttribute<int64_t>("exclusive", exclusive);
+      test.AddAttribute<int64_t>("reverse", reverse);
+      test.AddInput<int64_t>("x", {upper, dim, lower}, input_value);
+      test.AddInput<int32_t>("axis", {}, {1});
+      test.AddOutput<int64_t>("y", {upper, dim, lower}, output_value);
+      test.Run(OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+    }
+  }
+}
 }  // namespace test
 }  // namespace onnxruntime
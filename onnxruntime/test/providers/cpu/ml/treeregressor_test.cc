@@ -1,8 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/asserts.h"
 
 namespace onnxruntime {
 namespace test {
@@ -885,5 +887,173 @@ TEST(MLOpTest, TreeRegressorBranchEq) {
   test.Run();
 }
 
+TEST(MLOpTest, TreeRegressorBranchLtMissingTracks) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  // Two trees with only BRANCH_LT nodes, the first node tracks missing values to the true branch.
+  int64_t n_targets = 1;
+  std::vector<int64_t> nodes_featureids = {0, 0, 1, 0, 0, 1, 0, 0};
+  std::vector<std::string> nodes_modes = {"BRANCH_LT", "LEAF", "BRANCH_LT", "LEAF", "LEAF", "BRANCH_LT", "LEAF", "LEAF"};
+  std::vector<float> nodes_values = {0.5f, 0.f, 2.f, 0.f, 0.f, 2.f, 0.f, 0.f};
+  std::vector<int64_t> nodes_treeids = {0, 0, 0, 0, 0, 1, 1, 1};
+  std::vector<int64_t> nodes_nodeids = {0, 1, 2, 3, 4, 0, 1, 2};
+  std::vector<int64_t> nodes_falsenodeids = {2, 0, 4, 0, 0, 2, 0, 0};
+  std::vector<int64_t> nodes_truenodeids = {1, 0, 3, 0, 0, 1, 0, 0};
+  std::vector<int64_t> nodes_missing_value_tracks_true = {1, 0, 0, 0, 0, 0, 0, 0};
+
+  std::vector<int64_t> target_ids = {0, 0, 0, 0, 0};
+  std::vector<int64_t> target_nodeids = {1, 3, 4, 1, 2};
+  std::vector<int64_t> target_treeids = {0, 0, 0, 1, 1};
+  std::vector<float> target_weights = {1.f, 10.f, 100.f, 0.5f, 5.f};
+
+  // add attributes
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("nodes_missing_value_tracks_true", nodes_missing_value_tracks_true);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", n_targets);
+
+  // fill input data
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> X = {0.f, 1.f, 0.5f, 2.f, nan, 1.f, 1.f, nan, nan, nan, 0.7f, 1.9999f};
+  std::vector<float> Y = {1.5f, 105.f, 1.5f, 105.f, 6.f, 10.5f};
+  test.AddInput<float>("X", {6, 2}, X);
+  test.AddOutput<float>("Y", {6, 1}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorDeepTree) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  // One chain with 70 leaves, internal node k tests x <= k + 0.5 and its true branch is a leaf of weight k.
+  const int64_t n_leaves = 70;
+  std::vector<int64_t> nodes_featureids, nodes_treeids, nodes_nodeids, nodes_falsenodeids, nodes_truenodeids;
+  std::vector<std::string> nodes_modes;
+  std::vector<float> nodes_values;
+  std::vector<int64_t> target_ids, target_nodeids, target_treeids;
+  std::vector<float> target_weights;
+  for (int64_t k = 0; k < n_leaves; ++k) {
+    bool last = k == n_leaves - 1;
+    nodes_featureids.insert(nodes_featureids.end(), {0, 0});
+    nodes_treeids.insert(nodes_treeids.end(), {0, 0});
+    nodes_nodeids.insert(nodes_nodeids.end(), {2 * k, 2 * k + 1});
+    nodes_truenodeids.insert(nodes_truenodeids.end(), {last ? 0 : 2 * k + 1, 0});
+    nodes_falsenodeids.insert(nodes_falsenodeids.end(), {last ? 0 : 2 * k + 2, 0});
+    nodes_modes.insert(nodes_modes.end(), {last ? "LEAF" : "BRANCH_LEQ", "LEAF"});
+    nodes_values.insert(nodes_values.end(), {static_cast<float>(k) + 0.5f, 0.f});
+    target_ids.push_back(0);
+    target_nodeids.push_back(last ? 2 * k : 2 * k + 1);
+    target_treeids.push_back(0);
+    target_weights.push_back(static_cast<float>(k));
+  }
+  // The last internal position is a leaf, its unused sibling is removed.
+  for (auto* v : {&nodes_featureids, &nodes_treeids, &nodes_nodeids, &nodes_truenodeids, &nodes_falsenodeids}) {
+    v->pop_back();
+  }
+  nodes_modes.pop_back();
+  nodes_values.pop_back();
+
+  // add attributes
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", (int64_t)1);
+
+  // fill input data, 21 rows cover several blocks of rows
+  std::vector<float> X, Y;
+  for (int i = 0; i < 20; ++i) {
+    X.push_back(static_cast<float>(i * 4) - 0.25f);
+    Y.push_back(static_cast<float>(std::min(i * 4, 69)));
+  }
+  X.push_back(1000.f);
+  Y.push_back(69.f);
+  test.AddInput<float>("X", {21, 1}, X);
+  test.AddOutput<float>("Y", {21, 1}, Y);
+  test.Run();
+}
+
+TEST(MLOpTest, TreeRegressorManyTreesFewRows) {
+  // Enough stumps for the trees to be split among threads when there are only a few rows.
+  constexpr int64_t n_trees = 200;
+  for (int64_t n_targets : {1, 2}) {
+    std::vector<int64_t> nodes_featureids, nodes_treeids, nodes_nodeids, nodes_falsenodeids, nodes_truenodeids;
+    std::vector<std::string> nodes_modes;
+    std::vector<float> nodes_values;
+    std::vector<int64_t> target_ids, target_nodeids, target_treeids;
+    std::vector<float> target_weights;
+    for (int64_t t = 0; t < n_trees; ++t) {
+      nodes_featureids.insert(nodes_featureids.end(), {t % 2, 0, 0});
+      nodes_modes.insert(nodes_modes.end(), {"BRANCH_LEQ", "LEAF", "LEAF"});
+      nodes_values.insert(nodes_values.end(), {static_cast<float>(t) / n_trees, 0.f, 0.f});
+      nodes_treeids.insert(nodes_treeids.end(), {t, t, t});
+      nodes_nodeids.insert(nodes_nodeids.end(), {0, 1, 2});
+      nodes_truenodeids.insert(nodes_truenodeids.end(), {1, 0, 0});
+      nodes_falsenodeids.insert(nodes_falsenodeids.end(), {2, 0, 0});
+      for (int64_t target = 0; target < n_targets; ++target) {
+        target_ids.insert(target_ids.end(), {target, target});
+        target_nodeids.insert(target_nodeids.end(), {1, 2});
+        target_treeids.insert(target_treeids.end(), {t, t});
+        target_weights.insert(target_weights.end(),
+                              {static_cast<float>(t % 7 + target), -static_cast<float>(t % 3 + target)});
+      }
+    }
+
+    for (int64_t n_rows : {1, 3}) {
+      std::vector<float> X;
+      std::vector<float> Y;
+      for (int64_t i = 0; i < n_rows; ++i) {
+        const float x[2] = {0.3f + 0.2f * i, 0.8f - 0.3f * i};
+        X.insert(X.end(), x, x + 2);
+        for (int64_t target = 0; target < n_targets; ++target) {
+          float y = 0.f;
+          for (int64_t t = 0; t < n_trees; ++t) {
+            y += x[t % 2] <= static_cast<float>(t) / n_trees ? static_cast<float>(t % 7 + target)
+                                                             : -static_cast<float>(t % 3 + target);
+          }
+          Y.push_back(y);
+        }
+      }
+
+      OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+      test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+      test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+      test.AddAttribute("nodes_treeids", nodes_treeids);
+      test.AddAttribute("nodes_nodeids", nodes_nodeids);
+      test.AddAttribute("nodes_featureids", nodes_featureids);
+      test.AddAttribute("nodes_values", nodes_values);
+      test.AddAttribute("nodes_modes", nodes_modes);
+      test.AddAttribute("target_treeids", target_treeids);
+      test.AddAttribute("target_nodeids", target_nodeids);
+      test.AddAttribute("target_ids", target_ids);
+      test.AddAttribute("target_weights", target_weights);
+      test.AddAttribute("n_targets", n_targets);
+      test.AddInput<float>("X", {n_rows, 2}, X);
+      test.AddOutput<float>("Y", {n_rows, n_targets}, Y);
+      test.Run();
+
+      // Same result when QuickScorer is disabled and the trees are walked node by node.
+      SessionOptions so;
+      ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsTreeEnsembleQuickScorer, "0"));
+      test.Config(so).RunWithConfig();
+    }
+  }
+}
+
 }  // namespace test
 }  // namespace onnxruntime
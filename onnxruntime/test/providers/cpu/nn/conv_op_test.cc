@@ -1,9 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 #include "core/graph/constants.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "gtest/gtest.h"
 #include "test/common/random_generator.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/default_providers.h"
 
 using namespace std;
 namespace onnxruntime {
@@ -80,8 +82,73 @@ void TestConvOp(const ConvOpAndTestAttributes& attributes,
   test.Run(expect_result, err_str, excluded_providers);
 }
 
+// Runs a 3x3 Conv with mlas.enable_conv_fast_algorithms, for which MLAS selects the Winograd algorithm, and
+// compares it with a direct computation. The filter is transformed by PrePack if the shape of X is static, by the
+// first run if it is symbolic, and not at all if the filter is not an initializer.
+void TestConvFastAlgorithms(bool weight_is_initializer, bool symbolic_input_shape) {
+  constexpr int64_t C = 32, M = 32, H = 28, W = 28;
+
+  RandomValueGenerator random{1234};
+  const vector<int64_t> X_shape{1, C, H, W};
+  const vector<int64_t> W_shape{M, C, 3, 3};
+  const vector<float> X = random.Uniform<float>(X_shape, -1.0f, 1.0f);
+  const vector<float> filter = random.Uniform<float>(W_shape, -1.0f, 1.0f);
+  const vector<float> B = random.Uniform<float>(vector<int64_t>{M}, -1.0f, 1.0f);
+
+  vector<float> expected(M * H * W);
+  for (int64_t m = 0; m < M; m++) {
+    for (int64_t h = 0; h < H; h++) {
+      for (int64_t w = 0; w < W; w++) {
+        double sum = B[m];
+        for (int64_t c = 0; c < C; c++) {
+          for (int64_t kh = 0; kh < 3; kh++) {
+            for (int64_t kw = 0; kw < 3; kw++) {
+              const int64_t ih = h + kh - 1;
+              const int64_t iw = w + kw - 1;
+              if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+                sum += double(X[(c * H + ih) * W + iw]) * filter[((m * C + c) * 3 + kh) * 3 + kw];
+              }
+            }
+          }
+        }
+        expected[(m * H + h) * W + w] = static_cast<float>(sum);
+      }
+    }
+  }
+
+  OpTester test("Conv", 11);
+  test.AddAttribute("kernel_shape", vector<int64_t>{3, 3});
+  test.AddAttribute("pads", vector<int64_t>{1, 1, 1, 1});
+
+  const vector<string> X_dim_params{"N", "C", "H", "W"};
+  test.AddInput<float>("X", X_shape, X, false, symbolic_input_shape ? &X_dim_params : nullptr);
+  test.AddInput<float>("W", W_shape, filter, weight_is_initializer);
+  test.AddInput<float>("B", vector<int64_t>{M}, B, weight_is_initializer);
+  test.AddOutput<float>("Y", vector<int64_t>{1, M, H, W}, expected);
+  test.SetOutputTolerance(1e-3f);
+
+  SessionOptions so;
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsMlasConvFastAlgorithms, "1"));
+
+  test.Config(so)
+      .ConfigEp(DefaultCpuExecutionProvider())
+      .RunWithConfig();
+}
+
 }  // namespace
 
+TEST(ConvTest, Conv2D_FastAlgorithms_PrePacked) {
+  TestConvFastAlgorithms(true, false);
+}
+
+TEST(ConvTest, Conv2D_FastAlgorithms_SymbolicInputShape) {
+  TestConvFastAlgorithms(true, true);
+}
+
+TEST(ConvTest, Conv2D_FastAlgorithms_WeightNotInitializer) {
+  TestConvFastAlgorithms(false, false);
+}
+
 // Conv
 TEST(ConvTest, Conv1D_1) {
   ConvOpAndTestAttributes attrs = {
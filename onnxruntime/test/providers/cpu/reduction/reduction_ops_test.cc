@@ -2601,6 +2601,77 @@ TEST(ReductionOpTest, ReduceSum_bert_selected_batch_size) {
   test_apex_reduce_sum(86 * 128, 768);
 }
 
+// Reduces axes which can't be merged into the KR, RK, KRK or RKR layouts.
+TEST(ReductionOpTest, ReduceFloat_non_contiguous_axes) {
+  const std::vector<int64_t> dims{4, 6, 5, 33};
+  std::vector<float> X(4 * 6 * 5 * 33);
+  std::default_random_engine generator(0);
+  std::uniform_real_distribution<float> distribution(-2.0f, 2.0f);
+  for (auto& x : X) {
+    x = distribution(generator);
+  }
+
+  for (const auto& axes : {std::vector<int64_t>{1, 3}, std::vector<int64_t>{0, 2}}) {
+    for (const char* op : {"ReduceSum", "ReduceMean", "ReduceMax", "ReduceMin", "ReduceSumSquare",
+                           "ReduceLogSumExp"}) {
+      const std::string name(op);
+      std::vector<int64_t> output_dims(dims);
+      for (auto a : axes) {
+        output_dims[static_cast<size_t>(a)] = 1;
+      }
+      const size_t output_size = static_cast<size_t>(output_dims[0] * output_dims[1] * output_dims[2] *
+                                                     output_dims[3]);
+      std::vector<std::vector<double>> groups(output_size);
+      for (int64_t i0 = 0; i0 < dims[0]; ++i0) {
+        for (int64_t i1 = 0; i1 < dims[1]; ++i1) {
+          for (int64_t i2 = 0; i2 < dims[2]; ++i2) {
+            for (int64_t i3 = 0; i3 < dims[3]; ++i3) {
+              const int64_t index[] = {i0, i1, i2, i3};
+              int64_t o = 0;
+              for (size_t d = 0; d < 4; ++d) {
+                o = o * output_dims[d] + (output_dims[d] == 1 ? 0 : index[d]);
+              }
+              groups[o].push_back(X[((i0 * dims[1] + i1) * dims[2] + i2) * dims[3] + i3]);
+            }
+          }
+        }
+      }
+
+      std::vector<float> Y;
+      for (const auto& g : groups) {
+        const double maximum = *std::max_element(g.begin(), g.end());
+        double value = 0.0;
+        for (double v : g) {
+          value += name == "ReduceSumSquare" ? v * v : name == "ReduceLogSumExp" ? std::exp(v - maximum) : v;
+        }
+        if (name == "ReduceMean") {
+          value /= static_cast<double>(g.size());
+        } else if (name == "ReduceMax") {
+          value = maximum;
+        } else if (name == "ReduceMin") {
+          value = *std::min_element(g.begin(), g.end());
+        } else if (name == "ReduceLogSumExp") {
+          value = maximum + std::log(value);
+        }
+        Y.push_back(static_cast<float>(value));
+      }
+
+      OpTester test(op, 13);
+      if (name != "ReduceSum") {
+        test.AddAttribute("axes", axes);
+      }
+      test.AddInput<float>("data", dims, X);
+      if (name == "ReduceSum") {
+        test.AddInput<int64_t>("axes", {static_cast<int64_t>(axes.size())}, axes);
+      }
+      test.AddOutput<float>("reduced", output_dims, Y);
+      test.SetOutputAbsErr("reduced", 1e-4f);
+      test.SetOutputRelErr("reduced", 1e-4f);
+      test.Run();
+    }
+  }
+}
+
 TEST(ReductionOpTest, ReduceSum_apex_more) {
   std::srand(0);
 #ifdef USE_TENSORRT
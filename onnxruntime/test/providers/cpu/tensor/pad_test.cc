@@ -1404,5 +1404,43 @@ TEST(PadOpTest, Pad_Wrap_NegativeFront_PositiveBack) {
   test.RunWithConfig();
 }
 
+TEST(PadOpTest, ConstantPadLargeMixedPads) {
+  // large enough for the output to be split across threads, with padding and slicing on every axis
+  const std::vector<int64_t> input_shape = {6, 40, 150};
+  const std::vector<int64_t> pads = {1, -3, 7, -2, 5, -9};
+  const float value = -1.0f;
+
+  std::vector<float> input_data(6 * 40 * 150);
+  std::iota(input_data.begin(), input_data.end(), 0.0f);
+
+  std::vector<int64_t> expected_shape(3);
+  for (size_t i = 0; i < 3; ++i) {
+    expected_shape[i] = input_shape[i] + pads[i] + pads[i + 3];
+  }
+
+  std::vector<float> expected_data;
+  for (int64_t i0 = 0; i0 < expected_shape[0]; ++i0) {
+    for (int64_t i1 = 0; i1 < expected_shape[1]; ++i1) {
+      for (int64_t i2 = 0; i2 < expected_shape[2]; ++i2) {
+        // index into the input, which is outside of it in the padding
+        const int64_t j0 = i0 - pads[0], j1 = i1 - pads[1], j2 = i2 - pads[2];
+        const bool in_input = j0 >= 0 && j0 < input_shape[0] && j1 >= 0 && j1 < input_shape[1] &&
+                              j2 >= 0 && j2 < input_shape[2];
+        const auto offset = static_cast<size_t>((j0 * input_shape[1] + j1) * input_shape[2] + j2);
+        expected_data.push_back(in_input ? input_data[offset] : value);
+      }
+    }
+  }
+
+  OpTester test("Pad", 18);
+  test.AddAttribute("mode", "constant");
+  test.AddInput<float>("data", input_shape, input_data);
+  test.AddInput<int64_t>("pads", {static_cast<int64_t>(pads.size())}, pads, true);
+  test.AddInput<float>("constant_value", {}, {value}, true);
+  test.AddOutput<float>("output", expected_shape, expected_data);
+  test.ConfigExcludeEps({kTensorrtExecutionProvider, kNnapiExecutionProvider});
+  test.RunWithConfig();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
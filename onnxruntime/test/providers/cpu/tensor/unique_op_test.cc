@@ -1,6 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -137,6 +142,79 @@ TEST(Unique, Flatten_Sorted_String) {
                              inverse_indices_dims, inverse_indices, counts_dims, counts);
 }
 
+// -0 and +0 are the same value, and all NaNs are the same value, which sorts last
+TEST(Unique, Flatten_Sorted_SignedZeroAndNaN) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<int64_t> X_dims{7};
+  const std::vector<float> X{nan, 1.f, -0.f, 2.f, 0.f, nan, -1.f};
+  const int64_t* axis = nullptr;
+  bool sorted = true;
+  const std::vector<int64_t> Y_dims{5};
+  const std::vector<float> Y{-1.f, -0.f, 1.f, 2.f, nan};
+
+  const std::vector<int64_t> indices_dims{5};
+  const std::vector<int64_t> indices{6, 2, 1, 3, 0};
+  const std::vector<int64_t> inverse_indices_dims{7};
+  const std::vector<int64_t> inverse_indices{4, 2, 1, 3, 1, 4, 0};
+  const std::vector<int64_t> counts_dims{5};
+  const std::vector<int64_t> counts{1, 2, 1, 1, 2};
+
+  RunUniqueTest<float>(X_dims, X, axis, sorted, Y_dims, Y, indices_dims, indices,
+                       inverse_indices_dims, inverse_indices, counts_dims, counts);
+}
+
+// large enough to be split into partitions, with enough unique values to be radix sorted
+static void RunLargeFlattenedUniqueTest(bool sorted) {
+  std::default_random_engine generator(42);
+  std::uniform_int_distribution<int64_t> distribution(-50000, 50000);
+
+  std::vector<int64_t> X(200000);
+  for (auto& x : X) {
+    x = distribution(generator) * 1000003;
+  }
+
+  std::map<int64_t, int64_t> first_index;  // value -> first index
+  std::vector<int64_t> unique_values;      // in order of first occurrence
+  std::map<int64_t, int64_t> value_counts;
+  for (size_t i = 0; i < X.size(); ++i) {
+    if (first_index.emplace(X[i], static_cast<int64_t>(i)).second) {
+      unique_values.push_back(X[i]);
+    }
+    ++value_counts[X[i]];
+  }
+
+  if (sorted) {
+    std::sort(unique_values.begin(), unique_values.end());
+  }
+
+  std::map<int64_t, int64_t> output_index;
+  std::vector<int64_t> indices;
+  std::vector<int64_t> counts;
+  for (const auto value : unique_values) {
+    output_index[value] = static_cast<int64_t>(indices.size());
+    indices.push_back(first_index[value]);
+    counts.push_back(value_counts[value]);
+  }
+
+  std::vector<int64_t> inverse_indices;
+  for (const auto x : X) {
+    inverse_indices.push_back(output_index[x]);
+  }
+
+  const int64_t num_unique = static_cast<int64_t>(unique_values.size());
+  RunUniqueTest<int64_t>({static_cast<int64_t>(X.size())}, X, nullptr, sorted, {num_unique}, unique_values,
+                         {num_unique}, indices, {static_cast<int64_t>(X.size())}, inverse_indices,
+                         {num_unique}, counts);
+}
+
+TEST(Unique, Flatten_Unsorted_Large) {
+  RunLargeFlattenedUniqueTest(false);
+}
+
+TEST(Unique, Flatten_Sorted_Large) {
+  RunLargeFlattenedUniqueTest(true);
+}
+
 TEST(Unique, NoOptionalOutput) {
   const std::vector<int64_t> X_dims{2, 4};
   const std::vector<int8_t> X{1, 4, -1, 2, 2, 0, -1, 4};
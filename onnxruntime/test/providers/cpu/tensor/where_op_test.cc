@@ -146,5 +146,47 @@ TEST(WhereOpTest, BroadcastWithScalar) {
   test.Run();
 }
 
+TEST(WhereOpTest, LargeBroadcast) {
+  // large enough to be split across threads, with each input broadcast along a different axis
+  constexpr int64_t D0 = 16, D1 = 32, D2 = 257;
+
+  // std::vector<bool> has no data() so use an array for the condition
+  constexpr size_t condition_size = D0 * D2;
+  auto condition_values = std::make_unique<bool[]>(condition_size);
+  for (size_t i = 0; i < condition_size; ++i) {
+    condition_values[i] = (i * 7) % 3 != 0;
+  }
+
+  std::vector<float> X_values(D0 * D1 * D2);
+  for (size_t i = 0; i < X_values.size(); ++i) {
+    X_values[i] = static_cast<float>(i);
+  }
+
+  std::vector<float> Y_values(D1);
+  for (size_t i = 0; i < Y_values.size(); ++i) {
+    Y_values[i] = -static_cast<float>(i);
+  }
+
+  std::vector<float> result(D0 * D1 * D2);
+  for (int64_t i0 = 0; i0 < D0; ++i0) {
+    for (int64_t i1 = 0; i1 < D1; ++i1) {
+      for (int64_t i2 = 0; i2 < D2; ++i2) {
+        const int64_t offset = (i0 * D1 + i1) * D2 + i2;
+        result[offset] = condition_values[i0 * D2 + i2] ? X_values[offset] : Y_values[i1];
+      }
+    }
+  }
+
+  OpTester test{kOpName, kOpVersion};
+
+  test.AddInput<bool>("condition", {D0, 1, D2}, condition_values.get(), condition_size);
+  test.AddInput<float>("X", {D0, D1, D2}, X_values);
+  test.AddInput<float>("Y", {D1, 1}, Y_values);
+
+  test.AddOutput<float>("output", {D0, D1, D2}, result);
+
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime